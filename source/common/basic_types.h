@@ -83,7 +83,7 @@ typedef struct outputframe_t    outputframe_t;
 
 
 /* ---------------------------------------------------------------------------
- * SAOStatData
+ * SAOBlkParam
  */
 typedef struct SAOBlkParam {
     int         mergeIdx;             // 0: merge_left, 1: merge_up, 2 not merge (new parameter)
@@ -93,5 +93,13 @@ typedef struct SAOBlkParam {
     int         offset[MAX_NUM_SAO_CLASSES];
 } SAOBlkParam;
 
+/* ---------------------------------------------------------------------------
+ * SAOStatData
+ */
+typedef struct SAOStatData {
+    long        diff[MAX_NUM_SAO_CLASSES];
+    long        count[MAX_NUM_SAO_CLASSES];
+} SAOStatData;
+
 
 #endif  // XAVS2_BASIC_TYPES_H
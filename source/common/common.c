@@ -50,6 +50,13 @@
 #if HAVE_MALLOC_H
 #include <malloc.h>
 #endif
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
+#if SYS_LINUX && HAVE_MMAP
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
 
 /**
  * ===========================================================================
@@ -57,6 +64,9 @@
  * ===========================================================================
  */
 static size_t g_xavs2_size_mem_alloc = 0;
+#if HAVE_THREAD
+static xavs2_thread_mutex_t g_xavs2_init_mutex = XAVS2_PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 const float FRAME_RATE[8] = {
     24000.0f / 1001.0f, 24.0f, 25.0f, 30000.0f / 1001.0f, 30.0f, 50.0f, 60000.0f / 1001.0f, 60.0f
@@ -237,20 +247,100 @@ void xavs2_log(void *p, int i_log_level, const char *psz_fmt, ...)
     }
 }
 
-/* xavs2_malloc : will do or emulate a memalign
- * you have to use xavs2_free for buffers allocated with xavs2_malloc */
-void *xavs2_malloc(size_t i_size)
+/* ---------------------------------------------------------------------------
+ * the tables shared by all encoders are built once: a builder checks its flag
+ * with an acquire load, then builds and publishes it under this lock
+ */
+void xavs2_init_lock(void)
+{
+#if HAVE_THREAD
+    xavs2_thread_mutex_lock(&g_xavs2_init_mutex);
+#endif
+}
+
+void xavs2_init_unlock(void)
+{
+#if HAVE_THREAD
+    xavs2_thread_mutex_unlock(&g_xavs2_init_mutex);
+#endif
+}
+
+#if HAVE_MMAP
+/* ---------------------------------------------------------------------------
+ * map pages for a large buffer: huge pages and NUMA node are applied before
+ * the pages are touched. return the start address (aligned to a huge page)
+ */
+static uint8_t *xavs2_map_large(size_t map_size, uint8_t **p_base, int hugepage_mode, int numa_node)
+{
+    uint8_t *buf = (uint8_t *)MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if (hugepage_mode == 2) {
+        /* explicit huge pages, needs pages reserved in the hugetlb pool */
+        buf = (uint8_t *)mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+    if (buf == (uint8_t *)MAP_FAILED) {
+        buf = (uint8_t *)mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buf == (uint8_t *)MAP_FAILED) {
+            return NULL;
+        }
+#if HAVE_THP
+        if (hugepage_mode) {
+            madvise(buf, map_size, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
+#if SYS_LINUX && defined(SYS_mbind)
+    if (numa_node >= 0 && numa_node < 64) {
+        unsigned long node_mask = 1UL << numa_node;
+        /* MPOL_PREFERRED (1): fall back to other nodes when the node is full */
+        syscall(SYS_mbind, buf, map_size, 1, &node_mask, sizeof(node_mask) * 8, 0);
+    }
+#endif
+
+    *p_base = buf;
+    return (uint8_t *)(((uintptr_t)buf + HUGE_PAGE_SIZE - 1) & ~((uintptr_t)HUGE_PAGE_SIZE - 1));
+}
+#endif
+
+/* xavs2_malloc_policy : xavs2_malloc with the allocation policy of large buffers
+ * hugepage_mode: 0: off, 1: transparent huge pages, 2: explicit huge pages
+ * numa_node: preferred NUMA node of large buffers, -1: none
+ * the base address and the mapped size (0 for malloc) are stored before the buffer */
+void *xavs2_malloc_policy(size_t i_size, int hugepage_mode, int numa_node)
 {
     intptr_t mask = CACHE_LINE_SIZE - 1;
     uint8_t *align_buf = NULL;
-    size_t size_malloc = i_size + mask + sizeof(void **);
-    uint8_t *buf = (uint8_t *)malloc(size_malloc);
+    size_t size_malloc = i_size + mask + 2 * sizeof(void **);
+    uint8_t *buf;
+
+#if HAVE_MMAP
+    if ((hugepage_mode || numa_node >= 0) && i_size >= HUGE_PAGE_THRESHOLD) {
+        size_t map_size = ((i_size + CACHE_LINE_SIZE + HUGE_PAGE_SIZE - 1) & ~((size_t)HUGE_PAGE_SIZE - 1)) + HUGE_PAGE_SIZE;
+        uint8_t *start = xavs2_map_large(map_size, &buf, hugepage_mode, numa_node);
+
+        if (start != NULL) {
+            g_xavs2_size_mem_alloc += map_size;
+            align_buf = start + CACHE_LINE_SIZE;
+            *(((void **)align_buf) - 1) = buf;
+            *(((size_t *)align_buf) - 2) = map_size;
+            return align_buf;
+        }
+    }
+#else
+    UNUSED_PARAMETER(hugepage_mode);
+    UNUSED_PARAMETER(numa_node);
+#endif
 
+    buf = (uint8_t *)malloc(size_malloc);
     if (buf != NULL) {
         g_xavs2_size_mem_alloc += size_malloc;
-        align_buf = buf + mask + sizeof(void **);
+        align_buf = buf + mask + 2 * sizeof(void **);
         align_buf -= (intptr_t)align_buf & mask;
         *(((void **)align_buf) - 1) = buf;
+        *(((size_t *)align_buf) - 2) = 0;
     } else {
         fprintf(stderr, "malloc of size %zu failed\n", i_size);
     }
@@ -258,6 +348,13 @@ void *xavs2_malloc(size_t i_size)
     return align_buf;
 }
 
+/* xavs2_malloc : will do or emulate a memalign
+ * you have to use xavs2_free for buffers allocated with xavs2_malloc */
+void *xavs2_malloc(size_t i_size)
+{
+    return xavs2_malloc_policy(i_size, 0, -1);
+}
+
 void *xavs2_calloc(size_t count, size_t size)
 {
     void *p = xavs2_malloc(count * size);
@@ -270,6 +367,13 @@ void *xavs2_calloc(size_t count, size_t size)
 void xavs2_free(void *ptr)
 {
     if (ptr != NULL) {
+#if HAVE_MMAP
+        size_t map_size = *(((size_t *)ptr) - 2);
+        if (map_size != 0) {
+            munmap(*(((void **)ptr) - 1), map_size);
+            return;
+        }
+#endif
         free(*(((void **)ptr) - 1));
     }
 }
@@ -114,6 +114,15 @@
     }\
     MULTI_LINE_MACRO_END
 
+/* large buffers of an encoder: huge pages and NUMA node of its parameters */
+#define CHECKED_MALLOC_LARGE(var, type, size, param) \
+    MULTI_LINE_MACRO_BEGIN\
+    (var) = (type)xavs2_malloc_policy(size, (param)->hugepage_mode, (param)->numa_node);\
+    if ((var) == NULL) {\
+        goto fail;\
+    }\
+    MULTI_LINE_MACRO_END
+
 #define CHECKED_MALLOCZERO(var, type, size) \
     MULTI_LINE_MACRO_BEGIN\
     size_t new_size = ((size + 31) >> 5) << 5; /* align the size to 32 bytes */ \
@@ -135,7 +144,17 @@
 enum rc_method_e {
     XAVS2_RC_CQP = 0,           /* const QP */
     XAVS2_RC_CBR_FRM = 1,       /* const bit-rate, frame level */
-    XAVS2_RC_CBR_SCU = 2        /* const bit-rate, SCU   level */
+    XAVS2_RC_CBR_SCU = 2,       /* const bit-rate, SCU   level */
+    XAVS2_RC_CRF = 4            /* const quality, frame QP decided by complexity */
+};
+
+
+/* ---------------------------------------------------------------------------
+ * adaptive quantization modes
+ */
+enum aq_mode_e {
+    XAVS2_AQ_NONE     = 0,      /* off, all LCUs are coded with the frame QP */
+    XAVS2_AQ_VARIANCE = 1       /* QP offsets of LCUs decided by the variance of luma */
 };
 
 
@@ -147,7 +166,8 @@ enum me_mothod_e {
     XAVS2_ME_DIA  = 1,        /* diamond search */
     XAVS2_ME_HEX  = 2,        /* hexagon search */
     XAVS2_ME_UMH  = 3,        /* UMH search */
-    XAVS2_ME_TZ   = 4         /* TZ search */
+    XAVS2_ME_TZ   = 4,        /* TZ search */
+    XAVS2_ME_SEA  = 5         /* successive elimination full search */
 };
 
 
@@ -422,6 +442,14 @@ typedef struct binary_t {
     int (*est_chroma_block_coeff)(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, coeff_t *quant_coeff, runlevel_t *runlevel,
                                   int i_level, int max_bits);
 
+    /* rate of a whole RDO candidate, called once per mode decision */
+    int (*est_intra_luma_rate)(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, int ipmode, coeff_t *quant_coeff, runlevel_t *runlevel,
+                               int i_level, int i_stride_shift, int intra_mode, int max_bits, int *rate_coeff);
+    int (*est_chroma_coeff_rate)(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, runlevel_t *runlevel,
+                                 int cbp, int i_level, int rate, int max_bits);
+    int (*est_cu_rate_intra)(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, runlevel_t *runlevel, int max_bits);
+    int (*est_cu_rate_inter)(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, runlevel_t *runlevel, int rate_chroma, int max_bits);
+
 #if ENABLE_RATE_CONTROL_CU
     int (*write_cu_cbp_dqp)(xavs2_t *h, aec_t *p_aec, cu_info_t *p_cu_info, int slice_index_cur_cu, int *last_dqp);
 #else
@@ -540,6 +568,8 @@ typedef struct xavs2_param_t {
     /* --- stream structure ------------------------------------- */
     int     intra_period_max;         /* maximum intra-period, one I-frame mush appear in any NumMax of frames */
     int     intra_period_min;         /* minimum intra-period, only one I-frame can appear in at most NumMin of frames */
+    int     scenecut_threshold;       /* sensitivity of scene cut detection (0: off, 1~100), a detected cut
+                                       * is coded as a key frame restarting the GOP structure */
     int     b_open_gop;               /* open GOP? 1: open, 0: close */
     int     enable_f_frame;           /* enable F-frame */
     int     num_bframes;              /* number of B frames that will be used */
@@ -558,10 +588,16 @@ typedef struct xavs2_param_t {
     /* --- analysis options ------------------------------------- */
     int     enable_hadamard;          /* 0: 'normal' SAD in 1/4 pixel search.  1: use 4x4 Haphazard transform and
                                        * Sum of absolute transform difference' in 1/4 pixel search */
+    int     enable_intra_satd_x4;     /* predict and compare the angular intra modes four at a time in the
+                                       * intra mode scan (used only with enable_hadamard). 0: one by one */
     int     me_method;                /* Fast motion estimation method. 1: DIA, 2: HEX 3: UMH */
     int     search_range;             /* search range - integer pel search and 16x16 blocks.  The search window is
                                        * generally around the predicted vector. Max vector is 2xmcrange.  For 8x8
                                        * and 4x4 block sizes the search range is 1/2 of that for 16x16 blocks. */
+    int     me_pyramid_range;         /* search range (in full-res pixels) of hierarchical ME on the downscaled
+                                       * luma pyramid, the coarse MVs are tested as ME candidates. 0: off */
+    int     me_mv_reuse;              /* reuse the fullpel MVs found in current LCU to seed and early terminate the
+                                       * search of later partitions, sub-CUs and references. 0: off */
     int     num_max_ref;              /* 1: prediction from the last frame only. 2: prediction from the last or
                                        * second last frame etc.  Maximum 5 frames (number of reference frames) */
     int     inter_2pu;                /* enable inter 2NxN or Nx2N or AMP mode */
@@ -569,9 +605,10 @@ typedef struct xavs2_param_t {
     int     enable_intra;             /* enable intra mode for inter frame */
     int     rdo_bit_est_method;       /* RDO bit estimation method:
                                        * 0: AEC with context updating; 1: AEC without context update
-                                       * 2: VLC */
+                                       * 2: VLC; 3: fractional bits from a table, without context update */
     int     preset_level;             /* preset level */
     int     is_preset_configured;     /* whether preset configuration is utilized */
+    float   speed_ctrl_fps;           /* target encoding speed (frames per second) of adaptive speed control, 0: off */
 
     /* encoding tools ------------------------------------------- */
     int     enable_mhp_skip;          /* enable MHP-skip */
@@ -631,17 +668,30 @@ typedef struct xavs2_param_t {
     int     chroma_quant_param_delta_v; /* chroma quant param delta cr */
 
     /* --- rate control ----------------------------------------- */
-    int     i_rc_method;              /* rate control method: 0: CQP, 1: CBR (frame level), 2: CBR (SCU level), 3: VBR */
+    int     i_rc_method;              /* rate control method: 0: CQP, 1: CBR (frame level), 2: CBR (SCU level), 3: VBR, 4: CRF */
     int     i_target_bitrate;         /* target bitrate (bps) */
+    float   f_rate_factor;            /* rate factor of CRF, QP of frames with average complexity (<0: same as i_initial_qp) */
+    int     i_rc_pass;                /* multi-pass rate control, 0: one pass, 1: first pass (write stats), 2: second pass (read stats) */
     int     i_initial_qp;             /* initial QP */
     int     i_min_qp;                 /* min QP */
     int     i_max_qp;                 /* max QP */
+    int     i_aq_mode;                /* adaptive quantization mode: XAVS2_AQ_* */
+    float   f_aq_strength;            /* strength of adaptive quantization, scales the QP offsets of LCUs */
 
     /* --- parallel --------------------------------------------- */
     int     num_parallel_gop;         /* number of parallel GOP */
     int     i_frame_threads;          /* number of thread in frame   level parallel */
     int     i_lcurow_threads;         /* number of thread in LCU-row level parallel */
     int     enable_aec_thread;        /* enable AEC threadpool or not */
+    int     enable_lean_memory;       /* size the input frame pool by the pipeline depth and use row-scope
+                                       * temporaries, to reduce the memory footprint. 0: off */
+    int     hugepage_mode;            /* back large buffers with 2MB pages. 0: off, 1: transparent huge pages,
+                                       * 2: explicit huge pages (MAP_HUGETLB), falls back to 1 on failure */
+    int     numa_node;                /* NUMA node for the memory and threads of the encoder. -1: no binding */
+    int     enable_parallel_ctu;      /* evaluate the split and non-split candidates of 64x64/32x32 CUs
+                                       * concurrently (parallel analysis inside CTU). 0: off */
+    int     enable_lf_wavefront;      /* run the loop filter (deblocking and SAO) of each LCU row as a separate
+                                       * task trailing the RDO of the row, with LCU row threads. 0: off */
 
     /* --- log -------------------------------------------------- */
     int     i_log_level;              /* log level */
@@ -661,6 +711,7 @@ typedef struct xavs2_param_t {
     char    psz_in_file[FN_LEN];      /* YUV 4:2:0 input format */
     char    psz_bs_file[FN_LEN];      /* AVS compressed output bitstream */
     char    psz_dump_yuv[FN_LEN];     /* filename for reconstructed frames */
+    char    psz_stats_file[FN_LEN];   /* filename for stats of multi-pass rate control */
 #if XAVS2_TRACE
     char    psz_trace_file[FN_LEN];   /* filename for trace information */
 #endif
@@ -725,6 +776,7 @@ struct aec_t {
     uint32_t    i_low;                /* low */
     uint32_t    i_t1;                 /* t1 */
     uint32_t    i_bits_to_follow;     /* current bit counter to follow */
+    uint32_t    i_frac_bits;          /* fractional bits of the table-driven RDO, in 1/(1 << AEC_FRAC_BITS) */
 
     /* flag */
     uint32_t    b_writting;           /* write to bitstream buffer? */
@@ -732,6 +784,11 @@ struct aec_t {
     /* handle */
     binary_t    binary;               /* binary function handles */
 
+    /* context snapshot */
+    uintptr_t   ctx_base_id;          /* owner of the base snapshot of contexts (0: no valid base) */
+    uint32_t    ctx_base_ver;         /* version of the base snapshot */
+    uint32_t    ctx_dirty;            /* mask of context blocks which may differ from the base snapshot */
+
     /* context */
     ctx_set_t  *p_ctx_set;            /* can reference other aec_t object */
     ctx_set_t   ctx_set;              /* context models for AEC (current object) */
@@ -1020,6 +1077,8 @@ struct xavs2_frame_t {
     int         i_frm_type;           /* frame type: XAVS2_TYPE_* */
     int         i_state;              /* flag, -1 for exit flag in thread */
     int         b_keyframe;           /* key frame? */
+    int         b_scenecut;           /* first frame of a new scene? (coded as a key frame) */
+    float       f_rc_cost[2];         /* intra and inter cost per pixel from the lookahead, for stats of the first pass */
     int64_t     i_pts;                /* user pts (Presentation Time Stamp) */
     int64_t     i_dts;                /* user dts (Decoding Time Stamp) */
     int64_t     i_reordered_pts;      /* reordered PTS (in coding order) */
@@ -1048,6 +1107,13 @@ struct xavs2_frame_t {
     int         i_lines[3];           /* height for Y/U/V */
     pel_t      *planes[3];            /* pointers to Y/U/V data buffer */
     pel_t      *filtered[16];         /* pointers to interpolated luma data buffers */
+    pel_t      *lowres[ME_PYRAMID_LEVELS];          /* downscaled luma planes for hierarchical ME, [0]: 1/2, [1]: 1/4 */
+    int         i_lowres_stride[ME_PYRAMID_LEVELS]; /* stride for downscaled luma planes */
+    int         i_lowres_width [ME_PYRAMID_LEVELS]; /* width  for downscaled luma planes */
+    int         i_lowres_lines [ME_PYRAMID_LEVELS]; /* height for downscaled luma planes */
+    uint32_t   *integral;             /* integral (sum) plane of padded luma for SEA, points to the position (0, 0) */
+    int         i_integral_stride;    /* stride for integral plane */
+    volatile int i_integral_rows;     /* number of LCU rows of which the integral lines are ready */
 
     pel_t      *plane_buf;
     int         size_plane_buf;
@@ -1074,6 +1140,7 @@ struct xavs2_frame_t {
     uint32_t    cnt_refered;          /* reference count for FT_DEC */
 
     int        *num_lcu_coded_in_row; /* 0, not ready, 1, ready */
+    int8_t     *aq_qp_offset;         /* QP offsets of all LCUs decided by AQ (FT_ENC only, NULL: AQ off) */
 
     xavs2_thread_cond_t  cond;
     xavs2_thread_mutex_t mutex;
@@ -1140,6 +1207,7 @@ typedef struct xavs2_me_t {
     mv_t        bmv2;                 /* best motion vector (fullpel) */
     dist_t      bcost;                /* best cost of subpel  motion search, satd + lambda * nbits */
     dist_t      bcost2;               /* best cost of fullpel motion search, sad  + lambda * nbits */
+    dist_t      stop_cost;            /* skip the fullpel pattern search if one candidate is not worse (-1: off) */
 
     dist_t      mvcost[5];            /* mv cost for every direction*/
     dist_t      bmvcost[5];           /* cost of best mv of all ref for every direction */
@@ -1149,15 +1217,17 @@ typedef struct xavs2_me_t {
 } xavs2_me_t;
 
 
-
 /* ---------------------------------------------------------------------------
- * SAOStatData
+ * memory usage of an encoding context (in bytes)
  */
-typedef struct SAOStatData {
-    long        diff[MAX_NUM_SAO_CLASSES];
-    long        count[MAX_NUM_SAO_CLASSES];
-} SAOStatData;
-
+typedef struct mem_usage_t {
+    size_t      total;                /* total size of the context */
+    size_t      bitstream;            /* bitstream buffers */
+    size_t      interpolation;        /* temporary buffers for 1/4 interpolation */
+    size_t      motion_est;           /* buffers for motion estimation */
+    size_t      frame_info;           /* CU, PU, SAO and ALF data of the frame */
+    size_t      extra_frames;         /* extra frames: TDRDO, SAO, ALF */
+} mem_usage_t;
 
 /* ---------------------------------------------------------------------------
  * ALFParam
@@ -1199,6 +1269,7 @@ typedef struct rdoq_t {
     int         i_tu_level;           /* */
     int         b_luma;               /* is luma? */
     int         b_dc_diag;            /* is INTRA_PRED_DC_DIAG or not */
+    int         b_swap_xy;            /* is the coefficient scan transposed? */
 } rdoq_t;
 
 
@@ -1250,6 +1321,8 @@ typedef struct lcu_info_t {
     int         slice_index;          /* slice index */
 #if ENABLE_RATE_CONTROL_CU
     int         last_dqp;             /* last delta QP */
+    int         i_qp;                 /* QP of the LCU (frame QP with the AQ offset) */
+    int         i_qp_last;            /* QP of the last CU in coding order (previous QP for the next LCU) */
 #endif
 } lcu_info_t;
 
@@ -1262,8 +1335,10 @@ typedef struct row_info_t {
     int             b_top_slice_border;   /* whether top  slice border should be processed */
     int             b_down_slice_border;  /* whether down slice border should be processed */
     volatile int    coded;            /* position of latest coded LCU. [0, xavs2_t::i_width_in_lcu) */
+    volatile int    filtered;         /* position of latest loop filtered LCU (loop filter wavefront only) */
 
     xavs2_t         *h;               /* context for the row */
+    xavs2_t         *h_lf;            /* context for the loop filter of the row (loop filter wavefront only) */
     lcu_info_t      *lcus;            /* [LCUs] */
 
     xavs2_thread_cond_t  cond;       /* lcu cond */
@@ -1379,8 +1454,11 @@ typedef struct cu_parallel_t {
     ALIGN32(pel_t   buf_pred_inter_c[LCU_BUF_SIZE >> 1]);   /* temporary decoding buffer for inter prediction (chroma) */
     ALIGN32(pel_t   buf_pixel_temp  [LCU_BUF_SIZE]);        /* temporary pixel buffer, used for bi/dual-prediction */
 
-    /* predication buffers for all intra modes */
-    ALIGN32(pel_t   intra_pred  [NUM_INTRA_MODE       ][LCU_BUF_SIZE]);         /* for all 33 luma prediction modes */
+    /* predication buffers for intra modes. the luma modes are scanned through
+     * one block and the RDO candidates are predicted again when tested, so
+     * that the working set of a luma block stays in the L1/L2 cache */
+    ALIGN32(pel_t   intra_pred  [LCU_BUF_SIZE]);                                /* luma prediction of the mode being tested */
+    ALIGN32(pel_t   intra_pred_scan[LCU_BUF_SIZE]);                             /* luma prediction of the mode being scanned */
     ALIGN32(pel_t   intra_pred_c[NUM_INTRA_MODE_CHROMA][LCU_BUF_SIZE >> 1]);    /* for all chroma intra prediction modes */
     ALIGN32(pel_t   buf_edge_pixels[MAX_CU_SIZE << 3]);     /* reference pixels for intra luma/chroma prediction */
 
@@ -1393,6 +1471,26 @@ typedef struct cu_parallel_t {
     aec_t  cs_pu_init;              /* coding state before encoding one CU partition */
 } cu_parallel_t;
 
+/* ---------------------------------------------------------------------------
+ * parallel analysis inside CTU: the non-split candidate of a large CU is
+ * evaluated on a helper context, while the owner context evaluates the split
+ */
+typedef struct cu_fork_t {
+    xavs2_t    *h;                    /* helper context */
+    cu_t       *p_cu;                 /* CU in the coding tree of the helper context */
+    dist_t    (*mincost_buf)[MAX_INTER_MODES][MAX_REFS];  /* private SAD prediction rows of the helper (UMH) */
+    int         i_level;              /* level of the CU */
+    int         i_min_level;          /* min CU level of current CTU */
+    int         i_upper_mode;         /* best mode of the upper CU level, -1: not available */
+    uint32_t    avail_modes;          /* available partition modes (inter) */
+    rdcost_t    cost_limit;           /* rd-cost limit for the non-split candidate */
+    rdcost_t    cost;                 /* [out] rd-cost of the non-split candidate */
+    int         b_split;              /* [out] is splitting still allowed by the early terminations? */
+#if ENABLE_RATE_CONTROL_CU
+    int         last_dqp;             /* last delta QP of the helper */
+#endif
+} cu_fork_t;
+
 
 /* ---------------------------------------------------------------------------
  */
@@ -1472,6 +1570,9 @@ struct xavs2_t {
                                            int block_x, int block_y, int block_w, int block_h);
     int       (*get_intra_candidates_chroma)(xavs2_t *h, cu_t *p_cu, int i_level, int pix_y_c, int pix_x_c,
                                              intra_candidate_t *p_candidate_list);
+    pixel_cmp_t *intra_cmp;           /* either satd or sad for intra mode prediction */
+    pixel_cmp_t *fpel_cmp;            /* either satd or sad for fractional pixel comparison in ME */
+    int         b_intra_satd_x4;      /* scan the angular intra modes with intra_satd_x4 (satd only) */
     void      (*copy_aec_state_rdo)(aec_t *dst, aec_t *src);  /* pointer to copy aec_t */
     int         size_aec_rdo_copy;    /* number of bytes to copy in RDO for \function aec_copy_aec_state_rdo() */
     uint8_t    *tab_avail_TR;         /* pointers to array of available table, Top Right */
@@ -1480,6 +1581,8 @@ struct xavs2_t {
     int8_t      num_intra_rmd_dist2;  /* 2ĽǶȵ */
     int8_t      num_intra_rmd_dist1;  /* 1ĽǶȵ */
     int8_t      num_rdo_intra_chroma; /* number of RDO modes for intra chroma prediction */
+    int         i_speed_level;        /* preset level of the fast algorithms currently applied */
+    int         i_speed_max_cu_level; /* level of the largest CU analysed at the current speed level */
 
     SYNC_VARS_2(communal_vars_2);
     /* === END ===================================================== */
@@ -1562,6 +1665,7 @@ struct xavs2_t {
     int         i_nal;                /* current NAL index */
     int         i_nal_type;           /* NAL type */
     int         i_nal_ref_idc;        /* NAL priority */
+    int64_t     i_time_frm_start;     /* time when the frame task starts, used for speed control */
 
     bs_t        header_bs;            /* bitstream controller for main thread */
     uint8_t    *p_bs_buf_header;      /* pointer to bitstream buffer for headers */
@@ -1571,7 +1675,12 @@ struct xavs2_t {
 
     xavs2_me_t  me_state;             /* used for motion estimation */
 
+    mct_t      *img4Y_tmp_row[3];     /* row-scope temporary buffer for 1/4 interpolation (lean memory mode) */
+    mem_usage_t mem_usage;            /* memory allocated for this context */
+
     aec_t       aec;                  /* ac engine for RDO */
+    uint32_t    i_aec_base_ver;       /* version of the last context base snapshot of aec */
+    cu_fork_t  *cu_forks;             /* [2] helpers of the parallel analysis inside CTU, NULL: serial */
 
 #if ENABLE_RATE_CONTROL_CU
     int        *last_dquant;
@@ -1588,6 +1697,8 @@ struct xavs2_t {
         int     i_scu_y;              /* vertical   position (raster scan order in frame buffer) for the first SCU of lcu */
         int     i_scu_xy;             /* SCU index (raster scan order in frame buffer) for the top-left SCU of current lcu */
         int     i_lcu_xy;             /* LCU index (raster scan order in frame buffer) for current lcu */
+        int     i_qp;                 /* QP of current lcu (frame QP with the AQ offset) */
+        int     i_qp_left;            /* QP of the left lcu (frame QP for the first lcu in row) */
 
         bool_t  b_enable_rdoq;
         bool_t  bypass_all_dmh;
@@ -1614,13 +1725,8 @@ struct xavs2_t {
         // uint8_t     padding_bytes[24];/* padding bytes to make align */
 
         /* data used in each ctu layer */
-#define PARALLEL_INSIDE_CTU                    0
         cu_layer_t      cu_layer[CTU_DEPTH];
-#if PARALLEL_INSIDE_CTU
-        cu_parallel_t   cu_enc  [CTU_DEPTH];
-#else
-        cu_parallel_t   cu_enc  [1];                /* CTUڵĶ߳ʱֻҪһ */
-#endif
+        cu_parallel_t   cu_enc  [1];                /* the concurrent branches of a CU run on different contexts */
 
         ALIGN32(pel_t   fenc_buf[FENC_BUF_SIZE]);   /* encoding buffer (source Y/U/V buffer) */
         ALIGN32(pel_t   fdec_buf[FDEC_BUF_SIZE]);   /* decoding buffer (Reconstruction Y/U/V buffer) */
@@ -1635,6 +1741,19 @@ struct xavs2_t {
 
         /* only used for AEC */
         runlevel_t      run_level_write;            /* run-level buffer for encoding */
+
+        /* hierarchical motion estimation */
+        ALIGN32(pel_t   fenc_lowres[ME_PYRAMID_LEVELS][(MAX_CU_SIZE >> 1) * FENC_STRIDE]);  /* downscaled luma of current LCU */
+        mv_t            pyramid_mv[MAX_REFS][4];    /* coarse MVs (1/4 pixel) of the four quadrants of current LCU */
+        uint32_t        pyramid_mask;               /* bit i: pyramid_mv[i] is ready; bit 31: fenc_lowres is ready */
+
+        /* fullpel ME results of current LCU on the 8x8 grid, for MV reuse */
+        mv_t            mvcache_mv  [MAX_REFS][MV_CACHE_GRID * MV_CACHE_GRID];  /* fullpel MVs */
+        dist_t          mvcache_cost[MAX_REFS][MV_CACHE_GRID * MV_CACHE_GRID];  /* fullpel costs normalized to an 8x8 block */
+        uint8_t         mvcache_mask[MV_CACHE_GRID * MV_CACHE_GRID];            /* bit i: entry of reference i is ready */
+
+        /* parallel analysis inside CTU */
+        uint32_t        fork_mask;                  /* bit i: the non-split CU of level i is being evaluated on a helper */
     } lcu;
 
     /* coding states in RDO, independent for each thread */
@@ -1694,6 +1813,8 @@ void xavs2_log(void *p, int i_log_level, const char *psz_fmt, ...);
  * you have to use xavs2_free for buffers allocated with xavs2_malloc */
 #define xavs2_malloc FPFX(malloc)
 void *xavs2_malloc(size_t i_size);
+#define xavs2_malloc_policy FPFX(malloc_policy)
+void *xavs2_malloc_policy(size_t i_size, int hugepage_mode, int numa_node);
 #define xavs2_calloc FPFX(calloc)
 void *xavs2_calloc(size_t count, size_t size);
 #define xavs2_free FPFX(free)
@@ -1701,6 +1822,12 @@ void  xavs2_free(void *ptr);
 #define xavs2_get_total_malloc_space FPFX(get_total_malloc_space)
 size_t xavs2_get_total_malloc_space(void);
 
+/* lock of the one-time initialization of tables shared by all encoders */
+#define xavs2_init_lock FPFX(init_lock)
+void  xavs2_init_lock(void);
+#define xavs2_init_unlock FPFX(init_unlock)
+void  xavs2_init_unlock(void);
+
 
 #define g_xavs2_default_log          FPFX(g_xavs2_default_log)
 extern xavs2_log_t    g_xavs2_default_log;
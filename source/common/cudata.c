@@ -308,6 +308,19 @@ void lcu_start_init_pos(xavs2_t *h, int i_lcu_x, int i_lcu_y)
         h->i_qp = xavs2_rc_get_lcu_qp(h, h->fenc->i_frame, h->i_qp);
     }
 #endif
+    h->lcu.i_qp      = h->i_qp;
+    h->lcu.i_qp_left = h->i_qp;
+#if ENABLE_RATE_CONTROL_CU
+    if (h->fenc->aq_qp_offset != NULL) {
+        /* adaptive quantization: QP offset of the LCU decided in lookahead */
+        h->lcu.i_qp = XAVS2_CLIP3(h->param->i_min_qp, h->param->i_max_qp,
+                                  h->i_qp + h->fenc->aq_qp_offset[h->lcu.i_lcu_xy]);
+        if (i_lcu_x > 0) {
+            h->lcu.i_qp_left = XAVS2_CLIP3(h->param->i_min_qp, h->param->i_max_qp,
+                                           h->i_qp + h->fenc->aq_qp_offset[h->lcu.i_lcu_xy - 1]);
+        }
+    }
+#endif
 
     /* -------------------------------------------------------------
      * 3, init all SCU in current CTU
@@ -321,7 +334,7 @@ void lcu_start_init_pos(xavs2_t *h, int i_lcu_x, int i_lcu_y)
         cu_info_t *p_cu_info = &h->cu_info[h->lcu.i_scu_xy + y * h->i_width_in_mincu];  /* point to a SCU */
         for (x = w_in_scu; x != 0; x--, p_cu_info++) {
             p_cu_info->i_delta_qp  = 0;
-            p_cu_info->i_cu_qp     = (int8_t)(h->i_qp);   // needed in loop filter (even if constant QP is used)
+            p_cu_info->i_cu_qp     = (int8_t)(h->lcu.i_qp);   // needed in loop filter (even if constant QP is used)
 
             // reset syntax element entries in cu_info_t
             // ЩԪڱÿLCUʱãԴ˴Ҫ޸
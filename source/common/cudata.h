@@ -143,12 +143,8 @@ cu_mode_t *cu_get_layer_mode(xavs2_t *h, int i_cu_level)
 static ALWAYS_INLINE
 cu_parallel_t *cu_get_enc_context(xavs2_t *h, int i_cu_level)
 {
-#if PARALLEL_INSIDE_CTU
-    return &h->lcu.cu_enc[i_cu_level - MIN_CU_SIZE_IN_BIT];
-#else
     UNUSED_PARAMETER(i_cu_level);
     return &h->lcu.cu_enc[0];
-#endif
 }
 
 
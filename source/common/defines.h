@@ -142,7 +142,7 @@ enum xavs2_fast_algorithms_e {
 /* ---------------------------------------------------------------------------
  * Rate Control
  */
-#define ENABLE_RATE_CONTROL_CU  0     /* Enable Rate-Control on CU level: 1: enable, 0: disable */
+#define ENABLE_RATE_CONTROL_CU  1     /* Enable QP control on CU level (delta QP), used by AQ: 1: enable, 0: disable */
 
 #define ENABLE_AUTO_INIT_QP     1     /* ĿԶóʼQPֵ */
 
@@ -296,6 +296,8 @@ enum xavs2_fast_algorithms_e {
 #define XAVS2_THREAD_MAX        128   /* max number of threads */
 #define XAVS2_BS_HEAD_LEN       256   /* length of bitstream buffer for headers */
 #define XAVS2_PAD          (64 + 16)  /* number of pixels padded around the reference frame */
+#define ME_PYRAMID_LEVELS         2   /* number of downscaled luma levels (1/2, 1/4) for hierarchical ME */
+#define MV_CACHE_GRID  (MAX_CU_SIZE >> MIN_CU_SIZE_IN_BIT)  /* width of the ME result cache of one LCU, in 8x8 blocks */
 #define MAX_COST         (1LL << 50)  /* used for start value for cost variables */
 #define MAX_FRAME_INDEX  0x3FFFFF00   /* max frame index */
 #define MAX_REFS     XAVS2_MAX_REFS   /* max number of reference frames */
@@ -308,7 +310,11 @@ enum xavs2_fast_algorithms_e {
 /* ---------------------------------------------------------------------------
  * reference picture management
  */
-#define XAVS2_INPUT_NUM      (4 * MAX_PARALLEL_FRAMES + 4)    /* number of buffered input frames */
+#define XAVS2_INPUT_NUM      (4 * MAX_PARALLEL_FRAMES + 4)    /* number of buffered input frames (max) */
+#define HUGE_PAGE_SIZE       (2 << 20)                        /* size of a huge page */
+#define HUGE_PAGE_THRESHOLD  (HUGE_PAGE_SIZE * 7 / 8)         /* buffers larger than this are backed by huge pages */
+#define INTPL_ROW_TMP_MARGIN      8   /* lines above an LCU row in the row-scope interpolation buffer */
+#define INTPL_ROW_TMP_LINES(lcu_size) ((lcu_size) + 32)  /* lines of the row-scope interpolation buffer */
 #define FREF_BUF_SIZE (MAX_REFS + MAX_PARALLEL_FRAMES * 4)    /* number of reference + decoding frames to buffer */
 
 
@@ -40,6 +40,18 @@
 #include "cudata.h"
 #include "cpu.h"
 
+/**
+ * ===========================================================================
+ * local macros
+ * ===========================================================================
+ */
+
+/* buffer of boundary strengths in one LCU: one line per 4x4 row (vertical edges)
+ * or per SCU row (horizontal edges), one byte per 4x4 column plus the
+ * neighbouring columns covered by the horizontal pass */
+#define LF_BS_STRIDE    (MAX_CU_SIZE / MIN_PU_SIZE + 4)
+#define LF_BS_LINES     (MAX_CU_SIZE / MIN_PU_SIZE)
+
 /**
  * ===========================================================================
  * global/local variables
@@ -263,29 +275,47 @@ void lf_lcu_set_edge_filter(xavs2_t *h, int i_level, int scu_x, int scu_y, int s
 }
 
 /* ---------------------------------------------------------------------------
- * Return 1 if skip filtering is needed
+ * boundary strength of 4x4 blocks from their MVs and references:
+ * 0 if the edge between block i and block (i - i_neighbor) can be skipped
  */
-static INLINE
-uint8_t lf_skip_filter(xavs2_t *h, cu_info_t *MbP, cu_info_t *MbQ, int dir, int block_x, int block_y)
+static void deblock_bs_c(uint8_t *flag, const mv_t *mv, const int8_t *ref, int i_neighbor, int num)
 {
-    if (h->i_type == SLICE_TYPE_P || h->i_type == SLICE_TYPE_F) {
-        const mv_t *p_mv_buf = h->fwd_1st_mv;
-        const int8_t *p_ref_buf = h->fwd_1st_ref;
-        int w_in_4x4 = h->i_width_in_minpu;
-        int block_x2 = block_x - !dir;
-        int block_y2 = block_y -  dir;
-        int pos1 = block_y  * w_in_4x4 + block_x;
-        int pos2 = block_y2 * w_in_4x4 + block_x2;
-
-        if ((MbP->i_cbp == 0) && (MbQ->i_cbp == 0) &&
-            (XAVS2_ABS(p_mv_buf[pos1].x - p_mv_buf[pos2].x) < 4) &&
-            (XAVS2_ABS(p_mv_buf[pos1].y - p_mv_buf[pos2].y) < 4) &&
-            (p_ref_buf[pos1] != INVALID_REF && p_ref_buf[pos1] == p_ref_buf[pos2])) {
-            return 0;
-        }
+    int i;
+
+    for (i = 0; i < num; i++) {
+        const mv_t *mv_p = &mv[i - i_neighbor];
+
+        flag[i] = !((ref[i] != INVALID_REF && ref[i] == ref[i - i_neighbor]) &&
+                    (XAVS2_ABS(mv[i].x - mv_p->x) < 4) &&
+                    (XAVS2_ABS(mv[i].y - mv_p->y) < 4));
     }
+}
 
-    return 1;
+/* ---------------------------------------------------------------------------
+ * derive the boundary strengths of all edges in one direction of one LCU at a
+ * time, which is only needed in P/F frames
+ */
+static
+void lf_lcu_set_bs(xavs2_t *h, uint8_t *p_bs, int scu_x, int scu_y, int num_of_scu_hor, int num_of_scu_ver, int dir)
+{
+    const int w_in_4x4   = h->i_width_in_minpu;
+    const int i_neighbor = dir ? w_in_4x4 : 1;
+    const int num_lines  = dir ? num_of_scu_ver : (num_of_scu_ver << 1);
+    const int y_step     = dir ? 2 : 1;
+    int block_x = scu_x << 1;
+    int block_y = scu_y << 1;
+    int offset  = (block_x == 0 && !dir);   /* no left neighbor for the first column */
+    int num     = (num_of_scu_hor << 1) - offset;
+    int j;
+
+    for (j = 0; j < num_lines; j++, block_y += y_step, p_bs += LF_BS_STRIDE) {
+        int pos = block_y * w_in_4x4 + block_x + offset;
+
+        if (dir && block_y == 0) {
+            continue;   /* no top neighbor for the first row */
+        }
+        g_funcs.deblock_bs(p_bs + offset, h->fwd_1st_mv + pos, h->fwd_1st_ref + pos, i_neighbor, num);
+    }
 }
 
 /* ---------------------------------------------------------------------------
@@ -411,7 +441,8 @@ static void deblock_edge_hor_c(pel_t *src_u, pel_t *src_v, int stride, int alpha
 /* ---------------------------------------------------------------------------
  */
 static
-void lf_scu_deblock(xavs2_t *h, pel_t *p_rec[3], int i_stride, int i_stride_c, int scu_x, int scu_y, int dir)
+void lf_scu_deblock(xavs2_t *h, pel_t *p_rec[3], int i_stride, int i_stride_c, int scu_x, int scu_y, int dir,
+                    const uint8_t *p_bs)
 {
     static const int max_qp_deblock = 63;
     cu_info_t *MbQ = &h->cu_info[scu_y * h->i_width_in_mincu + scu_x];  /* current SCU */
@@ -426,11 +457,16 @@ void lf_scu_deblock(xavs2_t *h, pel_t *p_rec[3], int i_stride, int i_stride_c, i
         int alpha, beta;
         uint8_t b_filter_edge[2];
 
-        b_filter_edge[0] = lf_skip_filter(h, MbP, MbQ, dir, (scu_x << 1), (scu_y << 1));
-        b_filter_edge[1] = lf_skip_filter(h, MbP, MbQ, dir, (scu_x << 1) + dir, (scu_y << 1) + !dir);
-
-        if (b_filter_edge[0] == 0 && b_filter_edge[1] == 0) {
-            return;
+        /* the edge may only be skipped in P/F frames (p_bs != NULL) when no residual is coded */
+        if (p_bs != NULL && MbP->i_cbp == 0 && MbQ->i_cbp == 0) {
+            b_filter_edge[0] = p_bs[0];
+            b_filter_edge[1] = p_bs[dir ? 1 : LF_BS_STRIDE];
+            if (b_filter_edge[0] == 0 && b_filter_edge[1] == 0) {
+                return;
+            }
+        } else {
+            b_filter_edge[0] = 1;
+            b_filter_edge[1] = 1;
         }
 
         /* deblock luma edge */
@@ -474,6 +510,10 @@ void xavs2_lcu_deblock(xavs2_t *h, xavs2_frame_t *frm)
     int num_of_scu_ver = h->lcu.i_pix_height >> MIN_CU_SIZE_IN_BIT;
     uint8_t *p_fbuf0 = h->p_deblock_flag[0] + scu_x;
     uint8_t *p_fbuf1 = h->p_deblock_flag[1] + scu_x;
+    /* boundary strengths of the 4x4 blocks in one LCU, [0]: vertical edges, [1]: horizontal edges */
+    ALIGN16(uint8_t bs_buf[2][LF_BS_LINES * LF_BS_STRIDE]);
+    const uint8_t *p_bs[2] = { NULL, NULL };
+    int b_inter = h->i_type == SLICE_TYPE_P || h->i_type == SLICE_TYPE_F;
     int i, j;
 
     /* clear edge flags in one LCU */
@@ -488,10 +528,19 @@ void xavs2_lcu_deblock(xavs2_t *h, xavs2_frame_t *frm)
     /* set edge flags in one LCU */
     lf_lcu_set_edge_filter(h, h->i_lcu_level, h->lcu.i_scu_x, h->lcu.i_scu_y, h->lcu.i_scu_xy);
 
+    /* boundary strengths of all vertical edges in one LCU */
+    if (b_inter) {
+        lf_lcu_set_bs(h, bs_buf[0], scu_x, scu_y, num_of_scu_hor, num_of_scu_ver, EDGE_VER);
+    }
+
     /* deblock all vertical edges in one LCU */
     for (j = 0; j < num_of_scu_ver; j++) {
+        if (b_inter) {
+            p_bs[0] = bs_buf[0] + 2 * j * LF_BS_STRIDE;
+        }
         for (i = 0; i < num_of_scu_hor; i++) {
-            lf_scu_deblock(h, frm->planes, i_stride, i_stride_c, scu_x + i, scu_y + j, EDGE_VER);
+            lf_scu_deblock(h, frm->planes, i_stride, i_stride_c, scu_x + i, scu_y + j, EDGE_VER, p_bs[0]);
+            p_bs[0] += (p_bs[0] != NULL) << 1;
         }
     }
 
@@ -509,10 +558,19 @@ void xavs2_lcu_deblock(xavs2_t *h, xavs2_frame_t *frm)
         scu_x--;        /* begin from the last horizontal edge of previous LCU */
     }
 
+    /* boundary strengths of all horizontal edges in one LCU */
+    if (b_inter) {
+        lf_lcu_set_bs(h, bs_buf[1], scu_x, scu_y, num_of_scu_hor, num_of_scu_ver, EDGE_HOR);
+    }
+
     /* deblock all horizontal edges in one LCU */
     for (j = 0; j < num_of_scu_ver; j++) {
+        if (b_inter) {
+            p_bs[1] = bs_buf[1] + j * LF_BS_STRIDE;
+        }
         for (i = 0; i < num_of_scu_hor; i++) {
-            lf_scu_deblock(h, frm->planes, i_stride, i_stride_c, scu_x + i, scu_y + j, EDGE_HOR);
+            lf_scu_deblock(h, frm->planes, i_stride, i_stride_c, scu_x + i, scu_y + j, EDGE_HOR, p_bs[1]);
+            p_bs[1] += (p_bs[1] != NULL) << 1;
         }
     }
 }
@@ -525,8 +583,12 @@ void xavs2_deblock_init(uint32_t cpuid, intrinsic_func_t* lf)
     lf->deblock_luma  [1] = deblock_edge_hor;
     lf->deblock_chroma[0] = deblock_edge_ver_c;
     lf->deblock_chroma[1] = deblock_edge_hor_c;
+    lf->deblock_bs        = deblock_bs_c;
 
 #if HAVE_MMX
+    if (cpuid & XAVS2_CPU_SSE2) {
+        lf->deblock_bs      = deblock_bs_sse128;
+    }
     if (cpuid & XAVS2_CPU_SSE42) {
         lf->deblock_luma[0] = deblock_edge_ver_sse128;
         lf->deblock_luma[1] = deblock_edge_hor_sse128;
@@ -228,14 +228,243 @@ static void sao_block_c(pel_t *p_dst, int i_dst, pel_t *p_src, int i_src,
     }
 }
 
+/* ---------------------------------------------------------------------------
+ * SAO statistics: edge offset, horizontal
+ */
+static void sao_stat_EO_0_c(const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                            int i_block_w, int i_block_h,
+                            int *lcu_avail, SAOStatData *p_stats)
+{
+    int start_x, end_x;
+    int x, y;
+    int leftsign, rightsign;
+    int edgetype;
+
+    memset(p_stats, 0, sizeof(SAOStatData));
+
+    start_x = lcu_avail[SAO_L] ? 0 : 1;
+    end_x   = lcu_avail[SAO_R] ? i_block_w : (i_block_w - 1);
+    for (y = 0; y < i_block_h; y++) {
+        leftsign = xavs2_sign3(p_rec[start_x] - p_rec[start_x - 1]);
+        for (x = start_x; x < end_x; x++) {
+            rightsign = xavs2_sign3(p_rec[x] - p_rec[x + 1]);
+            edgetype = leftsign + rightsign;
+            leftsign = -rightsign;
+            p_stats->diff[edgetype + 2] += (p_org[x] - p_rec[x]);
+            p_stats->count[edgetype + 2]++;
+        }
+        p_rec += i_rec;
+        p_org += i_org;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * SAO statistics: edge offset, vertical
+ */
+static void sao_stat_EO_90_c(const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                             int i_block_w, int i_block_h,
+                             int *lcu_avail, SAOStatData *p_stats)
+{
+    int start_y, end_y;
+    int x, y;
+    int upsign, downsign;
+    int edgetype;
+
+    memset(p_stats, 0, sizeof(SAOStatData));
+
+    start_y = lcu_avail[SAO_T] ? 0 : 1;
+    end_y   = lcu_avail[SAO_D] ? i_block_h : (i_block_h - 1);
+    for (x = 0; x < i_block_w; x++) {
+        upsign = xavs2_sign3(p_rec[start_y * i_rec + x] - p_rec[(start_y - 1) * i_rec + x]);
+        for (y = start_y; y < end_y; y++) {
+            downsign = xavs2_sign3(p_rec[y * i_rec + x] - p_rec[(y + 1) * i_rec + x]);
+            edgetype = downsign + upsign;
+            upsign = -downsign;
+            p_stats->diff[edgetype + 2] += (p_org[y * i_org + x] - p_rec[y * i_rec + x]);
+            p_stats->count[edgetype + 2]++;
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * SAO statistics: edge offset, 135 degree
+ */
+static void sao_stat_EO_135_c(const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                              int i_block_w, int i_block_h,
+                              int *lcu_avail, SAOStatData *p_stats)
+{
+    int start_x_r0, end_x_r0, start_x_r, end_x_r, start_x_rn, end_x_rn;
+    int x, y;
+    int upsign, downsign;
+    int signupline[MAX_CU_SIZE << 1];
+    int reg = 0;
+    int edgetype;
+
+    memset(p_stats, 0, sizeof(SAOStatData));
+
+    start_x_r0 = lcu_avail[SAO_TL] ? 0 : 1;
+    end_x_r0   = lcu_avail[SAO_T] ? (lcu_avail[SAO_R] ? i_block_w : (i_block_w - 1)) : 1;
+    start_x_r  = lcu_avail[SAO_L] ? 0 : 1;
+    end_x_r    = lcu_avail[SAO_R] ? i_block_w : (i_block_w - 1);
+    start_x_rn = lcu_avail[SAO_D] ? (lcu_avail[SAO_L] ? 0 : 1) : (i_block_w - 1);
+    end_x_rn   = lcu_avail[SAO_DR] ? i_block_w : (i_block_w - 1);
+
+    // init the line buffer
+    for (x = start_x_r + 1; x < end_x_r + 1; x++) {
+        upsign = xavs2_sign3(p_rec[x + i_rec] - p_rec[x - 1]);
+        signupline[x] = upsign;
+    }
+    // first row
+    for (x = start_x_r0; x < end_x_r0; x++) {
+        upsign = xavs2_sign3(p_rec[x] - p_rec[x - 1 - i_rec]);
+        edgetype = upsign - signupline[x + 1];
+        p_stats->diff[edgetype + 2] += (p_org[x] - p_rec[x]);
+        p_stats->count[edgetype + 2]++;
+    }
+
+    // middle rows
+    p_rec += i_rec;
+    p_org += i_org;
+    for (y = 1; y < i_block_h - 1; y++) {
+        for (x = start_x_r; x < end_x_r; x++) {
+            if (x == start_x_r) {
+                upsign = xavs2_sign3(p_rec[x] - p_rec[x - 1 - i_rec]);
+                signupline[x] = upsign;
+            }
+            downsign = xavs2_sign3(p_rec[x] - p_rec[x + 1 + i_rec]);
+            edgetype = downsign + signupline[x];
+            p_stats->diff[edgetype + 2] += (p_org[x] - p_rec[x]);
+            p_stats->count[edgetype + 2]++;
+            signupline[x] = reg;
+            reg = -downsign;
+        }
+        p_rec += i_rec;
+        p_org += i_org;
+    }
+    // last row
+    for (x = start_x_rn; x < end_x_rn; x++) {
+        if (x == start_x_r) {
+            upsign = xavs2_sign3(p_rec[x] - p_rec[x - 1 - i_rec]);
+            signupline[x] = upsign;
+        }
+        downsign = xavs2_sign3(p_rec[x] - p_rec[x + 1 + i_rec]);
+        edgetype = downsign + signupline[x];
+        p_stats->diff[edgetype + 2] += (p_org[x] - p_rec[x]);
+        p_stats->count[edgetype + 2]++;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * SAO statistics: edge offset, 45 degree
+ */
+static void sao_stat_EO_45_c(const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                             int i_block_w, int i_block_h,
+                             int *lcu_avail, SAOStatData *p_stats)
+{
+    int start_x_r0, end_x_r0, start_x_r, end_x_r, start_x_rn, end_x_rn;
+    int x, y;
+    int upsign, downsign;
+    int signupline[MAX_CU_SIZE << 1];
+    int *signupline1;
+    int edgetype;
+
+    memset(p_stats, 0, sizeof(SAOStatData));
+
+    start_x_r0 = lcu_avail[SAO_T] ? (lcu_avail[SAO_L] ? 0 : 1) : (i_block_w - 1);
+    end_x_r0   = lcu_avail[SAO_TR] ? i_block_w : (i_block_w - 1);
+    start_x_r  = lcu_avail[SAO_L] ? 0 : 1;
+    end_x_r    = lcu_avail[SAO_R] ? i_block_w : (i_block_w - 1);
+    start_x_rn = lcu_avail[SAO_DL] ? 0 : 1;
+    end_x_rn   = lcu_avail[SAO_D] ? (lcu_avail[SAO_R] ? i_block_w : (i_block_w - 1)) : 1;
+
+    // init the line buffer
+    signupline1 = signupline + 1;
+    for (x = start_x_r - 1; x < XAVS2_MAX(end_x_r - 1, end_x_r0 - 1); x++) {
+        upsign = xavs2_sign3(p_rec[x + i_rec] - p_rec[x + 1]);
+        signupline1[x] = upsign;
+    }
+    // first row
+    for (x = start_x_r0; x < end_x_r0; x++) {
+        upsign = xavs2_sign3(p_rec[x] - p_rec[x + 1 - i_rec]);
+        edgetype = upsign - signupline1[x - 1];
+        p_stats->diff[edgetype + 2] += (p_org[x] - p_rec[x]);
+        p_stats->count[edgetype + 2]++;
+    }
+
+    // middle rows
+    p_rec += i_rec;
+    p_org += i_org;
+    for (y = 1; y < i_block_h - 1; y++) {
+        for (x = start_x_r; x < end_x_r; x++) {
+            if (x == end_x_r - 1) {
+                upsign = xavs2_sign3(p_rec[x] - p_rec[x + 1 - i_rec]);
+                signupline1[x] = upsign;
+            }
+            downsign = xavs2_sign3(p_rec[x] - p_rec[x - 1 + i_rec]);
+            edgetype = downsign + signupline1[x];
+            p_stats->diff[edgetype + 2] += (p_org[x] - p_rec[x]);
+            p_stats->count[edgetype + 2]++;
+            signupline1[x - 1] = -downsign;
+        }
+        p_rec += i_rec;
+        p_org += i_org;
+    }
+    // last row
+    for (x = start_x_rn; x < end_x_rn; x++) {
+        if (x == end_x_r - 1) {
+            upsign = xavs2_sign3(p_rec[x] - p_rec[x + 1 - i_rec]);
+            signupline1[x] = upsign;
+        }
+        downsign = xavs2_sign3(p_rec[x] - p_rec[x - 1 + i_rec]);
+        edgetype = downsign + signupline1[x];
+        p_stats->diff[edgetype + 2] += (p_org[x] - p_rec[x]);
+        p_stats->count[edgetype + 2]++;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * SAO statistics: band offset
+ */
+static void sao_stat_BO_c(const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                          int i_block_w, int i_block_h,
+                          int *lcu_avail, SAOStatData *p_stats)
+{
+    const int band_shift = g_bit_depth - NUM_SAO_BO_CLASSES_IN_BIT;
+    int bandtype;
+    int x, y;
+
+    UNUSED_PARAMETER(lcu_avail);
+    memset(p_stats, 0, sizeof(SAOStatData));
+
+    for (y = 0; y < i_block_h; y++) {
+        for (x = 0; x < i_block_w; x++) {
+            bandtype = p_rec[x] >> band_shift;
+            p_stats->diff[bandtype] += (p_org[x] - p_rec[x]);
+            p_stats->count[bandtype]++;
+        }
+        p_rec += i_rec;
+        p_org += i_org;
+    }
+}
+
 /* ---------------------------------------------------------------------------
  */
 void xavs2_sao_init(uint32_t cpuid, intrinsic_func_t *pf)
 {
     pf->sao_block = sao_block_c;
+    pf->sao_stat[SAO_TYPE_EO_0]   = sao_stat_EO_0_c;
+    pf->sao_stat[SAO_TYPE_EO_90]  = sao_stat_EO_90_c;
+    pf->sao_stat[SAO_TYPE_EO_135] = sao_stat_EO_135_c;
+    pf->sao_stat[SAO_TYPE_EO_45]  = sao_stat_EO_45_c;
+    pf->sao_stat[SAO_TYPE_BO]     = sao_stat_BO_c;
 #if HAVE_MMX
     if (cpuid & XAVS2_CPU_SSE4) {
         pf->sao_block = SAO_on_block_sse128;
+        pf->sao_stat[SAO_TYPE_EO_0]   = SAO_stat_EO_0_sse128;
+        pf->sao_stat[SAO_TYPE_EO_90]  = SAO_stat_EO_90_sse128;
+        pf->sao_stat[SAO_TYPE_EO_135] = SAO_stat_EO_135_sse128;
+        pf->sao_stat[SAO_TYPE_EO_45]  = SAO_stat_EO_45_sse128;
+        pf->sao_stat[SAO_TYPE_BO]     = SAO_stat_BO_sse128;
     }
 #ifdef _MSC_VER
     if (cpuid & XAVS2_CPU_AVX2) {
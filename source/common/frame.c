@@ -83,6 +83,34 @@ align_plane_size(int x, int disalign)
     return x;
 }
 
+/* ---------------------------------------------------------------------------
+ * size of the downscaled luma planes for hierarchical motion estimation
+ */
+static int
+frame_lowres_size(int img_w_l, int img_h_l)
+{
+    int size = 0;
+    int i;
+
+    for (i = 1; i <= ME_PYRAMID_LEVELS; i++) {
+        int stride = ((img_w_l >> i) + 63) & (~31);    /* spare pixels for SIMD over-reading */
+        size += stride * ((img_h_l >> i) + 1) * sizeof(pel_t) + CACHE_LINE_SIZE;
+    }
+
+    return size;
+}
+
+/* ---------------------------------------------------------------------------
+ * size of the integral plane of padded luma (for SEA motion search)
+ */
+static int
+frame_integral_size(int img_w_l, int img_h_l)
+{
+    int stride = (img_w_l + (XAVS2_PAD << 1) + 1 + 7) & (~7);
+
+    return stride * (img_h_l + (XAVS2_PAD << 1) + 1) * sizeof(uint32_t) + CACHE_LINE_SIZE;
+}
+
 /* ---------------------------------------------------------------------------
  */
 size_t xavs2_frame_buffer_size(const xavs2_param_t *param, int alloc_type)
@@ -105,6 +133,9 @@ size_t xavs2_frame_buffer_size(const xavs2_param_t *param, int alloc_type)
     int frame_size_in_mincu = 0;
 #endif
     int frame_size_in_mvstore = 0;  /* reference information size */
+    int lowres_size = 0;            /* size of downscaled luma planes */
+    int integral_size = 0;          /* size of integral plane */
+    int aq_size = 0;                /* size of QP offsets of LCUs (AQ) */
 
     /* compute stride and the plane size */
     switch (alloc_type) {
@@ -118,6 +149,12 @@ size_t xavs2_frame_buffer_size(const xavs2_param_t *param, int alloc_type)
         frame_size_in_mincu = (img_w_l >> MIN_CU_SIZE_IN_BIT) * (img_h_l >> MIN_CU_SIZE_IN_BIT);
 #endif
         frame_size_in_mvstore = (((img_w_l >> MIN_PU_SIZE_IN_BIT) + 3) >> 2) * (((img_h_l >> MIN_PU_SIZE_IN_BIT) + 3) >> 2);
+        if (param->me_pyramid_range > 0) {
+            lowres_size = frame_lowres_size(img_w_l, img_h_l);
+        }
+        if (param->me_method == XAVS2_ME_SEA) {
+            integral_size = frame_integral_size(img_w_l, img_h_l);
+        }
         planes_size = size_l + size_c * 2;
 #if ENABLE_FRAME_SUBPEL_INTPL
         planes_size += size_l * 15;
@@ -144,6 +181,11 @@ size_t xavs2_frame_buffer_size(const xavs2_param_t *param, int alloc_type)
         i_nal_info_size = (param->slice_num + 6) * sizeof(xavs2_nal_info_t);
 #endif
         bs_size         = size_l * sizeof(uint8_t);    /* let the PSNR compute correctly */
+        if (param->i_aq_mode != XAVS2_AQ_NONE) {
+            int size_lcu = 1 << param->lcu_bit_level;
+            aq_size = ((param->org_width  + size_lcu - 1) >> param->lcu_bit_level) *
+                      ((param->org_height + size_lcu - 1) >> param->lcu_bit_level) * sizeof(int8_t);
+        }
     }
 
     /* compute space size and alloc memory */
@@ -158,7 +200,10 @@ size_t xavs2_frame_buffer_size(const xavs2_param_t *param, int alloc_type)
                frame_size_in_mincu * sizeof(int8_t) * 3    + /* M7, size of cu mode/cbp/level buffers */
 #endif
                (img_h_l >> MIN_CU_SIZE_IN_BIT) * sizeof(int)+ /* M8, line status array */
-               CACHE_LINE_SIZE * 10;
+               lowres_size                                 + /* M9, size of downscaled luma planes */
+               integral_size                               + /* M10, size of integral plane */
+               aq_size                                     + /* M11, size of QP offsets of LCUs */
+               CACHE_LINE_SIZE * 11;
 
     /* align to CACHE_LINE_SIZE */
     mem_size = (mem_size + CACHE_LINE_SIZE - 1) & (~(uint32_t)(CACHE_LINE_SIZE - 1));
@@ -189,6 +234,9 @@ xavs2_frame_t *xavs2_frame_new(xavs2_t *h, uint8_t **mem_base, int alloc_type)
     int frame_size_in_mincu = 0;
 #endif
     int frame_size_in_mvstore = 0;  /* reference information size */
+    int lowres_size = 0;            /* size of downscaled luma planes */
+    int integral_size = 0;          /* size of integral plane */
+    int aq_size = 0;                /* size of QP offsets of LCUs (AQ) */
     uint8_t *mem_ptr;
 
     /* compute stride and the plane size */
@@ -203,6 +251,12 @@ xavs2_frame_t *xavs2_frame_new(xavs2_t *h, uint8_t **mem_base, int alloc_type)
         frame_size_in_mincu = h->i_width_in_mincu * h->i_height_in_mincu;
 #endif
         frame_size_in_mvstore = ((h->i_width_in_minpu + 3) >> 2) * ((h->i_height_in_minpu + 3) >> 2);
+        if (h->param->me_pyramid_range > 0) {
+            lowres_size = frame_lowres_size(img_w_l, img_h_l);
+        }
+        if (h->param->me_method == XAVS2_ME_SEA) {
+            integral_size = frame_integral_size(img_w_l, img_h_l);
+        }
         planes_size = size_l + size_c * 2;
 #if ENABLE_FRAME_SUBPEL_INTPL
         if (h->use_fractional_me == 1) {
@@ -233,6 +287,9 @@ xavs2_frame_t *xavs2_frame_new(xavs2_t *h, uint8_t **mem_base, int alloc_type)
         i_nal_info_size = (h->param->slice_num + 6) * sizeof(xavs2_nal_info_t);
 #endif
         bs_size         = size_l * sizeof(uint8_t);    /* let the PSNR compute correctly */
+        if (h->param->i_aq_mode != XAVS2_AQ_NONE) {
+            aq_size     = h->i_width_in_lcu * h->i_height_in_lcu * sizeof(int8_t);
+        }
     }
 
     /* compute space size and alloc memory */
@@ -247,13 +304,16 @@ xavs2_frame_t *xavs2_frame_new(xavs2_t *h, uint8_t **mem_base, int alloc_type)
                frame_size_in_mincu * sizeof(int8_t) * 3    + /* M7, size of cu mode/cbp/level buffers */
 #endif
                h->i_height_in_lcu * sizeof(int)            + /* M8, line status array */
-               CACHE_LINE_SIZE * 10;
+               lowres_size                                 + /* M9, size of downscaled luma planes */
+               integral_size                               + /* M10, size of integral plane */
+               aq_size                                     + /* M11, size of QP offsets of LCUs */
+               CACHE_LINE_SIZE * 11;
 
     /* align to CACHE_LINE_SIZE */
     mem_size = (mem_size + CACHE_LINE_SIZE - 1) & (~(uint32_t)(CACHE_LINE_SIZE - 1));
 
     if (mem_base == NULL) {
-        CHECKED_MALLOC(mem_ptr, uint8_t *, mem_size);
+        CHECKED_MALLOC_LARGE(mem_ptr, uint8_t *, mem_size, h->param);
     } else {
         mem_ptr = *mem_base;
     }
@@ -282,6 +342,17 @@ xavs2_frame_t *xavs2_frame_new(xavs2_t *h, uint8_t **mem_base, int alloc_type)
     }
 
     frame->i_frm_type = XAVS2_TYPE_AUTO;
+    frame->b_scenecut = 0;
+    for (i = 0; i < ME_PYRAMID_LEVELS; i++) {
+        frame->lowres[i]          = NULL;
+        frame->i_lowres_stride[i] = 0;
+        frame->i_lowres_width [i] = 0;
+        frame->i_lowres_lines [i] = 0;
+    }
+    frame->integral          = NULL;
+    frame->i_integral_stride = 0;
+    frame->aq_qp_offset      = NULL;
+    frame->i_integral_rows   = 0;
     frame->i_pts  = -1;
     frame->i_dts  = -1;
     frame->b_enable_intra = (h->param->enable_intra);
@@ -302,6 +373,15 @@ xavs2_frame_t *xavs2_frame_new(xavs2_t *h, uint8_t **mem_base, int alloc_type)
         frame->p_bs_buf = mem_ptr;
         frame->i_bs_buf = bs_size;     /* the length is long enough */
         mem_ptr        += bs_size;
+
+        /* M11, QP offsets of LCUs decided by AQ */
+        if (aq_size > 0) {
+            ALIGN_POINTER(mem_ptr);
+            frame->aq_qp_offset = (int8_t *)mem_ptr;
+            memset(frame->aq_qp_offset, 0, aq_size);
+            mem_ptr            += aq_size;
+            ALIGN_POINTER(mem_ptr);
+        }
     }
 
     /* M3, buffer for planes: Y+U+V */
@@ -395,6 +475,28 @@ xavs2_frame_t *xavs2_frame_new(xavs2_t *h, uint8_t **mem_base, int alloc_type)
         mem_ptr                    += h->i_height_in_lcu * sizeof(int);
         ALIGN_POINTER(mem_ptr);
 
+        /* M8, downscaled luma planes */
+        if (lowres_size > 0) {
+            for (i = 0; i < ME_PYRAMID_LEVELS; i++) {
+                frame->i_lowres_width [i] = img_w_l >> (i + 1);
+                frame->i_lowres_lines [i] = img_h_l >> (i + 1);
+                frame->i_lowres_stride[i] = (frame->i_lowres_width[i] + 63) & (~31);
+                frame->lowres[i]          = (pel_t *)mem_ptr;
+                mem_ptr += frame->i_lowres_stride[i] * (frame->i_lowres_lines[i] + 1) * sizeof(pel_t);
+                ALIGN_POINTER(mem_ptr);
+            }
+        }
+
+        /* M9, integral plane, the first line (above the top padding) is always zero */
+        if (integral_size > 0) {
+            int stride = (img_w_l + (XAVS2_PAD << 1) + 1 + 7) & (~7);
+            memset(mem_ptr, 0, stride * sizeof(uint32_t));
+            frame->i_integral_stride = stride;
+            frame->integral          = (uint32_t *)mem_ptr + stride * XAVS2_PAD + XAVS2_PAD;
+            mem_ptr += stride * (img_h_l + (XAVS2_PAD << 1) + 1) * sizeof(uint32_t);
+            ALIGN_POINTER(mem_ptr);
+        }
+
         memset(frame->num_lcu_sao_off, 0, sizeof(frame->num_lcu_sao_off));
     }
 
@@ -466,10 +568,15 @@ void xavs2_frame_destroy_objects(xavs2_handler_t *h_mgr, xavs2_frame_t *frame)
  */
 
 /* ---------------------------------------------------------------------------
+ * expand the border of a part of a plane, p_pix and i_width give the columns
+ * of the part, the left and right bands are only padded when the part lies on
+ * the left and right boundaries of the plane (the upper and lower bands cover
+ * the columns of the part plus the padded bands)
  */
 void
-plane_expand_border(pel_t *p_pix, int i_stride, int i_width, int i_height,
-                    int i_padh, int i_padv, int b_pad_top, int b_pad_bottom)
+plane_expand_border_part(pel_t *p_pix, int i_stride, int i_width, int i_height,
+                         int i_padh, int i_padv, int b_pad_top, int b_pad_bottom,
+                         int b_pad_left, int b_pad_right)
 {
     pel_t *pix = p_pix;
     pel_t *row;
@@ -477,19 +584,31 @@ plane_expand_border(pel_t *p_pix, int i_stride, int i_width, int i_height,
 
     /* --- horizontal ----------------------------------------------
      */
-    for (y = 0; y < i_height; y++) {
-        g_funcs.mem_repeat_p(pix - i_padh,  pix[0          ], i_padh);    /* left  band */
-        g_funcs.mem_repeat_p(pix + i_width, pix[i_width - 1], i_padh);    /* right band */
-        pix += i_stride;
+    if (b_pad_left || b_pad_right) {
+        for (y = 0; y < i_height; y++) {
+            if (b_pad_left) {
+                g_funcs.mem_repeat_p(pix - i_padh,  pix[0          ], i_padh);    /* left  band */
+            }
+            if (b_pad_right) {
+                g_funcs.mem_repeat_p(pix + i_width, pix[i_width - 1], i_padh);    /* right band */
+            }
+            pix += i_stride;
+        }
     }
 
     /* --- vertical ------------------------------------------------
      */
-    i_width += (i_padh << 1);
+    if (b_pad_left) {
+        p_pix   -= i_padh;
+        i_width += i_padh;
+    }
+    if (b_pad_right) {
+        i_width += i_padh;
+    }
 
     /* upper band */
     if (b_pad_top) {
-        pix = row = p_pix - i_padh;   /* start row position */
+        pix = row = p_pix;            /* start row position */
         for (y = 0; y < i_padv; y++) {
             pix -= i_stride;
             memcpy(pix, row, i_width * sizeof(pel_t));
@@ -498,7 +617,7 @@ plane_expand_border(pel_t *p_pix, int i_stride, int i_width, int i_height,
 
     /* lower band */
     if (b_pad_bottom) {
-        pix = row = p_pix + (i_height - 1) * i_stride - i_padh;
+        pix = row = p_pix + (i_height - 1) * i_stride;
         for (y = 0; y < i_padv; y++) {
             pix += i_stride;
             memcpy(pix, row, i_width * sizeof(pel_t));
@@ -506,6 +625,15 @@ plane_expand_border(pel_t *p_pix, int i_stride, int i_width, int i_height,
     }
 }
 
+/* ---------------------------------------------------------------------------
+ */
+void
+plane_expand_border(pel_t *p_pix, int i_stride, int i_width, int i_height,
+                    int i_padh, int i_padv, int b_pad_top, int b_pad_bottom)
+{
+    plane_expand_border_part(p_pix, i_stride, i_width, i_height, i_padh, i_padv, b_pad_top, b_pad_bottom, 1, 1);
+}
+
 /* ---------------------------------------------------------------------------
  */
 void xavs2_frame_expand_border_frame(xavs2_t *h, xavs2_frame_t *frame)
@@ -533,13 +661,16 @@ void xavs2_frame_expand_border_frame(xavs2_t *h, xavs2_frame_t *frame)
 }
 
 /* ---------------------------------------------------------------------------
+ * expand border of the LCUs [i_lcu_x_start, i_lcu_x_end) in one LCU row
  */
-void xavs2_frame_expand_border_lcurow(xavs2_t *h, xavs2_frame_t *frame, int i_lcu_y)
+void xavs2_frame_expand_border_lcurow(xavs2_t *h, xavs2_frame_t *frame, int i_lcu_y, int i_lcu_x_start, int i_lcu_x_end)
 {
     static const int UP_SHIFT = 4;
     int i_lcu_level = h->i_lcu_level;
     int b_start     = !i_lcu_y;
     int b_end       = (i_lcu_y == h->i_height_in_lcu - 1);
+    int b_left      = !i_lcu_x_start;
+    int b_right     = (i_lcu_x_end == h->i_width_in_lcu);
     int i;
 
     assert(h->param->slice_num == 1 || !h->param->b_cross_slice_loop_filter);
@@ -547,9 +678,10 @@ void xavs2_frame_expand_border_lcurow(xavs2_t *h, xavs2_frame_t *frame, int i_lc
     for (i = 0; i < frame->i_plane; i++) {
         int chroma_shift = !!i;
         int stride  = frame->i_stride[i];
-        int width   = frame->i_width[i];
         int padh    = XAVS2_PAD >> chroma_shift;
         int padv    = XAVS2_PAD >> chroma_shift;
+        int x_start = (i_lcu_x_start << (i_lcu_level - chroma_shift));
+        int x_end   = (i_lcu_x_end << (i_lcu_level - chroma_shift));
         int y_start = ((i_lcu_y + 0) << (i_lcu_level - chroma_shift));
         int y_end   = ((i_lcu_y + 1) << (i_lcu_level - chroma_shift));
         int height;
@@ -569,8 +701,95 @@ void xavs2_frame_expand_border_lcurow(xavs2_t *h, xavs2_frame_t *frame, int i_lc
         //               h->fenc->i_frame, h->i_slice_index, i_lcu_y, y_start, y_end);
         // }
 
-        pix = frame->planes[i] + y_start * stride;
-        plane_expand_border(pix, stride, width, height, padh, padv, b_start, b_end);
+        /* the upper and lower bands are also expanded over the next few
+         * (final) columns, which are read by the interpolation of the LCUs */
+        if (!b_right) {
+            x_end += (8 >> chroma_shift);
+        }
+        x_end = XAVS2_MIN(frame->i_width[i], x_end);
+
+        pix = frame->planes[i] + y_start * stride + x_start;
+        plane_expand_border_part(pix, stride, x_end - x_start, height, padh, padv, b_start, b_end, b_left, b_right);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * build the downscaled luma planes of the LCUs [i_lcu_x_start, i_lcu_x_end)
+ * in one LCU row for hierarchical ME
+ */
+void xavs2_frame_lowres_lcurow(xavs2_t *h, xavs2_frame_t *frame, int i_lcu_y, int i_lcu_x_start, int i_lcu_x_end)
+{
+    pel_t *p_src = frame->planes[IMG_Y];
+    int i_src    = frame->i_stride[IMG_Y];
+    int x_start  = i_lcu_x_start << h->i_lcu_level;
+    int x_end    = i_lcu_x_end   << h->i_lcu_level;
+    int y_start  = (i_lcu_y + 0) << h->i_lcu_level;
+    int y_end    = (i_lcu_y + 1) << h->i_lcu_level;
+    int i;
+
+    /* the bottom lines of one LCU row are modified when the next row is
+     * deblocked, use the same region as interpolate_lcu_row() */
+    if (i_lcu_y > 0) {
+        y_start -= 8;
+    }
+    if (i_lcu_y == h->i_height_in_lcu - 1) {
+        y_end = h->i_height;
+    } else {
+        y_end -= 8;
+    }
+
+    for (i = 0; i < ME_PYRAMID_LEVELS; i++) {
+        int i_dst = frame->i_lowres_stride[i];
+        int x0    = x_start >> (i + 1);
+        int x1    = (i_lcu_x_end == h->i_width_in_lcu) ? frame->i_lowres_width[i] : (x_end >> (i + 1));
+        int y0    = y_start >> (i + 1);
+        int y1    = XAVS2_MIN(y_end >> (i + 1), frame->i_lowres_lines[i]);
+
+        if (y1 > y0 && x1 > x0) {
+            g_funcs.lowres_filter(p_src + (y0 << 1) * i_src + (x0 << 1), i_src, frame->lowres[i] + y0 * i_dst + x0, i_dst,
+                                  x1 - x0, y1 - y0);
+        }
+        p_src = frame->lowres[i];
+        i_src = i_dst;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * build the integral lines of one LCU row (the rows above must be ready),
+ * integral[y][x] is the sum of padded luma pixels above and left of (x, y)
+ */
+void xavs2_frame_integral_lcurow(xavs2_t *h, xavs2_frame_t *frame, int i_lcu_y)
+{
+    int i_pix    = frame->i_stride[IMG_Y];
+    int i_sum    = frame->i_integral_stride;
+    int width    = frame->i_width[IMG_Y] + (XAVS2_PAD << 1);
+    int y_start  = (i_lcu_y + 0) << h->i_lcu_level;
+    int y_end    = (i_lcu_y + 1) << h->i_lcu_level;
+    int x, y;
+
+    /* same region as interpolate_lcu_row(), including the top and bottom padding */
+    if (i_lcu_y > 0) {
+        y_start -= 8;
+    } else {
+        y_start = -XAVS2_PAD;
+    }
+    if (i_lcu_y == h->i_height_in_lcu - 1) {
+        y_end = h->i_height + XAVS2_PAD;
+    } else {
+        y_end -= 8;
+    }
+
+    for (y = y_start; y < y_end; y++) {
+        const pel_t *p_pix = frame->planes[IMG_Y] + y * i_pix - XAVS2_PAD;
+        const uint32_t *p_up = frame->integral + y * i_sum - XAVS2_PAD;
+        uint32_t *p_dst = (uint32_t *)p_up + i_sum;
+        uint32_t sum = 0;
+
+        p_dst[0] = 0;
+        for (x = 0; x < width; x++) {
+            sum += p_pix[x];
+            p_dst[x + 1] = p_up[x + 1] + sum;
+        }
     }
 }
 
@@ -1859,6 +1859,23 @@ void fill_reference_samples_xy_c(const pel_t *pTL, int i_TL, const pel_t *pLcuEP
     }
 }
 
+/* ---------------------------------------------------------------------------
+ * predict the angular modes one by one and compute their SATDs,
+ * reference of the fused intra_satd_x4 kernels
+ */
+static void intra_satd_x4_c(pel_t *src, pel_t *fenc, int i_fenc, const int *modes, int num_modes,
+                            int bsx, int bsy, cmp_dist_t *costs)
+{
+    ALIGN32(pel_t pred[MAX_CU_SIZE * MAX_CU_SIZE]);
+    pixel_cmp_t satd = g_funcs.pixf.satd[PART_INDEX(bsx, bsy)];
+    int k;
+
+    for (k = 0; k < num_modes; k++) {
+        g_funcs.intraf[modes[k]](src, pred, bsx, modes[k], bsx, bsy);
+        costs[k] = satd(fenc, i_fenc, pred, bsx);
+    }
+}
+
 /**
  * ===========================================================================
  * interface function definition
@@ -1925,6 +1942,9 @@ void xavs2_intra_pred_init(uint32_t cpuid, intrinsic_func_t *pf)
     ipred[INTRA_ANG_Y_31]  = intra_pred_ang_y_31_c;
     ipred[INTRA_ANG_Y_32]  = intra_pred_ang_y_32_c;
 
+    pf->intra_satd_x4[0] = intra_satd_x4_c;
+    pf->intra_satd_x4[1] = intra_satd_x4_c;
+
     // TODO: 8bit½Ƕ7911ܲһ   20170716
 #if HAVE_MMX
     if (cpuid & XAVS2_CPU_SSE42) {
@@ -1959,6 +1979,8 @@ void xavs2_intra_pred_init(uint32_t cpuid, intrinsic_func_t *pf)
         pf->fill_edge_f[1] = fill_edge_samples_x_sse128;
         pf->fill_edge_f[2] = fill_edge_samples_y_sse128;
         pf->fill_edge_f[3] = fill_edge_samples_xy_sse128;
+        pf->intra_satd_x4[0] = intra_satd_x4_ang_x_sse128;
+        pf->intra_satd_x4[1] = intra_satd_x4_ang_y_sse128;
     }
 
     /* 8/10bit assemble*/
@@ -66,6 +66,9 @@ int rdo_get_pred_intra_luma_2nd_pass(xavs2_t *h, cu_t *p_cu, intra_candidate_t *
                                      pel_t *p_fenc, int mpm[], int blockidx,
                                      int block_x, int block_y, int block_w, int block_h);
 
+#define rdo_intra_pred_luma FPFX(rdo_intra_pred_luma)
+void rdo_intra_pred_luma(xavs2_t *h, cu_t *p_cu, pel_t *p_pred, int mode, int block_w, int block_h);
+
 #define rdo_get_pred_intra_chroma FPFX(rdo_get_pred_intra_chroma)
 int rdo_get_pred_intra_chroma(xavs2_t *h, cu_t *p_cu, int i_level, int pix_y_c, int pix_x_c,
                               intra_candidate_t *p_candidate_list);
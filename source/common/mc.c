@@ -589,13 +589,19 @@ void mc_luma(pel_t *p_pred, int i_pred, int pix_quad_x, int pix_quad_y,
 }
 
 /* ---------------------------------------------------------------------------
+ * interpolate the luma samples in columns [start_x, end_x) of the rows
+ * [start_y, start_y + height), start_x is -PAD_OFFSET for the left-most part
+ * of a row and end_x is (i_width + PAD_OFFSET) for the right-most one
  */
-void interpolate_sample_rows(xavs2_t *h, xavs2_frame_t* frm, int start_y, int height, int b_start, int b_end)
+static
+void interpolate_sample_area(xavs2_t *h, xavs2_frame_t* frm, int start_x, int end_x,
+                             int start_y, int height, int b_start, int b_end)
 {
     int stride  = frm->i_stride[IMG_Y];         // for src and dst
     int i_tmp   = frm->i_width[IMG_Y] + 2 * XAVS2_PAD;
-    int width   = frm->i_width[IMG_Y] + 2 * PAD_OFFSET;
-    int off_dst = start_y * stride - PAD_OFFSET;
+    int width   = end_x - start_x;
+    int off_dst = start_y * stride + start_x;
+    int off_tmp = XAVS2_PAD + start_x;
     pel_t *src  = frm->planes[IMG_Y] + off_dst; // reconstructed luma plane
     pel_t *p_dst[3];
     const int8_t *p_coeffs[3];
@@ -605,9 +611,16 @@ void interpolate_sample_rows(xavs2_t *h, xavs2_frame_t* frm, int start_y, int he
     /* -------------------------------------------------------------
      * init */
 
-    intpl_tmp[0] = h->img4Y_tmp[0] + (XAVS2_PAD + start_y) * i_tmp + XAVS2_PAD - PAD_OFFSET;
-    intpl_tmp[1] = h->img4Y_tmp[1] + (XAVS2_PAD + start_y) * i_tmp + XAVS2_PAD - PAD_OFFSET;
-    intpl_tmp[2] = h->img4Y_tmp[2] + (XAVS2_PAD + start_y) * i_tmp + XAVS2_PAD - PAD_OFFSET;
+    if (h->img4Y_tmp_row[0] != NULL) {
+        /* row-scope buffer, the first line of this row is at INTPL_ROW_TMP_MARGIN */
+        intpl_tmp[0] = h->img4Y_tmp_row[0] + INTPL_ROW_TMP_MARGIN * i_tmp + off_tmp;
+        intpl_tmp[1] = h->img4Y_tmp_row[1] + INTPL_ROW_TMP_MARGIN * i_tmp + off_tmp;
+        intpl_tmp[2] = h->img4Y_tmp_row[2] + INTPL_ROW_TMP_MARGIN * i_tmp + off_tmp;
+    } else {
+        intpl_tmp[0] = h->img4Y_tmp[0] + (XAVS2_PAD + start_y) * i_tmp + off_tmp;
+        intpl_tmp[1] = h->img4Y_tmp[1] + (XAVS2_PAD + start_y) * i_tmp + off_tmp;
+        intpl_tmp[2] = h->img4Y_tmp[2] + (XAVS2_PAD + start_y) * i_tmp + off_tmp;
+    }
 
     /* -------------------------------------------------------------
      * interpolate horizontal positions: a,b,c;
@@ -728,16 +741,16 @@ void interpolate_sample_rows(xavs2_t *h, xavs2_frame_t* frm, int start_y, int he
     {
         const int padh = XAVS2_PAD - PAD_OFFSET;
         const int padv = XAVS2_PAD - PAD_OFFSET;
+        int b_left  = start_x < 0;
+        int b_right = end_x > frm->i_width[IMG_Y];
         int i;
 
-        width  = frm->i_width[IMG_Y] + PAD_OFFSET * 2;
-
         /* loop over all 15 filtered planes */
         for (i = 1; i < 16; i++) {
             pel_t *pix = frm->filtered[i];
             if (pix != NULL) {
-                pix += start_y * stride - PAD_OFFSET;
-                plane_expand_border(pix, stride, width, height, padh, padv, b_start, b_end);
+                pix += off_dst;
+                plane_expand_border_part(pix, stride, width, height, padh, padv, b_start, b_end, b_left, b_right);
             }
         }
     }
@@ -745,12 +758,22 @@ void interpolate_sample_rows(xavs2_t *h, xavs2_frame_t* frm, int start_y, int he
 
 /* ---------------------------------------------------------------------------
  */
-void interpolate_lcu_row(xavs2_t *h, xavs2_frame_t* frm, int i_lcu_y)
+void interpolate_sample_rows(xavs2_t *h, xavs2_frame_t* frm, int start_y, int height, int b_start, int b_end)
+{
+    interpolate_sample_area(h, frm, -PAD_OFFSET, frm->i_width[IMG_Y] + PAD_OFFSET, start_y, height, b_start, b_end);
+}
+
+/* ---------------------------------------------------------------------------
+ * interpolate the LCUs [i_lcu_x_start, i_lcu_x_end) in one LCU row
+ */
+void interpolate_lcu_row(xavs2_t *h, xavs2_frame_t* frm, int i_lcu_y, int i_lcu_x_start, int i_lcu_x_end)
 {
     int b_start = !i_lcu_y;
     int b_end   = i_lcu_y == h->i_height_in_lcu - 1;
     int y_start = (i_lcu_y + 0) << h->i_lcu_level;
     int y_end   = (i_lcu_y + 1) << h->i_lcu_level;
+    int x_start = (i_lcu_x_start << h->i_lcu_level);
+    int x_end   = (i_lcu_x_end   << h->i_lcu_level);
     int height;
     slice_t *slice = h->slices[h->i_slice_index];
 
@@ -781,7 +804,13 @@ void interpolate_lcu_row(xavs2_t *h, xavs2_frame_t* frm, int i_lcu_y)
     height = y_end - y_start;
     // xavs2_log(NULL, XAVS2_LOG_DEBUG, "Intpl POC [%3d], Slice %2d, Row %2d, [%3d, %3d)\n",
     //           h->fenc->i_frame, h->i_slice_index, i_lcu_y, y_start, y_end);
-    interpolate_sample_rows(h, frm, y_start, height, b_start, b_end);
+    if (i_lcu_x_start == 0) {
+        x_start = -PAD_OFFSET;
+    }
+    if (i_lcu_x_end == h->i_width_in_lcu) {
+        x_end = frm->i_width[IMG_Y] + PAD_OFFSET;
+    }
+    interpolate_sample_area(h, frm, x_start, x_end, y_start, height, b_start, b_end);
 }
 
 
@@ -80,7 +80,7 @@ void get_mv_for_mc(xavs2_t *h, mv_t *mv, int pic_pix_x, int pic_pix_y, int blk_w
  * ===========================================================================
  */
 #define interpolate_lcu_row FPFX(interpolate_lcu_row)
-void interpolate_lcu_row(xavs2_t *h, xavs2_frame_t* frm, int i_lcu_y);
+void interpolate_lcu_row(xavs2_t *h, xavs2_frame_t* frm, int i_lcu_y, int i_lcu_x_start, int i_lcu_x_end);
 
 #define interpolate_sample_rows FPFX(interpolate_sample_rows)
 void interpolate_sample_rows(xavs2_t *h, xavs2_frame_t* frm, int start_y, int height, int b_start, int b_end);
@@ -333,6 +333,31 @@ xavs2_thread_create(xavs2_thread_t *t, void *a, void *(*f)(void *), void *d)
 #define xavs2_sleep_ms(x)              usleep(x * 1000)
 #endif
 
+/* ---------------------------------------------------------------------------
+ * progress counters read by other threads without a lock: the store makes
+ * all writes before it visible to a thread which loads the stored value
+ */
+#if defined(__GNUC__) && (__GNUC__ > 4 || __GNUC__ == 4 && __GNUC_MINOR__ >= 7)
+#define xavs2_atomic_load_acquire(p)     __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define xavs2_atomic_store_release(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+/* volatile accesses have acquire/release semantics (/volatile:ms) */
+#define xavs2_atomic_load_acquire(p)     (*(volatile int *)(p))
+#define xavs2_atomic_store_release(p, v) (*(volatile int *)(p) = (v))
+#else
+static ALWAYS_INLINE int xavs2_atomic_load_acquire(volatile int *p)
+{
+    int v = *p;
+    __sync_synchronize();
+    return v;
+}
+static ALWAYS_INLINE void xavs2_atomic_store_release(volatile int *p, int v)
+{
+    __sync_synchronize();
+    *p = v;
+}
+#endif
+
 
 /**
  * ===========================================================================
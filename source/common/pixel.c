@@ -1668,3 +1668,45 @@ void xavs2_mad_init(uint32_t cpuid, mad_funcs_t *madf)
 #endif //if HAVE_MMX
 }
 
+/* ---------------------------------------------------------------------------
+ * sum of squared differences between the pixels and the mean of the block,
+ * with the mean taken as sum / N (N * variance)
+ */
+static uint64_t var_NxN_c(pel_t *p_src, int i_src, int cu_size)
+{
+    int shift = 2 * xavs2_log2u(cu_size);
+    uint64_t sqr = 0;
+    uint32_t sum = 0;
+    int x, y;
+
+    for (y = 0; y < cu_size; ++y) {
+        for (x = 0; x < cu_size; ++x) {
+            sum += p_src[x];
+            sqr += p_src[x] * p_src[x];
+        }
+        p_src += i_src;
+    }
+
+    return sqr - (((uint64_t)sum * sum) >> shift);
+}
+
+
+/* ---------------------------------------------------------------------------
+ */
+void xavs2_var_init(uint32_t cpuid, var_funcs_t *varf)
+{
+    varf[B8X8_IN_BIT   - MIN_CU_SIZE_IN_BIT] = var_NxN_c;
+    varf[B16X16_IN_BIT - MIN_CU_SIZE_IN_BIT] = var_NxN_c;
+    varf[B32X32_IN_BIT - MIN_CU_SIZE_IN_BIT] = var_NxN_c;
+    varf[B64X64_IN_BIT - MIN_CU_SIZE_IN_BIT] = var_NxN_c;
+
+    /* init asm function handles */
+#if HAVE_MMX
+    /* functions defined in file intrinsic_mad.c */
+    if (cpuid & XAVS2_CPU_SSE2) {
+        varf[B8X8_IN_BIT   - MIN_CU_SIZE_IN_BIT] = var_8x8_sse128;
+        varf[B16X16_IN_BIT - MIN_CU_SIZE_IN_BIT] = var_16x16_sse128;
+    }
+#endif //if HAVE_MMX
+}
+
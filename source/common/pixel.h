@@ -137,6 +137,7 @@ typedef void(*pixel_add_ps_t)(pel_t* a, intptr_t dstride, const pel_t* b0, const
 typedef void(*pixel_avg_pp_t)(pel_t* dst, intptr_t dstride, const pel_t* src0, intptr_t sstride0, const pel_t* src1, intptr_t sstride1, int weight);
 
 typedef int(*mad_funcs_t)(pel_t *p_src, int i_src, int cu_size);
+typedef uint64_t(*var_funcs_t)(pel_t *p_src, int i_src, int cu_size);
 
 typedef struct {
 
@@ -155,10 +156,8 @@ typedef struct {
     copy_pp_t       copy_pp[NUM_PU_SIZES];
     pixel_avg_pp_t  avg    [NUM_PU_SIZES];
 
-    pixel_cmp_t    *intra_cmp;  /* either satd or sad for intra mode prediction */
-    pixel_cmp_t    *fpel_cmp;   /* either satd or sad for fractional pixel comparison in ME */
-
     mad_funcs_t     madf[CTU_DEPTH];
+    var_funcs_t     varf[CTU_DEPTH];  /* sum of squared differences to the block mean (variance * N) */
 
     pixel_ssd2_t    ssd_block;
     /* block average */
@@ -198,4 +197,7 @@ uint64_t xavs2_pixel_ssd_wxh(pixel_funcs_t *pf,
 #define xavs2_mad_init FPFX(mad_init)
 void xavs2_mad_init(uint32_t cpu, mad_funcs_t *madf);
 
+#define xavs2_var_init FPFX(var_init)
+void xavs2_var_init(uint32_t cpu, var_funcs_t *varf);
+
 #endif  // XAVS2_PIXEL_H
@@ -87,7 +87,7 @@ int check_mv_range(xavs2_t *h, const mv_t *mv, int ref_idx, int pix_x, int pix_y
     dep_lcu_x = XAVS2_MAX(0, dep_lcu_x);
     dep_lcu_y = XAVS2_MIN(h->i_height_in_lcu - 1, dep_lcu_y);
     dep_lcu_x = XAVS2_MIN(h->i_width_in_lcu - 1, dep_lcu_x);
-    dep_lcu_row_avail = h->fref[ref_idx]->num_lcu_coded_in_row[dep_lcu_y] > dep_lcu_x;
+    dep_lcu_row_avail = xavs2_atomic_load_acquire(&h->fref[ref_idx]->num_lcu_coded_in_row[dep_lcu_y]) > dep_lcu_x;
 
     return dep_lcu_row_avail && (mv->x <= max_x && mv->x >= min_x && mv->y <= max_y && mv->y >= min_y);
 }
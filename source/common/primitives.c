@@ -54,11 +54,8 @@ void xavs2_init_all_primitives(xavs2_param_t* param, intrinsic_func_t *p_funcs)
 {
     uint32_t cpuid = p_funcs->cpuid;
 
-    if (param != NULL) {
-        if (param->sample_bit_depth != g_bit_depth) {
-            xavs2_log(NULL, XAVS2_LOG_ERROR, "init primitives error: only %d bit-depth is supported\n", g_bit_depth);
-        }
-    }
+    /* the bit-depth is checked by every encoder, the primitives are only initialized once */
+    UNUSED_PARAMETER(param);
 
     /* init memory operation function handlers */
     xavs2_mem_oper_init  (cpuid, p_funcs);
@@ -72,6 +69,7 @@ void xavs2_init_all_primitives(xavs2_param_t* param, intrinsic_func_t *p_funcs)
     xavs2_quant_init     (cpuid, &p_funcs->dctf);
     xavs2_cg_scan_init   (cpuid, p_funcs);
     xavs2_mad_init       (cpuid, p_funcs->pixf.madf);
+    xavs2_var_init       (cpuid, p_funcs->pixf.varf);
 
     xavs2_sao_init       (cpuid, p_funcs);
     xavs2_alf_init       (cpuid, p_funcs);
@@ -84,6 +84,10 @@ typedef void (*filter_p2s_t)   (const pel_t   *src, intptr_t srcStride, int16_t
 typedef void(*intra_pred_t)(pel_t *src, pel_t *dst, int i_dst, int dir_mode, int bsx, int bsy);
 typedef void(*fill_edge_t) (const pel_t *p_topleft, int i_topleft, const pel_t *p_lcu_ep, pel_t *ep, uint32_t i_avail, int bsx, int bsy);
 typedef void(*fill_ref_samples_t)(xavs2_t *h, cu_t *p_cu, int img_x, int img_y, int block_x, int block_y, int bsx, int bsy);
+/* predict up to 4 angular modes of one class from the same reference samples and return their SATDs.
+ * mode 5 on 4x16 / 8x32 and mode 31 on 16x4 / 32x8 pad the far samples in intraf[] and are not covered */
+typedef void(*intra_satd_x4_t)(pel_t *src, pel_t *fenc, int i_fenc, const int *modes, int num_modes,
+                               int bsx, int bsy, cmp_dist_t *costs);
 
 
 /* ---------------------------------------------------------------------------
@@ -116,14 +120,27 @@ typedef struct {
     int(*quant)   (coeff_t *coef, const int i_coef, const int scale, const int shift, const int add);
     void(*dequant)(coeff_t *coef, const int i_coef, const int scale, const int shift);
     int(*wquant)  (coeff_t *coef, const int i_coef, const int scale, const int shift, const int add, int *levelscale);
+
+    /* RDOQ: candidate levels and quantization errors of the 16 coeffs in one CG */
+    int(*rdoq_cg_levels)(coeff_t *coef, int8_t *num_level, int32_t err_level[3][16],
+                         const int q_scale, const int q_shift, const int iq_scale, const int iq_shift, const int thres_lower);
 } dct_funcs_t;
 
 
+/* deblock: boundary strength of a run of 4x4 blocks derived from motion,
+ * flag[i] = 0 when block i and block (i - i_neighbor) use the same valid
+ * reference and their MVs differ by less than one integer pixel, else 1 */
+typedef void(*deblock_bs_t)(uint8_t *flag, const mv_t *mv, const int8_t *ref, int i_neighbor, int num);
+
 /* SAO filter function */
 typedef void(*sao_flt_t)(pel_t *p_dst, int i_dst, pel_t *p_src, int i_src,
                          int i_block_w, int i_block_h,
                          int *lcu_avail, SAOBlkParam *sao_param);
 
+/* SAO statistics function (for SAO decision in encoder) */
+typedef void(*sao_stat_t)(const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                          int i_block_w, int i_block_h,
+                          int *lcu_avail, SAOStatData *p_stats);
 
 
 /* ---------------------------------------------------------------------------
@@ -186,6 +203,7 @@ typedef struct intrinsic_func_t {
     intra_pred_t        intraf[NUM_INTRA_MODE];
     fill_edge_t         fill_edge_f[4];   /* 0, x, y, xy */
     fill_ref_samples_t  fill_ref_luma[2]; /* 0: CU inside picture; 1: on right/bottom */
+    intra_satd_x4_t     intra_satd_x4[2]; /* 0: X angles (3 ~ 11), 1: Y angles (25 ~ 32) */
 
     /* ---------------------------------------------------------------------------
      * transform and quantization
@@ -205,7 +223,10 @@ typedef struct intrinsic_func_t {
     void(*deblock_luma_double[2])  (pel_t *src, int stride, int alpha, int beta, uint8_t *flt_flag);
     void(*deblock_chroma_double[2])(pel_t *src_u, pel_t *src_v, int stride, int alpha, int beta, uint8_t *flt_flag);
 
+    deblock_bs_t    deblock_bs;         /* boundary strength from MVs and references */
+
     sao_flt_t       sao_block;          /* filter for SAO */
+    sao_stat_t      sao_stat[NUM_SAO_NEW_TYPES];  /* statistics for SAO: EO_0, EO_90, EO_135, EO_45, BO */
 
     /* function handles */
     void(*alf_flt[2])(pel_t *p_dst, int i_dst, pel_t *p_src, int i_src,
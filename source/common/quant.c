@@ -183,6 +183,48 @@ static void dequant_c(coeff_t *coef, const int i_coef, const int scale, const in
     }
 }
 
+/* ---------------------------------------------------------------------------
+ * RDOQ: generate the candidate levels of the 16 (absolute) coeffs in one CG
+ *   coef      - [in ] absolute coefficients in scan order;
+ *               [out] the largest candidate level L of each coefficient
+ *   num_level - number of candidate levels, the candidates are {0}, {0, L} or {0, L, L + 1}
+ *   err_level - squared quantization error of each candidate
+ * return a bit-mask of the coefficients which have non-zero candidate levels
+ */
+static int rdoq_cg_levels_c(coeff_t *coef, int8_t *num_level, int32_t err_level[3][16],
+                            const int q_scale, const int q_shift, const int iq_scale, const int iq_shift, const int thres_lower)
+{
+    const int iq_add = 1 << (iq_shift - 1);
+    int mask = 0;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        int coeff = coef[i];
+        int level = (coeff * q_scale) >> q_shift;
+        int rec   = (level * iq_scale + iq_add) >> iq_shift;
+        int b_lower = (coeff - rec) <= thres_lower;
+        int err;
+
+        if (level == 0) {
+            level = !b_lower;
+            num_level[i] = (int8_t)(1 + !b_lower);
+        } else {
+            num_level[i] = (int8_t)(2 + !b_lower);
+        }
+        mask |= (num_level[i] > 1) << i;
+        coef[i] = (coeff_t)level;
+
+        err = coeff;
+        err_level[0][i] = err * err;
+        err = coeff - ((level * iq_scale + iq_add) >> iq_shift);
+        err_level[1][i] = err * err;
+        err = coeff - (((level + 1) * iq_scale + iq_add) >> iq_shift);
+        err_level[2][i] = err * err;
+    }
+
+    return mask;
+}
+
 #if ENABLE_WQUANT
 /* ---------------------------------------------------------------------------
  */
@@ -219,6 +261,8 @@ void xavs2_quant_init(uint32_t cpuid, dct_funcs_t *dctf)
     dctf->abs_coeff = abs_coeff_c;
     dctf->add_sign  = add_sign_c;
 
+    dctf->rdoq_cg_levels = rdoq_cg_levels_c;
+
     /* init asm function handles */
 #if HAVE_MMX
     if (cpuid & XAVS2_CPU_SSE4) {
@@ -226,6 +270,7 @@ void xavs2_quant_init(uint32_t cpuid, dct_funcs_t *dctf)
         dctf->dequant   = FPFX(dequant_sse4);
         dctf->abs_coeff = abs_coeff_sse128;
         dctf->add_sign  = add_sign_sse128;
+        dctf->rdoq_cg_levels = rdoq_cg_levels_sse128;
     }
 
     if (cpuid & XAVS2_CPU_AVX2) {
@@ -113,6 +113,67 @@ int  xavs2_thread_set_cpu(int idx_core)
 #endif
 }
 
+/* ---------------------------------------------------------------------------
+ * bind the calling thread to all CPU cores of a NUMA node
+ */
+int  xavs2_thread_set_node(int node)
+{
+#if HAVE_POSIXTHREAD && SYS_LINUX
+    char path[64];
+    char list[1024];
+    char *p = list;
+    cpu_set_t mask;
+    FILE *fp;
+
+    if (node < 0) {
+        return 0;
+    }
+
+    /* the cpu list looks like "0-15,32-47" */
+    sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+    if ((fp = fopen(path, "r")) == NULL) {
+        return -1;
+    }
+    if (fgets(list, sizeof(list), fp) == NULL) {
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+
+    CPU_ZERO(&mask);
+    while (*p >= '0' && *p <= '9') {
+        int first = (int)strtol(p, &p, 10);
+        int last  = first;
+        if (*p == '-') {
+            last = (int)strtol(p + 1, &p, 10);
+        }
+        for (; first <= last && first < CPU_SETSIZE; first++) {
+            CPU_SET(first, &mask);
+        }
+        if (*p == ',') {
+            p++;
+        }
+    }
+
+    if (CPU_COUNT(&mask) == 0 || pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) != 0) {
+        return -1;
+    }
+    return 0;
+#else
+    UNUSED_PARAMETER(node);
+    return 0;
+#endif
+}
+
+/* ---------------------------------------------------------------------------
+ * init function of threads: bind to a NUMA node (pointer to the node index)
+ */
+void *xavs2_thread_init_node(void *p_node)
+{
+    xavs2_thread_set_node(*(int *)p_node);
+    return NULL;
+}
+
 /* ---------------------------------------------------------------------------
  */
 static INLINE
@@ -49,4 +49,9 @@ void *xavs2_threadpool_wait  (xavs2_threadpool_t *pool, void *arg);
 #define xavs2_threadpool_delete FPFX(threadpool_delete)
 void  xavs2_threadpool_delete(xavs2_threadpool_t *pool);
 
+#define xavs2_thread_set_node FPFX(thread_set_node)
+int   xavs2_thread_set_node  (int node);
+#define xavs2_thread_init_node FPFX(thread_init_node)
+void *xavs2_thread_init_node (void *p_node);
+
 #endif  // XAVS2_THREADPOOL_H
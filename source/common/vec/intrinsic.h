@@ -194,6 +194,8 @@ void deblock_edge_hor_sse128  (pel_t *SrcPtr, int stride, int Alpha, int Beta, u
 void deblock_edge_ver_c_sse128(pel_t *SrcPtrU, pel_t *SrcPtrV, int stride, int Alpha, int Beta, unsigned char *flt_flag);
 #define deblock_edge_hor_c_sse128 FPFX(deblock_edge_hor_c_sse128)
 void deblock_edge_hor_c_sse128(pel_t *SrcPtrU, pel_t *SrcPtrV, int stride, int Alpha, int Beta, unsigned char *flt_flag);
+#define deblock_bs_sse128 FPFX(deblock_bs_sse128)
+void deblock_bs_sse128(uint8_t *flag, const mv_t *mv, const int8_t *ref, int i_neighbor, int num);
 
 //--------avx2--------    add by zhangjiaqi    2016-12-02
 #define deblock_edge_hor_avx2 FPFX(deblock_edge_hor_avx2)
@@ -335,6 +337,9 @@ void coeff_scan4_yx_avx(coeff_t *dst, uint64_t r1, uint64_t r2, uint64_t r3, uin
 void abs_coeff_sse128(coeff_t *dst, const coeff_t *src, const int i_coef);
 #define add_sign_sse128 FPFX(add_sign_sse128)
 int add_sign_sse128(coeff_t *dst, const coeff_t *abs_val, const int i_coef);
+#define rdoq_cg_levels_sse128 FPFX(rdoq_cg_levels_sse128)
+int rdoq_cg_levels_sse128(coeff_t *coef, int8_t *num_level, int32_t err_level[3][16],
+                          const int q_scale, const int q_shift, const int iq_scale, const int iq_shift, const int thres_lower);
 
 #define quant_c_avx2 FPFX(quant_c_avx2)
 int quant_c_avx2(coeff_t *coef, const int i_coef, const int scale, const int shift, const int add);
@@ -357,6 +362,21 @@ void SAO_on_block_sse128(pel_t *p_dst, int i_dst, pel_t *p_src,
 void SAO_on_block_sse256(pel_t *p_dst, int i_dst, pel_t *p_src,
                          int i_src,int i_block_w, int i_block_h,
                          int *lcu_avail, SAOBlkParam *sao_param);
+#define SAO_stat_EO_0_sse128 FPFX(SAO_stat_EO_0_sse128)
+void SAO_stat_EO_0_sse128  (const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                            int i_block_w, int i_block_h, int *lcu_avail, SAOStatData *p_stats);
+#define SAO_stat_EO_90_sse128 FPFX(SAO_stat_EO_90_sse128)
+void SAO_stat_EO_90_sse128 (const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                            int i_block_w, int i_block_h, int *lcu_avail, SAOStatData *p_stats);
+#define SAO_stat_EO_135_sse128 FPFX(SAO_stat_EO_135_sse128)
+void SAO_stat_EO_135_sse128(const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                            int i_block_w, int i_block_h, int *lcu_avail, SAOStatData *p_stats);
+#define SAO_stat_EO_45_sse128 FPFX(SAO_stat_EO_45_sse128)
+void SAO_stat_EO_45_sse128 (const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                            int i_block_w, int i_block_h, int *lcu_avail, SAOStatData *p_stats);
+#define SAO_stat_BO_sse128 FPFX(SAO_stat_BO_sse128)
+void SAO_stat_BO_sse128    (const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                            int i_block_w, int i_block_h, int *lcu_avail, SAOStatData *p_stats);
 
 #define alf_flt_one_block_sse128 FPFX(alf_flt_one_block_sse128)
 void alf_flt_one_block_sse128(pel_t *p_dst, int i_dst, pel_t *p_src, int i_src,
@@ -406,6 +426,11 @@ void intra_pred_ang_y_31_sse128 (pel_t *src, pel_t *dst, int i_dst, int dir_mode
 #define intra_pred_ang_y_32_sse128 FPFX(intra_pred_ang_y_32_sse128)
 void intra_pred_ang_y_32_sse128 (pel_t *src, pel_t *dst, int i_dst, int dir_mode, int bsx, int bsy);
 
+#define intra_satd_x4_ang_x_sse128 FPFX(intra_satd_x4_ang_x_sse128)
+void intra_satd_x4_ang_x_sse128 (pel_t *src, pel_t *fenc, int i_fenc, const int *modes, int num_modes, int bsx, int bsy, cmp_dist_t *costs);
+#define intra_satd_x4_ang_y_sse128 FPFX(intra_satd_x4_ang_y_sse128)
+void intra_satd_x4_ang_y_sse128 (pel_t *src, pel_t *fenc, int i_fenc, const int *modes, int num_modes, int bsx, int bsy, cmp_dist_t *costs);
+
 #define intra_pred_ang_xy_13_sse128 FPFX(intra_pred_ang_xy_13_sse128)
 void intra_pred_ang_xy_13_sse128(pel_t *src, pel_t *dst, int i_dst, int dir_mode, int bsx, int bsy);
 #define intra_pred_ang_xy_14_sse128 FPFX(intra_pred_ang_xy_14_sse128)
@@ -496,6 +521,10 @@ int mad_16x16_sse128(pel_t *p_src, int i_src, int cu_size);
 int mad_32x32_sse128(pel_t *p_src, int i_src, int cu_size);
 #define mad_64x64_sse128 FPFX(mad_64x64_sse128)
 int mad_64x64_sse128(pel_t *p_src, int i_src, int cu_size);
+#define var_8x8_sse128 FPFX(var_8x8_sse128)
+uint64_t var_8x8_sse128(pel_t *p_src, int i_src, int cu_size);
+#define var_16x16_sse128 FPFX(var_16x16_sse128)
+uint64_t var_16x16_sse128(pel_t *p_src, int i_src, int cu_size);
 
 
 #endif // #ifndef XAVS2_INTRINSIC_H
@@ -35,6 +35,7 @@
  */
 
 #include "../basic_types.h"
+#include "../avs2_defs.h"
 #include "intrinsic.h"
 
 #include <mmintrin.h>
@@ -805,3 +806,46 @@ void deblock_edge_hor_c_sse128(pel_t *SrcPtrU, pel_t *SrcPtrV, int stride, int A
     ((int32_t*)(SrcPtrV - inc2))[0] = M128_I32(UL1, 1);
     ((int32_t*)(SrcPtrV + inc ))[0] = M128_I32(UR1, 1);
 }
+
+/* ---------------------------------------------------------------------------
+ * boundary strengths of 4 blocks at a time, see deblock_bs_c()
+ */
+void deblock_bs_sse128(uint8_t *flag, const mv_t *mv, const int8_t *ref, int i_neighbor, int num)
+{
+    const int32_t *p_mv = (const int32_t *)mv;
+    const __m128i c_3   = _mm_set1_epi16(3);
+    const __m128i c_m3  = _mm_set1_epi16(-3);
+    const __m128i c_1   = _mm_set1_epi8(1);
+    const __m128i c_inv = _mm_set1_epi8(INVALID_REF);
+    __m128i MVQ, MVP, D, REFQ, REFP, SKIP;
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        /* MVs differ by one integer pixel or more (saturated to avoid overflow) */
+        MVQ = _mm_loadu_si128((const __m128i *)(p_mv + i));
+        MVP = _mm_loadu_si128((const __m128i *)(p_mv + i - i_neighbor));
+        D   = _mm_subs_epi16(MVQ, MVP);
+        D   = _mm_or_si128(_mm_cmpgt_epi16(D, c_3), _mm_cmplt_epi16(D, c_m3));
+        D   = _mm_cmpeq_epi32(D, _mm_setzero_si128());     /* 32-bit lanes: both components are close */
+
+        /* same valid reference */
+        REFQ = _mm_cvtsi32_si128(*(const int32_t *)(ref + i));
+        REFP = _mm_cvtsi32_si128(*(const int32_t *)(ref + i - i_neighbor));
+        SKIP = _mm_andnot_si128(_mm_cmpeq_epi8(REFQ, c_inv), _mm_cmpeq_epi8(REFQ, REFP));
+
+        /* combine: 32-bit lanes -> bytes */
+        D    = _mm_packs_epi32(D, D);
+        D    = _mm_packs_epi16(D, D);
+        SKIP = _mm_and_si128(SKIP, D);
+        *(int32_t *)(flag + i) = _mm_cvtsi128_si32(_mm_andnot_si128(SKIP, c_1));
+    }
+
+    for (; i < num; i++) {
+        int16_t *mv_q = (int16_t *)(p_mv + i);
+        int16_t *mv_p = (int16_t *)(p_mv + i - i_neighbor);
+
+        flag[i] = !((ref[i] != INVALID_REF && ref[i] == ref[i - i_neighbor]) &&
+                    (XAVS2_ABS(mv_q[0] - mv_p[0]) < 4) &&
+                    (XAVS2_ABS(mv_q[1] - mv_p[1]) < 4));
+    }
+}
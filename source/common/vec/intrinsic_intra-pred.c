@@ -7927,4 +7927,248 @@ void intra_pred_ang_xy_23_sse128(pel_t *src, pel_t *dst, int i_dst, int dir_mode
 
 }
 
+/* ---------------------------------------------------------------------------
+ * fused angular prediction + SATD for the rough intra mode decision
+ *
+ * the Y angles are the X angles of the reversed left reference line on the
+ * transposed block, and the Hadamard cost of a 4x4 block does not change on
+ * transposition, so both classes share the same row kernel
+ */
+
+/* dx/dy of the X angles (3 ~ 11) and dy/dx of the Y angles (25 ~ 32), same as tab_auc_dir_dxdy in intra.c */
+static const int8_t tab_satd_x4_dxdy[NUM_INTRA_MODE][2] = {
+    { 0,0}, {0,0}, { 0,0},
+    {11,2}, {2,0}, {11,3}, {1,0}, {93,7}, {1,1}, {93,8}, {1,2}, { 1,3},                 /* X  */
+    { 0,0},
+    { 0,0}, {0,0}, { 0,0}, {0,0}, { 0,0}, {0,0}, { 0,0}, {0,0}, { 0,0}, {0,0}, {0,0},   /* XY */
+    { 0,0},
+    { 1,3}, {1,2}, {93,8}, {1,1}, {93,7}, {1,0}, {11,3}, {2,0}                          /* Y  */
+};
+
+/* ---------------------------------------------------------------------------
+ * reference positions and filter phases of all rows (along the reference line)
+ */
+static ALWAYS_INLINE
+void satd_x4_get_steps(int dir_mode, int num_rows, int *steps, int *offsets)
+{
+    const int mult  = tab_satd_x4_dxdy[dir_mode][0];
+    const int shift = tab_satd_x4_dxdy[dir_mode][1];
+    int i;
+
+    for (i = 0; i < num_rows; i++) {
+        int temp_d  = (i + 1) * mult;
+        int temp_dn = temp_d >> shift;
+
+        steps[i]   = temp_dn;
+        offsets[i] = ((temp_d << 5) >> shift) - (temp_dn << 5);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * one row of 8 predicted samples (4-tap filter along the reference line),
+ * minus the original samples
+ */
+static ALWAYS_INLINE
+__m128i satd_x4_pred_diff_row(const pel_t *p_ref, int offset, __m128i org)
+{
+    __m128i c01  = _mm_set1_epi16((int16_t)(((64 - offset) << 8) | (32 - offset)));
+    __m128i c23  = _mm_set1_epi16((int16_t)((offset << 8) | (32 + offset)));
+    __m128i ref  = _mm_loadu_si128((const __m128i *)p_ref);
+    __m128i p01  = _mm_unpacklo_epi8(ref, _mm_srli_si128(ref, 1));
+    __m128i p23  = _mm_unpacklo_epi8(_mm_srli_si128(ref, 2), _mm_srli_si128(ref, 3));
+    __m128i pred = _mm_add_epi16(_mm_maddubs_epi16(p01, c01), _mm_maddubs_epi16(p23, c23));
+
+    pred = _mm_srli_epi16(_mm_add_epi16(pred, _mm_set1_epi16(64)), 7);
+    return _mm_sub_epi16(pred, org);
+}
+
+#define HADAMARD4_EPI16(d0, d1, d2, d3) {\
+    __m128i s01 = _mm_add_epi16(d0, d1);\
+    __m128i t01 = _mm_sub_epi16(d0, d1);\
+    __m128i s23 = _mm_add_epi16(d2, d3);\
+    __m128i t23 = _mm_sub_epi16(d2, d3);\
+    d0 = _mm_add_epi16(s01, s23);\
+    d1 = _mm_sub_epi16(s01, s23);\
+    d2 = _mm_add_epi16(t01, t23);\
+    d3 = _mm_sub_epi16(t01, t23);\
+}
+
+/* ---------------------------------------------------------------------------
+ * Hadamard sums of the two 4x4 blocks in 4 rows of 8 differences:
+ * the left block in *p_sum0, the right one in *p_sum1 (both not halved)
+ */
+static ALWAYS_INLINE
+void satd_x4_hadamard_8x4(__m128i d0, __m128i d1, __m128i d2, __m128i d3, int *p_sum0, int *p_sum1)
+{
+    __m128i t0, t1, t2, t3;
+
+    HADAMARD4_EPI16(d0, d1, d2, d3);
+
+    /* transpose the two 4x4 blocks: t0 ~ t3 hold the columns 0 ~ 3 of both blocks */
+    t0 = _mm_unpacklo_epi16(d0, d1);
+    t1 = _mm_unpacklo_epi16(d2, d3);
+    t2 = _mm_unpackhi_epi16(d0, d1);
+    t3 = _mm_unpackhi_epi16(d2, d3);
+    d0 = _mm_unpacklo_epi32(t0, t1);
+    d1 = _mm_unpackhi_epi32(t0, t1);
+    d2 = _mm_unpacklo_epi32(t2, t3);
+    d3 = _mm_unpackhi_epi32(t2, t3);
+    t0 = _mm_unpacklo_epi64(d0, d2);
+    t1 = _mm_unpackhi_epi64(d0, d2);
+    t2 = _mm_unpacklo_epi64(d1, d3);
+    t3 = _mm_unpackhi_epi64(d1, d3);
+
+    HADAMARD4_EPI16(t0, t1, t2, t3);
+
+    t0 = _mm_add_epi16(_mm_add_epi16(_mm_abs_epi16(t0), _mm_abs_epi16(t1)),
+                       _mm_add_epi16(_mm_abs_epi16(t2), _mm_abs_epi16(t3)));
+    t0 = _mm_madd_epi16(t0, _mm_set1_epi16(1));
+    t0 = _mm_hadd_epi32(t0, t0);
+
+    *p_sum0 = _mm_cvtsi128_si32(t0);
+    *p_sum1 = _mm_extract_epi32(t0, 1);
+}
+
+#undef HADAMARD4_EPI16
+
+#define SATD_X4_NUM_BLOCKS  ((MAX_CU_SIZE >> 2) * (MAX_CU_SIZE >> 2))  /* number of 4x4 blocks in a CU */
+
+/* ---------------------------------------------------------------------------
+ * Hadamard sums of the 4x4 blocks of up to 4 angular predictions in "row space"
+ * (rows along the reference line), sums[k][y / 4][x / 4] (stride: MAX_CU_SIZE / 4).
+ * each 8x4 tile of the original samples is loaded once for all the modes
+ */
+static void satd_x4_ang_rows(const pel_t *p_ref, int steps[][MAX_CU_SIZE], int offsets[][MAX_CU_SIZE], int num_modes,
+                             const pel_t *p_org, int i_org, int width, int height, int sums[][SATD_X4_NUM_BLOCKS])
+{
+    __m128i zero = _mm_setzero_si128();
+    int x, y, k;
+
+    for (y = 0; y < height; y += 4) {
+        const pel_t *org = p_org + y * i_org;
+        int idx_row = (y >> 2) * (MAX_CU_SIZE >> 2);
+
+        for (x = 0; x < width; x += 8) {
+            __m128i o0 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(org + x)));
+            __m128i o1 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(org + x + i_org)));
+            __m128i o2 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(org + x + 2 * i_org)));
+            __m128i o3 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(org + x + 3 * i_org)));
+            int idx = idx_row + (x >> 2);
+
+            for (k = 0; k < num_modes; k++) {
+                const int *p_step = steps[k] + y;
+                const int *p_offs = offsets[k] + y;
+                __m128i d0 = satd_x4_pred_diff_row(p_ref + p_step[0] + x, p_offs[0], o0);
+                __m128i d1 = satd_x4_pred_diff_row(p_ref + p_step[1] + x, p_offs[1], o1);
+                __m128i d2 = satd_x4_pred_diff_row(p_ref + p_step[2] + x, p_offs[2], o2);
+                __m128i d3 = satd_x4_pred_diff_row(p_ref + p_step[3] + x, p_offs[3], o3);
+
+                if (width - x == 4) {
+                    /* only the left block is inside */
+                    d0 = _mm_unpacklo_epi64(d0, zero);
+                    d1 = _mm_unpacklo_epi64(d1, zero);
+                    d2 = _mm_unpacklo_epi64(d2, zero);
+                    d3 = _mm_unpacklo_epi64(d3, zero);
+                }
+
+                satd_x4_hadamard_8x4(d0, d1, d2, d3, &sums[k][idx], &sums[k][idx + 1]);
+            }
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * SATD from the 4x4 Hadamard sums, rounded as the C functions do:
+ * per 8x4 block when the width is a multiple of 8, per 4x4 block otherwise
+ */
+static ALWAYS_INLINE
+cmp_dist_t satd_x4_sum_blocks(const int *sums, int b_transposed, int bsx, int bsy)
+{
+    const int i_sums = MAX_CU_SIZE >> 2;
+    const int i_step = b_transposed ? i_sums : 1;   /* distance of horizontal neighbours */
+    const int i_line = b_transposed ? 1 : i_sums;   /* distance of vertical neighbours */
+    cmp_dist_t satd = 0;
+    int x, y;
+
+    for (y = 0; y < (bsy >> 2); y++) {
+        const int *p = sums + y * i_line;
+
+        if (bsx & 7) {
+            for (x = 0; x < (bsx >> 2); x++) {
+                satd += p[x * i_step] >> 1;
+            }
+        } else {
+            for (x = 0; x < (bsx >> 2); x += 2) {
+                satd += (p[x * i_step] + p[(x + 1) * i_step]) >> 1;
+            }
+        }
+    }
+
+    return satd;
+}
+
+/* ---------------------------------------------------------------------------
+ * X angles (3 ~ 11): the rows of the block are along the top reference line
+ */
+void intra_satd_x4_ang_x_sse128(pel_t *src, pel_t *fenc, int i_fenc, const int *modes, int num_modes,
+                                int bsx, int bsy, cmp_dist_t *costs)
+{
+    ALIGN16(int steps[4][MAX_CU_SIZE]);
+    ALIGN16(int offsets[4][MAX_CU_SIZE]);
+    ALIGN16(int sums[4][SATD_X4_NUM_BLOCKS]);
+    int k;
+
+    for (k = 0; k < num_modes; k++) {
+        satd_x4_get_steps(modes[k], bsy, steps[k], offsets[k]);
+    }
+
+    satd_x4_ang_rows(src, steps, offsets, num_modes, fenc, i_fenc, bsx, bsy, sums);
+
+    for (k = 0; k < num_modes; k++) {
+        costs[k] = satd_x4_sum_blocks(sums[k], 0, bsx, bsy);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Y angles (25 ~ 32): the columns of the block are along the left reference
+ * line, which is reversed once and shared by all modes together with the
+ * transposed original block
+ */
+void intra_satd_x4_ang_y_sse128(pel_t *src, pel_t *fenc, int i_fenc, const int *modes, int num_modes,
+                                int bsx, int bsy, cmp_dist_t *costs)
+{
+    ALIGN16(pel_t ref[MAX_CU_SIZE << 2]);
+    ALIGN16(pel_t org[MAX_CU_SIZE * MAX_CU_SIZE]);
+    ALIGN16(int steps[4][MAX_CU_SIZE]);
+    ALIGN16(int offsets[4][MAX_CU_SIZE]);
+    ALIGN16(int sums[4][SATD_X4_NUM_BLOCKS]);
+    const __m128i mask_rev = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    int num_ref = 2 * bsx + bsy + 16;   /* farthest sample used: iY + 3 < 2 * bsx + bsy */
+    int i, j, k;
+
+    /* ref[i] = src[-i] */
+    for (i = 0; i < num_ref; i += 16) {
+        __m128i T = _mm_loadu_si128((const __m128i *)(src - i - 15));
+        _mm_store_si128((__m128i *)(ref + i), _mm_shuffle_epi8(T, mask_rev));
+    }
+
+    /* org[x][y] = fenc[y][x] */
+    for (j = 0; j < bsy; j++) {
+        for (i = 0; i < bsx; i++) {
+            org[i * MAX_CU_SIZE + j] = fenc[j * i_fenc + i];
+        }
+    }
+
+    for (k = 0; k < num_modes; k++) {
+        satd_x4_get_steps(modes[k], bsx, steps[k], offsets[k]);
+    }
+
+    satd_x4_ang_rows(ref, steps, offsets, num_modes, org, MAX_CU_SIZE, bsy, bsx, sums);
+
+    for (k = 0; k < num_modes; k++) {
+        costs[k] = satd_x4_sum_blocks(sums[k], 1, bsx, bsy);
+    }
+}
+
+#undef SATD_X4_NUM_BLOCKS
 
@@ -4044,3 +4044,66 @@ int mad_64x64_sse128(pel_t *p_src, int i_src, int cu_size)
 
 
 
+
+/* ---------------------------------------------------------------------------
+ * sum of squared differences to the block mean (N * variance), see var_NxN_c()
+ */
+uint64_t var_8x8_sse128(pel_t *p_src, int i_src, int cu_size)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i S = zero;               /* sum of pixels */
+    __m128i Q = zero;               /* sum of squared pixels */
+    __m128i T0, T1;
+    uint32_t sum, sqr;
+    int i;
+
+    UNUSED_PARAMETER(cu_size);
+
+    for (i = 0; i < 8; i += 2) {
+        T0 = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i *)p_src), _mm_loadl_epi64((__m128i *)(p_src + i_src)));
+        S  = _mm_add_epi64(S, _mm_sad_epu8(T0, zero));
+        T1 = _mm_unpackhi_epi8(T0, zero);
+        T0 = _mm_unpacklo_epi8(T0, zero);
+        Q  = _mm_add_epi32(Q, _mm_madd_epi16(T0, T0));
+        Q  = _mm_add_epi32(Q, _mm_madd_epi16(T1, T1));
+        p_src += 2 * i_src;
+    }
+
+    Q   = _mm_add_epi32(Q, _mm_srli_si128(Q, 8));
+    Q   = _mm_add_epi32(Q, _mm_srli_si128(Q, 4));
+    sum = _mm_cvtsi128_si32(S) + _mm_cvtsi128_si32(_mm_srli_si128(S, 8));
+    sqr = _mm_cvtsi128_si32(Q);
+
+    return sqr - ((sum * sum) >> 6);
+}
+
+/* ---------------------------------------------------------------------------
+ */
+uint64_t var_16x16_sse128(pel_t *p_src, int i_src, int cu_size)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i S = zero;               /* sum of pixels */
+    __m128i Q = zero;               /* sum of squared pixels */
+    __m128i T0, T1;
+    uint32_t sum, sqr;
+    int i;
+
+    UNUSED_PARAMETER(cu_size);
+
+    for (i = 0; i < 16; i++) {
+        T0 = _mm_loadu_si128((__m128i *)p_src);
+        S  = _mm_add_epi64(S, _mm_sad_epu8(T0, zero));
+        T1 = _mm_unpackhi_epi8(T0, zero);
+        T0 = _mm_unpacklo_epi8(T0, zero);
+        Q  = _mm_add_epi32(Q, _mm_madd_epi16(T0, T0));
+        Q  = _mm_add_epi32(Q, _mm_madd_epi16(T1, T1));
+        p_src += i_src;
+    }
+
+    Q   = _mm_add_epi32(Q, _mm_srli_si128(Q, 8));
+    Q   = _mm_add_epi32(Q, _mm_srli_si128(Q, 4));
+    sum = _mm_cvtsi128_si32(S) + _mm_cvtsi128_si32(_mm_srli_si128(S, 8));
+    sqr = _mm_cvtsi128_si32(Q);
+
+    return sqr - (((uint64_t)sum * sum) >> 8);
+}
@@ -188,3 +188,56 @@ int add_sign_sse128(coeff_t *dst, const coeff_t *abs_val, const int i_coef)
 
     return i_coef - _mm_extract_epi16(mCount, 0);
 }
+
+/* ---------------------------------------------------------------------------
+ * RDOQ: candidate levels of the 16 coeffs in one CG, 4 coeffs per iteration
+ */
+int rdoq_cg_levels_sse128(coeff_t *coef, int8_t *num_level, int32_t err_level[3][16],
+                          const int q_scale, const int q_shift, const int iq_scale, const int iq_shift, const int thres_lower)
+{
+    const __m128i mZero     = _mm_setzero_si128();
+    const __m128i mOne      = _mm_set1_epi32(1);
+    const __m128i mTwo      = _mm_set1_epi32(2);
+    const __m128i mQScale   = _mm_set1_epi32(q_scale);
+    const __m128i mIQScale  = _mm_set1_epi32(iq_scale);
+    const __m128i mIQAdd    = _mm_set1_epi32(1 << (iq_shift - 1));
+    const __m128i mThres    = _mm_set1_epi32(thres_lower);
+    const __m128i mQShift   = _mm_cvtsi32_si128(q_shift);
+    const __m128i mIQShift  = _mm_cvtsi32_si128(iq_shift);
+    __m128i mLevel[4];
+    __m128i mNum[4];
+    __m128i mCoef, mRec, mErr, mHigher, mLevelZero;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        mCoef = _mm_cvtepi16_epi32(_mm_loadl_epi64((__m128i *)(coef + 4 * i)));
+
+        /* level = (coeff * q_scale) >> q_shift, and whether the residual is large */
+        mLevel[i]  = _mm_sra_epi32(_mm_mullo_epi32(mCoef, mQScale), mQShift);
+        mRec       = _mm_sra_epi32(_mm_add_epi32(_mm_mullo_epi32(mLevel[i], mIQScale), mIQAdd), mIQShift);
+        mHigher    = _mm_cmpgt_epi32(_mm_sub_epi32(mCoef, mRec), mThres);
+        mLevelZero = _mm_cmpeq_epi32(mLevel[i], mZero);
+
+        /* level 0: {0} or {0, 1}; otherwise: {0, L} or {0, L, L + 1} */
+        mLevel[i]  = _mm_blendv_epi8(mLevel[i], _mm_and_si128(mHigher, mOne), mLevelZero);
+        mNum[i]    = _mm_add_epi32(_mm_sub_epi32(mTwo, mHigher), mLevelZero);
+
+        /* squared errors of the candidates */
+        _mm_storeu_si128((__m128i *)(err_level[0] + 4 * i), _mm_mullo_epi32(mCoef, mCoef));
+        mRec = _mm_sra_epi32(_mm_add_epi32(_mm_mullo_epi32(mLevel[i], mIQScale), mIQAdd), mIQShift);
+        mErr = _mm_sub_epi32(mCoef, mRec);
+        _mm_storeu_si128((__m128i *)(err_level[1] + 4 * i), _mm_mullo_epi32(mErr, mErr));
+        mRec = _mm_add_epi32(_mm_mullo_epi32(_mm_add_epi32(mLevel[i], mOne), mIQScale), mIQAdd);
+        mRec = _mm_sra_epi32(mRec, mIQShift);
+        mErr = _mm_sub_epi32(mCoef, mRec);
+        _mm_storeu_si128((__m128i *)(err_level[2] + 4 * i), _mm_mullo_epi32(mErr, mErr));
+    }
+
+    _mm_storeu_si128((__m128i *)(coef + 0), _mm_packs_epi32(mLevel[0], mLevel[1]));
+    _mm_storeu_si128((__m128i *)(coef + 8), _mm_packs_epi32(mLevel[2], mLevel[3]));
+
+    mNum[0] = _mm_packs_epi16(_mm_packs_epi32(mNum[0], mNum[1]), _mm_packs_epi32(mNum[2], mNum[3]));
+    _mm_storeu_si128((__m128i *)num_level, mNum[0]);
+
+    return _mm_movemask_epi8(_mm_cmpgt_epi8(mNum[0], _mm_set1_epi8(1)));
+}
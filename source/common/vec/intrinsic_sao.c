@@ -696,3 +696,264 @@ void SAO_on_block_sse128(pel_t *p_dst, int i_dst, pel_t *p_src, int i_src, int i
 }
 
 
+
+/* ---------------------------------------------------------------------------
+ * accumulate statistics of edge offset in one row, pixels [start_x, end_x).
+ * the edge type of a pixel is decided by its two neighbors at (-i_nb) and (+i_nb),
+ * only classes 0, 1, 3 and 4 are accumulated for each type, class 2 is
+ * derived from the total difference in the end (acc_diff[2]).
+ */
+static ALWAYS_INLINE
+void sao_stat_eo_row_sse128(const pel_t *p_org, const pel_t *p_rec, intptr_t i_nb,
+                            int start_x, int end_x, __m128i *acc_diff, __m128i *acc_count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c2   = _mm_set1_epi8(2);
+    __m128i cnt0 = zero;
+    __m128i cnt1 = zero;
+    __m128i cnt3 = zero;
+    __m128i cnt4 = zero;
+    __m128i r_a, r_c, r_b, o_c;
+    __m128i t0, t1, t2, etype, mask;
+    int x;
+
+    for (x = start_x; x < end_x; x += 16) {
+        r_a = _mm_loadu_si128((const __m128i *)(p_rec + x - i_nb));
+        r_c = _mm_loadu_si128((const __m128i *)(p_rec + x));
+        r_b = _mm_loadu_si128((const __m128i *)(p_rec + x + i_nb));
+        o_c = _mm_loadu_si128((const __m128i *)(p_org + x));
+
+        /* edgetype = sign(c - a) + sign(c - b) + 2 */
+        t0 = _mm_min_epu8(r_a, r_c);
+        t1 = _mm_sub_epi8(_mm_cmpeq_epi8(t0, r_c), _mm_cmpeq_epi8(t0, r_a));
+        t0 = _mm_min_epu8(r_b, r_c);
+        t2 = _mm_sub_epi8(_mm_cmpeq_epi8(t0, r_c), _mm_cmpeq_epi8(t0, r_b));
+        etype = _mm_add_epi8(_mm_add_epi8(t1, t2), c2);
+
+        if (end_x - x < 16) {
+            /* invalid pixels: out of all classes and zero differences */
+            mask  = _mm_load_si128((const __m128i *)intrinsic_mask[end_x - x - 1]);
+            etype = _mm_or_si128(etype, _mm_andnot_si128(mask, _mm_cmpeq_epi8(zero, zero)));
+            o_c   = _mm_and_si128(o_c, mask);
+            r_c   = _mm_and_si128(r_c, mask);
+        }
+
+        /* total difference */
+        acc_diff[2] = _mm_add_epi64(acc_diff[2], _mm_sad_epu8(o_c, zero));
+        acc_diff[2] = _mm_sub_epi64(acc_diff[2], _mm_sad_epu8(r_c, zero));
+
+#define SAO_STAT_EO_CLASS(k, cnt) \
+        mask = _mm_cmpeq_epi8(etype, _mm_set1_epi8(k));\
+        cnt  = _mm_sub_epi8(cnt, mask);\
+        acc_diff[k] = _mm_add_epi64(acc_diff[k], _mm_sad_epu8(_mm_and_si128(o_c, mask), zero));\
+        acc_diff[k] = _mm_sub_epi64(acc_diff[k], _mm_sad_epu8(_mm_and_si128(r_c, mask), zero))
+
+        SAO_STAT_EO_CLASS(0, cnt0);
+        SAO_STAT_EO_CLASS(1, cnt1);
+        SAO_STAT_EO_CLASS(3, cnt3);
+        SAO_STAT_EO_CLASS(4, cnt4);
+#undef SAO_STAT_EO_CLASS
+    }
+
+    /* the byte counters cannot overflow in one row (at most 16 pixels per 16 bytes) */
+    acc_count[0] = _mm_add_epi64(acc_count[0], _mm_sad_epu8(cnt0, zero));
+    acc_count[1] = _mm_add_epi64(acc_count[1], _mm_sad_epu8(cnt1, zero));
+    acc_count[3] = _mm_add_epi64(acc_count[3], _mm_sad_epu8(cnt3, zero));
+    acc_count[4] = _mm_add_epi64(acc_count[4], _mm_sad_epu8(cnt4, zero));
+}
+
+/* ---------------------------------------------------------------------------
+ * write the accumulated edge offset statistics
+ */
+static ALWAYS_INLINE
+void sao_stat_eo_store_sse128(__m128i *acc_diff, __m128i *acc_count, int num_pixels, SAOStatData *p_stats)
+{
+    ALIGN16(int64_t buf[2]);
+    long diff_others  = 0;
+    long count_others = 0;
+    int k;
+
+    for (k = 0; k < 5; k++) {
+        if (k == 2) {
+            continue;
+        }
+        _mm_store_si128((__m128i *)buf, acc_diff[k]);
+        p_stats->diff[k]  = (long)(buf[0] + buf[1]);
+        _mm_store_si128((__m128i *)buf, acc_count[k]);
+        p_stats->count[k] = (long)(buf[0] + buf[1]);
+        diff_others  += p_stats->diff[k];
+        count_others += p_stats->count[k];
+    }
+
+    _mm_store_si128((__m128i *)buf, acc_diff[2]);
+    p_stats->diff[2]  = (long)(buf[0] + buf[1]) - diff_others;
+    p_stats->count[2] = num_pixels - count_others;
+}
+
+/* ---------------------------------------------------------------------------
+ */
+void SAO_stat_EO_0_sse128(const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                          int i_block_w, int i_block_h, int *lcu_avail, SAOStatData *p_stats)
+{
+    __m128i acc_diff [5];
+    __m128i acc_count[5];
+    int start_x = lcu_avail[SAO_L] ? 0 : 1;
+    int end_x   = lcu_avail[SAO_R] ? i_block_w : (i_block_w - 1);
+    int y;
+
+    memset(p_stats, 0, sizeof(SAOStatData));
+    memset(acc_diff,  0, sizeof(acc_diff));
+    memset(acc_count, 0, sizeof(acc_count));
+
+    for (y = 0; y < i_block_h; y++) {
+        sao_stat_eo_row_sse128(p_org, p_rec, 1, start_x, end_x, acc_diff, acc_count);
+        p_rec += i_rec;
+        p_org += i_org;
+    }
+
+    sao_stat_eo_store_sse128(acc_diff, acc_count, XAVS2_MAX(end_x - start_x, 0) * i_block_h, p_stats);
+}
+
+/* ---------------------------------------------------------------------------
+ */
+void SAO_stat_EO_90_sse128(const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                           int i_block_w, int i_block_h, int *lcu_avail, SAOStatData *p_stats)
+{
+    __m128i acc_diff [5];
+    __m128i acc_count[5];
+    int start_y = lcu_avail[SAO_T] ? 0 : 1;
+    int end_y   = lcu_avail[SAO_D] ? i_block_h : (i_block_h - 1);
+    int y;
+
+    memset(p_stats, 0, sizeof(SAOStatData));
+    memset(acc_diff,  0, sizeof(acc_diff));
+    memset(acc_count, 0, sizeof(acc_count));
+
+    p_rec += start_y * i_rec;
+    p_org += start_y * i_org;
+    for (y = start_y; y < end_y; y++) {
+        sao_stat_eo_row_sse128(p_org, p_rec, i_rec, 0, i_block_w, acc_diff, acc_count);
+        p_rec += i_rec;
+        p_org += i_org;
+    }
+
+    sao_stat_eo_store_sse128(acc_diff, acc_count, i_block_w * XAVS2_MAX(end_y - start_y, 0), p_stats);
+}
+
+/* ---------------------------------------------------------------------------
+ * diagonal edge offsets, the first and the last row have their own ranges
+ */
+static ALWAYS_INLINE
+void sao_stat_eo_diag_sse128(const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec, intptr_t i_nb,
+                             int i_block_h, int range[3][2], SAOStatData *p_stats)
+{
+    __m128i acc_diff [5];
+    __m128i acc_count[5];
+    int y_last = XAVS2_MAX(i_block_h - 1, 1);
+    int num_pixels;
+    int y;
+
+    memset(p_stats, 0, sizeof(SAOStatData));
+    memset(acc_diff,  0, sizeof(acc_diff));
+    memset(acc_count, 0, sizeof(acc_count));
+
+    /* first row */
+    sao_stat_eo_row_sse128(p_org, p_rec, i_nb, range[0][0], range[0][1], acc_diff, acc_count);
+    num_pixels = XAVS2_MAX(range[0][1] - range[0][0], 0);
+
+    /* middle rows */
+    for (y = 1; y < i_block_h - 1; y++) {
+        sao_stat_eo_row_sse128(p_org + y * i_org, p_rec + y * i_rec, i_nb, range[1][0], range[1][1], acc_diff, acc_count);
+    }
+    num_pixels += XAVS2_MAX(range[1][1] - range[1][0], 0) * XAVS2_MAX(i_block_h - 2, 0);
+
+    /* last row */
+    sao_stat_eo_row_sse128(p_org + y_last * i_org, p_rec + y_last * i_rec, i_nb, range[2][0], range[2][1], acc_diff, acc_count);
+    num_pixels += XAVS2_MAX(range[2][1] - range[2][0], 0);
+
+    sao_stat_eo_store_sse128(acc_diff, acc_count, num_pixels, p_stats);
+}
+
+/* ---------------------------------------------------------------------------
+ */
+void SAO_stat_EO_135_sse128(const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                            int i_block_w, int i_block_h, int *lcu_avail, SAOStatData *p_stats)
+{
+    int range[3][2];
+
+    range[0][0] = lcu_avail[SAO_TL] ? 0 : 1;
+    range[0][1] = lcu_avail[SAO_T] ? (lcu_avail[SAO_R] ? i_block_w : (i_block_w - 1)) : 1;
+    range[1][0] = lcu_avail[SAO_L] ? 0 : 1;
+    range[1][1] = lcu_avail[SAO_R] ? i_block_w : (i_block_w - 1);
+    range[2][0] = lcu_avail[SAO_D] ? (lcu_avail[SAO_L] ? 0 : 1) : (i_block_w - 1);
+    range[2][1] = lcu_avail[SAO_DR] ? i_block_w : (i_block_w - 1);
+
+    sao_stat_eo_diag_sse128(p_org, i_org, p_rec, i_rec, i_rec + 1, i_block_h, range, p_stats);
+}
+
+/* ---------------------------------------------------------------------------
+ */
+void SAO_stat_EO_45_sse128(const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                           int i_block_w, int i_block_h, int *lcu_avail, SAOStatData *p_stats)
+{
+    int range[3][2];
+
+    range[0][0] = lcu_avail[SAO_T] ? (lcu_avail[SAO_L] ? 0 : 1) : (i_block_w - 1);
+    range[0][1] = lcu_avail[SAO_TR] ? i_block_w : (i_block_w - 1);
+    range[1][0] = lcu_avail[SAO_L] ? 0 : 1;
+    range[1][1] = lcu_avail[SAO_R] ? i_block_w : (i_block_w - 1);
+    range[2][0] = lcu_avail[SAO_DL] ? 0 : 1;
+    range[2][1] = lcu_avail[SAO_D] ? (lcu_avail[SAO_R] ? i_block_w : (i_block_w - 1)) : 1;
+
+    sao_stat_eo_diag_sse128(p_org, i_org, p_rec, i_rec, i_rec - 1, i_block_h, range, p_stats);
+}
+
+/* ---------------------------------------------------------------------------
+ * band offset: band indexes and differences are calculated with SIMD,
+ * and then accumulated into the histogram
+ */
+void SAO_stat_BO_sse128(const pel_t *p_org, int i_org, const pel_t *p_rec, int i_rec,
+                        int i_block_w, int i_block_h, int *lcu_avail, SAOStatData *p_stats)
+{
+    ALIGN16(uint8_t band_buf[16]);
+    ALIGN16(int16_t diff_buf[16]);
+    int diff [MAX_NUM_SAO_CLASSES];
+    int count[MAX_NUM_SAO_CLASSES];
+    const int band_shift = g_bit_depth - NUM_SAO_BO_CLASSES_IN_BIT;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i band_mask = _mm_set1_epi8((int8_t)(0xFF >> band_shift));
+    const __m128i shift = _mm_cvtsi32_si128(band_shift);
+    __m128i r, o, t;
+    int x, y, i, num;
+
+    UNUSED_PARAMETER(lcu_avail);
+    memset(diff,  0, sizeof(diff));
+    memset(count, 0, sizeof(count));
+
+    for (y = 0; y < i_block_h; y++) {
+        for (x = 0; x < i_block_w; x += 16) {
+            r = _mm_loadu_si128((const __m128i *)(p_rec + x));
+            o = _mm_loadu_si128((const __m128i *)(p_org + x));
+
+            t = _mm_and_si128(_mm_srl_epi16(r, shift), band_mask);
+            _mm_store_si128((__m128i *)band_buf, t);
+            t = _mm_sub_epi16(_mm_unpacklo_epi8(o, zero), _mm_unpacklo_epi8(r, zero));
+            _mm_store_si128((__m128i *)(diff_buf + 0), t);
+            t = _mm_sub_epi16(_mm_unpackhi_epi8(o, zero), _mm_unpackhi_epi8(r, zero));
+            _mm_store_si128((__m128i *)(diff_buf + 8), t);
+
+            num = XAVS2_MIN(16, i_block_w - x);
+            for (i = 0; i < num; i++) {
+                diff [band_buf[i]] += diff_buf[i];
+                count[band_buf[i]]++;
+            }
+        }
+        p_rec += i_rec;
+        p_org += i_org;
+    }
+
+    for (i = 0; i < MAX_NUM_SAO_CLASSES; i++) {
+        p_stats->diff [i] = diff [i];
+        p_stats->count[i] = count[i];
+    }
+}
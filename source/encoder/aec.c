@@ -1979,8 +1979,8 @@ int write_cu_cbp_dqp(xavs2_t *h, aec_t *p_aec, cu_info_t *p_cu_info, int slice_i
         *last_dqp = 0;
     }
 
-    if (p_cu_info->i_cbp != 0 && h->param->i_rc_method == XAVS2_RC_CBR_SCU) {
-        rate += aec_write_dqp(p_aec, cu_get_qp(h, p_cu_info), *last_dqp);
+    if (p_cu_info->i_cbp != 0 && !h->param->fixed_picture_qp) {
+        rate += aec_write_dqp(p_aec, p_cu_info->i_delta_qp, *last_dqp);
 
 #if ENABLE_RATE_CONTROL_CU
         *last_dqp = p_cu_info->i_delta_qp;
@@ -2211,6 +2211,10 @@ binary_t gf_aec_default = {
     // .est_cu_refs_mvds        = write_cu_refs_mvds,         // not available
     // .est_luma_block_coeff    = write_luma_block_coeff,     // not available
     // .est_chroma_block_coeff  = write_chroma_block_coeff,   // not available
+    // .est_intra_luma_rate     = NULL,                       // not available
+    // .est_chroma_coeff_rate   = NULL,                       // not available
+    // .est_cu_rate_intra       = NULL,                       // not available
+    // .est_cu_rate_inter       = NULL,                       // not available
 
 #if ENABLE_RATE_CONTROL_CU
     .write_cu_cbp_dqp          = write_cu_cbp_dqp,
@@ -48,6 +48,7 @@ extern binary_t gf_aec_default;
 extern binary_t gf_aec_rdo;
 extern binary_t gf_aec_fastrdo;
 extern binary_t gf_aec_vrdo;
+extern binary_t gf_aec_tabrdo;
 
 #define tab_intra_mode_scan_type FPFX(tab_intra_mode_scan_type)
 extern const int tab_intra_mode_scan_type[NUM_INTRA_MODE];
@@ -57,6 +58,9 @@ extern context_t g_tab_ctx_mps[4096 * 5];    /* [2 * lg_pmps + mps + cycno * 409
 extern context_t g_tab_ctx_lps[4096 * 5];    /* [2 * lg_pmps + mps + cycno * 4096] */
 #endif
 
+#define g_tab_aec_frac_bits FPFX(g_tab_aec_frac_bits)
+extern uint32_t g_tab_aec_frac_bits[2048][2];   /* [lg_pmps][is_lps], bits of one bin in 1/(1 << AEC_FRAC_BITS) */
+
 /* ---------------------------------------------------------------------------
  * number of maximum flush bits in p_aec->reg_flush_bits
  */
@@ -109,6 +113,18 @@ static const int tab_coeff_offset[9][3] = {
 #define B_BITS              10
 #define QUARTER             (1 << (B_BITS-2))
 #define LG_PMPS_SHIFTNO     2
+#define AEC_FRAC_BITS       15        /* precision of the table-driven bit estimation */
+
+/* ---------------------------------------------------------------------------
+ * context snapshot: contexts are tracked in blocks of 64 bytes
+ */
+#define AEC_CTX_BLOCK_SHIFT 6
+#define AEC_CTX_BLOCK_SIZE  (1 << AEC_CTX_BLOCK_SHIFT)
+#define AEC_CTX_NUM_BLOCKS  ((sizeof(ctx_set_t) + AEC_CTX_BLOCK_SIZE - 1) >> AEC_CTX_BLOCK_SHIFT)
+#define AEC_CTX_ALL_BLOCKS  (0xFFFFFFFFu >> (32 - AEC_CTX_NUM_BLOCKS))
+
+/* the dirty mask (uint32_t) has one bit for each block of contexts */
+typedef char aec_ctx_blocks_fit_dirty_mask_t[AEC_CTX_NUM_BLOCKS <= 32 ? 1 : -1];
 
 /*
  * ===========================================================================
@@ -143,11 +159,68 @@ void aec_copy_aec_state_rdo(aec_t *dst, aec_t *src)
 static ALWAYS_INLINE
 void aec_copy_coding_state_sao(aec_t *p_dst, aec_t *p_src)
 {
-    int num_bytes_aec = (int)((uint8_t *)&p_dst->ctx_set - (uint8_t *)p_dst);
-    int num_bytes_context = (int)(sizeof(ctx_set_t) - ((uint8_t *)&p_dst->ctx_set.sao_merge_type_index[0] - (uint8_t *)&p_dst->ctx_set));
+    int num_bytes_aec     = (int)((uint8_t *)&p_dst->ctx_set - (uint8_t *)p_dst);
+    int offset_context    = (int)((uint8_t *)&p_dst->ctx_set.sao_merge_type_index[0] - (uint8_t *)&p_dst->ctx_set);
+    int num_bytes_context = (int)sizeof(ctx_set_t) - offset_context;
+    /* snapshot key of p_dst, before it is overwritten by the state of p_src */
+    uintptr_t base_id     = p_dst->ctx_base_id;
+    uint32_t  base_ver    = p_dst->ctx_base_ver;
+    uint32_t  dirty       = p_dst->ctx_dirty;
+
     memcpy(p_dst, p_src, num_bytes_aec);
-    p_dst->p_ctx_set = &p_dst->ctx_set;
+    p_dst->p_ctx_set    = &p_dst->ctx_set;
     memcpy(&p_dst->ctx_set.sao_merge_type_index[0], &p_src->ctx_set.sao_merge_type_index[0], num_bytes_context);
+    /* the other contexts are kept, so the snapshot of p_dst stays valid */
+    p_dst->ctx_base_id  = base_id;
+    p_dst->ctx_base_ver = base_ver;
+    p_dst->ctx_dirty    = dirty | (AEC_CTX_ALL_BLOCKS & ~((1u << (offset_context >> AEC_CTX_BLOCK_SHIFT)) - 1));
+}
+
+/* ---------------------------------------------------------------------------
+ * mark the block of a context model as modified
+ */
+static ALWAYS_INLINE
+void aec_mark_ctx_dirty(aec_t *p_aec, context_t *p_ctx)
+{
+    p_aec->ctx_dirty |= 1u << (uint32_t)(((uint8_t *)p_ctx - (uint8_t *)p_aec->p_ctx_set) >> AEC_CTX_BLOCK_SHIFT);
+}
+
+/* ---------------------------------------------------------------------------
+ * take the current contexts of p_aec as the base snapshot, all copies of
+ * p_aec made after this call only differ from it in the dirty blocks
+ */
+static ALWAYS_INLINE
+void aec_set_ctx_base(aec_t *p_aec, uint32_t version)
+{
+    p_aec->ctx_base_id  = (uintptr_t)p_aec;
+    p_aec->ctx_base_ver = version;
+    p_aec->ctx_dirty    = 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * copy coding state, only the context blocks modified by either side are
+ * copied when both states are derived from the same base snapshot
+ */
+static ALWAYS_INLINE
+void aec_copy_aec_state_tracked(aec_t *dst, aec_t *src)
+{
+    if (src->ctx_base_id != 0 && src->ctx_base_id == dst->ctx_base_id &&
+        src->ctx_base_ver == dst->ctx_base_ver) {
+        uint32_t mask = src->ctx_dirty | dst->ctx_dirty;
+        uint8_t *p_dst = (uint8_t *)&dst->ctx_set;
+        uint8_t *p_src = (uint8_t *)&src->ctx_set;
+
+        memcpy(dst, src, sizeof(aec_t) - sizeof(ctx_set_t));
+        dst->p_ctx_set = &dst->ctx_set;
+        while (mask) {
+            int offset = xavs2_ctz(mask) << AEC_CTX_BLOCK_SHIFT;
+            int size   = XAVS2_MIN(AEC_CTX_BLOCK_SIZE, (int)sizeof(ctx_set_t) - offset);
+            memcpy(p_dst + offset, p_src + offset, size);
+            mask &= mask - 1;
+        }
+    } else {
+        aec_copy_aec_state(dst, src);
+    }
 }
 
 
@@ -284,6 +357,10 @@ int tu_get_cg_run_level_info(runlevel_t *runlevel,
 void init_aec_context_tab(void);
 #endif
 
+/* init the bit cost table of the table-driven RDO */
+#define init_aec_frac_bits_tab FPFX(init_aec_frac_bits_tab)
+void init_aec_frac_bits_tab(void);
+
 /* ---------------------------------------------------------------------------
  * coding state initialization (no need to destroy, just free the space is OK)
  */
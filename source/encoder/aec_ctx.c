@@ -198,6 +198,9 @@ static ALWAYS_INLINE void aec_set_function_handles(xavs2_t *h, binary_t *fh, int
         case 2:
             memcpy(fh, &gf_aec_vrdo, sizeof(binary_t));
             break;
+        case 3:
+            memcpy(fh, &gf_aec_tabrdo, sizeof(binary_t));
+            break;
         default:
             memcpy(fh, &gf_aec_rdo, sizeof(binary_t));
             break;
@@ -224,7 +227,7 @@ void init_contexts(aec_t *p_aec)
 #if CTRL_OPT_AEC
 /* ---------------------------------------------------------------------------
  */
-void init_aec_context_tab(void)
+static void build_aec_context_tab(void)
 {
     context_t ctx_i;
     context_t ctx_o;
@@ -274,8 +277,65 @@ void init_aec_context_tab(void)
         }
     }
 }
+
+/* ---------------------------------------------------------------------------
+ * the context tables are shared by all encoders and only built once
+ */
+void init_aec_context_tab(void)
+{
+    static int b_tab_ready = 0;
+
+    if (!xavs2_atomic_load_acquire(&b_tab_ready)) {
+        xavs2_init_lock();
+        if (!b_tab_ready) {
+            build_aec_context_tab();
+            xavs2_atomic_store_release(&b_tab_ready, 1);
+        }
+        xavs2_init_unlock();
+    }
+}
 #endif
 
+/* ---------------------------------------------------------------------------
+ * LG_PMPS is -log2(p_mps) in units of 1/(256 << LG_PMPS_SHIFTNO) bit, thus the
+ * MPS costs LG_PMPS and the LPS costs -log2(1 - p_mps)
+ */
+uint32_t g_tab_aec_frac_bits[2048][2];
+
+/* ---------------------------------------------------------------------------
+ */
+static void build_aec_frac_bits_tab(void)
+{
+    const double f_scale = (double)(1 << AEC_FRAC_BITS);
+    int lg_pmps;
+
+    for (lg_pmps = 0; lg_pmps < 2048; lg_pmps++) {
+        /* a zero LG_PMPS never appears, clip it to keep the LPS cost finite */
+        double bits_mps = XAVS2_MAX(lg_pmps, 1) / (double)(256 << LG_PMPS_SHIFTNO);
+        double bits_lps = -log(1.0 - pow(2.0, -bits_mps)) / log(2.0);
+
+        g_tab_aec_frac_bits[lg_pmps][0] = (uint32_t)lg_pmps << (AEC_FRAC_BITS - 8 - LG_PMPS_SHIFTNO);
+        g_tab_aec_frac_bits[lg_pmps][1] = (uint32_t)(bits_lps * f_scale + 0.5);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * the bit cost table is shared by all encoders and only built once
+ */
+void init_aec_frac_bits_tab(void)
+{
+    static int b_tab_ready = 0;
+
+    if (!xavs2_atomic_load_acquire(&b_tab_ready)) {
+        xavs2_init_lock();
+        if (!b_tab_ready) {
+            build_aec_frac_bits_tab();
+            xavs2_atomic_store_release(&b_tab_ready, 1);
+        }
+        xavs2_init_unlock();
+    }
+}
+
 /* ---------------------------------------------------------------------------
  * initializes the aec_t for the arithmetic coder
  */
@@ -287,6 +347,7 @@ void aec_start(xavs2_t *h, aec_t *p_aec, uint8_t *p_bs_start, uint8_t *p_bs_end,
     p_aec->i_low            = 0;
     p_aec->i_t1             = 0xFF;
     p_aec->i_bits_to_follow = 0;
+    p_aec->i_frac_bits      = 0;
     p_aec->b_writting       = 0;
 
     p_aec->num_left_flush_bits = NUM_FLUSH_BITS + 1;      // to swallow first redundant bit
@@ -300,6 +361,7 @@ void aec_start(xavs2_t *h, aec_t *p_aec, uint8_t *p_bs_start, uint8_t *p_bs_end,
 
     /* init contexts */
     init_contexts(p_aec);
+    p_aec->ctx_base_id = 0;
 }
 
 /* ---------------------------------------------------------------------------
@@ -0,0 +1,172 @@
+/*
+ * aec_est_cu.h
+ *
+ * Description of this file:
+ *    CU-level rate estimation of the bit estimation engines of the xavs2 library
+ *
+ *    the rate of a whole RDO candidate (cu header, motion information, cbp and
+ *    coefficients) is gathered here, so that RDO calls the engine once per
+ *    candidate mode instead of once per syntax element. the engine source file
+ *    includes this file after its syntax coding, which provides:
+ *      aec_write_intra_pred_mode_est() : intra luma prediction mode
+ *      write_cu_header_est()           : cu header
+ *      write_cu_refs_mvds_est()        : reference indexes and mvds
+ *      write_cu_cbp_dqp_est()          : cbp and delta qp (ENABLE_RATE_CONTROL_CU)
+ *      aec_write_cu_cbp_est()          : cbp
+ *      write_luma_block_coeff_est()    : coefficients of a luma block
+ *      write_chroma_block_coeff_est()  : coefficients of a chroma block
+ *
+ * --------------------------------------------------------------------------
+ *
+ *    xavs2 - video encoder of AVS2/IEEE1857.4 video coding standard
+ *    Copyright (C) 2018~ VCL, NELVT, Peking University
+ *
+ *    Authors: Falei LUO <falei.luo@gmail.com>
+ *             etc.
+ *
+ *    Homepage1: http://vcl.idm.pku.edu.cn/xavs2
+ *    Homepage2: https://github.com/pkuvcl/xavs2
+ *    Homepage3: https://gitee.com/pkuvcl/xavs2
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ *    This program is also available under a commercial proprietary license.
+ *    For more information, contact us at sswang @ pku.edu.cn.
+ */
+
+/**
+ * ===========================================================================
+ * cu rate estimation
+ * ===========================================================================
+ */
+
+/* ---------------------------------------------------------------------------
+ * rate of an intra luma prediction mode and of its coefficients,
+ * quant_coeff is NULL when the block has no non-zero coefficient
+ */
+static
+int write_intra_luma_rate_est(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, int ipmode, coeff_t *quant_coeff, runlevel_t *runlevel,
+                              int i_level, int i_stride_shift, int intra_mode, int max_bits, int *rate_coeff)
+{
+    int rate = aec_write_intra_pred_mode_est(p_aec, ipmode);
+
+    *rate_coeff = 0;
+    if (quant_coeff != NULL) {
+        *rate_coeff = write_luma_block_coeff_est(h, p_aec, p_cu, quant_coeff, runlevel,
+                                                 i_level, i_stride_shift, 1, intra_mode, max_bits - rate);
+        rate += *rate_coeff;
+    }
+
+    return rate;
+}
+
+/* ---------------------------------------------------------------------------
+ * add the rate of the chroma coefficients flagged in cbp to rate
+ */
+static
+int write_chroma_coeff_rate_est(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, runlevel_t *runlevel,
+                                int cbp, int i_level, int rate, int max_bits)
+{
+    if (cbp & (1 << 4)) {
+        rate += write_chroma_block_coeff_est(h, p_aec, p_cu, p_cu->cu_info.p_coeff[1], runlevel, i_level, max_bits - rate);
+    }
+    if (cbp & (1 << 5)) {
+        rate += write_chroma_block_coeff_est(h, p_aec, p_cu, p_cu->cu_info.p_coeff[2], runlevel, i_level, max_bits - rate);
+    }
+
+    return rate;
+}
+
+/* ---------------------------------------------------------------------------
+ * rate of an intra cu except for its luma modes and coefficients
+ * (cu header, cbp and chroma coefficients)
+ */
+static
+int write_cu_rate_intra_est(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, runlevel_t *runlevel, int max_bits)
+{
+    int rate = write_cu_header_est(h, p_aec, p_cu);
+
+#if ENABLE_RATE_CONTROL_CU
+    rate += write_cu_cbp_dqp_est(h, p_aec, &p_cu->cu_info, h->i_slice_index, h->last_dquant);
+#else
+    rate += aec_write_cu_cbp_est(p_aec, &p_cu->cu_info, h->i_slice_index, h);
+#endif
+
+    return write_chroma_coeff_rate_est(h, p_aec, p_cu, runlevel, p_cu->cu_info.i_cbp,
+                                       p_cu->cu_info.i_level - 1, rate, max_bits);
+}
+
+/* ---------------------------------------------------------------------------
+ * rate of an inter cu, rate_chroma is used instead of the chroma coefficients
+ * when they have been estimated in advance (OPT_ADVANCE_CHROMA_AEC)
+ */
+static
+int write_cu_rate_inter_est(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, runlevel_t *runlevel, int rate_chroma, int max_bits)
+{
+    cu_info_t *p_cu_info = &p_cu->cu_info;
+    int level = p_cu_info->i_level;
+    int rate;
+    int block_idx;
+
+    /* rate of cu header */
+    rate = write_cu_header_est(h, p_aec, p_cu);
+
+    /* rate of motion information */
+    rate += write_cu_refs_mvds_est(h, p_aec, p_cu);
+
+    /* tu information */
+    if (p_cu_info->i_mode != PRED_SKIP || p_cu_info->i_cbp) {
+        /* rate of cbp & dqp */
+#if ENABLE_RATE_CONTROL_CU
+        rate += write_cu_cbp_dqp_est(h, p_aec, p_cu_info, h->i_slice_index, h->last_dquant);
+#else
+        rate += aec_write_cu_cbp_est(p_aec, p_cu_info, h->i_slice_index, h);
+#endif
+
+        /* rate of luma coefficients */
+        if (p_cu_info->i_tu_split != TU_SPLIT_NON) {
+            int use_wavelet = (level == B64X64_IN_BIT && p_cu_info->i_tu_split != TU_SPLIT_CROSS);
+            int i_tu_level = level - 1 - use_wavelet;
+            for (block_idx = 0; block_idx < 4; block_idx++) {
+                if (p_cu_info->i_cbp & (1 << block_idx)) {
+                    cb_t tb;
+
+                    cu_init_transform_block(level, p_cu_info->i_tu_split, block_idx, &tb);
+
+                    rate += write_luma_block_coeff_est(h, p_aec, p_cu,
+                            p_cu_info->p_coeff[0] + (block_idx << ((level - 1) << 1)),
+                            runlevel, i_tu_level, xavs2_log2u(tb.w) - use_wavelet, 0, 0, max_bits - rate);
+                }
+            }
+        } else {
+            if (p_cu_info->i_cbp & 15) {
+                int i_tu_level = level - (level == B64X64_IN_BIT);
+                rate += write_luma_block_coeff_est(h, p_aec, p_cu, p_cu_info->p_coeff[0],
+                        runlevel, i_tu_level, i_tu_level, 0, 0, max_bits - rate);
+            }
+        }
+
+        /* rate of chroma coefficients */
+        if (IS_ALG_ENABLE(OPT_ADVANCE_CHROMA_AEC)) {
+            if (p_cu_info->i_cbp != 0) {  // not skip mode
+                rate += rate_chroma;
+            }
+        } else {
+            rate = write_chroma_coeff_rate_est(h, p_aec, p_cu, runlevel, p_cu_info->i_cbp, level - 1, rate, max_bits);
+        }
+    }
+
+    return rate;
+}
@@ -0,0 +1,135 @@
+/*
+ * aec_tabrdo.c
+ *
+ * Description of this file:
+ *    AEC functions definition of the table-driven RDO module of the xavs2 library
+ *
+ * --------------------------------------------------------------------------
+ *
+ *    xavs2 - video encoder of AVS2/IEEE1857.4 video coding standard
+ *    Copyright (C) 2018~ VCL, NELVT, Peking University
+ *
+ *    Authors: Falei LUO <falei.luo@gmail.com>
+ *             etc.
+ *
+ *    Homepage1: http://vcl.idm.pku.edu.cn/xavs2
+ *    Homepage2: https://github.com/pkuvcl/xavs2
+ *    Homepage3: https://gitee.com/pkuvcl/xavs2
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ *    This program is also available under a commercial proprietary license.
+ *    For more information, contact us at sswang @ pku.edu.cn.
+ */
+
+#include "common.h"
+#include "aec.h"
+#include "bitstream.h"
+#include "block_info.h"
+#include "cudata.h"
+
+/**
+ * ===========================================================================
+ * binary
+ *
+ * the cost of each bin is read from g_tab_aec_frac_bits[] in units of
+ * 1/(1 << AEC_FRAC_BITS) bit, and the contexts are left untouched: they are
+ * only updated when the chosen mode is written by the real AEC engine
+ * ===========================================================================
+ */
+
+/* ---------------------------------------------------------------------------
+ * accumulate fractional bits, the integer part goes to i_bits_to_follow
+ */
+static ALWAYS_INLINE
+void aec_add_frac_bits(aec_t *p_aec, uint32_t frac_bits)
+{
+    frac_bits += p_aec->i_frac_bits;
+
+    p_aec->i_bits_to_follow += frac_bits >> AEC_FRAC_BITS;
+    p_aec->i_frac_bits       = frac_bits & ((1 << AEC_FRAC_BITS) - 1);
+}
+
+/* ---------------------------------------------------------------------------
+ */
+static INLINE
+void biari_encode_symbol_tabrdo(aec_t *p_aec, uint8_t symbol, context_t *p_ctx)
+{
+    aec_add_frac_bits(p_aec, g_tab_aec_frac_bits[p_ctx->LG_PMPS][symbol != p_ctx->MPS]);
+}
+
+
+/* ---------------------------------------------------------------------------
+ */
+static INLINE
+void biari_encode_tu_tabrdo(aec_t *p_aec, int num_zeros, int max_len, context_t *p_ctx)
+{
+    const uint32_t *p_bits = g_tab_aec_frac_bits[p_ctx->LG_PMPS];
+    const int mps = p_ctx->MPS;
+    uint32_t frac_bits = num_zeros * p_bits[mps != 0];
+
+    if (max_len != num_zeros) {
+        frac_bits += p_bits[mps != 1];
+    }
+
+    aec_add_frac_bits(p_aec, frac_bits);
+}
+
+
+/* ---------------------------------------------------------------------------
+ */
+static INLINE
+void biari_encode_symbol_eq_prob_tabrdo(aec_t *p_aec, uint8_t symbol)
+{
+    UNUSED_PARAMETER(symbol);
+
+    p_aec->i_bits_to_follow++;
+}
+
+/* ---------------------------------------------------------------------------
+ */
+static INLINE
+void biari_encode_symbols_eq_prob_tabrdo(aec_t *p_aec, uint32_t val, int len)
+{
+    UNUSED_PARAMETER(val);
+
+    p_aec->i_bits_to_follow += len;
+}
+
+/* ---------------------------------------------------------------------------
+ * the MPS of the final bin costs one step (1/256 bit) of the engine,
+ * the LPS terminates the engine with 8 bits
+ */
+static INLINE
+void biari_encode_symbol_final_tabrdo(aec_t *p_aec, uint8_t symbol)
+{
+    if (symbol) {
+        p_aec->i_bits_to_follow += 8;
+    } else {
+        aec_add_frac_bits(p_aec, 1 << (AEC_FRAC_BITS - 8));
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * engine hooks for the syntax coding in aec_est.h
+ */
+#define biari_encode_symbol_est             biari_encode_symbol_tabrdo
+#define biari_encode_tu_est                 biari_encode_tu_tabrdo
+#define biari_encode_symbol_eq_prob_est     biari_encode_symbol_eq_prob_tabrdo
+#define biari_encode_symbols_eq_prob_est    biari_encode_symbols_eq_prob_tabrdo
+#define biari_encode_symbol_final_est       biari_encode_symbol_final_tabrdo
+#define AEC_EST_HANDLES                     gf_aec_tabrdo
+
+#include "aec_est.h"
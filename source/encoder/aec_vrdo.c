@@ -643,28 +643,13 @@ int aec_write_cu_cbp_vrdo(aec_t *p_aec, cu_info_t *p_cu_info, int slice_index_cu
 static INLINE
 int aec_write_dqp_vrdo(aec_t *p_aec, int delta_qp, int last_dqp)
 {
-    context_t *p_ctx = p_aec->p_ctx_set->delta_qp_contexts;
     int org_bits = rdo_get_written_bits(p_aec);
-    int act_ctx  = (last_dqp) ? 1 : 0;
     int act_sym  = (delta_qp > 0) ? (2 * delta_qp - 1) : (-2 * delta_qp);
 
-    if (act_sym == 0) {
-        biari_encode_symbol_vrdo(p_aec, 1, p_ctx + act_ctx);
-    } else {
-        biari_encode_symbol_vrdo(p_aec, 0, p_ctx + act_ctx);
-        act_ctx = 2;
-        if (act_sym == 1) {
-            biari_encode_symbol_vrdo(p_aec, 1, p_ctx + act_ctx);
-        } else {
-            biari_encode_symbol_vrdo(p_aec, 0, p_ctx + act_ctx);
-            act_ctx++;
-            while (act_sym > 2) {
-                biari_encode_symbol_vrdo(p_aec, 0, p_ctx + act_ctx);
-                act_sym--;
-            }
-            biari_encode_symbol_vrdo(p_aec, 1, p_ctx + act_ctx);
-        }
-    }
+    UNUSED_PARAMETER(last_dqp);
+
+    /* unary code of the mapped delta QP: act_sym zeros and a terminating one */
+    biari_encode_tu_vrdo(p_aec, act_sym, act_sym + 1, NULL);
 
     /* return the number of written bits */
     return rdo_get_written_bits(p_aec) - org_bits;
@@ -1355,8 +1340,8 @@ int write_cu_cbp_dqp_vrdo(xavs2_t *h, aec_t *p_aec, cu_info_t *p_cu_info, int sl
         *last_dqp = 0;
     }
 
-    if (p_cu_info->i_cbp != 0 && h->param->i_rc_method == XAVS2_RC_CBR_SCU) {
-        rate += aec_write_dqp_vrdo(p_aec, cu_get_qp(h, p_cu_info), *last_dqp);
+    if (p_cu_info->i_cbp != 0 && !h->param->fixed_picture_qp) {
+        rate += aec_write_dqp_vrdo(p_aec, p_cu_info->i_delta_qp, *last_dqp);
 
 #if ENABLE_RATE_CONTROL_CU
         *last_dqp = p_cu_info->i_delta_qp;
@@ -1447,6 +1432,19 @@ int write_chroma_block_coeff_vrdo(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, coeff_t
     return aec_write_run_level_chroma_vrdo(p_aec, runlevel, h, max_bits);
 }
 
+/* ---------------------------------------------------------------------------
+ * cu rate estimation on top of the syntax coding above
+ */
+#define aec_write_intra_pred_mode_est       aec_write_intra_pred_mode_vrdo
+#define write_cu_header_est                 write_cu_header_vrdo
+#define write_cu_refs_mvds_est              write_cu_refs_mvds_vrdo
+#define write_cu_cbp_dqp_est                write_cu_cbp_dqp_vrdo
+#define aec_write_cu_cbp_est                aec_write_cu_cbp_vrdo
+#define write_luma_block_coeff_est          write_luma_block_coeff_vrdo
+#define write_chroma_block_coeff_est        write_chroma_block_coeff_vrdo
+
+#include "aec_est_cu.h"
+
 /**
  * ===========================================================================
  * function handler
@@ -1460,6 +1458,10 @@ binary_t gf_aec_vrdo = {
     .est_cu_refs_mvds          = write_cu_refs_mvds_vrdo,
     .est_luma_block_coeff      = write_luma_block_coeff_vrdo,
     .est_chroma_block_coeff    = write_chroma_block_coeff_vrdo,
+    .est_intra_luma_rate       = write_intra_luma_rate_est,
+    .est_chroma_coeff_rate     = write_chroma_coeff_rate_est,
+    .est_cu_rate_intra         = write_cu_rate_intra_est,
+    .est_cu_rate_inter         = write_cu_rate_inter_est,
     
 #if ENABLE_RATE_CONTROL_CU
     .write_cu_cbp_dqp          = write_cu_cbp_dqp_vrdo,
@@ -89,17 +89,18 @@ static const int8_t tab_cu_bfs_order[] = {
     21, 5, 1, 0
 };
 
-extern double tab_qsfd_thres[MAX_QP][2][CTU_DEPTH];
-
 /* ---------------------------------------------------------------------------
  * QSFD threshold
  */
 static ALWAYS_INLINE
 void qsfd_calculate_threshold_of_a_frame(xavs2_t *h)
 {
-    assert(sizeof(h->thres_qsfd_cu) == sizeof(tab_qsfd_thres[0]));
+    xavs2_handler_t *h_mgr = h->h_top;
+
+    assert(sizeof(h->thres_qsfd_cu) == sizeof(h_mgr->tab_qsfd_thres[0][0]));
 
-    memcpy(h->thres_qsfd_cu, tab_qsfd_thres[h->i_qp], sizeof(h->thres_qsfd_cu));
+    /* the level of fast algorithms applied to this frame task */
+    memcpy(h->thres_qsfd_cu, h_mgr->tab_qsfd_thres[h->i_speed_level][h->i_qp], sizeof(h->thres_qsfd_cu));
 }
 
 
@@ -340,6 +341,15 @@ static void xavs2e_update_lambda(xavs2_t *h, int i_type, double lambda)
     }
 }
 
+/* ---------------------------------------------------------------------------
+ * calculate lambda for RDO of an LCU with a QP offset (AQ). lambda follows
+ * the QP in the same way as in xavs2e_get_frame_lambda(): 2^(QP/4)
+ */
+void xavs2e_update_lcu_lambda(xavs2_t *h, int i_qp_offset)
+{
+    xavs2e_update_lambda(h, h->i_type, h->fenc->f_frm_lambda_ssd * pow(2, i_qp_offset / 4.0));
+}
+
 
 /* ---------------------------------------------------------------------------
  * initializes the parameters for a new frame
@@ -407,9 +417,21 @@ static xavs2_t *encoder_alloc_frame_task(xavs2_handler_t *h_mgr, xavs2_frame_t *
         for (i = 0; i < h_mgr->i_frm_threads; i++) {
             /* alloc a frame task */
             xavs2_t *h = h_mgr->frm_contexts[i];
+
+            if (h == NULL) {
+                /* all created frame contexts are busy, create a new one */
+                if ((h = encoder_build_frame_context(h_mgr, i)) == NULL) {
+                    xavs2_thread_mutex_unlock(&h_mgr->mutex); /* unlock */
+                    return 0;
+                }
+            }
             assert(h->task_type == XAVS2_TASK_FRAME);
 
             if (h->task_status == XAVS2_TASK_FREE) {
+                /* take the parameters changed by xavs2_encoder_reconfig() up to now,
+                 * they are not changed while this frame is being encoded */
+                memcpy((xavs2_param_t *)h->param, h_mgr->param, sizeof(xavs2_param_t));
+
                 /* initialize the task */
                 h->task_status  = XAVS2_TASK_BUSY;
                 h->i_frame_b    = h_mgr->dpb.i_frame_b;
@@ -426,17 +448,23 @@ static xavs2_t *encoder_alloc_frame_task(xavs2_handler_t *h_mgr, xavs2_frame_t *
                 for (j = 0; j < h->i_height_in_lcu; j++) {
                     row_info_t *row = &h->frameinfo->rows[j];
 
-                    row->h     = 0;
-                    row->row   = j;
-                    row->coded = -1;
+                    row->h        = 0;
+                    row->h_lf     = 0;
+                    row->row      = j;
+                    row->coded    = -1;
+                    row->filtered = -1;
                 }
 
+                /* apply the level of fast algorithms decided by speed control */
+                encoder_set_speed_level(h, h_mgr->speed_ctrl_level);
+                h->i_time_frm_start = xavs2_mdate();
+
                 /* init caches */
                 init_frame(h, frame);
                 h->fenc->b_random_access_decodable = (h->fenc->i_frame >= h_mgr->dpb.POC_IDR);
 
                 /* update the task manager */
-                frame_buffer_update(h, &h_mgr->dpb, h->fenc);
+                frame_buffer_update(h->param, &h_mgr->dpb, h->fenc);
 
                 /* advance to the next input frame */
                 h_mgr->i_frame_in = Advance2NextFrame(h_mgr, h_mgr->i_frame_in);
@@ -646,6 +674,9 @@ static void *encoder_aec_encode_one_frame(xavs2_t *h)
 #endif
     int lcu_xy = 0;
     int lcu_x = 0, lcu_y = 0;
+#if ENABLE_RATE_CONTROL_CU
+    int last_dqp = 0;
+#endif
 
     /* encode frame header */
     encoder_encode_frame_header(h);
@@ -674,6 +705,9 @@ static void *encoder_aec_encode_one_frame(xavs2_t *h)
                 /* slice start : initialize the aec engine */
                 aec_start(h, p_aec, slice->bs.p_start + PSEUDO_CODE_SIZE, slice->bs.p_end, 1);
                 p_aec->b_writting = 1;
+#if ENABLE_RATE_CONTROL_CU
+                last_dqp = 0;
+#endif
             }
 
             if (h->param->enable_sao) {
@@ -689,7 +723,14 @@ static void *encoder_aec_encode_one_frame(xavs2_t *h)
                 }
             }
 
+#if ENABLE_RATE_CONTROL_CU
+            /* the context of delta QP continues across LCUs within a slice */
+            lcu->last_dqp = last_dqp;
             xavs2_lcu_write(h, p_aec, lcu, h->i_lcu_level, lcu->pix_x, lcu->pix_y);
+            last_dqp = lcu->last_dqp;
+#else
+            xavs2_lcu_write(h, p_aec, lcu, h->i_lcu_level, lcu->pix_x, lcu->pix_y);
+#endif
 
             /* for the last LCU in SLice, write 1, otherwise write 0 */
             xavs2_lcu_terminat_bit_write(p_aec, lcu_xy == slice->i_last_lcu_xy);
@@ -853,24 +894,34 @@ static int encoder_decide_mv_range(xavs2_t *h)
     h->max_mv_range[0] =  8191;
 
     if (h->param->profile_id == MAIN10_PROFILE || h->param->profile_id == MAIN_PROFILE) {
-        if (h->param->i_frame_threads > 1) {
-            /* set vertical mv range */
-            h->min_mv_range[1] = -((1 << h->i_lcu_level) << 2);
-            h->max_mv_range[1] =  ((1 << h->i_lcu_level) << 2) - 1;
+        /* set vertical mv range */
+        if (h->param->level_id >= 0x40) {
+            h->min_mv_range[1] = -2048;
+            h->max_mv_range[1] =  2047;
+        } else if (h->param->level_id >= 0x20) {
+            h->min_mv_range[1] = -1024;
+            h->max_mv_range[1] =  1023;
+        } else if (h->param->level_id >= 0x10) {
+            h->min_mv_range[1] = -512;
+            h->max_mv_range[1] =  511;
         } else {
-            /* set vertical mv range */
-            if (h->param->level_id >= 0x40) {
-                h->min_mv_range[1] = -2048;
-                h->max_mv_range[1] =  2047;
-            } else if (h->param->level_id >= 0x20) {
-                h->min_mv_range[1] = -1024;
-                h->max_mv_range[1] =  1023;
-            } else if (h->param->level_id >= 0x10) {
-                h->min_mv_range[1] = -512;
-                h->max_mv_range[1] =  511;
-            } else {
-                return -1;
-            }
+            return -1;
+        }
+
+        if (h->param->i_frame_threads > 1) {
+            /* limit the vertical mv range to the reference rows which are
+             * guaranteed to be ready by xavs2e_inter_sync(). The last 8 lines
+             * of the lowest ready row are modified by the next row and
+             * another 8 lines are reserved for the interpolation taps
+             * (the same margins are used in check_mv_range()) */
+            int range = ((xavs2e_get_ref_row_lag(h) << h->i_lcu_level) - 16) << 2;
+            h->min_mv_range[1] = XAVS2_MAX(h->min_mv_range[1], -range);
+            h->max_mv_range[1] = XAVS2_MIN(h->max_mv_range[1],  range - 1);
+
+            /* the LCU columns on the right are ready up to the same lag, those
+             * on the left are final when handed over (8 columns of margin) */
+            range = ((xavs2e_get_ref_row_lag(h) << h->i_lcu_level) - 8) << 2;
+            h->max_mv_range[0] = XAVS2_MIN(h->max_mv_range[0], range - 1);
         }
 
         /* scale for field coding */
@@ -927,7 +978,7 @@ static void encoder_decide_level_id(xavs2_param_t *param)
 
     for (; tab_level_restriction[i][4] != 0;) {
         /* δʱΪ */
-        if (param->i_rc_method == 0 &&
+        if ((param->i_rc_method == XAVS2_RC_CQP || param->i_rc_method == XAVS2_RC_CRF) &&
             param->org_width <= tab_level_restriction[i_last_level][1] &&
             param->org_height <= tab_level_restriction[i_last_level][2] &&
             param->org_width <= tab_level_restriction[i][1] &&
@@ -944,7 +995,7 @@ static void encoder_decide_level_id(xavs2_param_t *param)
             param->frame_rate <= tab_level_restriction[i][3]) {
             i_last_level = i;
             /* 趨ɸLevelID */
-            if (param->i_rc_method != 0 &&
+            if (param->i_rc_method != XAVS2_RC_CQP && param->i_rc_method != XAVS2_RC_CRF &&
                 param->i_target_bitrate * 1.5 <= tab_level_restriction[i][4] * 1000 &&
                 param->bitrate_upper <= tab_level_restriction[i][4] * 1000) {
                 break;
@@ -1033,6 +1084,10 @@ int encoder_check_parameters(xavs2_param_t *param)
         xavs2_log(NULL, XAVS2_LOG_WARNING, "IntraPeriod: swapped Min/Max\n");
         XAVS2_SWAP(param->intra_period_max, param->intra_period_min);
     }
+    if (param->scenecut_threshold < 0 || param->scenecut_threshold > 100) {
+        xavs2_log(NULL, XAVS2_LOG_WARNING, "SceneCut: %d out of range [0, 100], clipped\n", param->scenecut_threshold);
+        param->scenecut_threshold = XAVS2_CLIP3(0, 100, param->scenecut_threshold);
+    }
     /* Only support GOP size divisible by 8 while using RA with openGOP */
     if (param->b_open_gop && param->num_bframes) {
         int period = param->intra_period_max / XAVS2_ABS(param->i_gop_size);
@@ -1100,6 +1155,20 @@ int encoder_check_parameters(xavs2_param_t *param)
         param->b_open_gop = FALSE;
     }
 
+    /* multi-pass rate control */
+    if (param->i_rc_pass < 0 || param->i_rc_pass > 2) {
+        xavs2_log(NULL, XAVS2_LOG_ERROR, "Error input parameter Pass: %d (0, 1 or 2)\n", param->i_rc_pass);
+        return -1;
+    } else if (param->i_rc_pass == 1) {
+        /* the first pass: the fastest preset with constant QP */
+        param->preset_level         = 0;
+        param->is_preset_configured = FALSE;
+        param->i_rc_method          = XAVS2_RC_CQP;
+    } else if (param->i_rc_pass == 2 && (param->i_rc_method == XAVS2_RC_CQP || param->i_rc_method == XAVS2_RC_CRF)) {
+        xavs2_log(NULL, XAVS2_LOG_INFO, "The second pass is a bitrate mode, using frame level rate control.\n");
+        param->i_rc_method = XAVS2_RC_CBR_FRM;
+    }
+
     /* check preset level */
     if (param->preset_level < 0 || param->preset_level > 9) {
         xavs2_log(NULL, XAVS2_LOG_ERROR, "Error input parameter preset_level, check configuration file\n");
@@ -1110,6 +1179,16 @@ int encoder_check_parameters(xavs2_param_t *param)
             parse_preset_level(param, param->preset_level);
         }
     }
+    if (param->rdo_bit_est_method < 0 || param->rdo_bit_est_method > 3) {
+        xavs2_log(NULL, XAVS2_LOG_WARNING, "Invalid RDO bit estimation method: %d, reset to 0\n",
+                  param->rdo_bit_est_method);
+        param->rdo_bit_est_method = 0;
+    }
+    if (param->speed_ctrl_fps < 0) {
+        xavs2_log(NULL, XAVS2_LOG_WARNING, "Invalid speed control target: %.2f fps, speed control disabled\n",
+                  param->speed_ctrl_fps);
+        param->speed_ctrl_fps = 0;
+    }
 
     /* check QP */
     if (param->i_initial_qp > MAX_QP || param->i_initial_qp < MIN_QP) {
@@ -1129,6 +1208,10 @@ int encoder_check_parameters(xavs2_param_t *param)
         param->i_min_qp = 0;
     }
     param->i_initial_qp = XAVS2_CLIP3(param->i_min_qp, param->i_max_qp, param->i_initial_qp);
+    if (param->f_rate_factor < 0) {
+        param->f_rate_factor = (float)param->i_initial_qp;
+    }
+    param->f_rate_factor = XAVS2_CLIP3F((float)param->i_min_qp, (float)param->i_max_qp, param->f_rate_factor);
 
     /* check LCU level */
     if (param->lcu_bit_level > 6 || param->lcu_bit_level < 3) {
@@ -1170,15 +1253,29 @@ int encoder_check_parameters(xavs2_param_t *param)
         param->low_delay = FALSE;
     }
 
-    /* Rate-Control */
-#if !ENABLE_RATE_CONTROL_CU
+    /* Rate-Control, the CU level QP is only driven by AQ */
     if (param->i_rc_method == XAVS2_RC_CBR_SCU) {
         xavs2_log(NULL, XAVS2_LOG_WARNING, "Rate Control with CU level control disabled in this version.\n");
         param->i_rc_method = XAVS2_RC_CBR_FRM;
     }
+
+    /* adaptive quantization */
+    if (param->i_aq_mode != XAVS2_AQ_NONE && param->i_aq_mode != XAVS2_AQ_VARIANCE) {
+        xavs2_log(NULL, XAVS2_LOG_WARNING, "AQMode: invalid value %d, AQ disabled\n", param->i_aq_mode);
+        param->i_aq_mode = XAVS2_AQ_NONE;
+    }
+    if (param->i_aq_mode != XAVS2_AQ_NONE && param->f_aq_strength <= 0) {
+        param->i_aq_mode = XAVS2_AQ_NONE;
+    }
+#if !ENABLE_RATE_CONTROL_CU
+    if (param->i_aq_mode != XAVS2_AQ_NONE) {
+        xavs2_log(NULL, XAVS2_LOG_WARNING, "AQ needs CU level QP control, which is disabled in this version.\n");
+        param->i_aq_mode = XAVS2_AQ_NONE;
+    }
 #endif
 
-    if (param->i_rc_method == XAVS2_RC_CBR_SCU) {
+    /* QPs of CUs are coded (as delta QP) only when AQ is enabled */
+    if (param->i_aq_mode != XAVS2_AQ_NONE) {
         param->fixed_picture_qp = FALSE;
     } else {
         param->fixed_picture_qp = TRUE;
@@ -1264,6 +1361,7 @@ xavs2_t *encoder_create_frame_context(const xavs2_param_t *param, int idx_frm_en
     int ipm_size = (w_in_4x4 + 16) * ((size_lcu >> MIN_PU_SIZE_IN_BIT) + 1);
     int size_4x4 = w_in_4x4 * h_in_4x4;
     int qpel_frame_size = (frame_w + 2 * XAVS2_PAD) * (frame_h + 2 * XAVS2_PAD);
+    int qpel_row_size   = (frame_w + 2 * XAVS2_PAD) * INTPL_ROW_TMP_LINES(size_lcu);
     int info_size = sizeof(frame_info_t) + h_in_lcu * sizeof(row_info_t) + w_in_lcu * h_in_lcu * sizeof(lcu_info_t);
 
     int size_sao_stats = w_in_lcu * h_in_lcu * sizeof(SAOStatData[NUM_SAO_COMPONENTS][NUM_SAO_NEW_TYPES]);
@@ -1282,6 +1380,14 @@ xavs2_t *encoder_create_frame_context(const xavs2_param_t *param, int idx_frm_en
 
     num_me_bytes = (num_me_bytes + 255) >> 8 << 8;    /* align number of bytes to 256 */
     qpel_frame_size = (qpel_frame_size + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+    qpel_row_size   = (qpel_row_size   + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+    if (param->enable_lean_memory) {
+        /* row-scope interpolation temporaries; SAD prediction is only used by UMH */
+        qpel_frame_size = qpel_row_size;
+        if (param->me_method != XAVS2_ME_UMH) {
+            num_me_bytes = 0;
+        }
+    }
     size_extra_frame_buffer = (param->enable_tdrdo + param->enable_sao + param->enable_alf) * xavs2_frame_buffer_size(param, FT_TEMP);
 
     /* compute the space size and alloc buffer */
@@ -1311,11 +1417,12 @@ xavs2_t *encoder_create_frame_context(const xavs2_param_t *param, int idx_frm_en
         size_sao_onoff + CACHE_LINE_SIZE      +  /* SAO on/off number of LCU row */
 
         size_alf + CACHE_LINE_SIZE            +  /* ALF encoder contexts */
+        sizeof(xavs2_param_t) + CACHE_LINE_SIZE +  /* parameters of the frame task */
         CACHE_LINE_SIZE * 30;                    /* used for align buffer */
 
     /* alloc memory space */
     mem_size = ((mem_size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE) * CACHE_LINE_SIZE;
-    CHECKED_MALLOC(mem_base, uint8_t *, mem_size);
+    CHECKED_MALLOC_LARGE(mem_base, uint8_t *, mem_size, param);
 
     /* assign handle pointer of the xavs2 encoder */
     h = (xavs2_t *)mem_base;
@@ -1327,8 +1434,11 @@ xavs2_t *encoder_create_frame_context(const xavs2_param_t *param, int idx_frm_en
     h->module_log.i_log_level = param->i_log_level;
     sprintf(h->module_log.module_name, "Enc[%2d] %06llx", idx_frm_encoder, (uintptr_t)(h));
 
-    /* copy the input parameters */
-    h->param = param;
+    /* copy the input parameters, a frame task copies them again when it starts */
+    memcpy(mem_base, param, sizeof(xavs2_param_t));
+    h->param  = (const xavs2_param_t *)mem_base;
+    mem_base += sizeof(xavs2_param_t);
+    ALIGN_POINTER(mem_base);
 
     /* const properties */
     h->i_width           = frame_w;
@@ -1457,9 +1567,15 @@ xavs2_t *encoder_create_frame_context(const xavs2_param_t *param, int idx_frm_en
     ALIGN_POINTER(mem_base);    /* align pointer */
 
     /* temporary buffer for 1/4 interpolation: a,1,b, alone buffer */
-    h->img4Y_tmp[0] = (mct_t *)mem_base;
-    h->img4Y_tmp[1] = h->img4Y_tmp[0] + qpel_frame_size;
-    h->img4Y_tmp[2] = h->img4Y_tmp[0] + qpel_frame_size * 2;
+    if (param->enable_lean_memory) {
+        h->img4Y_tmp_row[0] = (mct_t *)mem_base;
+        h->img4Y_tmp_row[1] = h->img4Y_tmp_row[0] + qpel_row_size;
+        h->img4Y_tmp_row[2] = h->img4Y_tmp_row[0] + qpel_row_size * 2;
+    } else {
+        h->img4Y_tmp[0] = (mct_t *)mem_base;
+        h->img4Y_tmp[1] = h->img4Y_tmp[0] + qpel_frame_size;
+        h->img4Y_tmp[2] = h->img4Y_tmp[0] + qpel_frame_size * 2;
+    }
     mem_base       += qpel_frame_size * 3 * sizeof(mct_t);
     ALIGN_POINTER(mem_base);
 
@@ -1505,10 +1621,12 @@ xavs2_t *encoder_create_frame_context(const xavs2_param_t *param, int idx_frm_en
     for (i = 0; i < h_in_lcu; i++) {
         row_info_t *row = &h->frameinfo->rows[i];
 
-        row->h     = 0;
-        row->row   = i;
-        row->coded = -1;
-        row->lcus  = (lcu_info_t *)mem_base;
+        row->h        = 0;
+        row->h_lf     = 0;
+        row->row      = i;
+        row->coded    = -1;
+        row->filtered = -1;
+        row->lcus     = (lcu_info_t *)mem_base;
         mem_base  += sizeof(lcu_info_t) * w_in_lcu;
 
         if (xavs2_thread_mutex_init(&row->mutex, NULL)) {
@@ -1542,7 +1660,7 @@ xavs2_t *encoder_create_frame_context(const xavs2_param_t *param, int idx_frm_en
     }
 
     /* motion estimation buffer */
-    h->all_mincost = (dist_t(*)[MAX_INTER_MODES][MAX_REFS])mem_base;
+    h->all_mincost = num_me_bytes > 0 ? (dist_t(*)[MAX_INTER_MODES][MAX_REFS])mem_base : NULL;
     mem_base += num_me_bytes;
     ALIGN_POINTER(mem_base);
 
@@ -1575,6 +1693,16 @@ xavs2_t *encoder_create_frame_context(const xavs2_param_t *param, int idx_frm_en
         /* malloc size allocation error: no enough memory */
         goto fail;
     }
+
+    /* memory usage, for the memory report */
+    h->mem_usage.total         = mem_size;
+    h->mem_usage.bitstream     = XAVS2_BS_HEAD_LEN + bs_size;
+    h->mem_usage.interpolation = qpel_frame_size * 3 * sizeof(mct_t);
+    h->mem_usage.motion_est    = xavs2_me_get_buf_size(param) + num_me_bytes;
+    h->mem_usage.frame_info    = info_size + frame_size_in_scu * sizeof(cu_info_t) + size_4x4 * (3 + 2 * sizeof(mv_t)) +
+                                 size_sao_stats + size_sao_param + size_sao_onoff + size_alf;
+    h->mem_usage.extra_frames  = size_extra_frame_buffer;
+
     /* -------------------------------------------------------------
      * init other properties/modules for xavs2 encoder
      */
@@ -1595,6 +1723,106 @@ fail:
     return NULL;
 }
 
+/* ---------------------------------------------------------------------------
+ * init the LCU coding part of a context from the communal variables
+ */
+static void encoder_init_lcu_context(xavs2_t *h, const void *communal_vars)
+{
+    memcpy(&h->communal_vars_1, communal_vars,
+           (uint8_t *)&h->communal_vars_2 - (uint8_t *)&h->communal_vars_1);
+
+    /* identify ourself */
+    h->task_type = XAVS2_TASK_ROW;
+
+    /* we are free */
+    h->i_aec_frm = -1;
+
+    /* assign pointers for all coding tree units */
+    h->lcu.p_ctu     = &h->lcu.all_cu[0];
+    h->lcu.i_scu_xy  = 1;     // borrowed
+    build_coding_tree(h, h->lcu.p_ctu, 0, h->i_lcu_level, 0, 0);
+    h->lcu.i_scu_xy  = 0;     // reset
+
+    /* assign pointers for p_fenc (Y/U/V pointers) */
+    h->lcu.p_fenc[0] = h->lcu.fenc_buf;
+    h->lcu.p_fenc[1] = h->lcu.fenc_buf + FENC_STRIDE * MAX_CU_SIZE;
+    h->lcu.p_fenc[2] = h->lcu.fenc_buf + FENC_STRIDE * MAX_CU_SIZE + FENC_STRIDE / 2;
+
+    /* assign pointers for p_fdec (Y/U/V pointers) */
+    h->lcu.p_fdec[0] = h->lcu.fdec_buf;
+    h->lcu.p_fdec[1] = h->lcu.fdec_buf + FDEC_STRIDE * MAX_CU_SIZE;
+    h->lcu.p_fdec[2] = h->lcu.fdec_buf + FDEC_STRIDE * MAX_CU_SIZE + FDEC_STRIDE / 2;
+
+    h->cu_forks      = NULL;
+    h->lcu.fork_mask = 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * create the two helper contexts of a context coding LCUs, on which the
+ * non-split candidates of the 64x64 and 32x32 CUs are evaluated (ParallelCTU).
+ * the analysis stays serial if the memory is not available
+ */
+static void encoder_create_cu_forks(xavs2_handler_t *h_mgr, xavs2_t *h)
+{
+    size_t size_mincost = 0;
+    size_t mem_size;
+    uint8_t *mem_base;
+    int i;
+
+    h->cu_forks      = NULL;
+    h->lcu.fork_mask = 0;
+    if (h_mgr->threadpool_ctu == NULL) {
+        return;
+    }
+
+    if (h->param->me_method == XAVS2_ME_UMH) {
+        /* private SAD prediction: the minimum PU rows of a LCU and the one above it */
+        size_mincost = ((MAX_CU_SIZE >> MIN_PU_SIZE_IN_BIT) + 1) * h->i_width_in_minpu * sizeof(dist_t[MAX_INTER_MODES][MAX_REFS]);
+        size_mincost = (size_mincost + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+    }
+
+    mem_size = 2 * (sizeof(cu_fork_t) + sizeof(xavs2_t) + size_mincost) + CACHE_LINE_SIZE;
+    mem_base = (uint8_t *)xavs2_malloc_policy(mem_size, h->param->hugepage_mode, h->param->numa_node);
+    if (mem_base == NULL) {
+        xavs2_log(h, XAVS2_LOG_WARNING, "no memory for ParallelCTU, using serial analysis\n");
+        return;
+    }
+    memset(mem_base, 0, 2 * sizeof(cu_fork_t));
+    h->cu_forks = (cu_fork_t *)mem_base;
+    mem_base   += 2 * sizeof(cu_fork_t);
+    ALIGN_POINTER(mem_base);
+
+    for (i = 0; i < 2; i++) {
+        cu_fork_t *p_fork = &h->cu_forks[i];
+        xavs2_t   *h_fork = (xavs2_t *)mem_base;
+
+        mem_base += sizeof(xavs2_t);
+        encoder_init_lcu_context(h_fork, &h->communal_vars_1);
+        memset(&h_fork->mem_usage, 0, sizeof(h_fork->mem_usage));
+        h_fork->img4Y_tmp_row[0] = NULL;
+        h_fork->img4Y_tmp_row[1] = NULL;
+        h_fork->img4Y_tmp_row[2] = NULL;
+        h_fork->aec.ctx_base_id  = 0;
+        h_fork->i_aec_base_ver   = 0;
+
+        p_fork->h           = h_fork;
+        p_fork->mincost_buf = size_mincost > 0 ? (dist_t(*)[MAX_INTER_MODES][MAX_REFS])mem_base : NULL;
+        mem_base += size_mincost;
+    }
+
+    h->mem_usage.total += mem_size;
+}
+
+/* ---------------------------------------------------------------------------
+ */
+static void encoder_destroy_cu_forks(xavs2_t *h)
+{
+    if (h->cu_forks != NULL) {
+        xavs2_free(h->cu_forks);
+        h->cu_forks = NULL;
+    }
+}
+
 /* ---------------------------------------------------------------------------
  */
 static void encoder_destroy_frame_context(xavs2_t *h)
@@ -1620,6 +1848,7 @@ static void encoder_destroy_frame_context(xavs2_t *h)
         }
     }
 
+    encoder_destroy_cu_forks(h);
     xavs2_free(h);
 }
 
@@ -1628,53 +1857,54 @@ static void encoder_destroy_frame_context(xavs2_t *h)
  */
 int encoder_contexts_init(xavs2_t *h, xavs2_handler_t *h_mgr)
 {
+    size_t size_communal = (uint8_t *)&h->communal_vars_2 - (uint8_t *)&h->communal_vars_1;
     int i;
 
+    /* other contexts are built on their first use, from the communal variables of the main context */
+    CHECKED_MALLOC(h_mgr->ctx_communal_vars, uint8_t *, size_communal);
+    memcpy(h_mgr->ctx_communal_vars, &h->communal_vars_1, size_communal);
+
     /* -------------------------------------------------------------
-     * build lcu row encoding contexts */
+     * allocate lcu row encoding contexts */
+    h_mgr->num_row_contexts_built = 0;
     if (h_mgr->num_row_contexts > 1) {
-        CHECKED_MALLOC(h_mgr->row_contexts, xavs2_t *, h_mgr->num_row_contexts * sizeof(xavs2_t));
+        /* in lean memory mode, each row context has its own row-scope interpolation
+         * temporaries, instead of sharing the frame-scope ones of the frame context */
+        size_t qpel_row_size = 0;
+        uint8_t *mem_base;
+
+        if (h->param->enable_lean_memory) {
+            qpel_row_size = (h->i_width + 2 * XAVS2_PAD) * INTPL_ROW_TMP_LINES(1 << h->i_lcu_level);
+            qpel_row_size = (qpel_row_size + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+        }
+        CHECKED_MALLOC_LARGE(h_mgr->row_contexts, xavs2_t *, h_mgr->num_row_contexts * (sizeof(xavs2_t) + qpel_row_size * 3 * sizeof(mct_t)), h->param);
+        mem_base = (uint8_t *)(h_mgr->row_contexts + h_mgr->num_row_contexts);
 
         for (i = 0; i < h_mgr->num_row_contexts; i++) {
             xavs2_t *h_row_coder = &h_mgr->row_contexts[i];
 
-            memcpy(&h_row_coder->communal_vars_1, &h->communal_vars_1,
-                   (uint8_t *)&h->communal_vars_2 - (uint8_t *)&h->communal_vars_1);
-
-            /* identify ourself */
-            h_row_coder->task_type = XAVS2_TASK_ROW;
-
-            /* we are free */
-            h_row_coder->i_aec_frm = -1;
-
-            /* assign pointers for all coding tree units */
-            h_row_coder->lcu.p_ctu     = &h_row_coder->lcu.all_cu[0];
-            h_row_coder->lcu.i_scu_xy  = 1;     // borrowed
-            build_coding_tree(h_row_coder, h_row_coder->lcu.p_ctu, 0, h_row_coder->i_lcu_level, 0, 0);
-            h_row_coder->lcu.i_scu_xy  = 0;     // reset
-
-            /* assign pointers for p_fenc (Y/U/V pointers) */
-            h_row_coder->lcu.p_fenc[0] = h_row_coder->lcu.fenc_buf;
-            h_row_coder->lcu.p_fenc[1] = h_row_coder->lcu.fenc_buf + FENC_STRIDE * MAX_CU_SIZE;
-            h_row_coder->lcu.p_fenc[2] = h_row_coder->lcu.fenc_buf + FENC_STRIDE * MAX_CU_SIZE + FENC_STRIDE / 2;
-
-            /* assign pointers for p_fdec (Y/U/V pointers) */
-            h_row_coder->lcu.p_fdec[0] = h_row_coder->lcu.fdec_buf;
-            h_row_coder->lcu.p_fdec[1] = h_row_coder->lcu.fdec_buf + FDEC_STRIDE * MAX_CU_SIZE;
-            h_row_coder->lcu.p_fdec[2] = h_row_coder->lcu.fdec_buf + FDEC_STRIDE * MAX_CU_SIZE + FDEC_STRIDE / 2;
+            /* interpolation temporaries */
+            memset(&h_row_coder->mem_usage, 0, sizeof(h_row_coder->mem_usage));
+            if (qpel_row_size > 0) {
+                h_row_coder->img4Y_tmp_row[0] = (mct_t *)mem_base;
+                h_row_coder->img4Y_tmp_row[1] = h_row_coder->img4Y_tmp_row[0] + qpel_row_size;
+                h_row_coder->img4Y_tmp_row[2] = h_row_coder->img4Y_tmp_row[0] + qpel_row_size * 2;
+                mem_base += qpel_row_size * 3 * sizeof(mct_t);
+            } else {
+                h_row_coder->img4Y_tmp_row[0] = NULL;
+                h_row_coder->img4Y_tmp_row[1] = NULL;
+                h_row_coder->img4Y_tmp_row[2] = NULL;
+            }
+            h_row_coder->mem_usage.interpolation = qpel_row_size * 3 * sizeof(mct_t);
+            h_row_coder->mem_usage.total         = sizeof(xavs2_t) + h_row_coder->mem_usage.interpolation;
         }
     }
 
     /* -------------------------------------------------------------
-     * build frame encoding contexts */
+     * frame encoding contexts, created in encoder_alloc_frame_task() */
     h_mgr->frm_contexts[0] = h; /* context 0 is the main encoder handle */
     for (i = 1; i < h_mgr->i_frm_threads; i++) {
-        if ((h_mgr->frm_contexts[i] = encoder_create_frame_context(h->param, i)) == 0) {
-            goto fail;
-        }
-
-        memcpy(&h_mgr->frm_contexts[i]->communal_vars_1, &h->communal_vars_1,
-               (uint8_t *)&h->communal_vars_2 - (uint8_t *)&h->communal_vars_1);
+        h_mgr->frm_contexts[i] = NULL;
     }
 
     return 0;
@@ -1683,6 +1913,39 @@ fail:
     return -1;
 }
 
+/* ---------------------------------------------------------------------------
+ * create a frame context on its first use (with h_mgr->mutex locked)
+ */
+xavs2_t *encoder_build_frame_context(xavs2_handler_t *h_mgr, int idx_frm_encoder)
+{
+    const xavs2_param_t *param;
+    xavs2_t *h;
+
+    h = encoder_create_frame_context(h_mgr->param, idx_frm_encoder);
+    if (h == NULL) {
+        xavs2_log(NULL, XAVS2_LOG_ERROR, "create frame context %d fail\n", idx_frm_encoder);
+        return NULL;
+    }
+
+    param = h->param;  /* own copy of the parameters */
+    memcpy(&h->communal_vars_1, h_mgr->ctx_communal_vars,
+           (uint8_t *)&h->communal_vars_2 - (uint8_t *)&h->communal_vars_1);
+    h->param = param;
+    encoder_create_cu_forks(h_mgr, h);
+    h_mgr->frm_contexts[idx_frm_encoder] = h;
+
+    return h;
+}
+
+/* ---------------------------------------------------------------------------
+ * build a row context on its first use (with h_mgr->mutex locked)
+ */
+void encoder_init_row_context(xavs2_handler_t *h_mgr, xavs2_t *h_row_coder)
+{
+    encoder_init_lcu_context(h_row_coder, h_mgr->ctx_communal_vars);
+    encoder_create_cu_forks(h_mgr, h_row_coder);
+}
+
 /* ---------------------------------------------------------------------------
  * free all contexts except for the main context : xavs2_handler_t::contexts[0]
  */
@@ -1692,9 +1955,18 @@ static void encoder_contexts_free(xavs2_handler_t *h_mgr)
 
     /* free all row contexts */
     if (h_mgr->row_contexts != NULL) {
+        for (i = 0; i < h_mgr->num_row_contexts_built; i++) {
+            encoder_destroy_cu_forks(&h_mgr->row_contexts[i]);
+        }
         xavs2_free(h_mgr->row_contexts);
         h_mgr->row_contexts = NULL;
     }
+    h_mgr->num_row_contexts_built = 0;
+
+    if (h_mgr->ctx_communal_vars != NULL) {
+        xavs2_free(h_mgr->ctx_communal_vars);
+        h_mgr->ctx_communal_vars = NULL;
+    }
 
     /* free frame contexts */
     for (i = 0; i < h_mgr->i_frm_threads; i++) {
@@ -1740,9 +2012,17 @@ void encoder_task_manager_free(xavs2_handler_t *h_mgr)
         xavs2_threadpool_delete(h_mgr->threadpool_rdo);
     }
 
+    /* destroy the thread pool for parallel analysis inside CTU */
+    if (h_mgr->threadpool_ctu != NULL) {
+        xavs2_threadpool_delete(h_mgr->threadpool_ctu);
+        h_mgr->threadpool_ctu = NULL;
+    }
+
 #if XAVS2_STAT
-    /* report everything */
-    encoder_report_stat_info(h_mgr->p_coder);
+    /* report everything (nothing if the encoder failed to open) */
+    if (h_mgr->p_coder != NULL) {
+        encoder_report_stat_info(h_mgr->p_coder);
+    }
 #endif
 
     /* destroy TDRDO */
@@ -1838,12 +2118,13 @@ static void encoder_init_func_handles(xavs2_t *h)
 {
     /* set some function handles according option or preset level */
     if (h->param->enable_hadamard) {
-        g_funcs.pixf.intra_cmp = g_funcs.pixf.satd;
-        g_funcs.pixf.fpel_cmp  = g_funcs.pixf.satd;
+        h->intra_cmp = g_funcs.pixf.satd;
+        h->fpel_cmp  = g_funcs.pixf.satd;
     } else {
-        g_funcs.pixf.intra_cmp = g_funcs.pixf.sad;
-        g_funcs.pixf.fpel_cmp  = g_funcs.pixf.sad;
+        h->intra_cmp = g_funcs.pixf.sad;
+        h->fpel_cmp  = g_funcs.pixf.sad;
     }
+    h->b_intra_satd_x4 = h->param->enable_hadamard && h->param->enable_intra_satd_x4;
 }
 
 /**
@@ -1872,6 +2153,7 @@ xavs2_t *encoder_open(xavs2_param_t *param, xavs2_handler_t *h_mgr)
 #endif
     /* decide ultimaete coding parameters by preset level */
     decide_ultimate_paramters(param);
+    encoder_init_qsfd_thresholds(h_mgr);
 
     /* init frame context */
     if ((h = encoder_create_frame_context(param, 0)) == NULL) {
@@ -1912,6 +2194,7 @@ xavs2_t *encoder_open(xavs2_param_t *param, xavs2_handler_t *h_mgr)
 #if CTRL_OPT_AEC
     init_aec_context_tab();
 #endif
+    init_aec_frac_bits_tab();
 
     /* parse RPS */
     rps_set_picture_reorder_delay(h);
@@ -1923,6 +2206,9 @@ xavs2_t *encoder_open(xavs2_param_t *param, xavs2_handler_t *h_mgr)
     /* init LCU row order */
     slice_lcu_row_order_init(h);
 
+    /* helper contexts of the parallel analysis inside CTU */
+    encoder_create_cu_forks(h_mgr, h);
+
     return h;
 
 fail:
@@ -2004,6 +2290,20 @@ void xavs2e_frame_coding_init(xavs2_t *h)
     }
 }
 
+/* ---------------------------------------------------------------------------
+ * start the loop filter task of one LCU row (loop filter wavefront)
+ */
+static int encoder_start_row_filter(xavs2_t *h, row_info_t *row)
+{
+    if ((row->h_lf = xavs2e_alloc_row_task(h)) == NULL) {
+        return -1;
+    }
+    encoder_set_speed_level(row->h_lf, h->i_speed_level);
+
+    xavs2_threadpool_run(h->h_top->threadpool_rdo, xavs2_lcu_row_filter, row, 0);
+    return 0;
+}
+
 /**
  * ---------------------------------------------------------------------------
  * Function   : encode a video frame
@@ -2074,6 +2374,7 @@ void *xavs2e_encode_one_frame(void *arg)
             if ((row->h = xavs2e_alloc_row_task(h)) == NULL) {
                 return NULL;
             }
+            encoder_set_speed_level(row->h, h->i_speed_level);
 
             /* 2, 鵱ǰǷӦ
              *    ΪȴһLCỤ߳ٵȴ1
@@ -2082,8 +2383,16 @@ void *xavs2e_encode_one_frame(void *arg)
 
             /* 3, ʹøм߳̽б */
             xavs2_threadpool_run(h->h_top->threadpool_rdo, xavs2_lcu_row_write, row, 0);
+
+            /* 4, the loop filter of the row trails its RDO */
+            if (h->param->enable_lf_wavefront && encoder_start_row_filter(h, row) < 0) {
+                return NULL;
+            }
         } else {
             row->h = h;
+            if (h->param->enable_lf_wavefront && encoder_start_row_filter(h, row) < 0) {
+                return NULL;
+            }
             xavs2_lcu_row_write(row);
         }
 
@@ -2095,7 +2404,7 @@ void *xavs2e_encode_one_frame(void *arg)
     }   // for all LCU rows
 
     /* (4) Make sure that all LCU row are finished */
-    if (h->param->slice_num > 1) {
+    if (h->param->slice_num > 1 || h->param->enable_lf_wavefront) {
         xavs2_frame_t *p_fdec = h->fdec;
 
         for (i = 0; i < h->i_height_in_lcu; i++) {
@@ -2141,10 +2450,22 @@ void *xavs2e_encode_one_frame(void *arg)
         if (h->pic_alf_on[0] && h->use_fractional_me != 0) {
             /* interpolate (after finished expanding border) */
             for (i = 0; i < h->i_height_in_lcu; i++) {
-                interpolate_lcu_row(h, h->fdec, i);
+                interpolate_lcu_row(h, h->fdec, i, 0, h->i_width_in_lcu);
             }
         }
 #endif
+        if (h->pic_alf_on[0] && h->param->me_pyramid_range > 0 && h->fdec->rps.referd_by_others) {
+            for (i = 0; i < h->i_height_in_lcu; i++) {
+                xavs2_frame_lowres_lcurow(h, h->fdec, i, 0, h->i_width_in_lcu);
+            }
+        }
+        if (h->fdec->integral != NULL && h->fdec->rps.referd_by_others) {
+            /* integral lines of the final reconstruction, published row by row */
+            for (i = 0; i < h->i_height_in_lcu; i++) {
+                xavs2_frame_integral_lcurow(h, h->fdec, i);
+                xavs2_atomic_store_release(&h->fdec->i_integral_rows, i + 1);
+            }
+        }
 
         if (h->h_top->threadpool_aec != NULL) {
             xavs2_threadpool_run(h->h_top->threadpool_aec, encoder_aec_encode_one_frame, h, 0);
@@ -46,6 +46,7 @@
 int      send_frame_to_enc_queue(xavs2_handler_t *h_mgr, xavs2_frame_t *frm);
 
 void     xavs2e_get_frame_lambda(xavs2_t *h, xavs2_frame_t *cur_frm, int i_qp);
+void     xavs2e_update_lcu_lambda(xavs2_t *h, int i_qp_offset);
 
 /**
  * ===========================================================================
@@ -60,6 +61,8 @@ int      encoder_encode(xavs2_handler_t *h_mgr, xavs2_frame_t *frame);
 void     encoder_close (xavs2_handler_t *h_mgr);
 
 int      encoder_contexts_init(xavs2_t *h, xavs2_handler_t *h_mgr);
+xavs2_t *encoder_build_frame_context(xavs2_handler_t *h_mgr, int idx_frm_encoder);
+void     encoder_init_row_context(xavs2_handler_t *h_mgr, xavs2_t *h_row_coder);
 void     dump_yuv_out(xavs2_t *h, FILE *fp, xavs2_frame_t *frame, int img_w, int img_h);
 void     encoder_fetch_one_encoded_frame(xavs2_handler_t *h_mgr, xavs2_outpacket_t *packet, int is_flush);
 
@@ -73,6 +76,7 @@ void     xavs2_reconfigure_encoder(xavs2_t *h);
  */
 void     encoder_show_head_info(xavs2_param_t *param);
 void     encoder_show_frame_info_tab(xavs2_t *h, xavs2_handler_t *mgr);
+void     encoder_show_memory_info(xavs2_handler_t *mgr);
 
 void     encoder_cal_psnr(xavs2_t *h, double *psnr_y, double *psnr_u, double *psnr_v);
 void     encoder_cal_ssim(xavs2_t *h, double *ssim_y, double *ssim_u, double *ssim_v);
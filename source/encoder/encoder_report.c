@@ -36,6 +36,7 @@
 
 #include "common.h"
 #include "mc.h"
+#include "frame.h"
 #include "wrapper.h"
 #include "encoder.h"
 #include "version.h"
@@ -417,8 +418,13 @@ void encoder_show_head_info(xavs2_param_t *param)
     xavs2_log(NULL, XAVS2_LOG_INFO, " Preset Level     : %d,  %s \n", param->preset_level, xavs2_preset_names[param->preset_level]);
     xavs2_log(NULL, XAVS2_LOG_INFO, " Ref Structure    : BFrames: %d; %s GOP; IntraPeriod: %d~%d\n",
               param->num_bframes, s_gop_param, param->intra_period_min, param->intra_period_max);
-    xavs2_log(NULL, XAVS2_LOG_INFO, " Rate Control     : %d; QP: %d, [%2d, %2d]; %.3f Mbps\n",
-              param->i_rc_method, param->i_initial_qp, param->i_min_qp, param->i_max_qp, 0.000001f * param->i_target_bitrate);
+    if (param->i_rc_method == XAVS2_RC_CRF) {
+        xavs2_log(NULL, XAVS2_LOG_INFO, " Rate Control     : %d; CRF: %.1f, [%2d, %2d]\n",
+                  param->i_rc_method, param->f_rate_factor, param->i_min_qp, param->i_max_qp);
+    } else {
+        xavs2_log(NULL, XAVS2_LOG_INFO, " Rate Control     : %d; QP: %d, [%2d, %2d]; %.3f Mbps\n",
+                  param->i_rc_method, param->i_initial_qp, param->i_min_qp, param->i_max_qp, 0.000001f * param->i_target_bitrate);
+    }
     xavs2_log(NULL, XAVS2_LOG_INFO, " Threads (Row/Frm): %s / %s, cpu cores %d \n", s_threads_row, s_threads_frame, xavs2_cpu_num_processors());
 }
 
@@ -430,8 +436,8 @@ void encoder_show_frame_info_tab(xavs2_t *h, xavs2_handler_t *mgr)
     size_t space_alloc = xavs2_get_total_malloc_space();
     space_alloc = (space_alloc + (1 << 20) - 1) >> 20;
 
-    xavs2_log(NULL, XAVS2_LOG_INFO, " Threads (Alloc)  : %d / %d, threadpool %d, RowContexts %d \n",
-              mgr->i_row_threads, mgr->i_frm_threads, mgr->num_pool_threads, mgr->num_row_contexts);
+    xavs2_log(NULL, XAVS2_LOG_INFO, " Threads (Alloc)  : %d / %d, threadpool %d, RowContexts %d, ParallelCTU %d \n",
+              mgr->i_row_threads, mgr->i_frm_threads, mgr->num_pool_threads, mgr->num_row_contexts, mgr->num_ctu_threads);
     xavs2_log(NULL, XAVS2_LOG_INFO, " Memory  (Alloc)  : %d MB \n", (int)(space_alloc));
     xavs2_log(NULL, XAVS2_LOG_INFO, " Enabled Tools    : LCU %d, 2NxN/Nx2N:%d, AMP:%d, IntraInInter:%d, SDIP:%d,\n"\
               "                    FFrame %d, DHP:%d, DMH:%d, MHP:%d, WSM:%d,\n"\
@@ -456,4 +462,52 @@ void encoder_show_frame_info_tab(xavs2_t *h, xavs2_handler_t *mgr)
     }
 }
 
+/* ---------------------------------------------------------------------------
+ * show the memory used by each component of the encoder
+ */
+void encoder_show_memory_info(xavs2_handler_t *mgr)
+{
+    const double f_mb = 1.0 / (1 << 20);
+    const xavs2_param_t *param = mgr->param;
+    mem_usage_t frm_usage;
+    size_t size_input = xavs2_frame_buffer_size(param, FT_ENC);
+    size_t size_dpb   = xavs2_frame_buffer_size(param, FT_DEC);
+    size_t size_rows  = 0;
+    size_t size_total;
+    int num_frm_contexts = 0;
+    int i;
+
+    memset(&frm_usage, 0, sizeof(frm_usage));
+    for (i = 0; i < mgr->i_frm_threads; i++) {
+        /* contexts not created yet have the same size as the main context */
+        const xavs2_t *h_frm = mgr->frm_contexts[i] != NULL ? mgr->frm_contexts[i] : mgr->frm_contexts[0];
+        const mem_usage_t *usage;
+        if (h_frm == NULL) {
+            continue;
+        }
+        usage = &h_frm->mem_usage;
+        frm_usage.total         += usage->total;
+        frm_usage.bitstream     += usage->bitstream;
+        frm_usage.interpolation += usage->interpolation;
+        frm_usage.motion_est    += usage->motion_est;
+        frm_usage.frame_info    += usage->frame_info;
+        frm_usage.extra_frames  += usage->extra_frames;
+        num_frm_contexts++;
+    }
+    for (i = 0; i < mgr->num_row_contexts && mgr->row_contexts != NULL; i++) {
+        size_rows += mgr->row_contexts[i].mem_usage.total;
+    }
+
+    size_total = size_input * mgr->ipb.num_frames + size_dpb * mgr->dpb.num_frames + frm_usage.total + size_rows;
+    xavs2_log(NULL, XAVS2_LOG_INFO, " Memory  (Detail) : %.1f MB, LeanMemory %d\n"\
+              "                    InputFrames %2d x %.1f MB, DPB %2d x %.1f MB\n"\
+              "                    FrameContexts %d: %.1f MB (Bitstream %.1f, Interpolation %.1f, ME %.1f, FrameInfo %.1f, ExtraFrames %.1f)\n"\
+              "                    RowContexts %d: %.1f MB\n",
+              size_total * f_mb, param->enable_lean_memory,
+              mgr->ipb.num_frames, size_input * f_mb, mgr->dpb.num_frames, size_dpb * f_mb,
+              num_frm_contexts, frm_usage.total * f_mb, frm_usage.bitstream * f_mb, frm_usage.interpolation * f_mb,
+              frm_usage.motion_est * f_mb, frm_usage.frame_info * f_mb, frm_usage.extra_frames * f_mb,
+              mgr->num_row_contexts, size_rows * f_mb);
+}
+
 #endif  // #if XAVS2_STAT
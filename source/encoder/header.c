@@ -560,7 +560,7 @@ int xavs2_slice_header_write(xavs2_t *h, slice_t *p_slice)
     }
 
     if (!h->param->fixed_picture_qp) {
-        len += u_v(p_bs, 1, h->param->i_rc_method != XAVS2_RC_CBR_SCU, "fixed_slice_qp");
+        len += u_v(p_bs, 1, 0,                                      "fixed_slice_qp");  /* QPs of CUs are coded */
         len += u_v(p_bs, 7, p_slice->i_qp,                          "slice_qp");
     }
 
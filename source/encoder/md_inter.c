@@ -865,6 +865,101 @@ int add_one_mv_candidate(xavs2_me_t *p_me, int16_t (*mvc)[2], int i_mvc, int x,
 }
 
 
+/* ---------------------------------------------------------------------------
+ * store the fullpel ME result of one PU into the MV cache of current LCU
+ */
+static void
+mv_cache_store(xavs2_t *h, int ref_idx, int pix_x, int pix_y, int bsx, int bsy, mv_t mv, dist_t cost)
+{
+    int x0 = (pix_x - h->lcu.i_pix_x) >> MIN_CU_SIZE_IN_BIT;
+    int y0 = (pix_y - h->lcu.i_pix_y) >> MIN_CU_SIZE_IN_BIT;
+    int x1 = (pix_x - h->lcu.i_pix_x + bsx - 1) >> MIN_CU_SIZE_IN_BIT;
+    int y1 = (pix_y - h->lcu.i_pix_y + bsy - 1) >> MIN_CU_SIZE_IN_BIT;
+    int i, j;
+
+    cost = (dist_t)(((int64_t)cost << (MIN_CU_SIZE_IN_BIT << 1)) / (bsx * bsy));
+    for (j = y0; j <= y1; j++) {
+        for (i = x0; i <= x1; i++) {
+            int k = j * MV_CACHE_GRID + i;
+            h->lcu.mvcache_mv  [ref_idx][k] = mv;
+            h->lcu.mvcache_cost[ref_idx][k] = cost;
+            h->lcu.mvcache_mask[k] |= (uint8_t)(1 << ref_idx);
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * add the cached fullpel MVs of one PU as ME candidates and set the threshold
+ * of early termination, which is the cached SAD of the PU region when all of
+ * the region has been searched before for the same reference
+ */
+static int
+mv_cache_seed(xavs2_t *h, xavs2_me_t *p_me, int16_t(*mvc)[2], int i_mvc,
+              int ref_idx, int pix_x, int pix_y, int bsx, int bsy)
+{
+    int x0 = (pix_x - h->lcu.i_pix_x) >> MIN_CU_SIZE_IN_BIT;
+    int y0 = (pix_y - h->lcu.i_pix_y) >> MIN_CU_SIZE_IN_BIT;
+    int x1 = (pix_x - h->lcu.i_pix_x + bsx - 1) >> MIN_CU_SIZE_IN_BIT;
+    int y1 = (pix_y - h->lcu.i_pix_y + bsy - 1) >> MIN_CU_SIZE_IN_BIT;
+    int xc = (pix_x - h->lcu.i_pix_x + (bsx >> 1)) >> MIN_CU_SIZE_IN_BIT;
+    int yc = (pix_y - h->lcu.i_pix_y + (bsy >> 1)) >> MIN_CU_SIZE_IN_BIT;
+    int mask = 1 << ref_idx;
+    int64_t sum_cost = 0;
+    int num_cells = 0;
+    int i, j, k;
+
+    /* top-left and center 8x8 blocks of the PU */
+    k = y0 * MV_CACHE_GRID + x0;
+    if (h->lcu.mvcache_mask[k] & mask) {
+        mv_t mv = h->lcu.mvcache_mv[ref_idx][k];
+        i_mvc = add_one_mv_candidate(p_me, mvc, i_mvc, mv.x << 2, mv.y << 2);
+    }
+    k = XAVS2_MIN(yc, y1) * MV_CACHE_GRID + XAVS2_MIN(xc, x1);
+    if (h->lcu.mvcache_mask[k] & mask) {
+        mv_t mv = h->lcu.mvcache_mv[ref_idx][k];
+        i_mvc = add_one_mv_candidate(p_me, mvc, i_mvc, mv.x << 2, mv.y << 2);
+    }
+
+    /* early termination */
+    p_me->stop_cost = -1;
+    for (j = y0; j <= y1; j++) {
+        for (i = x0; i <= x1; i++) {
+            k = j * MV_CACHE_GRID + i;
+            if (!(h->lcu.mvcache_mask[k] & mask)) {
+                return i_mvc;
+            }
+            sum_cost += h->lcu.mvcache_cost[ref_idx][k];
+            num_cells++;
+        }
+    }
+    p_me->stop_cost = (dist_t)((sum_cost * bsx * bsy) / ((int64_t)num_cells << (MIN_CU_SIZE_IN_BIT << 1)));
+
+    return i_mvc;
+}
+
+/* ---------------------------------------------------------------------------
+ * scale the fullpel MV found on the first searched reference to the current one
+ */
+static INLINE
+int mv_cache_seed_ref(xavs2_t *h, xavs2_me_t *p_me, int16_t(*mvc)[2], int i_mvc, int ref_idx)
+{
+    mv_t mv = p_me->all_best_imv[0];
+    int dist_src, dist_dst;
+
+    if (h->i_type == SLICE_TYPE_B) {
+        dist_src = -calculate_distance(h, B_BWD);   /* backward reference is searched first */
+        dist_dst =  calculate_distance(h, B_FWD);
+    } else {
+        dist_src = h->fdec->ref_dpoc[0];
+        dist_dst = h->fdec->ref_dpoc[ref_idx];
+    }
+    if (dist_src == 0) {
+        return i_mvc;
+    }
+
+    return add_one_mv_candidate(p_me, mvc, i_mvc, (mv.x * dist_dst / dist_src) << 2, (mv.y * dist_dst / dist_src) << 2);
+}
+
 /* ---------------------------------------------------------------------------
  */
 int pred_inter_search_single(xavs2_t *h, cu_t *p_cu, cb_t *p_cb, xavs2_me_t *p_me, dist_t *fwd_cost, dist_t *bwd_cost)
@@ -890,14 +985,17 @@ int pred_inter_search_single(xavs2_t *h, cu_t *p_cu, cb_t *p_cb, xavs2_me_t *p_m
     int i, j, m, n, k;
     cu_mv_mode_t *p_mode_mvs = cu_get_layer_mode(h, p_cu->cu_info.i_level)->mvs[mode];
     neighbor_inter_t *p_neighbors = cu_get_layer(h, p_cu->cu_info.i_level)->neighbor_inter;
-    dist_t(*all_min_costs)[MAX_INTER_MODES][MAX_REFS];
+    dist_t(*all_min_costs)[MAX_INTER_MODES][MAX_REFS] = NULL;
     int width_in_4x4 = h->i_width_in_minpu;
     int max_ref = h->i_ref;
 
     *fwd_cost = MAX_DISTORTION;
     mv_mempos_x = (pix_x + MIN_PU_SIZE - 1) >> MIN_PU_SIZE_IN_BIT;  // ǵ8x8ķǶԳƻ֣Ҫһλ
     mv_mempos_y = (pix_y + MIN_PU_SIZE - 1) >> MIN_PU_SIZE_IN_BIT;
-    all_min_costs = &h->all_mincost[mv_mempos_y * width_in_4x4 + mv_mempos_x];
+    if (h->param->me_method == XAVS2_ME_UMH) {
+        /* SAD prediction of UMH, not allocated for other methods (lean memory) */
+        all_min_costs = &h->all_mincost[mv_mempos_y * width_in_4x4 + mv_mempos_x];
+    }
 
     /* make p_fenc point to the start address of the current PU */
     p_me->p_fenc  = h->lcu.p_fenc[0] + (pix_y - h->lcu.i_pix_y) * FENC_STRIDE + pix_x - h->lcu.i_pix_x;
@@ -957,6 +1055,16 @@ int pred_inter_search_single(xavs2_t *h, cu_t *p_cu, cb_t *p_cb, xavs2_me_t *p_m
         i_mvc = 0;
         i_mvc = add_one_mv_candidate(p_me, mvc, i_mvc, p_me->mvp.x, p_me->mvp.y);
         i_mvc = add_one_mv_candidate(p_me, mvc, i_mvc, 0, 0);
+        if (h->param->me_pyramid_range > 0 && xavs2_me_get_pyramid_mv(h, ref_idx, pix_x, pix_y, bsx, bsy, &mv)) {
+            i_mvc = add_one_mv_candidate(p_me, mvc, i_mvc, mv.x, mv.y);
+        }
+        p_me->stop_cost = -1;
+        if (h->param->me_mv_reuse) {
+            if (ref_idx > 0) {
+                i_mvc = mv_cache_seed_ref(h, p_me, mvc, i_mvc, ref_idx);
+            }
+            i_mvc = mv_cache_seed(h, p_me, mvc, i_mvc, ref_idx, pix_x, pix_y, bsx, bsy);
+        }
 
         if (b_mv_valid) {
             cost = xavs2_me_search(h, p_me, mvc, i_mvc);
@@ -968,6 +1076,9 @@ int pred_inter_search_single(xavs2_t *h, cu_t *p_cu, cb_t *p_cb, xavs2_me_t *p_m
 
         /* store motion vectors and reference frame (for motion vector prediction) */
         p_me->all_best_imv[ref_idx] = p_me->bmv2;
+        if (h->param->me_mv_reuse && cost < MAX_DISTORTION) {
+            mv_cache_store(h, ref_idx, pix_x, pix_y, bsx, bsy, p_me->bmv2, p_me->bcost2);
+        }
         m = XAVS2_MAX(bsx >> (MIN_PU_SIZE_IN_BIT + pu_size_shift), 1);
         n = XAVS2_MAX(bsy >> (MIN_PU_SIZE_IN_BIT + pu_size_shift), 1);
 
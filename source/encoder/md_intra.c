@@ -210,18 +210,73 @@ void update_candidate_list(int mode, rdcost_t cost, int max_num, intra_candidate
 }
 
 /* ---------------------------------------------------------------------------
- * used for generating intra luma prediction samples
+ * get the intra_satd_x4 kernel of a luma mode, -1 if it has to be predicted alone.
+ * the specialised predictors of mode 5 on 1:4 blocks and mode 31 on 4:1 blocks
+ * (SDIP) pad the samples beyond the reference line, which the kernels do not
  */
-#define PREDICT_ADD_LUMA(MODE_IDX) \
-{\
-    pel_t *p_pred = p_enc->intra_pred[MODE_IDX];\
-    int mode_bits = (mpm[0] == (MODE_IDX) || mpm[1] == (MODE_IDX)) ? 2 : 6;\
-    rdcost_t cost = h->f_lambda_mode * mode_bits; \
-    \
-    xavs2_intra_prediction(h, edge_pixels, p_pred, block_w, MODE_IDX,\
-        p_cu->block_avail, block_w, block_h);\
-    cost += intra_cmp(p_fenc, FENC_STRIDE, p_pred, block_w);\
-    update_candidate_list(MODE_IDX, cost, INTRA_MODE_NUM_FOR_RDO, p_candidates);\
+static ALWAYS_INLINE
+int get_intra_satd_x4_class(int mode, int block_w, int block_h)
+{
+    if (mode >= INTRA_ANG_X_3 && mode <= INTRA_ANG_X_11) {
+        return (mode == INTRA_ANG_X_5 && block_h == (block_w << 2)) ? -1 : 0;
+    } else if (mode >= INTRA_ANG_Y_25 && mode <= INTRA_ANG_Y_32) {
+        return (mode == INTRA_ANG_Y_31 && block_w == (block_h << 2)) ? -1 : 1;
+    }
+    return -1;
+}
+
+/* ---------------------------------------------------------------------------
+ * calculate the costs of a list of luma modes and insert them into the
+ * candidate list in the order of the list. with SATD, the X and Y angles
+ * are predicted and compared up to four at a time by intra_satd_x4
+ */
+static void predict_add_luma_modes(xavs2_t *h, cu_t *p_cu, intra_candidate_t *p_candidates,
+                                   pel_t *edge_pixels, pel_t *p_pred, pel_t *p_fenc, int mpm[],
+                                   const int *modes, int num_modes, int block_w, int block_h)
+{
+    pixel_cmp_t intra_cmp = h->intra_cmp[PART_INDEX(block_w, block_h)];
+    cmp_dist_t dist[NUM_INTRA_MODE];
+    int ang_modes[2][NUM_INTRA_MODE];
+    int ang_index[2][NUM_INTRA_MODE];
+    int num_ang[2] = { 0, 0 };
+    int i, k;
+
+    for (i = 0; i < num_modes; i++) {
+        int mode = modes[i];
+        int ang_class = h->b_intra_satd_x4 ? get_intra_satd_x4_class(mode, block_w, block_h) : -1;
+
+        if (ang_class >= 0) {
+            ang_modes[ang_class][num_ang[ang_class]] = mode;
+            ang_index[ang_class][num_ang[ang_class]] = i;
+            num_ang[ang_class]++;
+        } else {
+            xavs2_intra_prediction(h, edge_pixels, p_pred, block_w, mode,
+                                   p_cu->block_avail, block_w, block_h);
+            dist[i] = intra_cmp(p_fenc, FENC_STRIDE, p_pred, block_w);
+        }
+    }
+
+    for (k = 0; k < 2; k++) {
+        for (i = 0; i < num_ang[k]; i += 4) {
+            cmp_dist_t costs[4];
+            int num = XAVS2_MIN(4, num_ang[k] - i);
+            int j;
+
+            g_funcs.intra_satd_x4[k](edge_pixels, p_fenc, FENC_STRIDE, &ang_modes[k][i], num,
+                                     block_w, block_h, costs);
+            for (j = 0; j < num; j++) {
+                dist[ang_index[k][i + j]] = costs[j];
+            }
+        }
+    }
+
+    for (i = 0; i < num_modes; i++) {
+        int mode_bits = (mpm[0] == modes[i] || mpm[1] == modes[i]) ? 2 : 6;
+        rdcost_t cost = h->f_lambda_mode * mode_bits;
+
+        cost += dist[i];
+        update_candidate_list(modes[i], cost, INTRA_MODE_NUM_FOR_RDO, p_candidates);
+    }
 }
 
 /* ---------------------------------------------------------------------------
@@ -231,9 +286,9 @@ int rdo_get_pred_intra_luma(xavs2_t *h, cu_t *p_cu, intra_candidate_t *p_candida
                             pel_t *p_fenc, int mpm[], int blockidx,
                             int block_x, int block_y, int block_w, int block_h)
 {
-    pixel_cmp_t intra_cmp = g_funcs.pixf.intra_cmp[PART_INDEX(block_w, block_h)];
     cu_parallel_t *p_enc = cu_get_enc_context(h, p_cu->cu_info.i_level);
     pel_t *edge_pixels   = &p_enc->buf_edge_pixels[(MAX_CU_SIZE << 2) - 1];
+    int modes[NUM_INTRA_MODE];
     int mode;
     int img_x = h->lcu.i_pix_x + p_cu->i_pos_x + block_x;
     int img_y = h->lcu.i_pix_y + p_cu->i_pos_y + block_y;
@@ -245,8 +300,10 @@ int rdo_get_pred_intra_luma(xavs2_t *h, cu_t *p_cu, intra_candidate_t *p_candida
 
     /* loop over all intra predication modes */
     for (mode = 0; mode < NUM_INTRA_MODE; mode++) {
-        PREDICT_ADD_LUMA(mode);
+        modes[mode] = mode;
     }
+    predict_add_luma_modes(h, p_cu, p_candidates, edge_pixels, p_enc->intra_pred_scan, p_fenc, mpm,
+                           modes, NUM_INTRA_MODE, block_w, block_h);
 
     p_cu->feature.intra_had_cost = p_candidates[0].cost;
     return h->tab_num_intra_rdo[p_cu->cu_info.i_level - (p_cu->cu_info.i_tu_split != TU_SPLIT_NON)];
@@ -262,9 +319,11 @@ int rdo_get_pred_intra_luma_rmd(xavs2_t *h, cu_t *p_cu, intra_candidate_t *p_can
     int visited[NUM_INTRA_MODE] = { 0 };    /* 0: not visited yet
                                              * 1: visited in the first phase
                                              * 2: visited in final_mode */
-    pixel_cmp_t intra_cmp = g_funcs.pixf.intra_cmp[PART_INDEX(block_w, block_h)];
     cu_parallel_t *p_enc  = cu_get_enc_context(h, p_cu->cu_info.i_level);
     pel_t *edge_pixels    = &p_enc->buf_edge_pixels[(MAX_CU_SIZE << 2) - 1];
+    pel_t *p_pred         = p_enc->intra_pred_scan;
+    int modes[NUM_INTRA_MODE];
+    int num_modes = 0;
     int mode, i, j;
     int num_angle = 0;
     int num_for_rdo;
@@ -280,14 +339,16 @@ int rdo_get_pred_intra_luma_rmd(xavs2_t *h, cu_t *p_cu, intra_candidate_t *p_can
     /* 1, ģʽ
      * (1.1) ؼĽǶ */
     for (mode = 0; mode < 3; mode++) {
-        PREDICT_ADD_LUMA(mode);
+        modes[num_modes++] = mode;
         visited[mode] = 1;
     }
     /* (1.2) ǶԤģʽ */
     for (mode = 4; mode < NUM_INTRA_MODE; mode += 4) {
-        PREDICT_ADD_LUMA(mode);
+        modes[num_modes++] = mode;
         visited[mode] = 1;
     }
+    predict_add_luma_modes(h, p_cu, p_candidates, edge_pixels, p_pred, p_fenc, mpm,
+                           modes, num_modes, block_w, block_h);
 
     /* 2, NŵģʽľΪģʽŵCandModeList */
     num_to_add = h->num_intra_rmd_dist2;
@@ -297,17 +358,20 @@ int rdo_get_pred_intra_luma_rmd(xavs2_t *h, cu_t *p_cu, intra_candidate_t *p_can
             continue;
         }
 
+        num_modes = 0;
         if (mode > 3 && !visited[mode - 2]) {
             j = mode - 2;
-            PREDICT_ADD_LUMA(j);
+            modes[num_modes++] = j;
             visited[j] = 1;
         }
 
         if (mode < NUM_INTRA_MODE - 2 && !visited[mode + 2]) {
             j = mode + 2;
-            PREDICT_ADD_LUMA(j);
+            modes[num_modes++] = j;
             visited[j] = 1;
         }
+        predict_add_luma_modes(h, p_cu, p_candidates, edge_pixels, p_pred, p_fenc, mpm,
+                               modes, num_modes, block_w, block_h);
     }
 
     /* 3, ϵõѵģʽľΪһģʽCandModeList */
@@ -318,33 +382,39 @@ int rdo_get_pred_intra_luma_rmd(xavs2_t *h, cu_t *p_cu, intra_candidate_t *p_can
             continue;
         }
 
+        num_modes = 0;
         if (mode > 3 && !visited[mode - 1]) {
             j = mode - 1;
-            PREDICT_ADD_LUMA(j);
+            modes[num_modes++] = j;
             visited[j] = 1;
             num_angle++;
         }
 
         if (mode < NUM_INTRA_MODE - 1 && !visited[mode + 1]) {
             j = mode + 1;
-            PREDICT_ADD_LUMA(j);
+            modes[num_modes++] = j;
             visited[j] = 1;
             num_angle++;
         }
+        predict_add_luma_modes(h, p_cu, p_candidates, edge_pixels, p_pred, p_fenc, mpm,
+                               modes, num_modes, block_w, block_h);
     }
 
     /* 4, бǷMPMsûУ룬ü */
+    num_modes = 0;
     if (!visited[mpm[0]]) {
         mode = mpm[0];
-        PREDICT_ADD_LUMA(mode);
+        modes[num_modes++] = mode;
         visited[mode] = 1;
     }
 
     if (!visited[mpm[1]]) {
         mode = mpm[1];
-        PREDICT_ADD_LUMA(mode);
+        modes[num_modes++] = mode;
         visited[mode] = 1;
     }
+    predict_add_luma_modes(h, p_cu, p_candidates, edge_pixels, p_pred, p_fenc, mpm,
+                           modes, num_modes, block_w, block_h);
 
     num_for_rdo = h->tab_num_intra_rdo[p_cu->cu_info.i_level - (p_cu->cu_info.i_tu_split != TU_SPLIT_NON)];
 
@@ -403,7 +473,6 @@ int rdo_get_pred_intra_luma_2nd_pass(xavs2_t *h, cu_t *p_cu, intra_candidate_t *
     cu_parallel_t *p_enc = cu_get_enc_context(h, p_cu->cu_info.i_level);
     int best_intra_mode = p_cu->cu_info.real_intra_modes[blockidx];
     pel_t *edge_pixels = &p_enc->buf_edge_pixels[(MAX_CU_SIZE << 2) - 1];
-    pel_t *p_pred = p_enc->intra_pred[best_intra_mode];
     int img_x = h->lcu.i_pix_x + p_cu->i_pos_x + block_x;
     int img_y = h->lcu.i_pix_y + p_cu->i_pos_y + block_y;
 
@@ -413,14 +482,23 @@ int rdo_get_pred_intra_luma_2nd_pass(xavs2_t *h, cu_t *p_cu, intra_candidate_t *
     UNUSED_PARAMETER(p_fenc);
     UNUSED_PARAMETER(mpm);
 
-    xavs2_intra_prediction(h, edge_pixels, p_pred, block_w, best_intra_mode, p_cu->block_avail, block_w, block_h);
+    /* the prediction is made by rdo_intra_pred_luma() when the mode is tested */
     p_candidates[0].mode = best_intra_mode;
     p_candidates[0].cost = 0;
 
     return 1;
 }
 
-#undef PREDICT_ADD_LUMA
+/* ---------------------------------------------------------------------------
+ * predict a luma block from the reference samples of the last candidate scan
+ */
+void rdo_intra_pred_luma(xavs2_t *h, cu_t *p_cu, pel_t *p_pred, int mode, int block_w, int block_h)
+{
+    cu_parallel_t *p_enc = cu_get_enc_context(h, p_cu->cu_info.i_level);
+    pel_t *edge_pixels   = &p_enc->buf_edge_pixels[(MAX_CU_SIZE << 2) - 1];
+
+    xavs2_intra_prediction(h, edge_pixels, p_pred, block_w, mode, p_cu->block_avail, block_w, block_h);
+}
 
 //#if OPT_FAST_RDO_INTRA_C
 /* ---------------------------------------------------------------------------
@@ -433,7 +511,7 @@ int rdo_get_pred_intra_chroma_fast(xavs2_t *h, cu_t *p_cu, int i_level, int pix_
     pel_t *p_fenc_u = h->lcu.p_fenc[IMG_U] + pix_y_c * FENC_STRIDE + pix_x_c;
     pel_t *p_fenc_v = h->lcu.p_fenc[IMG_V] + pix_y_c * FENC_STRIDE + pix_x_c;
     int blksize = 1 << i_level;
-    pixel_cmp_t intra_chroma_cost = g_funcs.pixf.intra_cmp[PART_INDEX(blksize, blksize)];
+    pixel_cmp_t intra_chroma_cost = h->intra_cmp[PART_INDEX(blksize, blksize)];
     int num_for_rdo = 0;
 
     int LUMA_MODE[5] = { -1, DC_PRED, HOR_PRED, VERT_PRED, BI_PRED }; // map chroma mode to luma mode
@@ -345,7 +345,7 @@ static const int i_org = FENC_STRIDE;
 {\
     pel_t *p_pred = p_filtered[(((my) & 3) << 2) + ((mx) & 3)] + i_offset\
                   + ((my) >> 2) * i_fref + ((mx) >> 2); \
-    cost = g_funcs.pixf.fpel_cmp[i_pixel](p_org, i_org, p_pred, i_fref) + MV_COST_FPEL(mx, my);\
+    cost = h->fpel_cmp[i_pixel](p_org, i_org, p_pred, i_fref) + MV_COST_FPEL(mx, my);\
 }
 
 /* ---------------------------------------------------------------------------
@@ -377,7 +377,7 @@ static const int i_org = FENC_STRIDE;
             p_src1 += i_offset + yy1 * i_fref + xx1;\
             p_src2 += i_offset + yy2 * i_fref + xx2;\
             g_funcs.pixf.avg[i_pixel](p_pred, 64, p_src1, i_fref, p_src2, i_fref, 32); \
-            cost = g_funcs.pixf.fpel_cmp[i_pixel](p_org, i_org, p_pred, MAX_CU_SIZE)\
+            cost = h->fpel_cmp[i_pixel](p_org, i_org, p_pred, MAX_CU_SIZE)\
                  + MV_COST_FPEL(mx, my);\
         } \
     }\
@@ -390,7 +390,7 @@ static const int i_org = FENC_STRIDE;
         int xx1 = mx     >> 2;\
         int yy1 = my     >> 2;\
         pel_t *p_src1 = p_filtered1[((my     & 3) << 2) + (mx     & 3)] + i_offset + yy1 * i_fref + xx1;\
-        int distortion = g_funcs.pixf.fpel_cmp[i_pixel](buf_pixel_temp, MAX_CU_SIZE, p_src1, i_fref) >> 1;\
+        int distortion = h->fpel_cmp[i_pixel](buf_pixel_temp, MAX_CU_SIZE, p_src1, i_fref) >> 1;\
         \
         cost = distortion + MV_COST_FPEL(mx, my) + mv_bid_bit;\
     } else {\
@@ -529,7 +529,7 @@ me_subpel_refine(xavs2_t *h, xavs2_me_t *p_me)
         mvt.v = MAKEDWORD(mx, my);
         get_mv_for_mc(h, &mvt, p_me->i_pix_x, p_me->i_pix_y, p_me->i_block_w, p_me->i_block_h);
         mc_luma(p_pred, MAX_CU_SIZE, mvt.x, mvt.y, p_me->i_block_w, p_me->i_block_h, p_me->p_fref_1st);
-        cost = g_funcs.pixf.fpel_cmp[i_pixel](p_org, i_org, p_pred, MAX_CU_SIZE) + MV_COST_FPEL(mx, my);
+        cost = h->fpel_cmp[i_pixel](p_org, i_org, p_pred, MAX_CU_SIZE) + MV_COST_FPEL(mx, my);
 #endif
         if (cost < bcost) {
             bcost = cost;
@@ -563,7 +563,7 @@ me_subpel_refine(xavs2_t *h, xavs2_me_t *p_me)
             mvt.v = MAKEDWORD(mx, my);
             get_mv_for_mc(h, &mvt, p_me->i_pix_x, p_me->i_pix_y, p_me->i_block_w, p_me->i_block_h);
             mc_luma(p_pred, MAX_CU_SIZE, mvt.x, mvt.y, p_me->i_block_w, p_me->i_block_h, p_me->p_fref_1st);
-            cost = g_funcs.pixf.fpel_cmp[i_pixel](p_org, i_org, p_pred, MAX_CU_SIZE) + MV_COST_FPEL(mx, my);
+            cost = h->fpel_cmp[i_pixel](p_org, i_org, p_pred, MAX_CU_SIZE) + MV_COST_FPEL(mx, my);
 #endif
             if (cost < bcost) {
                 bcost = cost;
@@ -579,6 +579,45 @@ me_subpel_refine(xavs2_t *h, xavs2_me_t *p_me)
 }
 
 
+/* ---------------------------------------------------------------------------
+ * table of MVD bits for search ranges up to 256, built once and shared by all encoders
+ */
+#define MVBITS_SHARED_RANGE     256
+#define MVBITS_SHARED_MAX_MVD   ((1 << 14) - 1)   /* max_mvd of MVBITS_SHARED_RANGE */
+static uint16_t g_tab_mvbits[2 * MVBITS_SHARED_MAX_MVD + 1];
+static int g_b_mvbits_ready = 0;
+
+/* ---------------------------------------------------------------------------
+ */
+static INLINE
+int me_get_max_mv_bits(const xavs2_param_t *param, int *p_max_mvd)
+{
+    int me_range    = XAVS2_MAX(MVBITS_SHARED_RANGE, param->search_range);
+    int subpel_num  = 4 * (2 * me_range + 3);
+    int max_mv_bits = 5 + 2 * (int)ceil(log(subpel_num + 1) / log(2) + 1e-10);
+
+    *p_max_mvd = (1 << ((max_mv_bits >> 1))) - 1;
+    return max_mv_bits;
+}
+
+/* ---------------------------------------------------------------------------
+ * mvbits points to the entry of MVD 0
+ */
+static void me_build_mvbits(uint16_t *mvbits, int max_mv_bits)
+{
+    int bits, i, imin, imax;
+
+    mvbits[0] = 1;
+    for (bits = 3; bits <= max_mv_bits; bits += 2) {
+        imax = 1 << (bits >> 1);
+        imin = imax >> 1;
+
+        for (i = imin; i < imax; i++) {
+            mvbits[-i] = mvbits[i] = (uint16_t)bits;
+        }
+    }
+}
+
 /**
  * ===========================================================================
  * interface function defines
@@ -590,14 +629,14 @@ me_subpel_refine(xavs2_t *h, xavs2_me_t *p_me)
  */
 int xavs2_me_get_buf_size(const xavs2_param_t *param)
 {
-    int me_range    = XAVS2_MAX(256, param->search_range);
-    int subpel_num  = 4 * (2 * me_range + 3);
-    int max_mv_bits = 5 + 2 * (int)ceil(log(subpel_num + 1) / log(2) + 1e-10);
-    int max_mvd     = (1 << ((max_mv_bits >> 1))) - 1;
-    int mem_size;
+    int max_mvd;
+    int mem_size = 0;
 
-    /* buffer size for mvbits */
-    mem_size = (max_mvd * 2 + 1) * sizeof(uint16_t) + CACHE_LINE_SIZE;
+    /* buffer size for mvbits, unless the shared one is used */
+    me_get_max_mv_bits(param, &max_mvd);
+    if (max_mvd > MVBITS_SHARED_MAX_MVD) {
+        mem_size = (max_mvd * 2 + 1) * sizeof(uint16_t) + CACHE_LINE_SIZE;
+    }
 
     return mem_size;
 }
@@ -614,11 +653,23 @@ int xavs2_me_get_buf_size(const xavs2_param_t *param)
 void xavs2_me_init(xavs2_t *h, uint8_t **mem_base)
 {
     uint8_t *mbase  = *mem_base;
-    int me_range    = XAVS2_MAX(256, h->param->search_range);
-    int subpel_num  = 4 * (2 * me_range + 3);
-    int max_mv_bits = 5 + 2 * (int)ceil(log(subpel_num + 1) / log(2) + 1e-10);
-    int max_mvd     = (1 << ((max_mv_bits >> 1))) - 1;
-    int bits, i, imin, imax;
+    int max_mvd;
+    int max_mv_bits = me_get_max_mv_bits(h->param, &max_mvd);
+
+    if (max_mvd <= MVBITS_SHARED_MAX_MVD) {
+        /* the shared table, its values only depend on constants */
+        assert(max_mvd == MVBITS_SHARED_MAX_MVD);
+        if (!xavs2_atomic_load_acquire(&g_b_mvbits_ready)) {
+            xavs2_init_lock();
+            if (!g_b_mvbits_ready) {
+                me_build_mvbits(g_tab_mvbits + MVBITS_SHARED_MAX_MVD, max_mv_bits);
+                xavs2_atomic_store_release(&g_b_mvbits_ready, 1);
+            }
+            xavs2_init_unlock();
+        }
+        h->mvbits = g_tab_mvbits + MVBITS_SHARED_MAX_MVD;
+        return;
+    }
 
     /* set pointer of mvbits */
     h->mvbits  = (uint16_t *)mbase;
@@ -629,15 +680,7 @@ void xavs2_me_init(xavs2_t *h, uint8_t **mem_base)
     *mem_base = mbase;
 
     // init array of motion vector bits
-    h->mvbits[0] = 1;
-    for (bits = 3; bits <= max_mv_bits; bits += 2) {
-        imax = 1 << (bits >> 1);
-        imin = imax >> 1;
-
-        for (i = imin; i < imax; i++) {
-            h->mvbits[-i] = h->mvbits[i] = (uint16_t)bits;
-        }
-    }
+    me_build_mvbits(h->mvbits, max_mv_bits);
 }
 
 /* ---------------------------------------------------------------------------
@@ -664,6 +707,141 @@ void xavs2_me_init_umh_threshold(xavs2_t *h, double *bsize, int i_qp)
     bsize[PRED_2Nx2N] = 4 * bsize[PRED_2NxN ];
 }
 
+/* ---------------------------------------------------------------------------
+ * number of luma lines (from the top of picture) of which the integral plane
+ * of the reference frame is ready
+ */
+static ALWAYS_INLINE
+int me_integral_ready_lines(xavs2_t *h, xavs2_frame_t *p_ref)
+{
+    int num_rows = xavs2_atomic_load_acquire(&p_ref->i_integral_rows);
+
+    if (num_rows >= h->i_height_in_lcu) {
+        return h->i_height + XAVS2_PAD;
+    } else {
+        return (num_rows << h->i_lcu_level) - 8;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * search one block on a downscaled luma plane, the search window is given by
+ * the top-left positions [x_min, x_max] x [y_min, y_max] of the block.
+ * (bx, by) is the position of the block itself, the best displacement is
+ * returned in (*bmx, *bmy)
+ */
+static void me_pyramid_search_block(const pel_t *p_org, const pel_t *p_ref, int i_ref, int i_pixel,
+                                    int bx, int by, int x_min, int y_min, int x_max, int y_max,
+                                    int *bmx, int *bmy)
+{
+    ALIGNED_ARRAY_16(int, costs, [4]);
+    int bcost = MAX_DISTORTION;
+    int x, y, k;
+
+    for (y = y_min; y <= y_max; y++) {
+        const pel_t *p = p_ref + y * i_ref;
+        /* a small penalty of the displacement, preferring the shorter MV */
+        int cost_y = XAVS2_ABS(y - by);
+
+        for (x = x_min; x + 3 <= x_max; x += 4) {
+            g_funcs.pixf.sad_x4[i_pixel](p_org, p + x, p + x + 1, p + x + 2, p + x + 3, i_ref, costs);
+            for (k = 0; k < 4; k++) {
+                int cost = costs[k] + cost_y + XAVS2_ABS(x + k - bx);
+                COPY3_IF_LT(bcost, cost, *bmx, x + k - bx, *bmy, y - by);
+            }
+        }
+        for (; x <= x_max; x++) {
+            int cost = g_funcs.pixf.sad[i_pixel](p_org, FENC_STRIDE, p + x, i_ref) + cost_y + XAVS2_ABS(x - bx);
+            COPY3_IF_LT(bcost, cost, *bmx, x - bx, *bmy, y - by);
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * hierarchical motion estimation of current LCU for one reference frame:
+ * an exhaustive search of the whole LCU on the 1/4 plane, then a small
+ * refinement of each LCU quadrant on the 1/2 plane
+ */
+static void me_pyramid_search_lcu(xavs2_t *h, int ref_idx)
+{
+    xavs2_frame_t *p_ref = h->fref[ref_idx];
+    int lcu_size = 1 << h->i_lcu_level;
+    int range    = XAVS2_MAX(h->param->me_pyramid_range >> 2, 1);
+    int mvx = 0, mvy = 0;
+    int bx, by, bsize, i;
+
+    /* 1, the whole LCU on the 1/4 plane */
+    bsize = lcu_size >> 2;
+    bx    = h->lcu.i_pix_x >> 2;
+    by    = h->lcu.i_pix_y >> 2;
+    me_pyramid_search_block(h->lcu.fenc_lowres[1], p_ref->lowres[1], p_ref->i_lowres_stride[1], PART_INDEX(bsize, bsize), bx, by,
+                            XAVS2_MAX(bx - range, XAVS2_MAX(0, bx - ((-h->min_mv_range[0]) >> 4))),
+                            XAVS2_MAX(by - range, XAVS2_MAX(0, by - ((-h->min_mv_range[1]) >> 4))),
+                            XAVS2_MIN(bx + range, XAVS2_MIN(p_ref->i_lowres_width[1] - bsize, bx + (h->max_mv_range[0] >> 4))),
+                            XAVS2_MIN(by + range, XAVS2_MIN(p_ref->i_lowres_lines[1] - bsize, by + (h->max_mv_range[1] >> 4))),
+                            &mvx, &mvy);
+
+    /* 2, refine the four quadrants on the 1/2 plane */
+    bsize = lcu_size >> 2;
+    for (i = 0; i < 4; i++) {
+        int qx = (i & 1) * bsize;
+        int qy = (i >> 1) * bsize;
+        int cx, cy, qmx = 0, qmy = 0;
+
+        bx = (h->lcu.i_pix_x >> 1) + qx;
+        by = (h->lcu.i_pix_y >> 1) + qy;
+        cx = bx + (mvx << 1);
+        cy = by + (mvy << 1);
+        me_pyramid_search_block(h->lcu.fenc_lowres[0] + qy * FENC_STRIDE + qx,
+                                p_ref->lowres[0], p_ref->i_lowres_stride[0], PART_INDEX(bsize, bsize), bx, by,
+                                XAVS2_MAX(cx - 2, XAVS2_MAX(0, bx - ((-h->min_mv_range[0]) >> 3))),
+                                XAVS2_MAX(cy - 2, XAVS2_MAX(0, by - ((-h->min_mv_range[1]) >> 3))),
+                                XAVS2_MIN(cx + 2, XAVS2_MIN(p_ref->i_lowres_width[0] - bsize, bx + (h->max_mv_range[0] >> 3))),
+                                XAVS2_MIN(cy + 2, XAVS2_MIN(p_ref->i_lowres_lines[0] - bsize, by + (h->max_mv_range[1] >> 3))),
+                                &qmx, &qmy);
+        h->lcu.pyramid_mv[ref_idx][i].x = (int16_t)(qmx << 3);
+        h->lcu.pyramid_mv[ref_idx][i].y = (int16_t)(qmy << 3);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * get the coarse MV (1/4 pixel) of hierarchical motion estimation for one PU
+ * return 0 if not available
+ */
+int xavs2_me_get_pyramid_mv(xavs2_t *h, int ref_idx, int pix_x, int pix_y, int bsx, int bsy, mv_t *mv)
+{
+    int lcu_size = 1 << h->i_lcu_level;
+    int quad;
+
+    /* only LCUs inside the picture */
+    if (h->lcu.i_pix_x + lcu_size > h->i_width || h->lcu.i_pix_y + lcu_size > h->i_height) {
+        return 0;
+    }
+
+    if (!(h->lcu.pyramid_mask & (1u << 31))) {
+        pel_t *p_src = h->lcu.p_fenc[IMG_Y];
+        int size = lcu_size;
+        int i;
+
+        for (i = 0; i < ME_PYRAMID_LEVELS; i++) {
+            size >>= 1;
+            g_funcs.lowres_filter(p_src, FENC_STRIDE, h->lcu.fenc_lowres[i], FENC_STRIDE, size, size);
+            p_src = h->lcu.fenc_lowres[i];
+        }
+        h->lcu.pyramid_mask |= 1u << 31;
+    }
+
+    if (!(h->lcu.pyramid_mask & (1u << ref_idx))) {
+        me_pyramid_search_lcu(h, ref_idx);
+        h->lcu.pyramid_mask |= 1u << ref_idx;
+    }
+
+    quad  = ((pix_x - h->lcu.i_pix_x) + (bsx >> 1) >= (lcu_size >> 1));
+    quad += ((pix_y - h->lcu.i_pix_y) + (bsy >> 1) >= (lcu_size >> 1)) << 1;
+    *mv   = h->lcu.pyramid_mv[ref_idx][quad];
+
+    return 1;
+}
+
 /* ---------------------------------------------------------------------------
  */
 static void tz_pattern_search(xavs2_t* h,
@@ -920,6 +1098,11 @@ dist_t xavs2_me_search(xavs2_t *h, xavs2_me_t *p_me, int16_t(*mvc)[2], int i_mvc
         goto _me_error;         /* me failed */
     }
 
+    /* a candidate is already as good as the results of previous searches in this region */
+    if (bcost <= p_me->stop_cost) {
+        goto _me_fpel_done;
+    }
+
     /* -------------------------------------------------------------
      * search using different method */
     switch (h->param->me_method) {
@@ -1153,7 +1336,68 @@ umh_step_3:                   /* UMH 5. the third step with a small search patte
             }
         }
         break;
+    case XAVS2_ME_SEA: {      /* successive elimination full search */
+        xavs2_frame_t *p_ref = p_me->p_fref_1st;
+        const uint32_t *p_sum = p_ref->integral;
+        int i_sum   = p_ref->i_integral_stride;
+        int bsx     = p_me->i_block_w;
+        int bsy     = p_me->i_block_h;
+        int x_min   = XAVS2_MAX(bmx - me_range, mv_x_min);
+        int y_min   = XAVS2_MAX(bmy - me_range, mv_y_min);
+        int x_max   = XAVS2_MIN(bmx + me_range - 1, mv_x_max);
+        int y_max   = XAVS2_MIN(bmy + me_range - 1, mv_y_max);
+        int org_sum = 0;
+        int num_cand;
+        int16_t cand[4][2];
+
+        /* fall back to the plain full search if the integral lines are not ready yet */
+        if (p_me->i_pix_y + y_max + bsy > me_integral_ready_lines(h, p_ref)) {
+            goto me_full_search;
+        }
+
+        for (j = 0; j < bsy; j++) {
+            for (i = 0; i < bsx; i++) {
+                org_sum += p_org[j * FENC_STRIDE + i];
+            }
+        }
+        p_sum += p_me->i_pix_y * i_sum + p_me->i_pix_x;
+
+        for (j = y_min; j <= y_max; j++) {
+            const uint32_t *p_top = p_sum + j * i_sum;
+            const uint32_t *p_bot = p_top + bsy * i_sum;
+            num_cand = 0;
+
+            for (i = x_min; i <= x_max; i++) {
+                /* |sum(org) - sum(ref)| is a lower bound of the SAD */
+                int ref_sum = (int)(p_bot[i + bsx] - p_top[i + bsx] - p_bot[i] + p_top[i]);
+                int cost    = XAVS2_ABS(org_sum - ref_sum) + MV_COST_IPEL(i, j);
+
+                if (cost < bcost) {
+                    cand[num_cand][0] = (int16_t)i;
+                    cand[num_cand][1] = (int16_t)j;
+                    if (++num_cand == 4) {
+                        g_funcs.pixf.sad_x4[i_pixel](p_org,
+                            p_fref + cand[0][1] * i_fref + cand[0][0],
+                            p_fref + cand[1][1] * i_fref + cand[1][0],
+                            p_fref + cand[2][1] * i_fref + cand[2][0],
+                            p_fref + cand[3][1] * i_fref + cand[3][0], i_fref, costs);
+                        for (idx = 0; idx < 4; idx++) {
+                            cost = costs[idx] + MV_COST_IPEL(cand[idx][0], cand[idx][1]);
+                            COPY3_IF_LT(bcost, cost, bmx, cand[idx][0], bmy, cand[idx][1]);
+                        }
+                        num_cand = 0;
+                    }
+                }
+            }
+            for (idx = 0; idx < num_cand; idx++) {
+                int cost = CAL_COST_IPEL(cand[idx][0], cand[idx][1]);
+                COPY3_IF_LT(bcost, cost, bmx, cand[idx][0], bmy, cand[idx][1]);
+            }
+        }
+        break;
+    }
     default:                    /* XAVS2_ME_FS: full search */
+me_full_search:
         omx = bmx;
         omy = bmy;
         for (j = -me_range; j < me_range; j++) {
@@ -1164,6 +1408,7 @@ umh_step_3:                   /* UMH 5. the third step with a small search patte
         break;
     }
 
+_me_fpel_done:
     /* -------------------------------------------------------------
      * store the results of fullpel search */
     p_me->bmv.v  = MAKEDWORD(FPEL(bmx), FPEL(bmy));
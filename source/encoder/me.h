@@ -117,6 +117,9 @@ void xavs2_me_init(xavs2_t *h, uint8_t **mem_base);
 #define xavs2_me_init_umh_threshold FPFX(me_init_umh_threshold)
 void xavs2_me_init_umh_threshold(xavs2_t *h, double *bsize, int i_qp);
 
+#define xavs2_me_get_pyramid_mv FPFX(me_get_pyramid_mv)
+int  xavs2_me_get_pyramid_mv(xavs2_t *h, int ref_idx, int pix_x, int pix_y, int bsx, int bsy, mv_t *mv);
+
 #define xavs2_me_search FPFX(me_search)
 dist_t xavs2_me_search(xavs2_t *h, xavs2_me_t *p_me, int16_t(*mvc)[2], int i_mvc);
 
@@ -43,6 +43,7 @@
 /* ---------------------------------------------------------------------------
  * include files */
 #include <stdio.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
@@ -65,20 +66,8 @@
  * ===========================================================================
  */
 
-#define MAP_TAB_SIZE    512     /* maximal size of mapping table */
 #define MAX_ITEMS       1024    /* maximal number of items to parse */
-
-#if defined(_MSC_VER) || defined(__INTEL_COMPILER)
-#define REMOVE_WARNING \
-    __pragma(warning(push))\
-    __pragma(warning(disable:4127))
-
-#define RESTORE_WARNING \
-    __pragma(warning(pop))
-#else
-#define REMOVE_WARNING
-#define RESTORE_WARNING
-#endif
+#define PARAM_HASH_SIZE 512     /* size of the parameter name hash table, power of 2 */
 
 #define xavs2_param_match(x,y) (!strcasecmp(x,y))
 
@@ -97,115 +86,84 @@ enum MAP_TYPE {
  * mapping for config item
  */
 typedef struct mapping_t {
-    char    name[32];           /* name for configuration */
-    void    *addr;              /* memory address to store parameter value */
-    int     type;               /* type, string or number */
+    const char *name;           /* name for configuration */
+    size_t      offset;         /* offset in struct xavs2_param_t to store parameter value */
+    int         type;           /* type, string or number */
     const char *s_instruction;  /* instruction */
 } mapping_t;
 
-/* mapping table of supported parameters */
-typedef struct xavs2_param_map_t {
-    xavs2_param_t *param;
-    mapping_t      map_tab[MAP_TAB_SIZE];
-} xavs2_param_map_t;
-
-static xavs2_param_map_t g_param_map = {
-    NULL
-};
-
-/**
- * ---------------------------------------------------------------------------
- * Function   : set default values for encoding parameters
- * Parameters :
- *      [in ] : map_tab - mapping table
- *            : p       - pointer to struct xavs2_param_t
- *      [out] : none
- * Return     : none
- * ---------------------------------------------------------------------------
+/* ---------------------------------------------------------------------------
+ * mapping table of supported parameters, independent of any parameter instance
+ * token - token name
+ * var   - member of struct xavs2_param_t to store the value
+ * t     - type
+ * instr - instruction of parameter
  */
-static void
-mapping_default(xavs2_param_map_t *p_map_tab, xavs2_param_t *p)
-{
-    mapping_t * map_tab = p_map_tab->map_tab;
-    p_map_tab->param = p;
-    /* token - token name
-     * var   - store address
-     * t     - type
-     * instr - instruction of parameter
-     * */
-#define MAP(token, var, t, instr)\
-    REMOVE_WARNING\
-    if (strlen(token) > 0) {\
-        strcpy(map_tab[item_idx].name, (token));\
-        map_tab[item_idx].addr = (var);\
-        map_tab[item_idx].type = (t);\
-        map_tab[item_idx].s_instruction = (instr);\
-        item_idx++;\
-    } else {\
-        map_tab[item_idx].addr = NULL;\
-        map_tab[item_idx].type = MAP_END;\
-        map_tab[item_idx].s_instruction = "";\
-    }\
-    RESTORE_WARNING
-
-    int item_idx = 0;
+#define MAP(token, var, t, instr)   { (token), offsetof(xavs2_param_t, var), (t), (instr) },
 
+static const mapping_t g_param_map_tab[] = {
     /* input */
-    MAP("Width",                        &p->org_width,                  MAP_NUM, "Image width  in pixels");
-    MAP("SourceWidth",                  &p->org_width,                  MAP_NUM, "  - Same as `Width`");
-    MAP("Height",                       &p->org_height,                 MAP_NUM, "Image height in pixels");
-    MAP("SourceHeight",                 &p->org_height,                 MAP_NUM, "  - Same as `Height`");
-    MAP("Input",                        &p->psz_in_file,                MAP_STR, "Input sequence, YUV 4:2:0");
-    MAP("InputFile",                    &p->psz_in_file,                MAP_STR, "  - Same as `Input`");
-    MAP("InputHeaderLength",            &p->infile_header,              MAP_NUM, "If the inputfile has a header, state it's length in byte here ");
-    MAP("FrameRate",                    &p->frame_rate_code,            MAP_NUM, "FramerateCode, 1: 24000/1001,2: 24,3: 25(default), 4: 30000/1001,5: 30,6: 50,7: 60000/1001,8: 60");
-    MAP("fps",                          &p->frame_rate,                 MAP_FLOAT, "Framerate, AVS2 supported value: 23.976(24000/1001), 24.0, 25.0(default), 29.97(30000/1001), 30.0, 50.0, 59.94(60000/1001), 60.0");
-    MAP("ChromaFormat",                 &p->chroma_format,              MAP_NUM, "YUV format, 1=4:2:0 (default, the only supported format for the standard), 0=4:0:0, 2=4:2:2");
-    MAP("InputSampleBitDepth",          &p->input_sample_bit_depth,     MAP_NUM, "Sample Bitdepth of input file");
-    MAP("Frames",                       &p->num_frames,                 MAP_NUM, "Number of frames to be coded");
-    MAP("FramesToBeEncoded",            &p->num_frames,                 MAP_NUM, "  - Same as `Frames`");
+    MAP("Width",                        org_width,                      MAP_NUM, "Image width  in pixels")
+    MAP("SourceWidth",                  org_width,                      MAP_NUM, "  - Same as `Width`")
+    MAP("Height",                       org_height,                     MAP_NUM, "Image height in pixels")
+    MAP("SourceHeight",                 org_height,                     MAP_NUM, "  - Same as `Height`")
+    MAP("Input",                        psz_in_file,                    MAP_STR, "Input sequence, YUV 4:2:0")
+    MAP("InputFile",                    psz_in_file,                    MAP_STR, "  - Same as `Input`")
+    MAP("InputHeaderLength",            infile_header,                  MAP_NUM, "If the inputfile has a header, state it's length in byte here ")
+    MAP("FrameRate",                    frame_rate_code,                MAP_NUM, "FramerateCode, 1: 24000/1001,2: 24,3: 25(default), 4: 30000/1001,5: 30,6: 50,7: 60000/1001,8: 60")
+    MAP("fps",                          frame_rate,                     MAP_FLOAT, "Framerate, AVS2 supported value: 23.976(24000/1001), 24.0, 25.0(default), 29.97(30000/1001), 30.0, 50.0, 59.94(60000/1001), 60.0")
+    MAP("ChromaFormat",                 chroma_format,                  MAP_NUM, "YUV format, 1=4:2:0 (default, the only supported format for the standard), 0=4:0:0, 2=4:2:2")
+    MAP("InputSampleBitDepth",          input_sample_bit_depth,         MAP_NUM, "Sample Bitdepth of input file")
+    MAP("Frames",                       num_frames,                     MAP_NUM, "Number of frames to be coded")
+    MAP("FramesToBeEncoded",            num_frames,                     MAP_NUM, "  - Same as `Frames`")
 
     /* output */
-    MAP("output",                       &p->psz_bs_file,                MAP_STR, "Output bistream file path");
-    MAP("OutputFile",                   &p->psz_bs_file,                MAP_STR, "  - Same as `output`");
-    MAP("Recon",                        &p->psz_dump_yuv,               MAP_STR, "Output reconstruction YUV file path");
-    MAP("ReconFile",                    &p->psz_dump_yuv,               MAP_STR, "  - Same as `Recon`");
+    MAP("output",                       psz_bs_file,                    MAP_STR, "Output bistream file path")
+    MAP("OutputFile",                   psz_bs_file,                    MAP_STR, "  - Same as `output`")
+    MAP("Recon",                        psz_dump_yuv,                   MAP_STR, "Output reconstruction YUV file path")
+    MAP("ReconFile",                    psz_dump_yuv,                   MAP_STR, "  - Same as `Recon`")
 
     /* encoder configurations */
-    MAP("MaxSizeInBit",                 &p->lcu_bit_level,              MAP_NUM, "Maximum Coding Unit (CU) Size (4, 5, 6)");
-    MAP("MinSizeInBit",                 &p->scu_bit_level,              MAP_NUM, "Minimum Coding Unit (CU) Size (3, 4, 5, 6)");
-    MAP("ProfileID",                    &p->profile_id,                 MAP_NUM, "Profile ID (18: MAIN PICTURE profile, 32: MAIN profile, 34: MAIN10 profile)");
-    MAP("LevelID",                      &p->level_id,                   MAP_NUM, "Level ID   (16: 2.0;  32: 4.0;  34: 4.2;  64: 6.0;  66: 6.2)");
-    MAP("SampleBitDepth",               &p->sample_bit_depth,           MAP_NUM, "Encoding bit-depth");
-    MAP("IntraPeriodMax",               &p->intra_period_max,           MAP_NUM, "maximum intra-period, one I-frame mush appear in any NumMax of frames");
-    MAP("IntraPeriodMin",               &p->intra_period_min,           MAP_NUM, "minimum intra-period, only one I-frame can appear in at most NumMin of frames");
-    MAP("OpenGOP",                      &p->b_open_gop,                 MAP_NUM, "Open GOP or Closed GOP, 1: Open(default), 0: Closed");
-    MAP("UseHadamard",                  &p->enable_hadamard,            MAP_NUM, "Hadamard transform (0=not used, 1=used)");
-    MAP("FME",                          &p->me_method,                  MAP_NUM, "Motion Estimation method: 0-Full Search, 1-DIA, 2-HEX, 3-UMH (default), 4-TZ");
-    MAP("SearchRange",                  &p->search_range,               MAP_NUM, "Max search range");
-    MAP("NumberReferenceFrames",        &p->num_max_ref,                MAP_NUM, "Number of previous frames used for inter motion search (1-5)");
+    MAP("MaxSizeInBit",                 lcu_bit_level,                  MAP_NUM, "Maximum Coding Unit (CU) Size (4, 5, 6)")
+    MAP("MinSizeInBit",                 scu_bit_level,                  MAP_NUM, "Minimum Coding Unit (CU) Size (3, 4, 5, 6)")
+    MAP("ProfileID",                    profile_id,                     MAP_NUM, "Profile ID (18: MAIN PICTURE profile, 32: MAIN profile, 34: MAIN10 profile)")
+    MAP("LevelID",                      level_id,                       MAP_NUM, "Level ID   (16: 2.0;  32: 4.0;  34: 4.2;  64: 6.0;  66: 6.2)")
+    MAP("SampleBitDepth",               sample_bit_depth,               MAP_NUM, "Encoding bit-depth")
+    MAP("IntraPeriodMax",               intra_period_max,               MAP_NUM, "maximum intra-period, one I-frame mush appear in any NumMax of frames")
+    MAP("IntraPeriodMin",               intra_period_min,               MAP_NUM, "minimum intra-period, only one I-frame can appear in at most NumMin of frames")
+    MAP("SceneCut",                     scenecut_threshold,             MAP_NUM, "sensitivity of scene cut detection (1~100, e.g. 40), a cut at least `IntraPeriodMin` frames after the last I frame is coded as a key frame. 0: off (default)")
+    MAP("OpenGOP",                      b_open_gop,                     MAP_NUM, "Open GOP or Closed GOP, 1: Open(default), 0: Closed")
+    MAP("UseHadamard",                  enable_hadamard,                MAP_NUM, "Hadamard transform (0=not used, 1=used)")
+    MAP("IntraSatdX4",                  enable_intra_satd_x4,           MAP_NUM, "predict and compare the angular intra modes four at a time when UseHadamard is on. 1: on (default), 0: one by one")
+    MAP("FME",                          me_method,                      MAP_NUM, "Motion Estimation method: 0-Full Search, 1-DIA, 2-HEX, 3-UMH (default), 4-TZ, 5-SEA (successive elimination full search)")
+    MAP("SearchRange",                  search_range,                   MAP_NUM, "Max search range")
+    MAP("MEPyramidRange",               me_pyramid_range,               MAP_NUM, "search range (in pixels) of hierarchical ME on a downscaled luma pyramid, the coarse MVs are added as ME candidates. 0: off (default)")
+    MAP("MEMvReuse",                    me_mv_reuse,                    MAP_NUM, "reuse fullpel MVs of searched PUs in current LCU to seed and early terminate later searches (partitions, sub-CUs, references). 0: off (default)")
+    MAP("NumberReferenceFrames",        num_max_ref,                    MAP_NUM, "Number of previous frames used for inter motion search (1-5)")
 
 #if XAVS2_TRACE
-    MAP("TraceFile",                    &p->psz_trace_file,             MAP_STR, "Tracing file path");
+    MAP("TraceFile",                    psz_trace_file,                 MAP_STR, "Tracing file path")
 #endif
-    MAP("TemporalIdExistFlag",          &p->temporal_id_exist_flag,     MAP_NUM, "temporal ID");
-    MAP("FFRAMEEnable",                 &p->enable_f_frame,             MAP_NUM, "Use F Frame or not (0: Don't use F frames  1:Use F frames instead of P frames)");
-    MAP("DHPEnable",                    &p->enable_dhp,                 MAP_NUM, "(0: Don't use DHP,      1:Use DHP)");
-    MAP("MHPSKIPEnable",                &p->enable_mhp_skip,            MAP_NUM, "(0: Don't use MH_PSKIP, 1:Use MH_PSKIP)");
-    MAP("WSMEnable",                    &p->enable_wsm,                 MAP_NUM, "(0: Don't use WSM,      1:Use WSM)");
-    MAP("NumberBFrames",                &p->num_bframes,          MAP_NUM, "Number of B frames inserted between I/P/F frames (0=not used)");
-    MAP("Inter2PU" ,                    &p->inter_2pu,                  MAP_NUM, "inter partition mode 2NxN or Nx2N or AMP");
-    MAP("InterAMP",                     &p->enable_amp,                 MAP_NUM, "inter partition mode AMP");
-    MAP("IntraInInter",                 &p->enable_intra,               MAP_NUM, "intra partition in inter frame");
-    MAP("RdoLevel",                     &p->i_rd_level,                 MAP_NUM, "RD-optimized mode decision (0:off, 1: only for best partition mode of one CU, 2: only for best 2 partition modes; 3: All partition modes)");
-    MAP("LoopFilterDisable",            &p->loop_filter_disable,        MAP_NUM, "Disable loop filter in picture header (0=Filter, 1=No Filter)");
-    MAP("LoopFilterParameter",          &p->loop_filter_parameter_flag, MAP_NUM, "Send loop filter parameter (0= No parameter, 1= Send Parameter)");
-    MAP("LoopFilterAlphaOffset",        &p->alpha_c_offset,             MAP_NUM, "Aplha offset in loop filter");
-    MAP("LoopFilterBetaOffset",         &p->beta_offset,                MAP_NUM, "Beta offset in loop filter");
-    MAP("SAOEnable",                    &p->enable_sao,                 MAP_NUM, "Enable SAO or not (1: on, 0: off)");
-    MAP("ALFEnable",                    &p->enable_alf,                 MAP_NUM, "Enable ALF or not (1: on, 0: off)");
-    MAP("ALFLowLatencyEncodingEnable",  &p->alf_LowLatencyEncoding,     MAP_NUM, "Enable Low Latency ALF (1=Low Latency mode, 0=High Efficiency mode)");
-    MAP("CrossSliceLoopFilter",         &p->b_cross_slice_loop_filter,  MAP_NUM, "Enable Cross Slice Boundary Filter (0=Disable, 1=Enable)");
+    MAP("TemporalIdExistFlag",          temporal_id_exist_flag,         MAP_NUM, "temporal ID")
+    MAP("FFRAMEEnable",                 enable_f_frame,                 MAP_NUM, "Use F Frame or not (0: Don't use F frames  1:Use F frames instead of P frames)")
+    MAP("DHPEnable",                    enable_dhp,                     MAP_NUM, "(0: Don't use DHP,      1:Use DHP)")
+    MAP("MHPSKIPEnable",                enable_mhp_skip,                MAP_NUM, "(0: Don't use MH_PSKIP, 1:Use MH_PSKIP)")
+    MAP("WSMEnable",                    enable_wsm,                     MAP_NUM, "(0: Don't use WSM,      1:Use WSM)")
+    MAP("NumberBFrames",                num_bframes,              MAP_NUM, "Number of B frames inserted between I/P/F frames (0=not used)")
+    MAP("Inter2PU" ,                    inter_2pu,                  MAP_NUM, "inter partition mode 2NxN or Nx2N or AMP")
+    MAP("InterAMP",                     enable_amp,                     MAP_NUM, "inter partition mode AMP")
+    MAP("IntraInInter",                 enable_intra,                   MAP_NUM, "intra partition in inter frame")
+    MAP("RdoLevel",                     i_rd_level,                     MAP_NUM, "RD-optimized mode decision (0:off, 1: only for best partition mode of one CU, 2: only for best 2 partition modes; 3: All partition modes)")
+    MAP("RdoBitEstMethod",              rdo_bit_est_method,             MAP_NUM, "bit estimation of RDO (0: AEC with context update, 1: AEC without context update, 2: VLC, 3: fractional bits from a table), default: set by the preset")
+    MAP("LoopFilterDisable",            loop_filter_disable,            MAP_NUM, "Disable loop filter in picture header (0=Filter, 1=No Filter)")
+    MAP("LoopFilterParameter",          loop_filter_parameter_flag,     MAP_NUM, "Send loop filter parameter (0= No parameter, 1= Send Parameter)")
+    MAP("LoopFilterAlphaOffset",        alpha_c_offset,                 MAP_NUM, "Aplha offset in loop filter")
+    MAP("LoopFilterBetaOffset",         beta_offset,                    MAP_NUM, "Beta offset in loop filter")
+    MAP("SAOEnable",                    enable_sao,                     MAP_NUM, "Enable SAO or not (1: on, 0: off)")
+    MAP("SAOBeforeDeblock",             b_sao_before_deblock,           MAP_FLAG, "Collect SAO statistics of one LCU before it is deblocked (1: on, 0: off)")
+    MAP("ALFEnable",                    enable_alf,                     MAP_NUM, "Enable ALF or not (1: on, 0: off)")
+    MAP("ALFLowLatencyEncodingEnable",  alf_LowLatencyEncoding,         MAP_NUM, "Enable Low Latency ALF (1=Low Latency mode, 0=High Efficiency mode)")
+    MAP("CrossSliceLoopFilter",         b_cross_slice_loop_filter,      MAP_NUM, "Enable Cross Slice Boundary Filter (0=Disable, 1=Enable)")
 
     /*  */
     // MAP("InterlaceCodingOption",        &p->InterlaceCodingOption,      MAP_NUM);
@@ -220,61 +178,74 @@ mapping_default(xavs2_param_map_t *p_map_tab, xavs2_param_t *p)
     // MAP("ViewPackingMode",              &p->view_packing_mode,          MAP_NUM);
     // MAP("ViewReverse",                  &p->view_reverse,               MAP_NUM);
 
-    MAP("WQEnable",                     &p->enable_wquant,              MAP_NUM, "Weighted quantization");
+    MAP("WQEnable",                     enable_wquant,                  MAP_NUM, "Weighted quantization")
 #if XAVS2_TRACE && ENABLE_WQUANT
-    MAP("SeqWQM",                       &p->SeqWQM,                     MAP_NUM);
-    MAP("SeqWQFile",                    &p->psz_seq_wq_file,            MAP_STR);
-    MAP("PicWQEnable",                  &p->PicWQEnable,                MAP_NUM);
-    MAP("WQParam",                      &p->WQParam,                    MAP_NUM);
-    MAP("WQModel",                      &p->WQModel,                    MAP_NUM);
-    MAP("WeightParamDetailed",          &p->WeightParamDetailed,        MAP_STR);
-    MAP("WeightParamUnDetailed",        &p->WeightParamUnDetailed,      MAP_STR);
-    MAP("ChromaDeltaQPDisable",         &p->chroma_quant_param_disable, MAP_NUM);
-    MAP("ChromaDeltaU",                 &p->chroma_quant_param_delta_u, MAP_NUM);
-    MAP("ChromaDeltaV",                 &p->chroma_quant_param_delta_v, MAP_NUM);
-    MAP("PicWQDataIndex",               &p->PicWQDataIndex,             MAP_NUM);
-    MAP("PicWQFile",                    &p->psz_pic_wq_file,            MAP_STR);
+    MAP("SeqWQM",                       SeqWQM,                         MAP_NUM)
+    MAP("SeqWQFile",                    psz_seq_wq_file,                MAP_STR)
+    MAP("PicWQEnable",                  PicWQEnable,                    MAP_NUM)
+    MAP("WQParam",                      WQParam,                        MAP_NUM)
+    MAP("WQModel",                      WQModel,                        MAP_NUM)
+    MAP("WeightParamDetailed",          WeightParamDetailed,            MAP_STR)
+    MAP("WeightParamUnDetailed",        WeightParamUnDetailed,          MAP_STR)
+    MAP("ChromaDeltaQPDisable",         chroma_quant_param_disable,     MAP_NUM)
+    MAP("ChromaDeltaU",                 chroma_quant_param_delta_u,     MAP_NUM)
+    MAP("ChromaDeltaV",                 chroma_quant_param_delta_v,     MAP_NUM)
+    MAP("PicWQDataIndex",               PicWQDataIndex,                 MAP_NUM)
+    MAP("PicWQFile",                    psz_pic_wq_file,                MAP_STR)
 #endif
 
-    MAP("RdoqLevel",                    &p->i_rdoq_level,               MAP_NUM, "Rdoq Level (0: off, 1: cu level, only for best partition mode, 2: all mode)");
-    MAP("LambdaFactor",                 &p->lambda_factor_rdoq,         MAP_NUM, "default: 75,  Rdoq Lambda factor");
-    MAP("LambdaFactorP",                &p->lambda_factor_rdoq_p,       MAP_NUM, "default: 120, Rdoq Lambda factor P/F frame");
-    MAP("LambdaFactorB",                &p->lambda_factor_rdoq_b,       MAP_NUM, "default: 100, Rdoq Lambda factor B frame");
-
-    MAP("PMVREnable",                   &p->enable_pmvr,                MAP_NUM, "PMVR");
-    MAP("NSQT",                         &p->enable_nsqt,                MAP_NUM, "NSQT");
-    MAP("SDIP",                         &p->enable_sdip,                MAP_NUM, "SDIP");
-    MAP("SECTEnable",                   &p->enable_secT,                MAP_NUM, "Secondary Transform");
-    MAP("TDRDOEnable",                  &p->enable_tdrdo,               MAP_NUM, "TDRDO, only for LDP configuration (without B frames)");
-    MAP("RefineQP",                     &p->enable_refine_qp,           MAP_NUM, "Refined QP, only for RA configuration (with B frames)");
-
-    MAP("RateControl",                  &p->i_rc_method,                MAP_NUM, "0: CQP, 1: CBR (frame level), 2: CBR (SCU level), 3: VBR");
-    MAP("TargetBitRate",                &p->i_target_bitrate,           MAP_NUM, "target bitrate, in bps");
-    MAP("QP",                           &p->i_initial_qp,               MAP_NUM, "initial qp for first frame (8bit: 0~63; 10bit: 0~79)");
-    MAP("InitialQP",                    &p->i_initial_qp,               MAP_NUM, "  - Same as `QP`");
-    MAP("QPIFrame",                     &p->i_initial_qp,               MAP_NUM, "  - Same as `QP`");
-    MAP("MinQP",                        &p->i_min_qp,                   MAP_NUM, "min qp (8bit: 0~63; 10bit: 0~79)");
-    MAP("MaxQP",                        &p->i_max_qp,                   MAP_NUM, "max qp (8bit: 0~63; 10bit: 0~79)");
-
-    MAP("GopSize",                      &p->i_gop_size,                 MAP_NUM, "sub GOP size (negative numbers indicating an employ of default settings, which will invliadate the following settings.)");
-    MAP("PresetLevel",                  &p->preset_level,               MAP_NUM, "preset level for tradeoff between speed and performance, ordered from fastest to slowest (0, ..., 9), default: 5");
-    MAP("Preset",                       &p->preset_level,               MAP_NUM, "  - Same as `PresetLevel`");
-
-    MAP("SliceNum",                     &p->slice_num,                  MAP_NUM, "Number of slices for each frame");
-
-    MAP("NumParallelGop",               &p->num_parallel_gop,           MAP_NUM, "number of parallel GOPs (0,1: no GOP parallelization)");
-    MAP("ThreadFrames",                 &p->i_frame_threads,            MAP_NUM, "number of parallel threads for frames ( 0: auto )");
-    MAP("ThreadRows",                   &p->i_lcurow_threads,           MAP_NUM, "number of parallel threads for rows   ( 0: auto )");
-    MAP("EnableAecThread",              &p->enable_aec_thread,          MAP_NUM, "Enable AEC thread or not (default: enabled)");
-
-    MAP("LogLevel",                     &p->i_log_level,                MAP_NUM, "log level: -1: none, 0: error, 1: warning, 2: info, 3: debug");
-    MAP("Log",                          &p->i_log_level,                MAP_NUM, "  - Same as `LogLevel`");
-    MAP("EnablePSNR",                   &p->enable_psnr,                MAP_NUM, "Enable PSNR or not (default: Enable)");
-    MAP("EnableSSIM",                   &p->enable_ssim,                MAP_NUM, "Enable SSIM or not (default: Disabled)");
+    MAP("RdoqLevel",                    i_rdoq_level,                   MAP_NUM, "Rdoq Level (0: off, 1: cu level, only for best partition mode, 2: all mode)")
+    MAP("LambdaFactor",                 lambda_factor_rdoq,             MAP_NUM, "default: 75,  Rdoq Lambda factor")
+    MAP("LambdaFactorP",                lambda_factor_rdoq_p,           MAP_NUM, "default: 120, Rdoq Lambda factor P/F frame")
+    MAP("LambdaFactorB",                lambda_factor_rdoq_b,           MAP_NUM, "default: 100, Rdoq Lambda factor B frame")
+
+    MAP("PMVREnable",                   enable_pmvr,                    MAP_NUM, "PMVR")
+    MAP("NSQT",                         enable_nsqt,                    MAP_NUM, "NSQT")
+    MAP("SDIP",                         enable_sdip,                    MAP_NUM, "SDIP")
+    MAP("SECTEnable",                   enable_secT,                    MAP_NUM, "Secondary Transform")
+    MAP("TDRDOEnable",                  enable_tdrdo,                   MAP_NUM, "TDRDO, only for LDP configuration (without B frames)")
+    MAP("RefineQP",                     enable_refine_qp,               MAP_NUM, "Refined QP, only for RA configuration (with B frames)")
+
+    MAP("RateControl",                  i_rc_method,                    MAP_NUM, "0: CQP, 1: CBR (frame level), 2: CBR (SCU level), 3: VBR, 4: CRF (constant quality)")
+    MAP("TargetBitRate",                i_target_bitrate,               MAP_NUM, "target bitrate, in bps")
+    MAP("CRF",                          f_rate_factor,                  MAP_FLOAT, "rate factor of CRF (RateControl=4), QP of frames with average complexity, same range as `QP`. default: `QP`")
+    MAP("Pass",                         i_rc_pass,                      MAP_NUM, "multi-pass rate control, 0: one pass (default), 1: first pass with the fastest preset at `QP`, writes `StatsFile`, 2: second pass, reads `StatsFile` to hit `TargetBitRate` over the whole sequence")
+    MAP("StatsFile",                    psz_stats_file,                 MAP_STR, "stats file of multi-pass rate control, default: xavs2_stats.log")
+    MAP("QP",                           i_initial_qp,                   MAP_NUM, "initial qp for first frame (8bit: 0~63; 10bit: 0~79)")
+    MAP("InitialQP",                    i_initial_qp,                   MAP_NUM, "  - Same as `QP`")
+    MAP("QPIFrame",                     i_initial_qp,                   MAP_NUM, "  - Same as `QP`")
+    MAP("MinQP",                        i_min_qp,                       MAP_NUM, "min qp (8bit: 0~63; 10bit: 0~79)")
+    MAP("MaxQP",                        i_max_qp,                       MAP_NUM, "max qp (8bit: 0~63; 10bit: 0~79)")
+    MAP("AQMode",                       i_aq_mode,                      MAP_NUM, "adaptive quantization, 0: off (default), 1: QP offsets of LCUs decided by the variance of luma, flat areas get lower QPs")
+    MAP("AQStrength",                   f_aq_strength,                  MAP_FLOAT, "strength of adaptive quantization (AQMode=1), default: 1.0")
+
+    MAP("GopSize",                      i_gop_size,                     MAP_NUM, "sub GOP size (negative numbers indicating an employ of default settings, which will invliadate the following settings.)")
+    MAP("PresetLevel",                  preset_level,                   MAP_NUM, "preset level for tradeoff between speed and performance, ordered from fastest to slowest (0, ..., 9), default: 5")
+    MAP("Preset",                       preset_level,                   MAP_NUM, "  - Same as `PresetLevel`")
+    MAP("SpeedControlFps",              speed_ctrl_fps,                 MAP_FLOAT, "target encoding speed (fps) of adaptive speed control, fast algorithms are switched to faster levels (never slower than `Preset`) to hold it. 0: off (default)")
+
+    MAP("SliceNum",                     slice_num,                      MAP_NUM, "Number of slices for each frame")
+
+    MAP("NumParallelGop",               num_parallel_gop,               MAP_NUM, "number of parallel GOPs (0,1: no GOP parallelization)")
+    MAP("ThreadFrames",                 i_frame_threads,                MAP_NUM, "number of parallel threads for frames ( 0: auto )")
+    MAP("ThreadRows",                   i_lcurow_threads,               MAP_NUM, "number of parallel threads for rows   ( 0: auto )")
+    MAP("EnableAecThread",              enable_aec_thread,              MAP_NUM, "Enable AEC thread or not (default: enabled)")
+    MAP("HugePages",                    hugepage_mode,                  MAP_NUM, "Back large buffers with 2MB pages. 0: off (default), 1: transparent huge pages, 2: explicit huge pages (MAP_HUGETLB)")
+    MAP("NumaNode",                     numa_node,                      MAP_NUM, "NUMA node for the memory and threads of the encoder. -1: no binding (default)")
+    MAP("ParallelCTU",                  enable_parallel_ctu,            MAP_NUM, "Evaluate the split and non-split candidates of 64x64/32x32 CUs concurrently on extra threads, for low-latency encoding with few LCU rows. 0: off (default)")
+    MAP("LoopFilterWavefront",          enable_lf_wavefront,            MAP_NUM, "Run deblocking and SAO of each LCU row as a task trailing the RDO of the row, so rows start without waiting for the loop filter (needs ThreadRows > 1). 0: off (default)")
+    MAP("LeanMemory",                   enable_lean_memory,             MAP_NUM, "Reduce memory footprint: input frames sized by pipeline depth, row-scope interpolation buffers. 0: off (default)")
+
+    MAP("LogLevel",                     i_log_level,                    MAP_NUM, "log level: -1: none, 0: error, 1: warning, 2: info, 3: debug")
+    MAP("Log",                          i_log_level,                    MAP_NUM, "  - Same as `LogLevel`")
+    MAP("EnablePSNR",                   enable_psnr,                    MAP_NUM, "Enable PSNR or not (default: Enable)")
+    MAP("EnableSSIM",                   enable_ssim,                    MAP_NUM, "Enable SSIM or not (default: Disabled)")
 
     /* end mapping */
-    MAP("", NULL, MAP_END, "")
-}
+    { "", 0, MAP_END, "" }
+};
+
+#undef MAP
 
 
 /**
@@ -418,22 +389,85 @@ static intptr_t ParseRefContent(xavs2_param_t *param, char **buf)
 }
 
 /* ---------------------------------------------------------------------------
+ * hash table of parameter names: index + 1 into g_param_map_tab, 0 for empty
+ */
+static int16_t      g_param_hash_tab[PARAM_HASH_SIZE];
+static int          g_b_param_hash_ready = 0;
+
+/* ---------------------------------------------------------------------------
+ * case-insensitive FNV-1a hash of a parameter name
  */
 static INLINE
-int ParameterNameToMapIndex(xavs2_param_map_t *p_map_tab, const char *param_name)
+uint32_t param_name_hash(const char *name)
 {
-    mapping_t *map_tab = p_map_tab->map_tab;
-    int i = 0;
+    uint32_t hash = 2166136261u;
 
-    while (map_tab[i].name[0] != '\0') {  // ֹλǿַ
-        if (xavs2_param_match(map_tab[i].name, param_name)) {
-            return i;
-        } else {
-            i++;
+    for (; *name != '\0'; name++) {
+        int c = *name;
+        c = (c >= 'A' && c <= 'Z') ? (c + 'a' - 'A') : c;
+        hash = (hash ^ (uint32_t)c) * 16777619u;
+    }
+
+    return hash;
+}
+
+/* ---------------------------------------------------------------------------
+ * build the hash table once, the first name of duplicates wins (as the linear search)
+ */
+static void param_hash_init(void)
+{
+    int i;
+
+    if (xavs2_atomic_load_acquire(&g_b_param_hash_ready)) {
+        return;
+    }
+
+    xavs2_init_lock();
+    if (g_b_param_hash_ready) {
+        xavs2_init_unlock();
+        return;
+    }
+
+    for (i = 0; g_param_map_tab[i].name[0] != '\0'; i++) {
+        uint32_t pos = param_name_hash(g_param_map_tab[i].name) & (PARAM_HASH_SIZE - 1);
+
+        for (;;) {
+            int idx = g_param_hash_tab[pos] - 1;
+
+            if (idx < 0) {
+                g_param_hash_tab[pos] = (int16_t)(i + 1);
+                break;
+            } else if (xavs2_param_match(g_param_map_tab[idx].name, g_param_map_tab[i].name)) {
+                break;  /* a duplicate name */
+            }
+            pos = (pos + 1) & (PARAM_HASH_SIZE - 1);
         }
     }
 
-    return -1;
+    xavs2_atomic_store_release(&g_b_param_hash_ready, 1);
+    xavs2_init_unlock();
+}
+
+/* ---------------------------------------------------------------------------
+ * find a parameter by name in g_param_map_tab, return -1 if not found
+ */
+static INLINE
+int param_hash_lookup(const char *param_name)
+{
+    uint32_t pos = param_name_hash(param_name) & (PARAM_HASH_SIZE - 1);
+
+    param_hash_init();
+
+    for (;;) {
+        int idx = g_param_hash_tab[pos] - 1;
+
+        if (idx < 0) {
+            return -1;
+        } else if (xavs2_param_match(g_param_map_tab[idx].name, param_name)) {
+            return idx;
+        }
+        pos = (pos + 1) & (PARAM_HASH_SIZE - 1);
+    }
 }
 
 /* ---------------------------------------------------------------------------
@@ -637,10 +671,6 @@ xavs2_encoder_opt_set(xavs2_param_t *param, int argc, char *argv[])
     p = contents;
     bufend = &contents[strlen(contents)];
 
-    /* alloc memory for mapping table and initialize the table */
-    memset(&g_param_map, 0, sizeof(g_param_map));
-    mapping_default(&g_param_map, param);
-
     /* generate an argc/argv-type list in items[], without comments and whitespace.
      * this is context insensitive and could be done most easily with lex(1). */
     while (p < bufend) {
@@ -738,17 +768,13 @@ xavs2_encoder_opt_set2(xavs2_param_t *param, const char *name, const char *value
     int map_index;
     int b_error = 0;
 
-    if (g_param_map.param != param) {
-        /* alloc memory for mapping table and initialize the table */
-        memset(&g_param_map, 0, sizeof(g_param_map));
-        mapping_default(&g_param_map, param);
-    }
-
-    if ((map_index = ParameterNameToMapIndex(&g_param_map, name)) >= 0) {
+    if ((map_index = param_hash_lookup(name)) >= 0) {
+        const mapping_t *p_map = &g_param_map_tab[map_index];
+        uint8_t *addr = (uint8_t *)param + p_map->offset;   /* address of the parameter value */
         int item_value;
         float val_float;
 
-        switch (g_param_map.map_tab[map_index].type) {
+        switch (p_map->type) {
         case MAP_NUM:   // numerical
             item_value = xavs2e_atoi(value_string, &b_error);
             if (b_error) {
@@ -756,7 +782,7 @@ xavs2_encoder_opt_set2(xavs2_param_t *param, const char *name, const char *value
                           name, value_string);
                 return -1;
             }
-            *(int *)(g_param_map.map_tab[map_index].addr) = item_value;
+            *(int *)addr = item_value;
             if (xavs2_param_match(name, "preset_level") || xavs2_param_match(name, "presetlevel") || xavs2_param_match(name, "preset")) {
                 parse_preset_level(param, param->preset_level);
             }
@@ -778,7 +804,7 @@ xavs2_encoder_opt_set2(xavs2_param_t *param, const char *name, const char *value
                           name, value_string);
                 return -1;
             }
-            *(float *)(g_param_map.map_tab[map_index].addr) = val_float;
+            *(float *)addr = val_float;
             break;
         case MAP_FLAG:
             item_value = xavs2e_atoi(value_string, &b_error);
@@ -787,11 +813,11 @@ xavs2_encoder_opt_set2(xavs2_param_t *param, const char *name, const char *value
                           name, value_string);
                 return -1;
             }
-            *(bool_t *)(g_param_map.map_tab[map_index].addr) = (bool_t)(!!item_value);
+            *(bool_t *)addr = (bool_t)(!!item_value);
             // fprintf(stdout, ".");
             break;
         case MAP_STR:   // string
-            strcpy((char *)g_param_map.map_tab[map_index].addr, value_string);
+            strcpy((char *)addr, value_string);
             // fprintf(stdout, ".");
             break;
         default:
@@ -873,19 +899,11 @@ xavs2_encoder_opt_get(xavs2_param_t *param, const char *name)
 void
 xavs2_encoder_opt_help(void)
 {
-    mapping_t *p_map = NULL;
-    xavs2_param_t param;
+    const mapping_t *p_map = g_param_map_tab;
     xavs2_log(NULL, XAVS2_LOG_INFO, "Usage:\n\t [-f EncoderFile.cfg] [-p ParameterName=Value] [--ParameterName=value]\n");
     xavs2_log(NULL, XAVS2_LOG_INFO, "Supported parameters:\n");
 
-    memset(&g_param_map, 0, sizeof(g_param_map));
-    mapping_default(&g_param_map, &param);
-
-    p_map = g_param_map.map_tab;
-    while (p_map != NULL) {
-        if (p_map->addr == NULL) {
-            break;
-        }
+    while (p_map->type != MAP_END) {
 
         xavs2_log(NULL, XAVS2_LOG_INFO, "    %-20s : %s\n", p_map->name, p_map->s_instruction);
         p_map++;
@@ -45,6 +45,238 @@
 #include "presets.h"
 #include "rps.h"
 
+/* ---------------------------------------------------------------------------
+ * scene cut detection, conducted incrementally on each input frame: the
+ * thumbnail (8x8 block means of luma) of the frame is compared with the one
+ * of the previous input frame. A cut is detected when their SAD rises far
+ * above the average SAD of the current scene and the histograms of the two
+ * thumbnails differ significantly.
+ * return 1 if the frame starts a new scene and may be coded as a key frame
+ */
+static
+int lookahead_scenecut_analyse(xavs2_handler_t *h_mgr, xavs2_frame_t *frm)
+{
+    lookahead_t *lookahead     = &h_mgr->lookahead;
+    const xavs2_param_t *param = h_mgr->param;
+    const int i_src     = frm->i_stride[0];
+    const int shift     = (SCENECUT_BLOCK_BITS << 1) + (param->sample_bit_depth - 8);
+    const int add       = 1 << (shift - 1);
+    const int w         = XAVS2_MIN(lookahead->i_thumb_width,  frm->i_width[0] >> SCENECUT_BLOCK_BITS);
+    const int h         = XAVS2_MIN(lookahead->i_thumb_height, frm->i_lines[0] >> SCENECUT_BLOCK_BITS);
+    const int num_blk   = w * h;
+    const int sensitivity = param->scenecut_threshold;
+    uint8_t *thumb      = lookahead->thumb[lookahead->i_thumb_cur];
+    uint8_t *thumb_prev = lookahead->thumb[!lookahead->i_thumb_cur];
+    int     *hist       = lookahead->hist[lookahead->i_thumb_cur];
+    int     *hist_prev  = lookahead->hist[!lookahead->i_thumb_cur];
+    int b_scenecut = 0;
+    int bx, by, i, j;
+
+    if (sensitivity <= 0 || num_blk <= 0) {
+        return 0;
+    }
+
+    /* thumbnail and its histogram */
+    memset(hist, 0, SCENECUT_HIST_BINS * sizeof(int));
+    for (by = 0; by < h; by++) {
+        const pel_t *p_src = frm->planes[0] + (by << SCENECUT_BLOCK_BITS) * i_src;
+
+        for (bx = 0; bx < w; bx++) {
+            const pel_t *p_blk = p_src + (bx << SCENECUT_BLOCK_BITS);
+            int sum = 0;
+
+            for (i = 0; i < (1 << SCENECUT_BLOCK_BITS); i++) {
+                for (j = 0; j < (1 << SCENECUT_BLOCK_BITS); j++) {
+                    sum += p_blk[j];
+                }
+                p_blk += i_src;
+            }
+            sum = XAVS2_MIN(255, (sum + add) >> shift);
+            thumb[by * w + bx] = (uint8_t)sum;
+            hist[sum * SCENECUT_HIST_BINS >> 8]++;
+        }
+    }
+
+    if (lookahead->b_thumb_valid) {
+        /* a higher sensitivity lowers both thresholds */
+        double f_sad_ratio  = 1.0 + (100 - sensitivity) / 20.0;
+        double f_hist_thres = (100 - sensitivity) / 600.0;
+        double f_sad;
+        int sad  = 0;
+        int diff = 0;
+
+        for (i = 0; i < num_blk; i++) {
+            sad += XAVS2_ABS(thumb[i] - thumb_prev[i]);
+        }
+        for (i = 0; i < SCENECUT_HIST_BINS; i++) {
+            diff += XAVS2_ABS(hist[i] - hist_prev[i]);
+        }
+        f_sad = (double)sad / num_blk;
+
+        b_scenecut = lookahead->f_sad_avg > 0 &&
+                     f_sad > f_sad_ratio * lookahead->f_sad_avg &&
+                     f_sad >= SCENECUT_MIN_SAD &&
+                     diff > f_hist_thres * 2 * num_blk;
+
+        /* the average SAD restarts with the new scene */
+        if (b_scenecut) {
+            lookahead->f_sad_avg = 0;
+        } else if (lookahead->f_sad_avg > 0) {
+            lookahead->f_sad_avg = (3 * lookahead->f_sad_avg + f_sad) * 0.25;
+        } else {
+            lookahead->f_sad_avg = XAVS2_MAX(f_sad, 0.5);
+        }
+    }
+    lookahead->b_thumb_valid = 1;
+    lookahead->i_thumb_cur   = !lookahead->i_thumb_cur;
+
+    /* a key frame is inserted only at least IntraPeriodMin frames after the last one */
+    if (b_scenecut) {
+        if (!lookahead->start || param->intra_period_max == 1 ||
+            lookahead->gopframes < param->intra_period_min) {
+            b_scenecut = 0;
+        } else {
+            xavs2_log(NULL, XAVS2_LOG_DEBUG, "scene cut: POC %d\n", frm->i_frame);
+        }
+    }
+
+    return b_scenecut;
+}
+
+/* ---------------------------------------------------------------------------
+ * adaptive quantization: QP offsets of LCUs decided by the activity of luma.
+ * The activity of an LCU is the average log2 variance of its 8x8 blocks, an
+ * LCU gets one QP lower per halving of its activity below the average of the
+ * frame (and higher above it), scaled by AQStrength. Flat areas, which band
+ * at coarse quantization, are thus coded with finer steps than textures
+ */
+static
+void lookahead_aq_analyse(xavs2_handler_t *h_mgr, xavs2_frame_t *frm)
+{
+    const xavs2_t       *h     = h_mgr->p_coder;
+    const xavs2_param_t *param = h_mgr->param;
+    var_funcs_t var_8x8 = g_funcs.pixf.varf[B8X8_IN_BIT - MIN_CU_SIZE_IN_BIT];
+    float *activity     = h_mgr->lookahead.aq_activity;
+    const int i_src     = frm->i_stride[0];
+    const int w_in_blk  = frm->i_width[0] >> B8X8_IN_BIT;
+    const int h_in_blk  = frm->i_lines[0] >> B8X8_IN_BIT;
+    const int lcu_bits  = h->i_lcu_level - B8X8_IN_BIT;    /* LCU size in 8x8 blocks */
+    const int shift     = B8X8_IN_BIT * 2 + (param->sample_bit_depth - 8) * 2;
+    const int max_offset = XAVS2_MIN(AQ_MAX_QP_OFFSET, param->i_max_qp - param->i_min_qp);
+    double f_frm_act = 0;
+    int num_lcu = 0;
+    int lcu_x, lcu_y, bx, by, i;
+
+    /* activities of LCUs */
+    for (lcu_y = 0; lcu_y < h->i_height_in_lcu; lcu_y++) {
+        for (lcu_x = 0; lcu_x < h->i_width_in_lcu; lcu_x++) {
+            const int bx_end = XAVS2_MIN((lcu_x + 1) << lcu_bits, w_in_blk);
+            const int by_end = XAVS2_MIN((lcu_y + 1) << lcu_bits, h_in_blk);
+            float f_act = 0;
+            int num_blk = 0;
+
+            for (by = lcu_y << lcu_bits; by < by_end; by++) {
+                pel_t *p_src = frm->planes[0] + (by << B8X8_IN_BIT) * i_src;
+                for (bx = lcu_x << lcu_bits; bx < bx_end; bx++) {
+                    /* variance per pixel on 8-bit scale */
+                    uint32_t var = (uint32_t)(var_8x8(p_src + (bx << B8X8_IN_BIT), i_src, 8) >> shift);
+                    f_act += log2f((float)(var + 1));
+                    num_blk++;
+                }
+            }
+
+            if (num_blk > 0) {
+                f_act /= num_blk;
+                f_frm_act += f_act;
+                num_lcu++;
+            } else {
+                f_act = -1;     /* no complete 8x8 block in the LCU */
+            }
+            activity[lcu_y * h->i_width_in_lcu + lcu_x] = f_act;
+        }
+    }
+
+    /* QP offsets relative to the average activity */
+    f_frm_act = num_lcu > 0 ? f_frm_act / num_lcu : 0;
+    for (i = 0; i < h->i_width_in_lcu * h->i_height_in_lcu; i++) {
+        int i_offset = 0;
+
+        if (activity[i] >= 0) {
+            double f_offset = param->f_aq_strength * (activity[i] - f_frm_act);
+            i_offset = (int)floor(f_offset + 0.5);
+            i_offset = XAVS2_CLIP3(-max_offset, max_offset, i_offset);
+        }
+        frm->aq_qp_offset[i] = (int8_t)i_offset;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * frame costs for the stats of the first pass, on the half-size luma of the
+ * input frames: the intra cost of an 8x8 block is its SATD to the DC of the
+ * top and left neighbours, the inter cost its SATD to the co-located block of
+ * the previous input frame, at most the intra cost. Both are per pixel of the
+ * half-size plane (8-bit scale), the inter cost of the first frame is -1
+ */
+static
+void lookahead_cost_analyse(xavs2_handler_t *h_mgr, xavs2_frame_t *frm)
+{
+    lookahead_t  *lookahead = &h_mgr->lookahead;
+    frm_lowres_t *cur       = &lookahead->lowres[lookahead->i_lowres_cur];
+    frm_lowres_t *prev      = &lookahead->lowres[!lookahead->i_lowres_cur];
+    pixel_cmp_t satd_8x8    = g_funcs.pixf.satd[LUMA_8x8];
+    const int bit_depth     = h_mgr->param->sample_bit_depth;
+    const int i_cur         = cur->i_stride;
+    const int w_in_blk      = cur->i_width >> 3;
+    const int h_in_blk      = cur->i_lines >> 3;
+    const int num_pixels    = XAVS2_MAX(w_in_blk * h_in_blk, 1) << 6;
+    ALIGN16(pel_t pred[8 * 8]);
+    int64_t sum_intra = 0;
+    int64_t sum_inter = 0;
+    int bx, by, i;
+
+    g_funcs.lowres_filter(frm->planes[0], frm->i_stride[0], cur->filtered, i_cur, cur->i_width, cur->i_lines);
+
+    for (by = 0; by < h_in_blk; by++) {
+        for (bx = 0; bx < w_in_blk; bx++) {
+            const int offset = (by << 3) * i_cur + (bx << 3);
+            pel_t *p_blk = cur->filtered + offset;
+            int dc  = 0;
+            int num = 0;
+            int icost;
+
+            if (by > 0) {
+                for (i = 0; i < 8; i++) {
+                    dc += p_blk[i - i_cur];
+                }
+                num += 8;
+            }
+            if (bx > 0) {
+                for (i = 0; i < 8; i++) {
+                    dc += p_blk[i * i_cur - 1];
+                }
+                num += 8;
+            }
+            dc = num > 0 ? (dc + (num >> 1)) / num : 1 << (bit_depth - 1);
+            for (i = 0; i < 8 * 8; i++) {
+                pred[i] = (pel_t)dc;
+            }
+
+            icost = satd_8x8(p_blk, i_cur, pred, 8);
+            sum_intra += icost;
+            if (lookahead->b_lowres_valid) {
+                int pcost = satd_8x8(p_blk, i_cur, prev->filtered + offset, prev->i_stride);
+                sum_inter += XAVS2_MIN(icost, pcost);
+            }
+        }
+    }
+
+    frm->f_rc_cost[0] = (float)((double)sum_intra / num_pixels / (1 << (bit_depth - 8)));
+    frm->f_rc_cost[1] = lookahead->b_lowres_valid ? (float)((double)sum_inter / num_pixels / (1 << (bit_depth - 8))) : -1.0f;
+
+    lookahead->b_lowres_valid = 1;
+    lookahead->i_lowres_cur   = !lookahead->i_lowres_cur;
+}
+
 /* ---------------------------------------------------------------------------
  */
 static
@@ -61,9 +293,14 @@ int slice_type_analyse(xavs2_handler_t *h_mgr, xavs2_frame_t *frm)
      *
      */
     lookahead_t *lookahead     = &h_mgr->lookahead;
-    const xavs2_param_t *param = h_mgr->p_coder->param;
+    const xavs2_param_t *param = h_mgr->param;
     int b_delayed = 0;            // the frame is normal to be encoded default
 
+    /* a scene cut restarts the GOP structure with a key frame */
+    if (frm->b_scenecut) {
+        lookahead->start = 0;
+    }
+
     /* slice type decision */
     if (lookahead->start) {
         int p_frm_type = param->enable_f_frame ? XAVS2_TYPE_F : XAVS2_TYPE_P;
@@ -120,6 +357,19 @@ int slice_type_analyse(xavs2_handler_t *h_mgr, xavs2_frame_t *frm)
         lookahead->gopframes= 1;
     }
 
+    /* a new intra period starts here, switch to the reconfigured one */
+    if (h_mgr->intra_period_next[0] > 0 && frm->i_frm_type == XAVS2_TYPE_I) {
+        xavs2_thread_mutex_lock(&h_mgr->mutex);     /* lock */
+        h_mgr->param->intra_period_max = h_mgr->intra_period_next[0];
+        h_mgr->param->intra_period_min = h_mgr->intra_period_next[1];
+        h_mgr->intra_period_next[0] = 0;
+        xavs2_thread_mutex_unlock(&h_mgr->mutex);   /* unlock */
+
+        xavs2_rc_reconfig(h_mgr->rate_control, param);
+        xavs2_log(NULL, XAVS2_LOG_DEBUG, "reconfig: POC %d, IntraPeriod { Min %d Max %d }\n",
+                  frm->i_frame, param->intra_period_min, param->intra_period_max);
+    }
+
     return b_delayed;
 }
 
@@ -158,7 +408,7 @@ void lookahead_append_frame(xavs2_handler_t *h_mgr, xlist_t *list_out, xavs2_fra
         fenc->i_frm_coi = h_mgr->ipb.COI;
         h_mgr->ipb.COI++;
 
-        frame_buffer_update(h_mgr->p_coder, &h_mgr->ipb, fenc);
+        frame_buffer_update(h_mgr->param, &h_mgr->ipb, fenc);
         fenc->i_gop_idr_coi = h_mgr->ipb.COI_IDR;
 
         decide_frame_dts(h_mgr, fenc);
@@ -180,8 +430,7 @@ void lookahead_append_subgop_frames(xavs2_handler_t *h_mgr, xlist_t *list_out,
                                     xavs2_frame_t **blocked_frm_set, int64_t *blocked_pts_set,
                                     int num_frames)
 {
-    xavs2_t         *h               = h_mgr->p_coder;
-    const xavs2_param_t *param       = h->param;
+    const xavs2_param_t *param       = h_mgr->param;
     int i;
 
     /* append all frames one by one to output list */
@@ -243,7 +492,7 @@ void lookahead_append_subgop_frames(xavs2_handler_t *h_mgr, xlist_t *list_out,
 
                 /* set frame type */
                 if (i == 0) {
-                    frm->i_frm_type = h_mgr->p_coder->param->enable_f_frame ? XAVS2_TYPE_F : XAVS2_TYPE_P;
+                    frm->i_frm_type = param->enable_f_frame ? XAVS2_TYPE_F : XAVS2_TYPE_P;
                 }
 
                 /* set DTS */
@@ -281,8 +530,7 @@ void lookahead_append_subgop_frames(xavs2_handler_t *h_mgr, xlist_t *list_out,
  */
 int send_frame_to_enc_queue(xavs2_handler_t *h_mgr, xavs2_frame_t *frm)
 {
-    xavs2_t         *h               = h_mgr->p_coder;
-    const xavs2_param_t *param       = h->param;
+    const xavs2_param_t *param       = h_mgr->param;
     xavs2_frame_t  **blocked_frm_set = h_mgr->blocked_frm_set;
     int64_t         *blocked_pts_set = h_mgr->blocked_pts_set;
     xlist_t         *list_out        = &h_mgr->list_frames_ready;
@@ -301,8 +549,26 @@ int send_frame_to_enc_queue(xavs2_handler_t *h_mgr, xavs2_frame_t *frm)
 
     /* process... */
     if (frm->i_state != XAVS2_FLUSH) {
+        int b_delayed;
+
+        /* QP offsets of LCUs (AQ) */
+        if (frm->aq_qp_offset != NULL) {
+            lookahead_aq_analyse(h_mgr, frm);
+        }
+
+        /* intra and inter costs for the stats of the first pass */
+        if (param->i_rc_pass == 1) {
+            lookahead_cost_analyse(h_mgr, frm);
+        }
+
+        /* scene cut: close the sub-GOP of the last scene, the frame starts a new GOP */
+        frm->b_scenecut = lookahead_scenecut_analyse(h_mgr, frm);
+        if (frm->b_scenecut) {
+            lookahead_append_subgop_frames(h_mgr, list_out, blocked_frm_set, blocked_pts_set, h_mgr->num_blocked_frames);
+        }
+
         /* decide the slice type of current frame */
-        int b_delayed = slice_type_analyse(h_mgr, frm);          // is frame delayed to be encoded (B frame) ?
+        b_delayed = slice_type_analyse(h_mgr, frm);          // is frame delayed to be encoded (B frame) ?
 
         if (b_delayed) {
             /* block a whole GOP until the last frame(I/P/F) of current GOP
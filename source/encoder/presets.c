@@ -37,6 +37,7 @@
 #include "common/common.h"
 #include "encoder/aec.h"
 #include "presets.h"
+#include "wrapper.h"
 
 /**
  * ===========================================================================
@@ -47,6 +48,10 @@
 #define SWITCH_OFF(m)   enable_algs &= (~(1LL << (m)))
 #define SWITCH_ON(m)    enable_algs |=   (1LL << (m))
 
+/* adaptive speed control */
+#define SPEED_CTRL_HOLD_FRAMES    4     /* minimum number of frames between two level switches */
+#define SPEED_CTRL_SLOWER_RATIO   0.70  /* switch to a slower level when time cost is below this ratio of the budget */
+
 /**
  * ===========================================================================
  * local tables
@@ -103,14 +108,15 @@ const static double tab_qsfd_cu_size_weight[4] = {
     0.25, 1.0, 3.0, 7.5  /* 8x8, 16x16, 32x32, 64x64 */
 };
 
-double tab_qsfd_thres[MAX_QP][2][CTU_DEPTH];
+/* QSFD thresholds of all preset levels, built once and shared by all encoders */
+static double g_tab_qsfd_thres[10][MAX_QP][2][CTU_DEPTH];
+static int    g_b_qsfd_thres_ready = 0;
 
-/*--------------------------------------------------------------------------
+/* ---------------------------------------------------------------------------
+ * compute QSFD thresholds of all QPs for one preset level
  */
-static INLINE
-void algorithm_init_thresholds(xavs2_param_t *p_param)
+static void build_qsfd_thresholds(double tab_qsfd_thres[MAX_QP][2][CTU_DEPTH], int i_preset_level)
 {
-    int i_preset_level = p_param->preset_level;
     //trade-off encoding time and performance
     const double s_inter = tab_qsfd_s_presets[0][i_preset_level];
     const double s_intra = tab_qsfd_s_presets[1][i_preset_level];
@@ -139,11 +145,70 @@ void algorithm_init_thresholds(xavs2_param_t *p_param)
         tab_qsfd_thres[i][1][2] = th_32 * s_intra * 1.2;
         tab_qsfd_thres[i][1][3] = th_64 * s_intra * 1.0;
     }
+}
+
+/* ---------------------------------------------------------------------------
+ * Function   : set QSFD thresholds of all QPs for all preset levels
+ * Parameters :
+ *      [out] : h_mgr - the encoder handler which refers to the shared table
+ * Return     : none
+ * Note       : the tables are built once, under the lock of shared tables
+ * ---------------------------------------------------------------------------
+ */
+void encoder_init_qsfd_thresholds(xavs2_handler_t *h_mgr)
+{
+    if (!xavs2_atomic_load_acquire(&g_b_qsfd_thres_ready)) {
+        xavs2_init_lock();
+        if (!g_b_qsfd_thres_ready) {
+            int i;
+            for (i = 0; i < 10; i++) {
+                build_qsfd_thresholds(g_tab_qsfd_thres[i], i);
+            }
+            xavs2_atomic_store_release(&g_b_qsfd_thres_ready, 1);
+        }
+        xavs2_init_unlock();
+    }
+
+    h_mgr->tab_qsfd_thres = (const double (*)[MAX_QP][2][CTU_DEPTH])g_tab_qsfd_thres;
+}
+
+/*--------------------------------------------------------------------------
+ */
+static INLINE
+void algorithm_init_thresholds(xavs2_param_t *p_param)
+{
+    int i_preset_level = p_param->preset_level;
 
     /* ȫ */
     p_param->factor_zero_block = tab_th_zero_block_factor[i_preset_level];
 }
 
+/* ---------------------------------------------------------------------------
+ * RDOQ level of a preset level: All for preset 9, Off for preset 0~5
+ */
+static INLINE
+int get_rdoq_level_of_preset(int i_preset_level)
+{
+    return i_preset_level > 8 ? RDOQ_ALL : i_preset_level > 5 ? RDOQ_CU_LEVEL : RDOQ_OFF;
+}
+
+/* ---------------------------------------------------------------------------
+ * RDO level of a preset level
+ */
+static INLINE
+int get_rd_level_of_preset(int i_preset_level)
+{
+    if (i_preset_level < 0) {
+        return RDO_OFF;
+    } else if (i_preset_level < 1) {
+        return RDO_CU_LEVEL1;
+    } else if (i_preset_level < 5) {
+        return RDO_CU_LEVEL2;
+    } else {
+        return RDO_ALL;
+    }
+}
+
 /* ---------------------------------------------------------------------------
  * Function   : modify configurations according to different preset levels.
  * Parameters :
@@ -191,19 +256,11 @@ void parse_preset_level(xavs2_param_t *p_param, int i_preset_level)
 
     /* ---------------------------  ---------------------------
      * Level: All for preset 9, Off for preset 0~2 */
-    p_param->i_rdoq_level = i_preset_level > 8 ? RDOQ_ALL : i_preset_level > 5 ? RDOQ_CU_LEVEL : RDOQ_OFF;
+    p_param->i_rdoq_level = get_rdoq_level_of_preset(i_preset_level);
 
     /* --------------------------- RDO ---------------------------
     */
-    if (i_preset_level < 0) {
-        p_param->i_rd_level = RDO_OFF;
-    } else if (i_preset_level < 1) {
-        p_param->i_rd_level = RDO_CU_LEVEL1;
-    } else if (i_preset_level < 5) {
-        p_param->i_rd_level = RDO_CU_LEVEL2;
-    } else {
-        p_param->i_rd_level = RDO_ALL;
-    }
+    p_param->i_rd_level = get_rd_level_of_preset(i_preset_level);
 
     /* --------------------------- ر ---------------------------
      */
@@ -235,7 +292,47 @@ void parse_preset_level(xavs2_param_t *p_param, int i_preset_level)
  */
 void xavs2_reconfigure_encoder(xavs2_t *h)
 {
-    UNUSED_PARAMETER(h);
+    xavs2_handler_t *h_mgr = h->h_top;
+    double time_budget;
+    double time_cost;
+    int i_level;
+
+    if (h->param->speed_ctrl_fps <= 0) {
+        return;
+    }
+
+    /* time budget and time cost of one frame (in us), frame tasks run in parallel */
+    time_budget = 1000000.0 / h->param->speed_ctrl_fps;
+    time_cost   = (double)(xavs2_mdate() - h->i_time_frm_start) / h_mgr->i_frm_threads;
+
+    xavs2_thread_mutex_lock(&h_mgr->mutex);   /* lock */
+
+    if (h_mgr->speed_ctrl_num_frames == 0) {
+        h_mgr->speed_ctrl_avg_time = time_cost;
+    } else {
+        h_mgr->speed_ctrl_avg_time = 0.75 * h_mgr->speed_ctrl_avg_time + 0.25 * time_cost;
+    }
+    h_mgr->speed_ctrl_num_frames++;
+
+    /* switch the level of fast algorithms for the following frames */
+    i_level = h_mgr->speed_ctrl_level;
+    if (h_mgr->speed_ctrl_num_frames >= SPEED_CTRL_HOLD_FRAMES) {
+        if (h_mgr->speed_ctrl_avg_time > time_budget && i_level > 0) {
+            i_level--;
+        } else if (h_mgr->speed_ctrl_avg_time < time_budget * SPEED_CTRL_SLOWER_RATIO &&
+                   i_level < h->param->preset_level) {
+            i_level++;
+        }
+    }
+
+    if (i_level != h_mgr->speed_ctrl_level) {
+        xavs2_log(h, XAVS2_LOG_DEBUG, "speed control: POC %d, %.2f ms/frame, level %d -> %d\n",
+                  h->fenc->i_frame, 0.001 * h_mgr->speed_ctrl_avg_time, h_mgr->speed_ctrl_level, i_level);
+        h_mgr->speed_ctrl_level = i_level;
+        h_mgr->speed_ctrl_num_frames = 1;   /* keep the average time as the start point */
+    }
+
+    xavs2_thread_mutex_unlock(&h_mgr->mutex); /* unlock */
 }
 
 /* ---------------------------------------------------------------------------
@@ -306,40 +403,21 @@ uint64_t get_fast_algorithms(xavs2_t *h, int i_preset_level)
     return enable_algs;
 }
 
-/**
- * ---------------------------------------------------------------------------
- * Function   : set fast algorithms enabled according to different preset levels
- * Parameters :
- *      [in ] : h - pointer to struct xavs2_t, the xavs2 encoder
- * Return     : none
- * ---------------------------------------------------------------------------
+/* ---------------------------------------------------------------------------
+ * set the fast algorithms which can be switched between frames
  */
-void encoder_set_fast_algorithms(xavs2_t *h)
+static void set_fast_algorithms_of_level(xavs2_t *h, int i_preset_level)
 {
-    const int num_algorithm = NUM_FAST_ALGS;
-    int i_preset_level = h->param->preset_level;
     uint64_t enable_algs = 0;  // disable all algorithms
 
-    if (num_algorithm > 64) {
-        xavs2_log(h, XAVS2_LOG_ERROR, "Algorithms error: too many flags: %d\n", num_algorithm);
-        exit(0);
-    }
-
     /* -------------------------------------------------------------
      * 1, switch on some algorithms with little efficiency loss
      */
-
-    /* ǷҪ˶
-     * ο֡1ʱMVŶMVؾȴﵽ1/4
-     */
-    if (i_preset_level < 2) {
-        h->use_fractional_me = 1;
-    } else {
-        h->use_fractional_me = 2;
-    }
     h->use_fast_sub_me = (i_preset_level < 5);
     h->UMH_big_hex_level = (i_preset_level < 5) ? 0 : (i_preset_level < 9) ? 1 : 2;
     h->skip_rough_improved = (i_preset_level > 3);
+    /* CU structure of the preset: 32x32 LCUs for preset 0, 1 */
+    h->i_speed_max_cu_level = 5 + (i_preset_level > 1);
     /* -------------------------------------------------------------
      * 2, switch off part of fast algorithms according to different preset levels
      */
@@ -348,7 +426,8 @@ void encoder_set_fast_algorithms(xavs2_t *h)
     SWITCH_OFF(OPT_ROUGH_PU_SEL);
 
     /* apply the settings */
-    h->i_fast_algs = enable_algs;
+    h->i_fast_algs   = enable_algs;
+    h->i_speed_level = i_preset_level;
 
     if (IS_ALG_ENABLE(OPT_ET_RDO_INTRA_L)) {
         memcpy(h->tab_num_intra_rdo, INTRA_FULL_RDO_NUM[i_preset_level >> 1], sizeof(h->tab_num_intra_rdo));
@@ -371,21 +450,94 @@ void encoder_set_fast_algorithms(xavs2_t *h)
     } else {
         h->get_intra_candidates_chroma = rdo_get_pred_intra_chroma;
     }
+}
+
+/**
+ * ---------------------------------------------------------------------------
+ * Function   : set fast algorithms enabled according to different preset levels
+ * Parameters :
+ *      [in ] : h - pointer to struct xavs2_t, the xavs2 encoder
+ * Return     : none
+ * ---------------------------------------------------------------------------
+ */
+void encoder_set_fast_algorithms(xavs2_t *h)
+{
+    const int num_algorithm = NUM_FAST_ALGS;
+    int i_preset_level = h->param->preset_level;
+
+    if (num_algorithm > 64) {
+        xavs2_log(h, XAVS2_LOG_ERROR, "Algorithms error: too many flags: %d\n", num_algorithm);
+        exit(0);
+    }
+
+    /* ǷҪ˶
+     * ο֡1ʱMVŶMVؾȴﵽ1/4
+     */
+    if (i_preset_level < 2) {
+        h->use_fractional_me = 1;
+    } else {
+        h->use_fractional_me = 2;
+    }
+
+    /* fast algorithms, which may be adjusted by speed control later */
+    set_fast_algorithms_of_level(h, i_preset_level);
 
     /* AEC */
     switch (h->param->rdo_bit_est_method) {
     case 1:
     case 2:
+    case 3:
         h->size_aec_rdo_copy = sizeof(aec_t) - sizeof(ctx_set_t);
         h->copy_aec_state_rdo = aec_copy_aec_state_rdo;
         break;
     default:
         h->size_aec_rdo_copy = sizeof(aec_t);
-        h->copy_aec_state_rdo = aec_copy_aec_state;
+        h->copy_aec_state_rdo = aec_copy_aec_state_tracked;
         break;
     }
 }
 
+/* ---------------------------------------------------------------------------
+ * lower the coding tools of the parameters of a frame task to a faster preset
+ * level. Only the tools which can be switched between frames without changing
+ * buffers, references or the sequence header are lowered: the RDO and RDOQ
+ * levels, UMH (to HEX, SEA is kept since later frames may search the integral
+ * planes of this one), the search range and the zero block threshold
+ */
+static void set_param_of_level(xavs2_param_t *p_param, int i_level)
+{
+    if (i_level >= p_param->preset_level) {
+        return;                 /* tools of the configured preset level */
+    }
+
+    p_param->i_rd_level   = XAVS2_MIN(p_param->i_rd_level,   get_rd_level_of_preset(i_level));
+    p_param->i_rdoq_level = XAVS2_MIN(p_param->i_rdoq_level, get_rdoq_level_of_preset(i_level));
+
+    if (i_level < 4 && p_param->me_method == XAVS2_ME_UMH) {
+        p_param->me_method = XAVS2_ME_HEX;
+    }
+    if (i_level < 2) {
+        p_param->search_range = XAVS2_MIN(p_param->search_range, 57);
+    }
+
+    p_param->factor_zero_block = tab_th_zero_block_factor[i_level];
+}
+
+/* ---------------------------------------------------------------------------
+ * apply the fast algorithms of another preset level to a frame or row context.
+ * a frame task also lowers the coding tools of its own copy of the parameters,
+ * which its row tasks share
+ */
+void encoder_set_speed_level(xavs2_t *h, int i_level)
+{
+    if (h->task_type == XAVS2_TASK_FRAME) {
+        set_param_of_level((xavs2_param_t *)h->param, i_level);
+    }
+    if (h->i_speed_level != i_level) {
+        set_fast_algorithms_of_level(h, i_level);
+    }
+}
+
 /**
 * ---------------------------------------------------------------------------
 * Function   : decide the ultimate parameters used by encoders
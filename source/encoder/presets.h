@@ -42,6 +42,10 @@
 void parse_preset_level(xavs2_param_t *p_param, int i_preset_level);
 #define encoder_set_fast_algorithms FPFX(encoder_set_fast_algorithms)
 void encoder_set_fast_algorithms(xavs2_t *h);
+#define encoder_set_speed_level FPFX(encoder_set_speed_level)
+void encoder_set_speed_level(xavs2_t *h, int i_level);
+#define encoder_init_qsfd_thresholds FPFX(encoder_init_qsfd_thresholds)
+void encoder_init_qsfd_thresholds(xavs2_handler_t *h_mgr);
 #define decide_ultimate_paramters FPFX(decide_ultimate_paramters)
 void decide_ultimate_paramters(xavs2_param_t *p_param);
 
@@ -47,6 +47,12 @@
 static const double PI               = (3.14159265358979);
 static const int    RC_MAX_INT       = 1024;    // max frame number, used to refresh encoder when frame number is not known
 static const double RC_MAX_DELTA_QP  = 3.5;     // max delta QP between current key frame and its previous key frame
+static const double RC_CRF_QCOMP     = 0.6;     // QP compression of CRF, QP step is proportional to complexity^(1 - qcomp)
+static const double RC_CRF_REF_GRAD  = 8.0;     // gradient per pixel (8-bit) of frames encoded with QP = CRF
+static const double RC_CRF_MAX_DELTA = 8.0;     // max delta QP from CRF caused by complexity
+static const double RC_2PASS_MAX_DELTA = 24.0;  // max delta QP of the second pass to the first pass
+static const double RC_2PASS_QCOMP     = 0.6;   // QP compression of the second pass, QP step is proportional to cost^(1 - qcomp)
+static const double RC_2PASS_MAX_CPLX_DELTA = 6.0;  // max delta QP of a frame caused by its cost in the second pass
 
 #define RC_LCU_LEVEL            0       // 1 - enable LCU level rate control, 0 - disable
 #define RC_AUTO_ADJUST          0       // 1 - enable auto adjust the qp
@@ -83,6 +89,23 @@ typedef struct RCLCU {
 } RCLCU;
 #endif
 
+/* ---------------------------------------------------------------------------
+* stats of one frame in the first pass
+*/
+typedef struct rc_frame_stat_t {
+    int         b_valid;              // found in the stats file
+    int         b_started;            // QP decided in the second pass
+    char        c_type;               // frame type: I, P, F or B
+    int         i_qp;                 // QP in the first pass
+    int         i_bits;               // bits in the first pass
+    float       f_cplx;               // estimated bits per pixel at QP 32
+    float       f_icost;              // intra cost per pixel (lookahead)
+    float       f_pcost;              // inter cost per pixel (lookahead, -1: no previous frame)
+    double      f_qp_ref;             // QP of the frame relative to the other frames in the second pass
+    double      f_ref_bits;           // bits predicted from the complexity at f_qp_ref
+    double      f_planned_bits;       // bits predicted from the first pass for the QP of the second pass
+} rc_frame_stat_t;
+
 /* ---------------------------------------------------------------------------
 *           |<---                 WIN                   --->|
 * . . . . . I B B . . . F B B . . . F B B . . . F B B . . . I B B . . .
@@ -114,6 +137,20 @@ struct ratectrl_t {    //EKIN_MARK
     double      f_win_bpp;            // sum of KEY frame BPP in current WIN
     double      f_gop_bpp;            // sum of frame BPP in current GOP
 
+    /* crf */
+    double      f_rate_factor;        // QP of frames with average complexity
+
+    /* multi-pass */
+    int         i_pass;               // 0: one pass, 1: first pass, 2: second pass
+    FILE       *f_stats;              // stats file written by the first pass
+    rc_frame_stat_t *frm_stats;       // stats of all frames read by the second pass (indexed by frame number)
+    int         num_frm_stats;        // number of entries in frm_stats
+    double      f_2pass_target_bits;  // target bits of the whole sequence
+    double      f_2pass_ref_bits;     // sum of f_ref_bits of frames not started yet
+    double      f_2pass_inflight;     // sum of predicted bits of frames being encoded
+    double      f_2pass_coded_bits;   // sum of actual    bits of coded frames
+    double      f_2pass_coded_pred;   // sum of predicted bits of coded frames
+
     /* bpp */
     double      f_target_bpp;         // average target BBP (bit per pixel) for each frame
     double      f_intra_bpp;          // BPP of intra KEY frame (used only for i_intra_period = 0/1)
@@ -183,7 +220,6 @@ static const double tab_qp_gpp[3][3] = {
 #endif
 
 
-#if ENABLE_AUTO_INIT_QP
 /* ---------------------------------------------------------------------------
 * compute the gradient per pixel
 */
@@ -213,7 +249,6 @@ static double cal_frame_gradient(xavs2_frame_t *frm)
 
     return grad_per_pixel / size;
 }
-#endif
 
 /* ---------------------------------------------------------------------------
 */
@@ -423,6 +458,248 @@ static int rc_calculate_frame_qp(xavs2_t *h, int frm_idx, int frm_type, int forc
     return XAVS2_CLIP3F(rc->i_min_qp, max_qp, (int)(qp + 0.5));
 }
 
+/* ---------------------------------------------------------------------------
+* character of a frame type in the stats file
+*/
+static char rc_frame_type_char(int frm_type)
+{
+    switch (frm_type) {
+    case XAVS2_TYPE_I: return 'I';
+    case XAVS2_TYPE_P: return 'P';
+    case XAVS2_TYPE_F: return 'F';
+    default:           return 'B';
+    }
+}
+
+/* ---------------------------------------------------------------------------
+* cost of a frame in the first pass deciding its share of bits: the intra
+* cost for I frames, the inter cost for the others
+*/
+static double rc_frame_2pass_cost(const rc_frame_stat_t *stat)
+{
+    double cost = (stat->c_type == 'I' || stat->f_pcost < 0) ? stat->f_icost : stat->f_pcost;
+
+    return XAVS2_MAX(cost, 0.1);
+}
+
+/* ---------------------------------------------------------------------------
+* QPs of all frames relative to each other in the second pass, and the bits
+* predicted at these QPs. A frame keeps the QP offset of its type and layer
+* in the first pass, and gets a higher QP the higher its cost is compared
+* with the average of the frames of the same class (intra or inter), so the
+* bits are distributed over the whole sequence as in CRF. The bits at a QP
+* follow from the complexity (bits per pixel at QP 32) of the first pass
+*/
+static void rc_init_2pass_model(ratectrl_t *rc, const xavs2_param_t *param)
+{
+    const int bit_depth_offset = (param->sample_bit_depth - 8) * 8;
+    double log_cost_sum[2] = { 0, 0 };
+    int    num_cost[2]     = { 0, 0 };
+    int i;
+
+    /* average cost of intra and inter frames */
+    for (i = 0; i < rc->num_frm_stats; i++) {
+        const rc_frame_stat_t *stat = &rc->frm_stats[i];
+
+        if (stat->b_valid) {
+            int b_inter = stat->c_type != 'I';
+            log_cost_sum[b_inter] += log(rc_frame_2pass_cost(stat));
+            num_cost[b_inter]++;
+        }
+    }
+    for (i = 0; i < 2; i++) {
+        log_cost_sum[i] /= XAVS2_MAX(num_cost[i], 1);
+    }
+
+    rc->f_2pass_ref_bits = 0;
+    for (i = 0; i < rc->num_frm_stats; i++) {
+        rc_frame_stat_t *stat = &rc->frm_stats[i];
+        double delta_qp;
+
+        if (!stat->b_valid) {
+            continue;
+        }
+        delta_qp = 8.0 * (1.0 - RC_2PASS_QCOMP) * (log(rc_frame_2pass_cost(stat)) - log_cost_sum[stat->c_type != 'I']) / log(2.0);
+        delta_qp = XAVS2_CLIP3F(-RC_2PASS_MAX_CPLX_DELTA, RC_2PASS_MAX_CPLX_DELTA, delta_qp);
+
+        stat->f_qp_ref   = stat->i_qp + delta_qp;
+        stat->f_ref_bits = (double)stat->f_cplx * rc->i_frame_size * pow(2.0, (32 + bit_depth_offset - stat->f_qp_ref) / 8.0);
+        rc->f_2pass_ref_bits += stat->f_ref_bits;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+* read the stats file of the first pass
+*/
+static int rc_read_stats(ratectrl_t *rc, const xavs2_param_t *param)
+{
+    FILE *fp;
+    char line[256];
+    int width = 0, height = 0, gop_size = 0;
+    int num_frames = 0;
+
+    if ((fp = fopen(param->psz_stats_file, "r")) == NULL) {
+        xavs2_log(NULL, XAVS2_LOG_ERROR, "RC: can not open stats file %s\n", param->psz_stats_file);
+        return -1;
+    }
+
+    /* header and number of frames */
+    if (fgets(line, sizeof(line), fp) == NULL ||
+        sscanf(line, "#xavs2 stats: %dx%d gop %d", &width, &height, &gop_size) != 3) {
+        xavs2_log(NULL, XAVS2_LOG_ERROR, "RC: invalid stats file %s\n", param->psz_stats_file);
+        fclose(fp);
+        return -1;
+    }
+    if (width != param->org_width || height != param->org_height || gop_size != param->i_gop_size) {
+        xavs2_log(NULL, XAVS2_LOG_ERROR, "RC: stats of %dx%d (GOP %d) do not match the encoder %dx%d (GOP %d)\n",
+                  width, height, gop_size, param->org_width, param->org_height, param->i_gop_size);
+        fclose(fp);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        int frm_idx;
+        if (sscanf(line, "in:%d", &frm_idx) == 1 && frm_idx >= num_frames) {
+            num_frames = frm_idx + 1;
+        }
+    }
+    if (num_frames <= 0) {
+        xavs2_log(NULL, XAVS2_LOG_ERROR, "RC: no frames in stats file %s\n", param->psz_stats_file);
+        fclose(fp);
+        return -1;
+    }
+
+    /* stats of all frames */
+    rc->frm_stats = (rc_frame_stat_t *)xavs2_malloc(num_frames * sizeof(rc_frame_stat_t));
+    if (rc->frm_stats == NULL) {
+        fclose(fp);
+        return -1;
+    }
+    memset(rc->frm_stats, 0, num_frames * sizeof(rc_frame_stat_t));
+    rc->num_frm_stats = num_frames;
+
+    rewind(fp);
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        rc_frame_stat_t stat;
+        int frm_idx;
+
+        memset(&stat, 0, sizeof(stat));
+        if (sscanf(line, "in:%d type:%c q:%d bits:%d cplx:%f icost:%f pcost:%f", &frm_idx, &stat.c_type,
+                   &stat.i_qp, &stat.i_bits, &stat.f_cplx, &stat.f_icost, &stat.f_pcost) == 7 &&
+            frm_idx >= 0 && frm_idx < num_frames) {
+            stat.b_valid = 1;
+            rc->frm_stats[frm_idx] = stat;
+        }
+    }
+    fclose(fp);
+
+    /* budget of the whole sequence */
+    rc->f_2pass_target_bits = (double)param->i_target_bitrate * num_frames / param->frame_rate;
+    rc_init_2pass_model(rc, param);
+    xavs2_log(NULL, XAVS2_LOG_INFO, "RC: second pass, %d frames, %.0f kbits in the first pass, target %.0f kbits\n",
+              num_frames, rc->f_2pass_ref_bits * 0.001, rc->f_2pass_target_bits * 0.001);
+
+    return 0;
+}
+
+/**
+* ---------------------------------------------------------------------------
+* Function   : calculate the frame QP of the second pass: the relative QPs of
+*              all frames (rc_init_2pass_model) are moved by one delta QP, so
+*              that the bits of the frames not coded yet meet the remaining
+*              budget. The predicted bits are scaled by the ratio of actual to
+*              predicted bits of the coded frames, since the presets of the two
+*              passes differ.
+* Parameters :
+*      [in ] : h        - handle of the xavs2 video encoder
+*            : frm_idx  - frame index
+*            : force_qp - specified qp for encoding current frame
+*      [out] : none
+* Return     : the frame QP
+* ---------------------------------------------------------------------------
+*/
+static int rc_calculate_2pass_qp(xavs2_t *h, int frm_idx, int frm_type, int force_qp)
+{
+    ratectrl_t *rc = h->rc;
+    const int max_qp = rc->i_max_qp + (h->param->sample_bit_depth - 8) * 8;
+    rc_frame_stat_t *stat;
+    double ratio, ref_bits, remain_bits, delta_qp;
+    int qp;
+
+    if (frm_idx < 0 || frm_idx >= rc->num_frm_stats || !rc->frm_stats[frm_idx].b_valid) {
+        return h->i_qp;         /* not in the first pass */
+    }
+
+    stat = &rc->frm_stats[frm_idx];
+    if (stat->c_type != rc_frame_type_char(frm_type)) {
+        xavs2_log(NULL, XAVS2_LOG_DEBUG, "RC: frame %d is %c in the first pass, %c now\n",
+                  frm_idx, stat->c_type, rc_frame_type_char(frm_type));
+    }
+
+    ratio = 1.0;
+    if (rc->f_2pass_coded_pred > 0) {
+        ratio = XAVS2_CLIP3F(0.25, 4.0, rc->f_2pass_coded_bits / rc->f_2pass_coded_pred);
+    }
+
+    /* frames not started (including this one) share the budget left */
+    ref_bits    = XAVS2_MAX(ratio * rc->f_2pass_ref_bits, 1.0);
+    remain_bits = rc->f_2pass_target_bits - rc->f_2pass_coded_bits - ratio * rc->f_2pass_inflight;
+    remain_bits = XAVS2_MAX(remain_bits, ref_bits / 256);
+    delta_qp    = 8.0 * log(ref_bits / remain_bits) / log(2.0);   /* bits are halved every 8 QPs */
+    delta_qp    = XAVS2_CLIP3F(-RC_2PASS_MAX_DELTA, RC_2PASS_MAX_DELTA, delta_qp);
+
+    if (force_qp != XAVS2_QP_AUTO) {
+        qp = force_qp - 1;
+    } else {
+        qp = (int)floor(stat->f_qp_ref + delta_qp + 0.5);
+    }
+    qp = XAVS2_CLIP3(rc->i_min_qp, max_qp, qp);
+
+    if (!stat->b_started) {
+        stat->b_started       = 1;
+        stat->f_planned_bits  = stat->f_ref_bits * pow(2.0, (stat->f_qp_ref - qp) / 8.0);
+        rc->f_2pass_ref_bits -= stat->f_ref_bits;
+        rc->f_2pass_inflight += stat->f_planned_bits;
+    }
+
+    return qp;
+}
+
+/**
+* ---------------------------------------------------------------------------
+* Function   : calculate the frame QP of CRF, from the complexity and the temporal
+*              layer of the frame only, so neither the number of frames nor the
+*              encoding order is needed
+* Parameters :
+*      [in ] : h        - handle of the xavs2 video encoder
+*            : grad     - gradient per pixel of the frame
+*            : force_qp - specified qp for encoding current frame
+*      [out] : none
+* Return     : the frame QP
+* ---------------------------------------------------------------------------
+*/
+static int rc_calculate_crf_qp(xavs2_t *h, double grad, int force_qp)
+{
+    ratectrl_t *rc = h->rc;
+    const int max_qp = rc->i_max_qp + (h->param->sample_bit_depth - 8) * 8;
+    double delta_qp;
+    double qp;
+
+    if (force_qp != XAVS2_QP_AUTO) {
+        return XAVS2_CLIP3(rc->i_min_qp, max_qp, force_qp - 1);
+    }
+
+    /* complex frames mask more distortion: qstep ~ complexity^(1 - qcomp) */
+    grad     = XAVS2_MAX(grad / (1 << (h->param->sample_bit_depth - 8)), 0.5);
+    delta_qp = 6.0 * (1.0 - RC_CRF_QCOMP) * log(grad / RC_CRF_REF_GRAD) / log(2.0);
+    delta_qp = XAVS2_CLIP3F(-RC_CRF_MAX_DELTA, RC_CRF_MAX_DELTA, delta_qp);
+
+    /* h->i_qp is the QP of the frame in its temporal layer (QP offset and
+     * refined QP) when the base QP is the rate factor */
+    qp = h->i_qp + (rc->f_rate_factor - rc->i_base_qp) + delta_qp;
+
+    return XAVS2_CLIP3F(rc->i_min_qp, max_qp, (int)(qp + 0.5));
+}
+
 /* ---------------------------------------------------------------------------
 */
 #if RC_LCU_LEVEL
@@ -523,6 +800,10 @@ int xavs2_rc_init(ratectrl_t *rc, xavs2_param_t *param)
 
     rc->f_delta_qp = 0.0;
     rc->i_base_qp = param->i_initial_qp;
+    rc->f_rate_factor = param->f_rate_factor;
+    if (param->i_rc_method == XAVS2_RC_CRF) {
+        rc->i_base_qp = (int)(param->f_rate_factor + 0.5);  /* QP of the first frames before the complexity is known */
+    }
     rc->i_last_qp = 0;
     rc->i_min_qp = param->i_min_qp;
     rc->i_max_qp = param->i_max_qp;
@@ -560,6 +841,21 @@ int xavs2_rc_init(ratectrl_t *rc, xavs2_param_t *param)
         init_fuzzy_controller(0.75);
     }
 
+    /* multi-pass */
+    rc->i_pass = param->i_rc_pass;
+    if (rc->i_pass == 1) {
+        if ((rc->f_stats = fopen(param->psz_stats_file, "w")) == NULL) {
+            xavs2_log(NULL, XAVS2_LOG_ERROR, "RC: can not create stats file %s\n", param->psz_stats_file);
+            return -1;
+        }
+        fprintf(rc->f_stats, "#xavs2 stats: %dx%d gop %d qp %d\n",
+                param->org_width, param->org_height, param->i_gop_size, param->i_initial_qp);
+    } else if (rc->i_pass == 2) {
+        if (rc_read_stats(rc, param) < 0) {
+            return -1;
+        }
+    }
+
     if (xavs2_thread_mutex_init(&rc->rc_mutex, NULL)) {
         return -1;
     }
@@ -567,6 +863,46 @@ int xavs2_rc_init(ratectrl_t *rc, xavs2_param_t *param)
     return 0;
 }
 
+/**
+ * ---------------------------------------------------------------------------
+ * Function   : update the rate control module after the parameters are reconfigured
+ * Parameters :
+ *      [in ] : rc    - handle of the rate control module
+ *            : param - parameters with new target bitrate, QP range and intra period
+ *      [out] : none
+ * Return     : none
+ * ---------------------------------------------------------------------------
+ */
+void xavs2_rc_reconfig(ratectrl_t *rc, const xavs2_param_t *param)
+{
+    xavs2_thread_mutex_lock(&rc->rc_mutex);     // lock
+
+    rc->i_min_qp     = param->i_min_qp;
+    rc->i_max_qp     = param->i_max_qp;
+    rc->f_target_bpp = param->i_target_bitrate / (param->frame_rate * rc->i_frame_size);
+    rc->f_rate_factor = param->f_rate_factor;
+    if (rc->i_pass == 2) {
+        rc->f_2pass_target_bits = (double)param->i_target_bitrate * rc->num_frm_stats / param->frame_rate;
+    }
+    if (param->i_rc_method == XAVS2_RC_CQP) {
+        rc->i_base_qp = param->i_initial_qp;
+    } else if (param->i_rc_method == XAVS2_RC_CRF) {
+        rc->i_base_qp = (int)(param->f_rate_factor + 0.5);
+    }
+
+    /* the statistics of the current WIN are kept, only its size is changed */
+    if (rc->i_intra_period != param->intra_period_max) {
+        rc->i_intra_period = param->intra_period_max;
+        if (rc->b_open_gop && rc->i_coded_frames > 0) {
+            rc->i_win_size = param->i_gop_size * rc->i_intra_period;
+        } else {
+            rc->i_win_size = param->i_gop_size * (rc->i_intra_period - 1) + 1;
+        }
+    }
+
+    xavs2_thread_mutex_unlock(&rc->rc_mutex);   // unlock
+}
+
 /**
 * ---------------------------------------------------------------------------
 * Function   : get base qp of the encoder
@@ -593,7 +929,24 @@ int xavs2_rc_get_base_qp(xavs2_t *h)
 int xavs2_rc_get_frame_qp(xavs2_t *h, int frm_idx, int frm_type, int force_qp)
 {
     /* get QP for current frame */
-    if (h->param->i_rc_method != XAVS2_RC_CQP && frm_type != XAVS2_TYPE_B) {
+    if (h->rc->i_pass == 2) {
+        /* all frames, from the stats of the first pass */
+        int i_qp;
+        xavs2_thread_mutex_lock(&h->rc->rc_mutex);
+        i_qp = rc_calculate_2pass_qp(h, frm_idx, frm_type, force_qp);
+        xavs2_thread_mutex_unlock(&h->rc->rc_mutex);
+        return i_qp;
+    } else if (h->param->i_rc_method == XAVS2_RC_CRF) {
+        /* all frames, the complexity is measured outside of the lock */
+        double grad;
+        int i_qp;
+        xavs2_emms();
+        grad = cal_frame_gradient(h->fenc);
+        xavs2_thread_mutex_lock(&h->rc->rc_mutex);
+        i_qp = rc_calculate_crf_qp(h, grad, force_qp);
+        xavs2_thread_mutex_unlock(&h->rc->rc_mutex);
+        return i_qp;
+    } else if (h->param->i_rc_method != XAVS2_RC_CQP && frm_type != XAVS2_TYPE_B) {
         int i_qp;
         xavs2_thread_mutex_lock(&h->rc->rc_mutex);
         i_qp = rc_calculate_frame_qp(h, frm_idx, frm_type, force_qp);
@@ -730,7 +1083,27 @@ void xavs2_rc_update_after_frame_coded(xavs2_t *h, int frm_bits, int frm_qp, int
     ratectrl_t *rc = h->rc;
     double frm_bpp = (double)frm_bits / rc->i_frame_size;   // bits per pixel
 
-    if (h->param->i_rc_method == XAVS2_RC_CQP) {
+    if (rc->i_pass == 1) {
+        /* write stats of the first pass, the frames may be finished out of order */
+        xavs2_thread_mutex_lock(&rc->rc_mutex);     // lock
+        fprintf(rc->f_stats, "in:%d type:%c q:%d bits:%d cplx:%.4f icost:%.3f pcost:%.3f\n",
+                frm_idx, rc_frame_type_char(frm_type), frm_qp, frm_bits,
+                frm_bpp * pow(2.0, (frm_qp - 32 - (h->param->sample_bit_depth - 8) * 8) / 8.0),
+                h->fenc->f_rc_cost[0], h->fenc->f_rc_cost[1]);
+        xavs2_thread_mutex_unlock(&rc->rc_mutex);   // unlock
+        return;
+    } else if (rc->i_pass == 2) {
+        xavs2_thread_mutex_lock(&rc->rc_mutex);     // lock
+        if (frm_idx >= 0 && frm_idx < rc->num_frm_stats && rc->frm_stats[frm_idx].b_started) {
+            rc->f_2pass_inflight   -= rc->frm_stats[frm_idx].f_planned_bits;
+            rc->f_2pass_coded_pred += rc->frm_stats[frm_idx].f_planned_bits;
+        }
+        rc->f_2pass_coded_bits += frm_bits;
+        xavs2_thread_mutex_unlock(&rc->rc_mutex);   // unlock
+        return;
+    }
+
+    if (h->param->i_rc_method == XAVS2_RC_CQP || h->param->i_rc_method == XAVS2_RC_CRF) {
         return;                 /* no need to update */
     }
 
@@ -832,5 +1205,13 @@ void xavs2_rc_update_after_frame_coded(xavs2_t *h, int frm_bits, int frm_qp, int
 */
 void xavs2_rc_destroy(ratectrl_t *rc)
 {
+    if (rc->f_stats != NULL) {
+        fclose(rc->f_stats);
+        rc->f_stats = NULL;
+    }
+    if (rc->frm_stats != NULL) {
+        xavs2_free(rc->frm_stats);
+        rc->frm_stats = NULL;
+    }
     xavs2_thread_mutex_destroy(&rc->rc_mutex);
 }
@@ -60,6 +60,9 @@ int  xavs2_rc_get_lcu_qp(xavs2_t *h, int frm_idx, int qp);
 void xavs2_rc_update_after_lcu_coded(xavs2_t *h, int frm_idx, int qp);
 #endif  // ENABLE_RATE_CONTROL_CU
 
+#define xavs2_rc_reconfig FPFX(rc_reconfig)
+void xavs2_rc_reconfig(ratectrl_t *rc, const xavs2_param_t *param);
+
 #define xavs2_rc_destroy FPFX(rc_destroy)
 void xavs2_rc_destroy(ratectrl_t *rc);
 
@@ -35,6 +35,7 @@
  */
 
 #include "common.h"
+#include "wrapper.h"
 #include "rdo.h"
 #include "cudata.h"
 #include "aec.h"
@@ -239,17 +240,17 @@ void cu_init(xavs2_t *h, cu_t *p_cu, cu_info_t *best, int i_level)
 
 #if ENABLE_RATE_CONTROL_CU
     /* set qp needed in loop filter (even if constant QP is used) */
-    p_cu->cu_info.i_cu_qp = h->i_qp;
-
-    if (h->param->i_rc_method == XAVS2_RC_CBR_SCU) {
-        int i_left_cu_qp;
-        if (p_cu->i_pix_x > 0) {
-            i_left_cu_qp = h->cu_info[p_cu->i_scu_xy - 1].i_cu_qp;
+    p_cu->cu_info.i_cu_qp = (int8_t)h->lcu.i_qp;
+
+    if (!h->param->fixed_picture_qp) {
+        /* estimated delta QP for RDO: only CUs on the left edge of the LCU
+         * are expected to signal a change of QP. the actual one is decided
+         * in coding order after the LCU is analyzed */
+        if (p_cu->i_pix_x == h->lcu.i_pix_x) {
+            p_cu->cu_info.i_delta_qp = p_cu->cu_info.i_cu_qp - h->lcu.i_qp_left;
         } else {
-            i_left_cu_qp = h->i_qp;
+            p_cu->cu_info.i_delta_qp = 0;
         }
-
-        p_cu->cu_info.i_delta_qp = p_cu->cu_info.i_cu_qp - i_left_cu_qp;
     } else {
         p_cu->cu_info.i_delta_qp = 0;
     }
@@ -1064,12 +1065,13 @@ static void cu_check_intra(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, cu_info_t *best
             dist_t dist_curr;     // ǰ֡ڿʧ
             int rate_curr = 0; // ǰ֡ڿʣ
             int Mode = p_candidates[i].mode;
-            pel_t *p_pred = p_enc->intra_pred[Mode];
+            pel_t *p_pred = p_enc->intra_pred;
 
             // get and check rate_chroma-distortion cost
             int mode_idx_aec = (mpm[0] == Mode) ? -2 : ((mpm[1] == Mode) ? -1 : (mpm[0] > Mode ? Mode : (mpm[1] > Mode ? Mode - 1 : Mode - 2)));
             int num_nonzero;
 
+            rdo_intra_pred_luma(h, p_cu, p_pred, Mode, block_w, block_h);
             num_nonzero = cu_recon_intra_luma(h, p_aec, p_cu, p_pred,
                                               block_w, block_h, block_x, block_y,
                                               blockidx, Mode, &dist_curr);
@@ -1079,19 +1081,18 @@ static void cu_check_intra(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, cu_info_t *best
                 int w_tr = block_w >> used_wavelet;
                 int i_tu_level = p_cu->cu_info.i_level - (p_cu->cu_info.i_tu_split != TU_SPLIT_NON) - used_wavelet;
                 int rate_luma_mode;
-                coeff_t *p_coeff_y = p_cu->cu_info.p_coeff[0] + (blockidx << ((p_cu->cu_info.i_level - 1) << 1));
-
-                // get rate for intra prediction mode
-                rate_luma_mode = p_aec->binary.write_intra_pred_mode(p_aec, mode_idx_aec);
+                int bits_left = 0;
+                coeff_t *p_coeff_y = NULL;
 
-                // get rate for luminance coefficients
                 if (num_nonzero) {
-                    int bits_left = rdo_get_left_bits(h, best_rdcost, dist_curr) - rate_luma_mode;
-                    rate_curr = p_aec->binary.est_luma_block_coeff(h, p_aec, p_cu, p_coeff_y, &p_enc->runlevel, i_tu_level, xavs2_log2u(w_tr),
-                                1, Mode, bits_left);
-                    rate_luma_mode += rate_curr;
+                    p_coeff_y = p_cu->cu_info.p_coeff[0] + (blockidx << ((p_cu->cu_info.i_level - 1) << 1));
+                    bits_left = rdo_get_left_bits(h, best_rdcost, dist_curr);
                 }
 
+                // get rate for intra prediction mode and luminance coefficients
+                rate_luma_mode = p_aec->binary.est_intra_luma_rate(h, p_aec, p_cu, mode_idx_aec, p_coeff_y, &p_enc->runlevel,
+                                                                   i_tu_level, xavs2_log2u(w_tr), Mode, bits_left, &rate_curr);
+
                 // calculate RD-cost and return it
                 rdcost = dist_curr + h->f_lambda_mode * rate_luma_mode;
             }
@@ -1198,23 +1199,8 @@ static void cu_check_intra(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, cu_info_t *best
             p_cu->cu_info.i_cbp = (int8_t)(tmp_cbp_luma + cbp_c);
 
             /* ------- GET RATE -------- */
-            rate_chroma = p_aec->binary.est_cu_header(h, p_aec, p_cu);
-#if ENABLE_RATE_CONTROL_CU
-            rate_chroma += p_aec->binary.write_cu_cbp_dqp(h, p_aec, &p_cu->cu_info, h->i_slice_index, h->last_dquant);
-#else
-            rate_chroma += p_aec->binary.write_cu_cbp(p_aec, &p_cu->cu_info, h->i_slice_index, h);
-#endif
-
-            bits_left = rdo_get_left_bits(h, *min_rdcost - rdcost_luma, dist_chroma);
-
-            if (p_cu->cu_info.i_cbp & (1 << 4)) {
-                int cur_bits_left = bits_left - rate_chroma;
-                rate_chroma += p_aec->binary.est_chroma_block_coeff(h, p_aec, p_cu, p_cu->cu_info.p_coeff[1], &p_enc->runlevel, level - 1, cur_bits_left);
-            }
-            if (p_cu->cu_info.i_cbp & (1 << 5)) {
-                int cur_bits_left = bits_left - rate_chroma;
-                rate_chroma += p_aec->binary.est_chroma_block_coeff(h, p_aec, p_cu, p_cu->cu_info.p_coeff[2], &p_enc->runlevel, level - 1, cur_bits_left);
-            }
+            bits_left   = rdo_get_left_bits(h, *min_rdcost - rdcost_luma, dist_chroma);
+            rate_chroma = p_aec->binary.est_cu_rate_intra(h, p_aec, p_cu, &p_enc->runlevel, bits_left);
 
             rdcost = dist_chroma + h->f_lambda_mode * rate_chroma + rdcost_luma;
 
@@ -1238,12 +1224,7 @@ static void cu_check_intra(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, cu_info_t *best
         }
     } else {   /* YUV400 */
         /* ------- GET RATE -------- */
-        int rate_hdr = p_aec->binary.est_cu_header(h, p_aec, p_cu);
-#if ENABLE_RATE_CONTROL_CU
-        rate_hdr += p_aec->binary.write_cu_cbp_dqp(h, p_aec, &p_cu->cu_info, h->i_slice_index, h->last_dquant);
-#else
-        rate_hdr += p_aec->binary.write_cu_cbp(p_aec, &p_cu->cu_info, h->i_slice_index, h);
-#endif
+        int rate_hdr = p_aec->binary.est_cu_rate_intra(h, p_aec, p_cu, &p_enc->runlevel, 0);
         rdcost = h->f_lambda_mode * rate_hdr + rdcost_luma;
 
         if (rdcost < *min_rdcost) {
@@ -1507,74 +1488,13 @@ dist_t cu_recon_inter_luma(xavs2_t *h, aec_t *p_aec, cu_t *p_cu,
 static int tu_rdcost_inter(xavs2_t *h, aec_t *p_aec, cu_t *p_cu,
                            dist_t distortion, int rate_chroma, rdcost_t *rdcost)
 {
-    int mode = p_cu->cu_info.i_mode;
-    int level = p_cu->cu_info.i_level;
+    cu_parallel_t *p_enc = cu_get_enc_context(h, p_cu->cu_info.i_level);
+    int bits_left = rdo_get_left_bits(h, *rdcost, distortion);
     int rate;
-    int block_idx;
-    cu_parallel_t *p_enc = cu_get_enc_context(h, level);
 
     /* -------------------------------------------------------------
      * get rate */
-
-    /* rate of cu header */
-    rate = p_aec->binary.est_cu_header(h, p_aec, p_cu);
-
-    /* rate of motion information */
-    rate += p_aec->binary.est_cu_refs_mvds(h, p_aec, p_cu);
-
-    /* tu information */
-    if (mode != PRED_SKIP || p_cu->cu_info.i_cbp) {
-        int bits_left = rdo_get_left_bits(h, *rdcost, distortion);
-        int cur_bits_left;
-        /* rate of cbp & dqp */
-#if ENABLE_RATE_CONTROL_CU
-        rate += p_aec->binary.write_cu_cbp_dqp(h, p_aec, &p_cu->cu_info, h->i_slice_index, h->last_dquant);
-#else
-        rate += p_aec->binary.write_cu_cbp(p_aec, &p_cu->cu_info, h->i_slice_index, h);
-#endif
-
-        /* rate of luma coefficients */
-        if (p_cu->cu_info.i_tu_split != TU_SPLIT_NON) {
-            int use_wavelet = (level == B64X64_IN_BIT && p_cu->cu_info.i_tu_split != TU_SPLIT_CROSS);
-            int i_tu_level = level - 1 - use_wavelet;
-            for (block_idx = 0; block_idx < 4; block_idx++) {
-                if (p_cu->cu_info.i_cbp & (1 << block_idx)) {
-                    cb_t tb;
-                    cur_bits_left = bits_left - rate;
-
-                    cu_init_transform_block(p_cu->cu_info.i_level, p_cu->cu_info.i_tu_split, block_idx, &tb);
-
-                    rate += p_aec->binary.est_luma_block_coeff(h, p_aec, p_cu,
-                            p_cu->cu_info.p_coeff[0] + (block_idx << ((p_cu->cu_info.i_level - 1) << 1)),
-                            &p_enc->runlevel, i_tu_level, xavs2_log2u(tb.w) - use_wavelet, 0, 0, cur_bits_left);
-                }
-            }
-        } else {
-            if (p_cu->cu_info.i_cbp & 15) {
-                int i_tu_level = level - (level == B64X64_IN_BIT);
-                cur_bits_left = bits_left - rate;
-                rate += p_aec->binary.est_luma_block_coeff(h, p_aec, p_cu, p_cu->cu_info.p_coeff[0],
-                        &p_enc->runlevel, i_tu_level, i_tu_level, 0, 0, cur_bits_left);
-            }
-        }
-
-        /* rate of chroma coefficients */
-        if (IS_ALG_ENABLE(OPT_ADVANCE_CHROMA_AEC)) {
-            if (p_cu->cu_info.i_cbp != 0) {  // not skip mode
-                rate += rate_chroma;
-            }
-        } else {
-            level--;
-            if (p_cu->cu_info.i_cbp & (1 << 4)) {
-                cur_bits_left = bits_left - rate;
-                rate += p_aec->binary.est_chroma_block_coeff(h, p_aec, p_cu, p_cu->cu_info.p_coeff[1], &p_enc->runlevel, level, cur_bits_left);
-            }
-            if (p_cu->cu_info.i_cbp & (1 << 5)) {
-                cur_bits_left = bits_left - rate;
-                rate += p_aec->binary.est_chroma_block_coeff(h, p_aec, p_cu, p_cu->cu_info.p_coeff[2], &p_enc->runlevel, level, cur_bits_left);
-            }
-        }
-    }
+    rate = p_aec->binary.est_cu_rate_inter(h, p_aec, p_cu, &p_enc->runlevel, rate_chroma, bits_left);
 
     /* -------------------------------------------------------------
      * get rate-distortion cost */
@@ -1734,15 +1654,7 @@ int cu_rdcost_inter(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, rdcost_t *min_rdcost,
         if (IS_ALG_ENABLE(OPT_ADVANCE_CHROMA_AEC)) {
             int bits_left = rdo_get_left_bits(h, *min_rdcost, dist_chroma);
             int i_level_c = p_cu->cu_info.i_level - 1;
-            int cur_bits_left;
-            if (cbp_c & (1 << 4)) {
-                cur_bits_left = bits_left - rate_chroma;
-                rate_chroma += p_aec->binary.est_chroma_block_coeff(h, p_aec, p_cu, p_cu->cu_info.p_coeff[1], &p_enc->runlevel, i_level_c, cur_bits_left);
-            }
-            if (cbp_c & (1 << 5)) {
-                cur_bits_left = bits_left - rate_chroma;
-                rate_chroma += p_aec->binary.est_chroma_block_coeff(h, p_aec, p_cu, p_cu->cu_info.p_coeff[2], &p_enc->runlevel, i_level_c, cur_bits_left);
-            }
+            rate_chroma = p_aec->binary.est_chroma_coeff_rate(h, p_aec, p_cu, &p_enc->runlevel, cbp_c, i_level_c, rate_chroma, bits_left);
         }
     }
 
@@ -3297,6 +3209,248 @@ int ctu_intra_depth_pred_mad(xavs2_t *h, int level, int pix_x, int pix_y)
 }
 
 
+/* ---------------------------------------------------------------------------
+ * best mode of the upper CU level, -1 when it is not available
+ */
+static INLINE
+int cu_get_upper_mode(xavs2_t *h, int i_level)
+{
+    if (i_level >= MAX_CU_SIZE_IN_BIT || (h->lcu.fork_mask & (1u << (i_level + 1)))) {
+        return -1;      /* the upper CU is evaluated on a helper context */
+    }
+    return cu_get_layer(h, i_level + 1)->cu_best.i_mode;
+}
+
+/* ---------------------------------------------------------------------------
+ * evaluate the non-split candidate of an intra CU,
+ * *b_split_ctu is cleared if the smaller CUs can be skipped
+ */
+static
+rdcost_t compress_ctu_intra_large(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, cu_info_t *best,
+                                  rdcost_t cost_limit, int *b_split_ctu)
+{
+    aec_t cs_aec;
+    rdcost_t large_cu_cost;
+
+    cs_aec.ctx_base_id = 0;     /* stack memory holds no valid context snapshot */
+    h->copy_aec_state_rdo(&cs_aec, p_aec);
+    large_cu_cost = compress_cu_intra(h, &cs_aec, p_cu, best, cost_limit);
+
+    /* QSFD, skip smaller CU partitions */
+    if (IS_ALG_ENABLE(OPT_CU_QSFD)) {
+        if (p_cu->cu_info.i_level > 3 && large_cu_cost < h->thres_qsfd_cu[1][p_cu->cu_info.i_level - 3]) {
+            *b_split_ctu = FALSE;
+        }
+    }
+
+    return large_cu_cost;
+}
+
+/* ---------------------------------------------------------------------------
+ * evaluate the non-split candidate of an inter CU,
+ * *b_split_ctu is cleared if the smaller CUs can be skipped
+ */
+static
+rdcost_t compress_ctu_inter_large(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, cu_info_t *best, uint32_t avail_modes,
+                                  int i_level, int i_min_level, int i_upper_mode, rdcost_t cost_limit, int *b_split_ctu)
+{
+    aec_t cs_aec;
+    rdcost_t large_cu_cost;
+    rdcost_t split_flag_cost = 0;
+
+    cs_aec.ctx_base_id = 0;     /* stack memory holds no valid context snapshot */
+    h->copy_aec_state_rdo(&cs_aec, p_aec);
+    if (i_level > MIN_CU_SIZE_IN_BIT) {
+        split_flag_cost = h->f_lambda_mode * p_aec->binary.write_ctu_split_flag(&cs_aec, 0, i_level);
+    }
+
+    large_cu_cost = compress_cu_inter(h, &cs_aec, p_cu, best, avail_modes, MAX_COST, cost_limit);
+    large_cu_cost += split_flag_cost;
+
+    if (IS_ALG_ENABLE(OPT_ET_HOMO_MV) && i_level > i_min_level) {
+        *b_split_ctu &= !is_ET_inter_recur(h, p_cu, best);
+    }
+
+    /* ǰCUһCUģʽΪSKIPģʽ²CUĻ @ */
+    if (IS_ALG_ENABLE(OPT_CU_CSET) &&
+        ((p_cu->i_size <= 16 && h->i_type == SLICE_TYPE_B) || (p_cu->i_size <= 32 && h->fdec->rps.referd_by_others == 0))) {
+        if (IS_SKIP_MODE(i_upper_mode) && IS_SKIP_MODE(best->i_mode)) {
+            *b_split_ctu = 0;
+        }
+    }
+
+    /* QSFD, skip smaller CU partitions */
+    if (IS_ALG_ENABLE(OPT_CU_QSFD)) {
+        if (p_cu->cu_info.i_level != 3 && large_cu_cost < h->thres_qsfd_cu[0][p_cu->cu_info.i_level - 3]) {
+            *b_split_ctu = FALSE;
+        }
+    }
+
+    if (IS_ALG_ENABLE(OPT_ECU) && i_level > i_min_level) {
+        // int i_level_left = p_cu->p_left_cu ? p_cu->p_left_cu->i_level : MAX_CU_SIZE_IN_BIT;
+        // int i_level_top  = p_cu->p_topA_cu ? p_cu->p_topA_cu->i_level : MAX_CU_SIZE_IN_BIT;
+
+        // *b_split_ctu &= !(i_level_left >= i_level && i_level_top >= i_level && (best->i_mode == PRED_SKIP));
+        *b_split_ctu &= !((best->i_mode == PRED_SKIP) && (best->i_cbp == 0) && p_cu->is_zero_block);
+    }
+
+    return large_cu_cost;
+}
+
+/* ---------------------------------------------------------------------------
+ * parallel analysis inside CTU (ParallelCTU): the non-split candidate of a
+ * 64x64 or 32x32 CU is evaluated on a helper context, while the owner context
+ * goes on with the 4 sub-CUs. the two candidates are compared after joining
+ */
+static void *cu_fork_proc(void *arg)
+{
+    cu_fork_t *p_fork = (cu_fork_t *)arg;
+    xavs2_t   *h      = p_fork->h;
+    cu_t      *p_cu   = p_fork->p_cu;
+    cu_info_t *best   = &cu_get_layer(h, p_fork->i_level)->cu_best;
+    int b_split_ctu   = TRUE;
+
+    cu_init(h, p_cu, best, p_fork->i_level);
+    if (h->i_type == SLICE_TYPE_I) {
+        p_fork->cost = compress_ctu_intra_large(h, &h->aec, p_cu, best, p_fork->cost_limit, &b_split_ctu);
+    } else {
+        p_fork->cost = compress_ctu_inter_large(h, &h->aec, p_cu, best, p_fork->avail_modes, p_fork->i_level,
+                                                p_fork->i_min_level, p_fork->i_upper_mode, p_fork->cost_limit, &b_split_ctu);
+    }
+    p_fork->b_split = b_split_ctu;
+
+    return NULL;
+}
+
+/* ---------------------------------------------------------------------------
+ * start evaluating the non-split candidate of a CU on a helper context
+ */
+static void cu_fork_start(xavs2_t *h, cu_fork_t *p_fork, aec_t *p_aec, cu_t *p_cu, int i_level,
+                          int i_min_level, uint32_t avail_modes, rdcost_t cost_limit)
+{
+    xavs2_t *h_fork    = p_fork->h;
+    cu_t    *p_fork_cu = h_fork->lcu.all_cu + (p_cu - h->lcu.all_cu);
+
+    /* the helper starts from the current state of the owner */
+    h_fork->param = h->param;
+    memcpy(&h_fork->rc, &h->rc, (uint8_t *)&h->communal_vars_2 - (uint8_t *)&h->rc);
+    memcpy(&h_fork->row_vars_1, &h->row_vars_1, (uint8_t *)&h->row_vars_2 - (uint8_t *)&h->row_vars_1);
+    memcpy(&h_fork->lcu, &h->lcu, (uint8_t *)&h->lcu.p_ctu - (uint8_t *)&h->lcu);
+    memcpy(h_fork->lcu.fenc_buf,     h->lcu.fenc_buf,     sizeof(h->lcu.fenc_buf));
+    memcpy(h_fork->lcu.fdec_buf,     h->lcu.fdec_buf,     sizeof(h->lcu.fdec_buf));
+    memcpy(h_fork->lcu.ctu_border,   h->lcu.ctu_border,   sizeof(h->lcu.ctu_border));
+    memcpy(h_fork->lcu.fenc_lowres,  h->lcu.fenc_lowres,  sizeof(h->lcu.fenc_lowres));
+    memcpy(h_fork->lcu.pyramid_mv,   h->lcu.pyramid_mv,   sizeof(h->lcu.pyramid_mv));
+    memcpy(h_fork->lcu.mvcache_mv,   h->lcu.mvcache_mv,   sizeof(h->lcu.mvcache_mv));
+    memcpy(h_fork->lcu.mvcache_cost, h->lcu.mvcache_cost, sizeof(h->lcu.mvcache_cost));
+    memcpy(h_fork->lcu.mvcache_mask, h->lcu.mvcache_mask, sizeof(h->lcu.mvcache_mask));
+    h_fork->lcu.pyramid_mask = h->lcu.pyramid_mask;
+    h->copy_aec_state_rdo(&h_fork->aec, p_aec);
+#if ENABLE_RATE_CONTROL_CU
+    p_fork->last_dqp     = *h->last_dquant;
+    h_fork->last_dquant  = &p_fork->last_dqp;
+#endif
+
+    /* the SAD prediction of UMH is written by both candidates, the helper
+     * works on a private copy of the rows around the CU */
+    if (p_fork->mincost_buf != NULL) {
+        int w_in_4x4 = h->i_width_in_minpu;
+        int b4_x     = p_cu->i_pix_x >> MIN_PU_SIZE_IN_BIT;
+        int b4_y     = p_cu->i_pix_y >> MIN_PU_SIZE_IN_BIT;
+        int b4_size  = p_cu->i_size  >> MIN_PU_SIZE_IN_BIT;
+        int start_y  = XAVS2_MAX(b4_y - 1, 0);
+        int start_x  = XAVS2_MAX(b4_x - 1, 0);
+        int end_x    = XAVS2_MIN(b4_x + b4_size + 1, w_in_4x4);
+        int y;
+
+        h_fork->all_mincost = p_fork->mincost_buf - start_y * w_in_4x4;
+        for (y = start_y; y < b4_y + b4_size; y++) {
+            memcpy(h_fork->all_mincost + y * w_in_4x4 + start_x, h->all_mincost + y * w_in_4x4 + start_x,
+                   (end_x - start_x) * sizeof(h->all_mincost[0]));
+        }
+    }
+
+    /* position of the CU in the coding tree of the helper */
+    p_fork_cu->i_pix_x         = p_cu->i_pix_x;
+    p_fork_cu->i_pix_y         = p_cu->i_pix_y;
+    p_fork_cu->i_scu_xy        = p_cu->i_scu_xy;
+    p_fork_cu->cu_info.i_scu_x = p_cu->cu_info.i_scu_x;
+    p_fork_cu->cu_info.i_scu_y = p_cu->cu_info.i_scu_y;
+
+    p_fork->p_cu         = p_fork_cu;
+    p_fork->i_level      = i_level;
+    p_fork->i_min_level  = i_min_level;
+    p_fork->i_upper_mode = cu_get_upper_mode(h, i_level);
+    p_fork->avail_modes  = avail_modes;
+    p_fork->cost_limit   = cost_limit;
+
+    h->lcu.fork_mask |= 1u << i_level;
+    xavs2_threadpool_run(h->h_top->threadpool_ctu, cu_fork_proc, p_fork, 1);
+}
+
+/* ---------------------------------------------------------------------------
+ * wait for the non-split candidate evaluated on a helper context and return
+ * its rd-cost. the early terminations of the split candidate, skipped while
+ * the non-split one was not known, are applied on the partial sums here
+ */
+static rdcost_t cu_fork_join(xavs2_t *h, cu_fork_t *p_fork, const rdcost_t split_cu_costs[4], int b_inter,
+                             rdcost_t *split_cu_cost)
+{
+    rdcost_t large_cu_cost;
+    int i;
+
+    xavs2_threadpool_wait(h->h_top->threadpool_ctu, p_fork);
+    h->lcu.fork_mask &= ~(1u << p_fork->i_level);
+    large_cu_cost = p_fork->cost;
+
+    if (!p_fork->b_split) {
+        *split_cu_cost = MAX_COST;
+    }
+
+    for (i = 0; i < 4 && *split_cu_cost != MAX_COST; i++) {
+        if (split_cu_costs[i] < 0) {
+            continue;       // current sub CU is outside the frame
+        }
+        if (split_cu_costs[i] > large_cu_cost ||
+            (i != 3 && IS_ALG_ENABLE(OPT_CODE_OPTIMZATION) && (split_cu_costs[i] >= SUBCU_COST_RATE[b_inter][i] * large_cu_cost))) {
+            *split_cu_cost = MAX_COST; // guide RDO to select large CU
+        }
+    }
+
+    return large_cu_cost;
+}
+
+/* ---------------------------------------------------------------------------
+ * take the non-split candidate evaluated on a helper context
+ */
+static void cu_fork_merge(xavs2_t *h, cu_fork_t *p_fork, aec_t *p_aec, cu_t *p_cu)
+{
+    cu_layer_t *p_fork_layer = cu_get_layer(p_fork->h, p_fork->i_level);
+
+    memcpy(&p_cu->mc, &p_fork->p_cu->mc, sizeof(p_cu->mc));
+    if (h->i_type != SLICE_TYPE_I) {
+        memcpy(&cu_get_layer_mode(h, p_fork->i_level)->best_mc, &p_fork_layer->cu_mode.best_mc, sizeof(cu_mc_param_t));
+    }
+    cu_copy_stored_parameters(h, p_cu, &p_fork_layer->cu_best);
+    h->copy_aec_state_rdo(p_aec, &p_fork_layer->cs_cu);
+#if ENABLE_RATE_CONTROL_CU
+    *h->last_dquant = p_fork->last_dqp;
+#endif
+}
+
+/* ---------------------------------------------------------------------------
+ * helper context for the non-split candidate of a CU, NULL: serial analysis
+ */
+static INLINE
+cu_fork_t *cu_get_fork(xavs2_t *h, int i_level, int b_check_large_cu, int b_split_ctu)
+{
+    if (h->cu_forks != NULL && b_check_large_cu && b_split_ctu && i_level >= B32X32_IN_BIT &&
+        h->i_lcu_level - i_level < 2) {
+        return &h->cu_forks[h->i_lcu_level - i_level];
+    }
+    return NULL;
+}
+
 /**
  * ===========================================================================
  * interface function defines
@@ -3361,11 +3515,12 @@ void xavs2_init_valid_mode_table(xavs2_t *h)
  */
 rdcost_t compress_ctu_intra(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, int i_level, int i_min_level, int i_max_level, rdcost_t cost_limit)
 {
-    aec_t cs_aec;
     cu_layer_t *p_layer    = cu_get_layer(h, i_level);
     cu_info_t *best        = &p_layer->cu_best;
+    cu_fork_t *p_fork      = NULL;
     rdcost_t large_cu_cost = MAX_COST;
     rdcost_t split_cu_cost = MAX_COST;
+    rdcost_t split_cu_costs[4] = { -1, -1, -1, -1 };  /* partial sums of the split candidate */
     int b_inside_pic       = (p_cu->i_pix_x + p_cu->i_size <= h->i_width) && (p_cu->i_pix_y + p_cu->i_size <= h->i_height);
     int b_split_ctu        = (i_level > i_min_level || !b_inside_pic);
     int b_check_large_cu   = (b_inside_pic && i_level <= i_max_level);
@@ -3381,14 +3536,10 @@ rdcost_t compress_ctu_intra(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, int i_level, i
             b_split_ctu &= ctu_intra_depth_pred_mad(h, i_level, p_cu->i_pos_x, p_cu->i_pos_y);
         }
 
-        h->copy_aec_state_rdo(&cs_aec, p_aec);
-        large_cu_cost = compress_cu_intra(h, &cs_aec, p_cu, best, cost_limit);
-
-        /* QSFD, skip smaller CU partitions */
-        if (IS_ALG_ENABLE(OPT_CU_QSFD)) {
-            if (p_cu->cu_info.i_level > 3 && large_cu_cost < h->thres_qsfd_cu[1][p_cu->cu_info.i_level - 3]) {
-                b_split_ctu = FALSE;
-            }
+        if ((p_fork = cu_get_fork(h, i_level, b_check_large_cu, b_split_ctu)) != NULL) {
+            cu_fork_start(h, p_fork, p_aec, p_cu, i_level, i_min_level, 0, cost_limit);
+        } else {
+            large_cu_cost = compress_ctu_intra_large(h, p_aec, p_cu, best, cost_limit, &b_split_ctu);
         }
     }
 
@@ -3411,6 +3562,7 @@ rdcost_t compress_ctu_intra(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, int i_level, i
             }
 
             split_cu_cost += compress_ctu_intra(h, p_aec, p_sub_cu, i_level - 1, i_min_level, i_max_level, large_cu_cost - split_cu_cost);
+            split_cu_costs[i] = split_cu_cost;
 
             if (split_cu_cost > large_cu_cost ||
                 (i != 3 && IS_ALG_ENABLE(OPT_CODE_OPTIMZATION) && (split_cu_cost >= SUBCU_COST_RATE[0][i] * large_cu_cost))) {
@@ -3422,7 +3574,13 @@ rdcost_t compress_ctu_intra(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, int i_level, i
 
     /* decide split or not -----------------------------------------
      */
-    if (large_cu_cost < split_cu_cost) {
+    if (p_fork != NULL) {
+        large_cu_cost = cu_fork_join(h, p_fork, split_cu_costs, 0, &split_cu_cost);
+        if (large_cu_cost < split_cu_cost) {
+            cu_fork_merge(h, p_fork, p_aec, p_cu);
+            split_cu_cost = large_cu_cost;
+        }
+    } else if (large_cu_cost < split_cu_cost) {
         /* the larger cu is selected */
         cu_copy_stored_parameters(h, p_cu, best);
         h->copy_aec_state_rdo(p_aec, &p_layer->cs_cu);
@@ -3436,12 +3594,12 @@ rdcost_t compress_ctu_intra(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, int i_level, i
  */
 rdcost_t compress_ctu_inter(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, int i_level, int i_min_level, int i_max_level, rdcost_t cost_limit)
 {
-    aec_t cs_aec;
     cu_layer_t *p_layer      = cu_get_layer(h, i_level);
     cu_info_t *best          = &p_layer->cu_best;
+    cu_fork_t *p_fork        = NULL;
     rdcost_t large_cu_cost   = MAX_COST;
     rdcost_t split_cu_cost   = MAX_COST;
-    rdcost_t split_flag_cost = 0;
+    rdcost_t split_cu_costs[4] = { -1, -1, -1, -1 };  /* partial sums of the split candidate */
     uint32_t avail_modes     = cu_get_valid_modes(h, h->i_type, i_level);
     int b_inside_pic         = (p_cu->i_pix_x + p_cu->i_size <= h->i_width) && (p_cu->i_pix_y + p_cu->i_size <= h->i_height);
     int b_split_ctu          = (i_level > i_min_level || !b_inside_pic);
@@ -3454,41 +3612,11 @@ rdcost_t compress_ctu_inter(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, int i_level, i
     /* coding current CU -------------------------------------------
      */
     if (b_check_large_cu) {
-        h->copy_aec_state_rdo(&cs_aec, p_aec);
-        if (i_level > MIN_CU_SIZE_IN_BIT) {
-            split_flag_cost = h->f_lambda_mode * p_aec->binary.write_ctu_split_flag(&cs_aec, 0, i_level);
-        }
-
-        large_cu_cost = compress_cu_inter(h, &cs_aec, p_cu, best, avail_modes, large_cu_cost, cost_limit);
-        large_cu_cost += split_flag_cost;
-
-        if (IS_ALG_ENABLE(OPT_ET_HOMO_MV) && i_level > i_min_level) {
-            b_split_ctu &= !is_ET_inter_recur(h, p_cu, best);
-        }
-
-        /* ǰCUһCUģʽΪSKIPģʽ²CUĻ @ */
-        if (IS_ALG_ENABLE(OPT_CU_CSET) &&
-            ((p_cu->i_size <= 16 && h->i_type == SLICE_TYPE_B) || (p_cu->i_size <= 32 && h->fdec->rps.referd_by_others == 0))) {
-            cu_layer_t *p_ulayer = cu_get_layer(h, i_level + 1);
-            cu_info_t *curr_ubest = &p_ulayer->cu_best;
-            if (IS_SKIP_MODE(curr_ubest->i_mode) && IS_SKIP_MODE(best->i_mode)) {
-                b_split_ctu = 0;
-            }
-        }
-
-        /* QSFD, skip smaller CU partitions */
-        if (IS_ALG_ENABLE(OPT_CU_QSFD)) {
-            if (p_cu->cu_info.i_level != 3 && large_cu_cost < h->thres_qsfd_cu[0][p_cu->cu_info.i_level - 3]) {
-                b_split_ctu = FALSE;
-            }
-        }
-
-        if (IS_ALG_ENABLE(OPT_ECU) && i_level > i_min_level) {
-            // int i_level_left = p_cu->p_left_cu ? p_cu->p_left_cu->i_level : MAX_CU_SIZE_IN_BIT;
-            // int i_level_top  = p_cu->p_topA_cu ? p_cu->p_topA_cu->i_level : MAX_CU_SIZE_IN_BIT;
-
-            // b_split_ctu &= !(i_level_left >= i_level && i_level_top >= i_level && (best->i_mode == PRED_SKIP));
-            b_split_ctu &= !((best->i_mode == PRED_SKIP) && (best->i_cbp == 0) && p_cu->is_zero_block);
+        if ((p_fork = cu_get_fork(h, i_level, b_check_large_cu, b_split_ctu)) != NULL) {
+            cu_fork_start(h, p_fork, p_aec, p_cu, i_level, i_min_level, avail_modes, cost_limit);
+        } else {
+            large_cu_cost = compress_ctu_inter_large(h, p_aec, p_cu, best, avail_modes, i_level, i_min_level,
+                                                     cu_get_upper_mode(h, i_level), cost_limit, &b_split_ctu);
         }
     }
 
@@ -3513,6 +3641,7 @@ rdcost_t compress_ctu_inter(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, int i_level, i
             }
 
             split_cu_cost += compress_ctu_inter(h, p_aec, p_sub_cu, i_level - 1, i_min_level, i_max_level, large_cu_cost - split_cu_cost);
+            split_cu_costs[i] = split_cu_cost;
 
             if (split_cu_cost > large_cu_cost ||
                 (i != 3 && IS_ALG_ENABLE(OPT_CODE_OPTIMZATION) && (split_cu_cost >= SUBCU_COST_RATE[1][i] * large_cu_cost))) {
@@ -3537,10 +3666,18 @@ rdcost_t compress_ctu_inter(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, int i_level, i
 
     /* decide split or not -----------------------------------------
      */
-    if (large_cu_cost < split_cu_cost) {
+    if (p_fork != NULL) {
+        large_cu_cost = cu_fork_join(h, p_fork, split_cu_costs, 1, &split_cu_cost);
+        if (large_cu_cost < split_cu_cost) {
+            cu_fork_merge(h, p_fork, p_aec, p_cu);
+        }
+    } else if (large_cu_cost < split_cu_cost) {
         /* the larger cu is selected */
         cu_copy_stored_parameters(h, p_cu, best);
         h->copy_aec_state_rdo(p_aec, &p_layer->cs_cu);
+    }
+
+    if (large_cu_cost < split_cu_cost) {
         split_cu_cost = large_cu_cost;
         p_cu->is_ctu_split = FALSE;
     } else {
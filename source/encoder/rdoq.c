@@ -83,16 +83,15 @@ typedef struct cost_state_t {
 
 
 /* ---------------------------------------------------------------------------
- * level info for RDOQ
+ * candidate levels of the 16 coefficients in one CG for RDOQ
+ * (structure of arrays, indexed by the scan position in CG)
  */
-typedef struct level_info_t {
-    int         pos_scan;             /* position in transform block zig-zag scan order */
-    int         pos_xy;               /* position in block */
-    int         num_level;            /* number of candidate levels */
-    coeff_t     level[3];             /* candidate levels */
-    coeff_t     coeff;                /* coefficient before quantization */
-    double      errLevel[3];          /* quantization errors of each candidate */
-} level_info_t;
+typedef struct cg_level_t {
+    ALIGN16(int32_t err_level[3][16]); /* squared quantization errors of each candidate */
+    ALIGN16(coeff_t level    [16]);    /* the largest candidate level L: {0}, {0, L} or {0, L, L + 1} */
+    ALIGN16(int8_t  num_level[16]);    /* number of candidate levels */
+    double          f_err_level_mult;  /* scale of the squared quantization errors */
+} cg_level_t;
 
 
 /* ---------------------------------------------------------------------------
@@ -101,7 +100,6 @@ typedef struct node_t node_t;
 struct node_t {
     node_t       *prev;
     node_t       *next;
-    level_info_t *level_info;
     int           attrib;             // node_type_e, 0: last pos; 1: last run; 2: (Run, Level) pair
     int           level;
     int           run;
@@ -171,13 +169,12 @@ static ALWAYS_INLINE void list_init(node_list_t *list)
  * create a new node and append it to list
  */
 static ALWAYS_INLINE node_t *
-create_and_append_node(node_list_t *list, level_info_t *level_info, int attrib, int pos)
+create_and_append_node(node_list_t *list, int attrib, int pos)
 {
     node_t *p_node = list->nodeBuf + list->i_size;
 
     /* 1, create a new node */
     p_node->attrib     = attrib;
-    p_node->level_info = level_info;
     p_node->run        = 0;
     p_node->pos        = pos;
     p_node->prev       = NULL;
@@ -580,140 +577,103 @@ rdoq_get_last_cg_pos(coeff_t *ncur_blk, int num_coeff, const int thres_lower_int
 
 #if ENABLE_WQUANT
 /* ---------------------------------------------------------------------------
- * rdoqԤȼһϵȡֵȨ
+ * generate the candidate levels of the coefficients in one CG (weighted quantization)
+ * return a bit-mask of the coefficients which have non-zero candidate levels
  */
-static int rdoq_est_coeff_level_wq(xavs2_t *h, level_info_t *p_level_info,
-                                   wq_data_t *wq, int wqm_size_id, int wqm_size, int xx, int yy,
-                                   coeff_t coeff, int qp, int shift_bit)
+static int rdoq_est_cg_levels_wq(xavs2_t *h, rdoq_t *p_rdoq, cg_level_t *p_cg, coeff_t *p_ncoeff, int i_cg,
+                                 wq_data_t *wq, int wqm_size_id, int wqm_size, int qp, int shift_bit)
 {
-    const double f_err_level_mult = 256.0 / (1 << (shift_bit * 2));
     const int thres_lower_int = (int)((16384 << shift_bit) / (double)(tab_Q_TAB[qp]));
     const int scale = tab_IQ_TAB[qp];
     const int shift = tab_IQ_SHIFT[qp] - shift_bit;
+    const int size_shift = xavs2_log2u(p_rdoq->num_cg_x << 2);
     int wqm_shift   = (h->param->PicWQDataIndex == 1) ? 3 : 0;
-    int wqm_coef    = 1;
-    int rec, err;
-    int level;
-    int b_lower;
-    int stride;
-
-    if ((wqm_size_id == 0) || (wqm_size_id == 1)) {
-        stride   = wqm_size;
-        wqm_coef = wq->cur_wq_matrix[wqm_size_id][(yy & (stride - 1)) * stride + (xx & (stride - 1))];
-    } else if (wqm_size_id == 2) {
-        stride   = wqm_size >> 1;
-        wqm_coef = wq->cur_wq_matrix[wqm_size_id][((yy >> 1) & (stride - 1)) * stride + ((xx >> 1) & (stride - 1))];
-    } else if (wqm_size_id == 3) {
-        stride   = wqm_size >> 2;
-        wqm_coef = wq->cur_wq_matrix[wqm_size_id][((yy >> 2) & (stride - 1)) * stride + ((xx >> 2) & (stride - 1))];
-    }
+    int mask = 0;
+    int i;
 
-    level   = (int)(coeff * tab_Q_TAB[qp] >> (15 + shift_bit));
-    level   = XAVS2_CLIP3((-((1 << 18) / wqm_coef)), (((1 << 18) / wqm_coef) - 1), level);
-    rec     = (((((coeff * wqm_coef) >> 3) * scale) >> 4) + (1 << (shift - 1))) >> shift;
-    b_lower = (coeff - rec) <= thres_lower_int;
-
-#define GET_ERROR_LEVEL_WQ(i, cur_level) \
-    {\
-        rec = ((((((int)(cur_level) * wqm_coef) >> wqm_shift) * scale) >> 4) + (1 << (shift - 1))) >> shift;\
-        err = coeff - rec;\
-        p_level_info->errLevel[i] = err * err * f_err_level_mult;\
-        p_level_info->level[i]    = (coeff_t)(cur_level);\
-    }
+    for (i = 0; i < 16; i++) {
+        int xx_yy = p_rdoq->p_scan_tab_1d[(i_cg << 4) + i];
+        int xx    = xx_yy & ((1 << size_shift) - 1);
+        int yy    = xx_yy >> size_shift;
+        int coeff = p_ncoeff[i];
+        int wqm_coef = 1;
+        int rec, err;
+        int level;
+        int b_lower;
+        int stride;
+
+        if ((wqm_size_id == 0) || (wqm_size_id == 1)) {
+            stride   = wqm_size;
+            wqm_coef = wq->cur_wq_matrix[wqm_size_id][(yy & (stride - 1)) * stride + (xx & (stride - 1))];
+        } else if (wqm_size_id == 2) {
+            stride   = wqm_size >> 1;
+            wqm_coef = wq->cur_wq_matrix[wqm_size_id][((yy >> 1) & (stride - 1)) * stride + ((xx >> 1) & (stride - 1))];
+        } else if (wqm_size_id == 3) {
+            stride   = wqm_size >> 2;
+            wqm_coef = wq->cur_wq_matrix[wqm_size_id][((yy >> 2) & (stride - 1)) * stride + ((xx >> 2) & (stride - 1))];
+        }
 
-    /* 1, generate levels of one coefficient [xx, yy] */
-    p_level_info->coeff = coeff;
-    GET_ERROR_LEVEL_WQ(0, 0);
-    if (level == 0) {
-        if (b_lower) {
-            p_level_info->num_level = 1;
-            return 0;
+        level   = (int)(coeff * tab_Q_TAB[qp] >> (15 + shift_bit));
+        level   = XAVS2_CLIP3((-((1 << 18) / wqm_coef)), (((1 << 18) / wqm_coef) - 1), level);
+        rec     = (((((coeff * wqm_coef) >> 3) * scale) >> 4) + (1 << (shift - 1))) >> shift;
+        b_lower = (coeff - rec) <= thres_lower_int;
+
+        /* candidates: {0}, {0, 1}, {0, level} or {0, level, level + 1} */
+        if (level == 0) {
+            level = !b_lower;
+            p_cg->num_level[i] = (int8_t)(1 + !b_lower);
         } else {
-            GET_ERROR_LEVEL_WQ(1, 1);
-            p_level_info->num_level = 2;
-            return 1;
+            p_cg->num_level[i] = (int8_t)(2 + !b_lower);
         }
-    } else {
-        if (b_lower) {
-            GET_ERROR_LEVEL_WQ(1, level);
-            p_level_info->num_level = 2;
-        } else {
-            GET_ERROR_LEVEL_WQ(1, level);
-            GET_ERROR_LEVEL_WQ(2, level + 1);
-            p_level_info->num_level = 3;
+        p_ncoeff[i] = (coeff_t)level;
+        mask |= (p_cg->num_level[i] > 1) << i;
+
+#define GET_ERROR_LEVEL_WQ(j, cur_level) \
+        {\
+            rec = ((((((int)(cur_level) * wqm_coef) >> wqm_shift) * scale) >> 4) + (1 << (shift - 1))) >> shift;\
+            err = coeff - rec;\
+            p_cg->err_level[j][i] = err * err;\
         }
 
-        return level;
+        GET_ERROR_LEVEL_WQ(0, 0);
+        GET_ERROR_LEVEL_WQ(1, level);
+        GET_ERROR_LEVEL_WQ(2, level + 1);
+#undef GET_ERROR_LEVEL_WQ
     }
 
-#undef GET_ERROR_LEVEL_WQ
+    return mask;
 }
 #endif
 
 /* ---------------------------------------------------------------------------
- * rdoqԤȼһϵȡֵ
+ * quantization error of the i-th candidate level of the coefficient at pos
  */
-static ALWAYS_INLINE int
-rdoq_est_coeff_level(level_info_t *p_level_info, coeff_t coeff, int qp, int shift_bit,
-                     const double f_err_level_mult, const int thres_lower_int)
+static ALWAYS_INLINE double
+rdoq_get_err_level(const cg_level_t *p_cg, int i, int pos)
 {
-    const int scale = tab_IQ_TAB[qp];
-    const int shift = tab_IQ_SHIFT[qp] - shift_bit;
-    const int shift_offset = 1 << (shift - 1);
-    int rec, err;
-    int level;
-    int b_lower;
-
-#define GET_ERROR_LEVEL(i, cur_level) \
-    {\
-        rec = ((cur_level) * scale + shift_offset) >> shift;\
-        err = coeff - rec;\
-        p_level_info->errLevel[i] = err * err * f_err_level_mult;\
-        p_level_info->level[i] = (coeff_t)(cur_level);\
-    }
-
-    level   = (int)(coeff * tab_Q_TAB[qp] >> (15 + shift_bit));
-    rec     = (level * scale + shift_offset) >> shift;
-    b_lower = (coeff - rec) <= thres_lower_int;
-
-    p_level_info->coeff = coeff;
-    GET_ERROR_LEVEL(0, 0);
-    if (level == 0) {
-        if (b_lower) {
-            p_level_info->num_level = 1;
-            return 0;
-        } else {
-            GET_ERROR_LEVEL(1, 1);
-            p_level_info->num_level = 2;
-            return 1;
-        }
-    } else {
-        if (b_lower) {
-            GET_ERROR_LEVEL(1, level);
-            p_level_info->num_level = 2;
-        } else {
-            GET_ERROR_LEVEL(1, level);
-            GET_ERROR_LEVEL(2, level + 1);
-            p_level_info->num_level = 3;
-        }
-
-        return level;
-    }
+    return p_cg->err_level[i][pos] * p_cg->f_err_level_mult;
+}
 
-#undef GET_ERROR_LEVEL
+/* ---------------------------------------------------------------------------
+ * the i-th candidate level of the coefficient at pos
+ */
+static ALWAYS_INLINE int
+rdoq_get_cand_level(const cg_level_t *p_cg, int i, int pos)
+{
+    return i ? p_cg->level[pos] + i - 1 : 0;
 }
 
 /* ---------------------------------------------------------------------------
- * ָڵϵۼӺ
+ * sum of the coefficients in [pos_start, pos_end] of one CG
  */
 static ALWAYS_INLINE int
-rdoq_get_sum_abs_coeff(level_info_t *p_level_info, const coeff_t *p_ncoeff, int pos_start, int pos_end)
+rdoq_get_sum_abs_coeff(const coeff_t *p_ncoeff, int pos_start, int pos_end)
 {
     int sum = 0;
     int pos;
 
     for (pos = pos_start; pos <= pos_end; pos++) {
-        sum += p_ncoeff[p_level_info[pos].pos_scan];
+        sum += p_ncoeff[pos];
     }
 
     return sum;
@@ -722,10 +682,11 @@ rdoq_get_sum_abs_coeff(level_info_t *p_level_info, const coeff_t *p_ncoeff, int
 /* ---------------------------------------------------------------------------
  * һCGڵϵĸlevelǰCG
  */
-static int rdoq_est_cg(xavs2_t *h, rdoq_t *p_rdoq, level_info_t *p_level_info, cost_state_t *p_cost_stat, node_t *node,
+static int rdoq_est_cg(xavs2_t *h, rdoq_t *p_rdoq, cg_level_t *p_cg, cost_state_t *p_cost_stat, node_t *node,
                        coeff_t *ncur_blk, int8_t *p_sig_cg_flag, int iCG, int rank_pre)
 {
     static const int T_Chr[5] = {0, 1, 2, 4, INT_MAX};
+    coeff_t *p_ncoeff = ncur_blk + (iCG << 4);
     pair_cost_t *p_pair_cost = &p_cost_stat->pairCost[0];
     context_t(*p_ctx_primary)[NUM_MAP_CTX] = p_rdoq->p_ctx_primary;
     context_t *p_ctx;
@@ -772,14 +733,14 @@ static int rdoq_est_cg(xavs2_t *h, rdoq_t *p_rdoq, level_info_t *p_level_info, c
             int xx_yy;
 
             isSigCG = 1;
-            for (levelNo = 1; levelNo < node->level_info->num_level; levelNo++) {
+            for (levelNo = 1; levelNo < p_cg->num_level[node->pos]; levelNo++) {
                 int rateLevel;
                 int rateRunCurr;
                 int rateRunPrev;
                 int pos_end = XAVS2_MIN(node->pos + 6, 15);
 
                 // rate: Level
-                absLevel  = node->level_info->level[levelNo];
+                absLevel  = rdoq_get_cand_level(p_cg, levelNo, node->pos);
                 p_ctx     = p_rdoq->p_ctx_coeff_level;
                 rateLevel = est_rate_level(p_ctx, rank, absLevel, pairsInCG, iCG, 15 - node->pos, p_rdoq->b_luma);
 
@@ -787,7 +748,7 @@ static int rdoq_est_cg(xavs2_t *h, rdoq_t *p_rdoq, level_info_t *p_level_info, c
                 rateLevel += biari_encode_symbol_eq_prob_est(absLevel < 0);
 
                 // rate: Run[i]
-                absSum5     = absLevel + rdoq_get_sum_abs_coeff(p_level_info, ncur_blk, node->pos + 1, pos_end);
+                absSum5     = absLevel + rdoq_get_sum_abs_coeff(p_ncoeff, node->pos + 1, pos_end);
                 p_ctx       = p_ctx_primary[XAVS2_MIN((absSum5 >> 1), 2)];
                 rateRunCurr = est_rate_run(p_rdoq, p_ctx, node->run, 15 - node->pos, iCG, node->pos);
 
@@ -805,18 +766,18 @@ static int rdoq_est_cg(xavs2_t *h, rdoq_t *p_rdoq, level_info_t *p_level_info, c
                     p_cost_stat->lastRunCost = lambda_rdoq * rateRunPrev;
                 } else { // RUN_LEVEL_PAIR
                     pos_end     = XAVS2_MIN(node->prev->pos + 6, 15);
-                    absSum5     = rdoq_get_sum_abs_coeff(p_level_info, ncur_blk, node->prev->pos, pos_end);
+                    absSum5     = rdoq_get_sum_abs_coeff(p_ncoeff, node->prev->pos, pos_end);
                     p_ctx       = p_ctx_primary[XAVS2_MIN((absSum5 >> 1), 2)];
                     rateRunPrev = est_rate_run(p_rdoq, p_ctx, node->prev->run, 15 - node->prev->pos, iCG, node->prev->pos);
                 }
 
                 // cost for the current (Level, Run) pair
-                p_pair_cost->levelCost = (rdcost_t)(node->level_info->errLevel[levelNo] + lambda_rdoq * rateLevel);
+                p_pair_cost->levelCost = (rdcost_t)(rdoq_get_err_level(p_cg, levelNo, node->pos) + lambda_rdoq * rateLevel);
                 p_pair_cost->runCost   = lambda_rdoq * rateRunCurr;
-                p_pair_cost->scanPos   = node->level_info->pos_scan;
+                p_pair_cost->scanPos   = (iCG << 4) + node->pos;
 
                 // calculate cost: distLevel[i] + rateLevel[i] + rateRun[i] + rateRun[i+1]
-                lagr = (rdcost_t)(node->level_info->errLevel[levelNo] + lambda_rdoq * (rateLevel + rateRunCurr + rateRunPrev));
+                lagr = (rdcost_t)(rdoq_get_err_level(p_cg, levelNo, node->pos) + lambda_rdoq * (rateLevel + rateRunCurr + rateRunPrev));
                 if (lagr < minlagr) {
                     minlagr = lagr;
                     best_state = levelNo;
@@ -824,7 +785,7 @@ static int rdoq_est_cg(xavs2_t *h, rdoq_t *p_rdoq, level_info_t *p_level_info, c
 
                 lagrDelta = lambda_rdoq * rateRunPrev;
             }
-            p_pair_cost->uncodedCost = (rdcost_t)(node->level_info->errLevel[0]);
+            p_pair_cost->uncodedCost = (rdcost_t)(rdoq_get_err_level(p_cg, 0, node->pos));
 
             // compare cost of level or level-1 with uncoded case (level=0)
             // Run[i]
@@ -833,7 +794,7 @@ static int rdoq_est_cg(xavs2_t *h, rdoq_t *p_rdoq, level_info_t *p_level_info, c
                     int pos_start = node->prev->pos;
                     int pos_end   = XAVS2_MIN(pos_start + 6, 15);
 
-                    absSum5       = rdoq_get_sum_abs_coeff(p_level_info, ncur_blk, pos_start, pos_end);
+                    absSum5       = rdoq_get_sum_abs_coeff(p_ncoeff, pos_start, pos_end);
                     p_ctx         = p_ctx_primary[XAVS2_MIN((absSum5 >> 1), 2)];
                     rateRunMerged = est_rate_run(p_rdoq, p_ctx, node->prev->run + 1 + node->run, 15 - pos_start, iCG, pos_start);
                     lagrDelta0    = p_cost_stat->pairCost[pairsInCG - 1].runCost;
@@ -849,7 +810,7 @@ static int rdoq_est_cg(xavs2_t *h, rdoq_t *p_rdoq, level_info_t *p_level_info, c
                 }
 
                 // calculate cost: distLevel[i][0] + rate(Run[i] + Run[i+1] + 1)
-                lagr = (rdcost_t)(node->level_info->errLevel[0] + lambda_rdoq * rateRunMerged);
+                lagr = (rdcost_t)(rdoq_get_err_level(p_cg, 0, node->pos) + lambda_rdoq * rateRunMerged);
 
                 if (lagr < minlagr) {
                     minlagr    = lagr;
@@ -859,17 +820,17 @@ static int rdoq_est_cg(xavs2_t *h, rdoq_t *p_rdoq, level_info_t *p_level_info, c
             }
 
             // set SDQ results
-            xx_yy = p_level_info[node->pos].pos_xy;
-            absLevel = node->level = node->level_info->level[best_state];
-            ncur_blk[p_level_info[node->pos].pos_scan] = (coeff_t)absLevel;
+            xx_yy = p_rdoq->p_scan_tab_1d[(iCG << 4) + node->pos];
+            absLevel = node->level = rdoq_get_cand_level(p_cg, best_state, node->pos);
+            p_ncoeff[node->pos] = (coeff_t)absLevel;
 
             lagrAcc     += minlagr - lagrDelta;
-            lagrUncoded += (rdcost_t)(node->level_info->errLevel[0]);
+            lagrUncoded += (rdcost_t)(rdoq_get_err_level(p_cg, 0, node->pos));
 
             p_pair_cost->posBlockX = (int16_t)((xx_yy >> w_shift_x) & 0x3);
             p_pair_cost->posBlockY = (int16_t)((xx_yy >> w_shift_y) & 0x3);
 
-            p_pair_cost->scanPos = p_level_info[node->pos].pos_scan;
+            p_pair_cost->scanPos = (iCG << 4) + node->pos;
             if (best_state == 0) {
                 // adjust the run of the previous node and remove the current node
                 node->prev->run += node->run + 1;
@@ -925,14 +886,12 @@ static
 int rdoq_cg(xavs2_t *h, rdoq_t *p_rdoq, cu_t *p_cu, coeff_t *ncur_blk, const int num_coeff, int qp)
 {
     ALIGN16(cost_state_t    cg_cost_stat [64]);
-    ALIGN16(level_info_t    cg_level_data[16]);   // level data in a CG
+    ALIGN16(cg_level_t      cg_level_data);       // level data in a CG
     int8_t *p_sig_cg_flag = p_rdoq->sig_cg_flag;
     node_list_t list_run_level;
     cost_state_t *p_cost_stat;
-    const int16_t *p_tab_coeff_scan1d = p_rdoq->p_scan_tab_1d;
     const int i_tu_level = p_rdoq->i_tu_level;
     const int shift_bit = 16 - (h->param->sample_bit_depth + 1) - i_tu_level;
-    const double f_err_level_mult = 256.0 / (1 << (shift_bit * 2));
     const int thres_lower_int = (int)((16384 << shift_bit) / (double)(tab_Q_TAB[qp]));
     const rdcost_t lambda_rdoq = h->f_lambda_rdoq;
     int last_pos = -1;
@@ -962,48 +921,59 @@ int rdoq_cg(xavs2_t *h, rdoq_t *p_rdoq, cu_t *p_cu, coeff_t *ncur_blk, const int
     /* βȫϵcg */
     num_cg = rdoq_get_last_cg_pos(ncur_blk, num_coeff, thres_lower_int);
 
+    cg_level_data.f_err_level_mult = 256.0 / (1 << (shift_bit * 2));
+
     for (i_cg = num_cg - 1; i_cg >= 0; i_cg--) {
+        coeff_t *p_ncoeff = ncur_blk + (i_cg << 4);
         node_t *p_node = NULL;
-        int idx_coeff_in_cg = 15;
-        int idx_coeff = (i_cg << 4) + idx_coeff_in_cg;
+        int idx_coeff_in_cg;
+        int mask_nonzero;
 
         p_cost_stat = &cg_cost_stat[i_cg];
-        for (; idx_coeff_in_cg >= 0; idx_coeff_in_cg--, idx_coeff--) {
-            level_info_t *p_level_info = &cg_level_data[idx_coeff_in_cg];
-            int xx_yy;
 
-            // quant_init
-            xx_yy = p_tab_coeff_scan1d[idx_coeff];
-
-            /* 1, generate levels of one coefficient [xx, yy] */
+        /* 1, generate levels of all coefficients in this CG */
 #if ENABLE_WQUANT
-            if (h->WeightQuantEnable) {
-                ncur_blk[idx_coeff] = (coeff_t)rdoq_est_coeff_level_wq(h, p_level_info,
-                                      wq, wqm_size_id, wqm_size, xx, yy, ncur_blk[idx_coeff],
-                                      qp, shift_bit);
-            } else {
-                ncur_blk[idx_coeff] = (coeff_t)rdoq_est_coeff_level(p_level_info, ncur_blk[idx_coeff],
-                                      qp, shift_bit, f_err_level_mult, thres_lower_int);
-            }
+        if (h->WeightQuantEnable) {
+            mask_nonzero = rdoq_est_cg_levels_wq(h, p_rdoq, &cg_level_data, p_ncoeff, i_cg,
+                                                 wq, wqm_size_id, wqm_size, qp, shift_bit);
+        } else {
+            mask_nonzero = g_funcs.dctf.rdoq_cg_levels(p_ncoeff, cg_level_data.num_level, cg_level_data.err_level,
+                                                       tab_Q_TAB[qp], 15 + shift_bit,
+                                                       tab_IQ_TAB[qp], tab_IQ_SHIFT[qp] - shift_bit, thres_lower_int);
+        }
 #else
-            ncur_blk[idx_coeff] = (coeff_t)rdoq_est_coeff_level(p_level_info, ncur_blk[idx_coeff],
-                                  qp, shift_bit, f_err_level_mult, thres_lower_int);
+        mask_nonzero = g_funcs.dctf.rdoq_cg_levels(p_ncoeff, cg_level_data.num_level, cg_level_data.err_level,
+                                                   tab_Q_TAB[qp], 15 + shift_bit,
+                                                   tab_IQ_TAB[qp], tab_IQ_SHIFT[qp] - shift_bit, thres_lower_int);
 #endif
 
-            p_level_info->pos_xy   = xx_yy;
-            p_level_info->pos_scan = idx_coeff;
+        /* all coefficients are quantized to zero: no (Level, Run) pair in this CG */
+        if (mask_nonzero == 0) {
+            if (last_pos != -1) {
+                int sig_cg_ctx = p_rdoq->b_luma && (i_cg != 0);
+
+                p_cost_stat->lastRunCost   = 0;
+                p_cost_stat->sigCGFlagCost = lambda_rdoq * est_rate_nonzero_cg_flag(p_rdoq, 0, sig_cg_ctx);
+                p_cost_stat->pairNum       = 0;
+            }
+            continue;
+        }
+        memcpy(cg_level_data.level, p_ncoeff, sizeof(cg_level_data.level));
+
+        /* 2, build (Level, Run) pair linked list */
+        for (idx_coeff_in_cg = 15; idx_coeff_in_cg >= 0; idx_coeff_in_cg--) {
+            int b_nonzero = (mask_nonzero >> idx_coeff_in_cg) & 1;
 
-            /* 2, build (Level, Run) pair linked list */
             if (last_pos == -1) { // last is not found yet
-                if (p_level_info->num_level > 1) {
+                if (b_nonzero) {
                     list_init(&list_run_level);
                     // found last position in last CG
                     last_pos = idx_coeff_in_cg;
                     // first node in the list is last position
-                    p_node = create_and_append_node(&list_run_level, NULL, LAST_POS, idx_coeff_in_cg);
+                    p_node = create_and_append_node(&list_run_level, LAST_POS, idx_coeff_in_cg);
 
                     // the second node is the (run, pair) pair
-                    p_node = create_and_append_node(&list_run_level, p_level_info, RUN_LEVEL_PAIR, idx_coeff_in_cg);
+                    p_node = create_and_append_node(&list_run_level, RUN_LEVEL_PAIR, idx_coeff_in_cg);
 
                     num_cg = i_cg + 1;
                     p_sig_cg_flag[i_cg] = 1; // this is the last CG
@@ -1013,12 +983,12 @@ int rdoq_cg(xavs2_t *h, rdoq_t *p_rdoq, cu_t *p_cu, coeff_t *ncur_blk, const int
                 if (idx_coeff_in_cg == 15) { // a new CG begins
                     list_init(&list_run_level);
                     // the position of the last run is always initialized to 15
-                    p_node = create_and_append_node(&list_run_level, NULL, LAST_RUN, idx_coeff_in_cg);
+                    p_node = create_and_append_node(&list_run_level, LAST_RUN, idx_coeff_in_cg);
                 }
 
                 // starting from the 2nd node, it is (level, run) node
-                if (p_level_info->num_level > 1) {
-                    p_node = create_and_append_node(&list_run_level, p_level_info, RUN_LEVEL_PAIR, idx_coeff_in_cg);
+                if (b_nonzero) {
+                    p_node = create_and_append_node(&list_run_level, RUN_LEVEL_PAIR, idx_coeff_in_cg);
                     p_sig_cg_flag[i_cg] = 1;
                     // get the real position of last run
                     if (p_node->prev->attrib == LAST_RUN) {
@@ -1031,10 +1001,8 @@ int rdoq_cg(xavs2_t *h, rdoq_t *p_rdoq, cu_t *p_cu, coeff_t *ncur_blk, const int
         }
 
         /* 3, estimate costs */
-        if (last_pos != -1) { // a CG just ended
-            rank = rdoq_est_cg(h, p_rdoq, cg_level_data, p_cost_stat, list_run_level.head, ncur_blk, p_sig_cg_flag, i_cg, rank);
-            num_nonzero += p_cost_stat->pairNum;
-        }
+        rank = rdoq_est_cg(h, p_rdoq, &cg_level_data, p_cost_stat, list_run_level.head, ncur_blk, p_sig_cg_flag, i_cg, rank);
+        num_nonzero += p_cost_stat->pairNum;
     }
 
     if (!num_nonzero) {
@@ -1183,6 +1151,7 @@ rdoq_init(rdoq_t *p_rdoq, aec_t *p_aec, cu_t *p_cu, int bsx, int bsy, int i_tu_l
     p_rdoq->i_tu_level  = i_tu_level;
     p_rdoq->b_luma      = b_luma;
     p_rdoq->b_dc_diag   = (b_luma && tab_intra_mode_scan_type[intra_mode] != INTRA_PRED_DC_DIAG) ? 0 : 1;
+    p_rdoq->b_swap_xy   = b_swap_xy;
 
     if (b_swap_xy) {
         p_rdoq->bit_size_shift_x = xavs2_log2u(bsx);
@@ -1220,6 +1189,50 @@ rdoq_init(rdoq_t *p_rdoq, aec_t *p_aec, cu_t *p_cu, int bsx, int bsy, int i_tu_l
     p_rdoq->p_ctx_coeff_level = p_aec->p_ctx_set->coeff_level;
 }
 
+/* ---------------------------------------------------------------------------
+ * scan the coefficients into CG-major order:
+ * every 4x4 CG is transposed into zig-zag order, starting from the
+ * block position of its first coefficient in the scan table
+ */
+static ALWAYS_INLINE void
+rdoq_scan_coeffs(rdoq_t *p_rdoq, coeff_t *ncur_blk, const coeff_t *p_coeff, int coeff_num)
+{
+    const int16_t *p_tab_coeff_scan_1d = p_rdoq->p_scan_tab_1d;
+    int i;
+
+    if (p_rdoq->num_cg_x > 0 && p_rdoq->num_cg_y > 0) {
+        coeff_scan_t scan_4x4 = g_funcs.transpose_coeff_scan[LUMA_4x4][p_rdoq->b_swap_xy];
+        int i_src_shift = xavs2_log2u(p_rdoq->num_cg_x << 2);
+
+        for (i = 0; i < coeff_num; i += 16) {
+            scan_4x4(ncur_blk + i, p_coeff + p_tab_coeff_scan_1d[i], i_src_shift);
+        }
+    } else {
+        for (i = 0; i < coeff_num; i++) {
+            ncur_blk[i] = p_coeff[p_tab_coeff_scan_1d[i]];
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * inverse scan the coefficients, only the significant CGs are scattered
+ */
+static ALWAYS_INLINE void
+rdoq_inv_scan_coeffs(rdoq_t *p_rdoq, coeff_t *p_coeff, const coeff_t *ncur_blk, int coeff_num)
+{
+    const int16_t *p_tab_coeff_scan_1d = p_rdoq->p_scan_tab_1d;
+    int i_cg, i;
+
+    memset(p_coeff, 0, coeff_num * sizeof(coeff_t));
+    for (i_cg = 0; i_cg < (coeff_num >> 4); i_cg++) {
+        if (p_rdoq->sig_cg_flag[i_cg]) {
+            for (i = i_cg << 4; i < (i_cg + 1) << 4; i++) {
+                p_coeff[p_tab_coeff_scan_1d[i]] = ncur_blk[i];
+            }
+        }
+    }
+}
+
 
 /**
  * ===========================================================================
@@ -1237,27 +1250,19 @@ int rdoq_block(xavs2_t *h, aec_t *p_aec, cu_t *p_cu, coeff_t *cur_blk, int bsx,
     coeff_t *ncur_blk = p_rdoq->ncur_blk;
     const int coeff_num = bsx * bsy;
     int num_non_zero = 0;
-    int i;
-    const int16_t *p_tab_coeff_scan_1d;
 
     rdoq_init(p_rdoq, p_aec, p_cu, bsx, bsy, i_tu_level, b_luma, intra_mode);
 
     g_funcs.dctf.abs_coeff(p_coeff, cur_blk, coeff_num);
 
     /* scan the coeffs */
-    p_tab_coeff_scan_1d = p_rdoq->p_scan_tab_1d;
-
-    for (i = 0; i < coeff_num; i++) {
-        ncur_blk[i] = p_coeff[p_tab_coeff_scan_1d[i]];
-    }
+    rdoq_scan_coeffs(p_rdoq, ncur_blk, p_coeff, coeff_num);
 
     num_non_zero = rdoq_cg(h, p_rdoq, p_cu, ncur_blk, coeff_num, qp);
 
     /* inverse scan the coeffs */
     if (num_non_zero) {
-        for (i = 0; i < coeff_num; i++) {
-            p_coeff[p_tab_coeff_scan_1d[i]] = ncur_blk[i];
-        }
+        rdoq_inv_scan_coeffs(p_rdoq, p_coeff, ncur_blk, coeff_num);
 
         num_non_zero = g_funcs.dctf.add_sign(cur_blk, p_coeff, coeff_num);
     } else {
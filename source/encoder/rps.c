@@ -215,7 +215,7 @@ int xavs2e_get_frame_rps(const xavs2_t *h, xavs2_frame_buffer_t *frm_buf,
             p_rps->num_to_rm        = 0;
             p_rps->referd_by_others = 1;
 
-            if (!h->param->b_open_gop || !h->param->num_bframes) {
+            if (!h->param->b_open_gop || !h->param->num_bframes || cur_frm->b_scenecut) {
                 // IDR refresh
                 for (j = 0; j < frm_buf->num_frames; j++) {
                     if ((frame = frm_buf->frames[j]) != NULL && cur_frm->i_frame != frame->i_frame) {
@@ -250,11 +250,12 @@ int xavs2e_get_frame_rps(const xavs2_t *h, xavs2_frame_buffer_t *frm_buf,
             p_rps->qp_offset        = 0;
         }
     } else {
-        rps_idx = (cur_frm->i_frm_coi - 1 - ((!h->param->b_open_gop && h->param->num_bframes > 0) ? frm_buf->COI_IDR : 0)) % h->i_gop_size;
+        rps_idx = (cur_frm->i_frm_coi - 1 - frm_buf->COI_RPS) % h->i_gop_size;
         memcpy(p_rps, &p_seq_rps[rps_idx], sizeof(xavs2_rps_t));
 
-        if (cur_frm->i_frame > frm_buf->POC_IDR && (!h->param->b_open_gop || !h->param->num_bframes)) {
-            /* clear frames before IDR frame */
+        if (cur_frm->i_frame > frm_buf->POC_IDR && (!h->param->b_open_gop || !h->param->num_bframes ||
+                                                    (frm_buf->COI_RPS > 0 && frm_buf->COI_RPS == frm_buf->COI_IDR))) {
+            /* clear frames before IDR frame (including the key frame of a scene cut) */
             for (j = 0; j < frm_buf->num_frames; j++) {
                 if ((frame = frm_buf->frames[j]) != NULL) {
                     xavs2_thread_mutex_lock(&frame->mutex);      /* lock */
@@ -621,6 +622,7 @@ xavs2_frame_t *frame_buffer_find_free_frame_dpb(xavs2_handler_t *h_mgr, xavs2_t
         fdec_frm->cnt_refered += fdec_frm->rps.referd_by_others;
 
         memset(fdec_frm->num_lcu_coded_in_row, 0, h->i_height_in_lcu * sizeof(fdec_frm->num_lcu_coded_in_row[0]));
+        fdec_frm->i_integral_rows = 0;
     }
 
     return fdec_frm;
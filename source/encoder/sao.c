@@ -55,323 +55,6 @@ static const int tab_sao_check_mode_fast[3][5] = {
  * ===========================================================================
  */
 
-/* ---------------------------------------------------------------------------
- */
-static ALWAYS_INLINE void sao_init_stat_data(SAOStatData *p_stats)
-{
-    memset(p_stats, 0, sizeof(SAOStatData));
-}
-
-/* ---------------------------------------------------------------------------
- */
-static
-void sao_get_stat_block_EO_0(xavs2_frame_t *frm_rec, xavs2_frame_t *frm_org,
-                             SAOStatData *p_stats, sao_region_t *p_region, int compIdx)
-{
-    int start_x, end_x, start_y, end_y;
-    int x, y;
-    int leftsign, rightsign;
-    /* the size of SAO region max be larger than MAX_CU_SIZE on right/down of picture */
-    int edgetype;
-
-    int pix_x = p_region->pix_x[compIdx];
-    int pix_y = p_region->pix_y[compIdx];
-    int width = p_region->width[compIdx];
-    int height = p_region->height[compIdx];
-
-    int i_rec = frm_rec->i_stride[compIdx];
-    int i_org = frm_org->i_stride[compIdx];
-    const pel_t *p_rec = frm_rec->planes[compIdx] + pix_y * i_rec + pix_x;
-    const pel_t *p_org = frm_org->planes[compIdx] + pix_y * i_org + pix_x;
-    const pel_t *p_org_iter;
-    const pel_t *p_rec_iter;
-    sao_init_stat_data(p_stats);
-    p_org_iter = p_org;
-    p_rec_iter = p_rec;
-    start_y = 0;
-    end_y = height;
-    start_x = p_region->b_left ? 0 : 1;
-    end_x = p_region->b_right ? width : (width - 1);
-    p_org_iter = p_org + start_y * i_org;
-    p_rec_iter += start_y * i_rec;
-    for (y = start_y; y < end_y; y++) {
-        leftsign = xavs2_sign3(p_rec_iter[start_x] - p_rec_iter[start_x - 1]);
-        for (x = start_x; x < end_x; x++) {
-            rightsign = xavs2_sign3(p_rec_iter[x] - p_rec_iter[x + 1]);
-            edgetype = leftsign + rightsign;
-            leftsign = -rightsign;
-            p_stats->diff[edgetype + 2] += (p_org_iter[x] - p_rec_iter[x]);
-            p_stats->count[edgetype + 2]++;
-        }
-        p_rec_iter += i_rec;
-        p_org_iter += i_org;
-    }
-}
-
-/* ---------------------------------------------------------------------------
-*/
-static
-void sao_get_stat_block_EO_90(xavs2_frame_t *frm_rec, xavs2_frame_t *frm_org,
-                              SAOStatData *p_stats, sao_region_t *p_region, int compIdx)
-{
-    int start_x, end_x, start_y, end_y;
-    int x, y;
-    int upsign, downsign;
-    /* the size of SAO region max be larger than MAX_CU_SIZE on right/down of picture */
-    int edgetype;
-
-    int pix_x = p_region->pix_x[compIdx];
-    int pix_y = p_region->pix_y[compIdx];
-    int width = p_region->width[compIdx];
-    int height = p_region->height[compIdx];
-
-    int i_rec = frm_rec->i_stride[compIdx];
-    int i_org = frm_org->i_stride[compIdx];
-    const pel_t *p_rec = frm_rec->planes[compIdx] + pix_y * i_rec + pix_x;
-    const pel_t *p_org = frm_org->planes[compIdx] + pix_y * i_org + pix_x;
-    const pel_t *p_org_iter;
-    const pel_t *p_rec_iter;
-
-    sao_init_stat_data(p_stats);
-
-    p_org_iter = p_org;
-    p_rec_iter = p_rec;
-    start_x = 0;
-    end_x = width;
-    start_y = p_region->b_top ? 0 : 1;
-    end_y = p_region->b_down ? height : (height - 1);
-    for (x = start_x; x < end_x; x++) {
-        upsign = xavs2_sign3(p_rec_iter[start_y * i_rec + x] - p_rec_iter[(start_y - 1) * i_rec + x]);
-        for (y = start_y; y < end_y; y++) {
-            downsign = xavs2_sign3(p_rec_iter[y * i_rec + x] - p_rec_iter[(y + 1) * i_rec + x]);
-            edgetype = downsign + upsign;
-            upsign = -downsign;
-            p_stats->diff[edgetype + 2] += (p_org_iter[y * i_org + x] - p_rec_iter[y * i_rec + x]);
-            p_stats->count[edgetype + 2]++;
-        }
-    }
-}
-
-/* ---------------------------------------------------------------------------
-*/
-static
-void sao_get_stat_block_EO_135(xavs2_frame_t *frm_rec, xavs2_frame_t *frm_org,
-                               SAOStatData *p_stats, sao_region_t *p_region, int compIdx)
-{
-    int start_x_r0, end_x_r0, start_x_r, end_x_r, start_x_rn, end_x_rn;
-    int x, y;
-    int upsign, downsign;
-    /* the size of SAO region max be larger than MAX_CU_SIZE on right/down of picture */
-    int signupline[MAX_CU_SIZE << 1];
-    int reg = 0;
-    int edgetype;
-
-    int pix_x = p_region->pix_x[compIdx];
-    int pix_y = p_region->pix_y[compIdx];
-    int width = p_region->width[compIdx];
-    int height = p_region->height[compIdx];
-
-    int i_rec = frm_rec->i_stride[compIdx];
-    int i_org = frm_org->i_stride[compIdx];
-    const pel_t *p_rec = frm_rec->planes[compIdx] + pix_y * i_rec + pix_x;
-    const pel_t *p_org = frm_org->planes[compIdx] + pix_y * i_org + pix_x;
-    const pel_t *p_org_iter;
-    const pel_t *p_rec_iter;
-
-    sao_init_stat_data(p_stats);
-
-    p_org_iter = p_org;
-    p_rec_iter = p_rec;
-    start_x_r0 = p_region->b_top_left ? 0 : 1;
-    end_x_r0 = p_region->b_top ? (p_region->b_right ? width : (width - 1)) : 1;
-    start_x_r = p_region->b_left ? 0 : 1;
-    end_x_r = p_region->b_right ? width : (width - 1);
-    start_x_rn = p_region->b_down ? (p_region->b_left ? 0 : 1) : (width - 1);
-    end_x_rn = p_region->b_right_down ? width : (width - 1);
-
-    // init the line buffer
-    for (x = start_x_r + 1; x < end_x_r + 1; x++) {
-        upsign = xavs2_sign3(p_rec_iter[x + i_rec] - p_rec_iter[x - 1]);
-        signupline[x] = upsign;
-    }
-    // first row
-    for (x = start_x_r0; x < end_x_r0; x++) {
-        upsign = xavs2_sign3(p_rec_iter[x] - p_rec_iter[x - 1 - i_rec]);
-        edgetype = upsign - signupline[x + 1];
-        p_stats->diff[edgetype + 2] += (p_org_iter[x] - p_rec_iter[x]);
-        p_stats->count[edgetype + 2]++;
-    }
-
-    // middle rows
-    p_rec_iter += i_rec;
-    p_org_iter += i_org;
-    for (y = 1; y < height - 1; y++) {
-        for (x = start_x_r; x < end_x_r; x++) {
-            if (x == start_x_r) {
-                upsign = xavs2_sign3(p_rec_iter[x] - p_rec_iter[x - 1 - i_rec]);
-                signupline[x] = upsign;
-            }
-            downsign = xavs2_sign3(p_rec_iter[x] - p_rec_iter[x + 1 + i_rec]);
-            edgetype = downsign + signupline[x];
-            p_stats->diff[edgetype + 2] += (p_org_iter[x] - p_rec_iter[x]);
-            p_stats->count[edgetype + 2]++;
-            signupline[x] = (char)reg;
-            reg = -downsign;
-        }
-        p_rec_iter += i_rec;
-        p_org_iter += i_org;
-    }
-    // last row
-    for (x = start_x_rn; x < end_x_rn; x++) {
-        if (x == start_x_r) {
-            upsign = xavs2_sign3(p_rec_iter[x] - p_rec_iter[x - 1 - i_rec]);
-            signupline[x] = upsign;
-        }
-        downsign = xavs2_sign3(p_rec_iter[x] - p_rec_iter[x + 1 + i_rec]);
-        edgetype = downsign + signupline[x];
-        p_stats->diff[edgetype + 2] += (p_org_iter[x] - p_rec_iter[x]);
-        p_stats->count[edgetype + 2]++;
-    }
-}
-
-/* ---------------------------------------------------------------------------
-*/
-static
-void sao_get_stat_block_EO_45(xavs2_frame_t *frm_rec, xavs2_frame_t *frm_org,
-                              SAOStatData *p_stats, sao_region_t *p_region, int compIdx)
-{
-    int start_x_r0, end_x_r0, start_x_r, end_x_r, start_x_rn, end_x_rn;
-    int x, y;
-    int upsign, downsign;
-    /* the size of SAO region max be larger than MAX_CU_SIZE on right/down of picture */
-    int signupline[MAX_CU_SIZE << 1];
-    int *signupline1;
-    int edgetype;
-
-    int pix_x = p_region->pix_x[compIdx];
-    int pix_y = p_region->pix_y[compIdx];
-    int width = p_region->width[compIdx];
-    int height = p_region->height[compIdx];
-
-    int i_rec = frm_rec->i_stride[compIdx];
-    int i_org = frm_org->i_stride[compIdx];
-    const pel_t *p_rec = frm_rec->planes[compIdx] + pix_y * i_rec + pix_x;
-    const pel_t *p_org = frm_org->planes[compIdx] + pix_y * i_org + pix_x;
-    const pel_t *p_org_iter;
-    const pel_t *p_rec_iter;
-
-    sao_init_stat_data(p_stats);
-
-    p_org_iter = p_org;
-    p_rec_iter = p_rec;
-    start_x_r0 = p_region->b_top ? (p_region->b_left ? 0 : 1) : (width - 1);
-    end_x_r0 = p_region->b_top_right ? width : (width - 1);
-    start_x_r = p_region->b_left ? 0 : 1;
-    end_x_r = p_region->b_right ? width : (width - 1);
-    start_x_rn = p_region->b_down_left ? 0 : 1;
-    end_x_rn = p_region->b_down ? (p_region->b_right ? width : (width - 1)) : 1;
-
-    // init the line buffer
-    signupline1 = signupline + 1;
-    for (x = start_x_r - 1; x < XAVS2_MAX(end_x_r - 1, end_x_r0 - 1); x++) {
-        upsign = xavs2_sign3(p_rec_iter[x + i_rec] - p_rec_iter[x + 1]);
-        signupline1[x] = upsign;
-    }
-    // first row
-    for (x = start_x_r0; x < end_x_r0; x++) {
-        upsign = xavs2_sign3(p_rec_iter[x] - p_rec_iter[x + 1 - i_rec]);
-        edgetype = upsign - signupline1[x - 1];
-        p_stats->diff[edgetype + 2] += (p_org_iter[x] - p_rec_iter[x]);
-        p_stats->count[edgetype + 2]++;
-    }
-
-    // middle rows
-    p_rec_iter += i_rec;
-    p_org_iter += i_org;
-    for (y = 1; y < height - 1; y++) {
-        for (x = start_x_r; x < end_x_r; x++) {
-            if (x == end_x_r - 1) {
-                upsign = xavs2_sign3(p_rec_iter[x] - p_rec_iter[x + 1 - i_rec]);
-                signupline1[x] = upsign;
-            }
-            downsign = xavs2_sign3(p_rec_iter[x] - p_rec_iter[x - 1 + i_rec]);
-            edgetype = downsign + signupline1[x];
-            p_stats->diff[edgetype + 2] += (p_org_iter[x] - p_rec_iter[x]);
-            p_stats->count[edgetype + 2]++;
-            signupline1[x - 1] = -downsign;
-        }
-        p_rec_iter += i_rec;
-        p_org_iter += i_org;
-    }
-    for (x = start_x_rn; x < end_x_rn; x++) {
-        if (x == end_x_r - 1) {
-            upsign = xavs2_sign3(p_rec_iter[x] - p_rec_iter[x + 1 - i_rec]);
-            signupline1[x] = upsign;
-        }
-        downsign = xavs2_sign3(p_rec_iter[x] - p_rec_iter[x - 1 + i_rec]);
-        edgetype = downsign + signupline1[x];
-        p_stats->diff[edgetype + 2] += (p_org_iter[x] - p_rec_iter[x]);
-        p_stats->count[edgetype + 2]++;
-    }
-}
-
-/* ---------------------------------------------------------------------------
-*/
-static
-void sao_get_stat_block_BO(xavs2_frame_t *frm_rec, xavs2_frame_t *frm_org,
-                           SAOStatData *p_stats, sao_region_t *p_region, int compIdx)
-{
-    int start_x, end_x, start_y, end_y;
-    int x, y;
-    /* the size of SAO region max be larger than MAX_CU_SIZE on right/down of picture */
-    int bandtype;
-    int band_shift;
-
-    int pix_x = p_region->pix_x[compIdx];
-    int pix_y = p_region->pix_y[compIdx];
-    int width = p_region->width[compIdx];
-    int height = p_region->height[compIdx];
-
-    int i_rec = frm_rec->i_stride[compIdx];
-    int i_org = frm_org->i_stride[compIdx];
-    const pel_t *p_rec = frm_rec->planes[compIdx] + pix_y * i_rec + pix_x;
-    const pel_t *p_org = frm_org->planes[compIdx] + pix_y * i_org + pix_x;
-    const pel_t *p_org_iter;
-    const pel_t *p_rec_iter;
-
-    sao_init_stat_data(p_stats);
-
-    p_org_iter = p_org;
-    p_rec_iter = p_rec;
-    band_shift = (g_bit_depth - NUM_SAO_BO_CLASSES_IN_BIT);
-    start_x = 0;
-    end_x = width;
-    start_y = 0;
-    end_y = height;
-    for (y = start_y; y < end_y; y++) {
-        for (x = start_x; x < end_x; x++) {
-            bandtype = p_rec_iter[x] >> band_shift;
-            p_stats->diff[bandtype] += (p_org_iter[x] - p_rec_iter[x]);
-            p_stats->count[bandtype]++;
-        }
-        p_rec_iter += i_rec;
-        p_org_iter += i_org;
-    }
-}
-
-/* ---------------------------------------------------------------------------
-*/
-typedef void(*sao_pf)(xavs2_frame_t *frm_rec, xavs2_frame_t *frm_org,
-                      SAOStatData *stat_datas, sao_region_t *p_region, int compIdx);
-
-sao_pf gf_sao_stat[5] = {
-    sao_get_stat_block_EO_0,
-    sao_get_stat_block_EO_90,
-    sao_get_stat_block_EO_135,
-    sao_get_stat_block_EO_45,
-    sao_get_stat_block_BO
-};
-
 /* ---------------------------------------------------------------------------
  */
 static ALWAYS_INLINE
@@ -1084,6 +767,8 @@ void sao_slice_onoff_decision(xavs2_t *h, bool_t *slice_sao_on)
 }
 
 /* ---------------------------------------------------------------------------
+ * copy the deblocked pixels of one LCU (and the rows above it which are
+ * covered by its SAO region) for the components with SAO enabled
  */
 static
 void sao_copy_lcu(xavs2_t *h, xavs2_frame_t *frm_dst, xavs2_frame_t *frm_src, int lcu_x, int lcu_y)
@@ -1103,11 +788,13 @@ void sao_copy_lcu(xavs2_t *h, xavs2_frame_t *frm_dst, xavs2_frame_t *frm_src, in
     pel_t *p_src2, *p_dst2;
 
     /* luma component */
-    start_y -= start_y_shift;
-    lcu_height = end_y - start_y;
-    p_src = frm_src->planes[0] + start_y * i_src + start_x;
-    p_dst = frm_dst->planes[0] + start_y * i_dst + start_x;
-    g_funcs.plane_copy(p_dst, i_dst, p_src, i_src, lcu_width, lcu_height);
+    if (h->slice_sao_on[0]) {
+        start_y -= start_y_shift;
+        lcu_height = end_y - start_y;
+        p_src = frm_src->planes[0] + start_y * i_src + start_x;
+        p_dst = frm_dst->planes[0] + start_y * i_dst + start_x;
+        g_funcs.plane_copy(p_dst, i_dst, p_src, i_src, lcu_width, lcu_height);
+    }
 
     /* chroma component */
     start_y = lcu_y << (h->i_lcu_level - CHROMA_V_SHIFT);
@@ -1124,40 +811,79 @@ void sao_copy_lcu(xavs2_t *h, xavs2_frame_t *frm_dst, xavs2_frame_t *frm_src, in
     p_src2 = frm_src->planes[2] + start_y * i_src + start_x;
     p_dst  = frm_dst->planes[1] + start_y * i_dst + start_x;
     p_dst2 = frm_dst->planes[2] + start_y * i_dst + start_x;
-    g_funcs.plane_copy(p_dst, i_dst, p_src, i_src, lcu_width, lcu_height);
-    g_funcs.plane_copy(p_dst2, i_dst, p_src2, i_src, lcu_width, lcu_height);
+    if (h->slice_sao_on[1]) {
+        g_funcs.plane_copy(p_dst, i_dst, p_src, i_src, lcu_width, lcu_height);
+    }
+    if (h->slice_sao_on[2]) {
+        g_funcs.plane_copy(p_dst2, i_dst, p_src2, i_src, lcu_width, lcu_height);
+    }
 }
 
 /* ---------------------------------------------------------------------------
+ * collect the SAO statistics of one LCU on the reconstruction frame frm_rec
  */
-void sao_get_lcu_param_after_deblock(xavs2_t *h, aec_t *p_aec, int i_lcu_x, int i_lcu_y)
+static
+void sao_get_lcu_stat(xavs2_t *h, xavs2_frame_t *frm_rec, int i_lcu_x, int i_lcu_y)
 {
     sao_region_t region;
     int i_lcu_xy = i_lcu_y * h->i_width_in_lcu + i_lcu_x;
+    int avail[8];
     int compIdx, type;
 
-    sao_copy_lcu(h, h->img_sao, h->fdec, i_lcu_x, i_lcu_y);
     sao_get_neighbor_avail(h, &region, i_lcu_x, i_lcu_y);
+    avail[SAO_T ] = region.b_top;
+    avail[SAO_D ] = region.b_down;
+    avail[SAO_L ] = region.b_left;
+    avail[SAO_R ] = region.b_right;
+    avail[SAO_TL] = region.b_top_left;
+    avail[SAO_TR] = region.b_top_right;
+    avail[SAO_DL] = region.b_down_left;
+    avail[SAO_DR] = region.b_right_down;
 
     for (compIdx = 0; compIdx < 3; compIdx++) {
         if (h->slice_sao_on[compIdx]) {
+            int pix_y = region.pix_y[compIdx];
+            int pix_x = region.pix_x[compIdx];
+            int i_rec = frm_rec->i_stride[compIdx];
+            int i_org = h->fenc->i_stride[compIdx];
+            const pel_t *p_rec = frm_rec->planes[compIdx] + pix_y * i_rec + pix_x;
+            const pel_t *p_org = h->fenc->planes[compIdx] + pix_y * i_org + pix_x;
+
             for (type = 0; type < 5; type++) {
                 if (!h->param->b_fast_sao || tab_sao_check_mode_fast[compIdx][type]) {
                     if (((!IS_ALG_ENABLE(OPT_FAST_SAO)) || (!(!h->fdec->rps.referd_by_others && h->i_type == SLICE_TYPE_B)))) {
-                        gf_sao_stat[type](h->img_sao, h->fenc, &h->sao_stat_datas[i_lcu_xy][compIdx][type], &region, compIdx);
+                        g_funcs.sao_stat[type](p_org, i_org, p_rec, i_rec,
+                                               region.width[compIdx], region.height[compIdx],
+                                               avail, &h->sao_stat_datas[i_lcu_xy][compIdx][type]);
                     }
-                    // SAOStatData tmp;
-                    // memset(&tmp, 0, sizeof(tmp));
-                    // gf_sao_stat[type](h->fdec, h->fenc, &tmp, &region, compIdx);
-                    // if (memcmp(&tmp, &h->sao_stat_datas[i_lcu_xy][compIdx][type], sizeof(tmp)) != 0) {
-                    //     xavs2_log(h, XAVS2_LOG_ERROR, "SAO mismatch!\n");
-                    //     gf_sao_stat[type](h->img_sao, h->fenc, &h->sao_stat_datas[i_lcu_xy][compIdx][type], &region, compIdx);
-                    //     gf_sao_stat[type](h->fdec, h->fenc, &tmp, &region, compIdx);
-                    // }
                 }
             }
         }
     }
+}
+
+/* ---------------------------------------------------------------------------
+ */
+void sao_get_lcu_stat_before_deblock(xavs2_t *h, int i_lcu_x, int i_lcu_y)
+{
+    if (h->slice_sao_on[0] || h->slice_sao_on[1] || h->slice_sao_on[2]) {
+        sao_get_lcu_stat(h, h->fdec, i_lcu_x, i_lcu_y);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ */
+void sao_get_lcu_param_after_deblock(xavs2_t *h, aec_t *p_aec, int i_lcu_x, int i_lcu_y)
+{
+    int i_lcu_xy = i_lcu_y * h->i_width_in_lcu + i_lcu_x;
+
+    /* the copy is only needed for the filtering of enabled components */
+    if (h->slice_sao_on[0] || h->slice_sao_on[1] || h->slice_sao_on[2]) {
+        sao_copy_lcu(h, h->img_sao, h->fdec, i_lcu_x, i_lcu_y);
+        if (!h->param->b_sao_before_deblock) {
+            sao_get_lcu_stat(h, h->img_sao, i_lcu_x, i_lcu_y);
+        }
+    }
 
     sao_get_param_lcu(h, p_aec, i_lcu_x, i_lcu_y, h->slice_sao_on,
                       h->sao_stat_datas[i_lcu_xy],
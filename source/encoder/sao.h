@@ -43,6 +43,10 @@ void write_saoparam_one_lcu(xavs2_t *h, aec_t *p_aec, int lcu_x, int lcu_y, bool
 #define sao_slice_onoff_decision FPFX(sao_slice_onoff_decision)
 void sao_slice_onoff_decision(xavs2_t *h, bool_t *slice_sao_on);
 
+/* collect sao statistics of one lcu on its reconstruction before deblocking */
+#define sao_get_lcu_stat_before_deblock FPFX(sao_get_lcu_stat_before_deblock)
+void sao_get_lcu_stat_before_deblock(xavs2_t *h, int i_lcu_x, int i_lcu_y);
+
 /* decide sao parameters directly after one lcu reconstruction */
 #define sao_get_lcu_param_after_deblock FPFX(sao_get_lcu_param_after_deblock)
 void sao_get_lcu_param_after_deblock(xavs2_t *h, aec_t *p_aec, int i_lcu_x, int i_lcu_y);
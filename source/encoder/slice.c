@@ -39,6 +39,8 @@
 #include "aec.h"
 #include "nal.h"
 #include "wrapper.h"
+#include "frame.h"
+#include "encoder.h"
 #include "slice.h"
 #include "header.h"
 #include "bitstream.h"
@@ -46,7 +48,6 @@
 #include "rdo.h"
 #include "tdrdo.h"
 #include "wrapper.h"
-#include "frame.h"
 #include "alf.h"
 #include "sao.h"
 
@@ -278,24 +279,26 @@ static void est_cu_depth_range(xavs2_t *h, int *min_level, int *max_level)
 //#endif
 
 /* ---------------------------------------------------------------------------
- * store cu info for one LCU row
+ * store cu info for the LCUs [i_lcu_x_start, i_lcu_x_end) in one LCU row
  */
-static void store_cu_info_row(row_info_t *row)
+static void store_cu_info_lcus(xavs2_t *h, int i_lcu_x_start, int i_lcu_x_end)
 {
     int i, j, k, l;
-    xavs2_t *h = row->h;
 
     int lcu_height_in_scu = 1 << (h->i_lcu_level - MIN_CU_SIZE_IN_BIT);
     int last_lcu_row = ((h->lcu.i_scu_y + lcu_height_in_scu) < h->i_height_in_mincu ? 0 : 1);
+    int last_lcu_col = (i_lcu_x_end == h->i_width_in_lcu);
     int num_scu_y = last_lcu_row == 0 ? lcu_height_in_scu : h->i_height_in_mincu - h->lcu.i_scu_y;
+    int scu_x0    = i_lcu_x_start << (h->i_lcu_level - MIN_CU_SIZE_IN_BIT);
+    int scu_x1    = XAVS2_MIN(h->i_width_in_mincu, i_lcu_x_end << (h->i_lcu_level - MIN_CU_SIZE_IN_BIT));
 
 #if SAVE_CU_INFO
     /* store cu info (one lcu row) of reference frame */
     for (i = 0; i < num_scu_y; i++) {
         int scu_offset = (h->lcu.i_scu_y + i) * h->i_width_in_mincu;
-        cu_info_t *p_cu_info = &h->cu_info[scu_offset];
+        cu_info_t *p_cu_info = &h->cu_info[scu_offset + scu_x0];
 
-        for (j = 0; j < h->i_width_in_mincu; j++) {
+        for (j = scu_x0; j < scu_x1; j++) {
             h->fdec->cu_level[scu_offset + j] = (int8_t)p_cu_info->i_level;
             h->fdec->cu_mode[scu_offset + j] = (int8_t)p_cu_info->i_mode;
             h->fdec->cu_cbp[scu_offset + j] = (int8_t)p_cu_info->i_cbp;
@@ -317,6 +320,8 @@ static void store_cu_info_row(row_info_t *row)
 
         int start_16x16_y = h->lcu.i_scu_y >> 1;
         int num_16x16_y   = num_scu_y >> 1;
+        int start_16x16_x = i_lcu_x_start << (h->i_lcu_level - 4);
+        int end_16x16_x   = XAVS2_MIN(w0_in_16x16, i_lcu_x_end << (h->i_lcu_level - 4));
 
         const mv_t   *src_mv  = h->fwd_1st_mv;
         const int8_t *src_ref = h->fwd_1st_ref;
@@ -329,7 +334,7 @@ static void store_cu_info_row(row_info_t *row)
         // store middle pixel's motion information
         for (i = start_16x16_y; i < start_16x16_y + num_16x16_y; i++) {
             k = ((i << 2) + 2) * w_in_4x4;
-            for (j = 0; j < w0_in_16x16; j++) {
+            for (j = start_16x16_x; j < end_16x16_x; j++) {
                 l = (j << 2) + 2;
                 dst_mv[i * w_in_16x16 + j]  = src_mv[k + l];
                 dst_ref[i * w_in_16x16 + j] = src_ref[k + l];
@@ -339,13 +344,13 @@ static void store_cu_info_row(row_info_t *row)
         ///! last LCU row
         if (last_lcu_row && (h0_in_16x16 < h_in_16x16)) {
             k = (((h0_in_16x16 << 2) + h_in_4x4) >> 1) * w_in_4x4;
-            for (j = 0; j < w0_in_16x16; j++) {
+            for (j = start_16x16_x; j < end_16x16_x; j++) {
                 l = (j << 2) + 2;
                 dst_mv[h0_in_16x16 * w_in_16x16 + j]  = src_mv[k + l];
                 dst_ref[h0_in_16x16 * w_in_16x16 + j] = src_ref[k + l];
             }
 
-            if (w0_in_16x16 < w_in_16x16) {
+            if (last_lcu_col && w0_in_16x16 < w_in_16x16) {
                 l = ((w0_in_16x16 << 2) + w_in_4x4) >> 1;
                 dst_mv[h0_in_16x16 * w_in_16x16 + w0_in_16x16]  = src_mv[k + l];
                 dst_ref[h0_in_16x16 * w_in_16x16 + w0_in_16x16] = src_ref[k + l];
@@ -353,7 +358,7 @@ static void store_cu_info_row(row_info_t *row)
         }
 
         ///! last column
-        if (w0_in_16x16 < w_in_16x16) {
+        if (last_lcu_col && w0_in_16x16 < w_in_16x16) {
             i = ((w0_in_16x16 << 2) + w_in_4x4) >> 1;
 
             for (j = start_16x16_y; j < start_16x16_y + num_16x16_y; j++) {
@@ -366,6 +371,270 @@ static void store_cu_info_row(row_info_t *row)
 
 
 
+/* ---------------------------------------------------------------------------
+ * set the position of the LCU for a loop filter context
+ */
+static void lcu_filter_init_pos(xavs2_t *h, int i_lcu_x, int i_lcu_y)
+{
+    const int scu_x = i_lcu_x << (h->i_lcu_level - MIN_CU_SIZE_IN_BIT);
+    const int scu_y = i_lcu_y << (h->i_lcu_level - MIN_CU_SIZE_IN_BIT);
+    const int pix_x = scu_x << MIN_CU_SIZE_IN_BIT;
+    const int pix_y = scu_y << MIN_CU_SIZE_IN_BIT;
+
+    h->lcu.i_lcu_xy     = i_lcu_y * h->i_width_in_lcu + i_lcu_x;
+    h->lcu.i_scu_xy     = scu_y * h->i_width_in_mincu + scu_x;
+    h->lcu.i_scu_x      = scu_x;
+    h->lcu.i_scu_y      = scu_y;
+    h->lcu.i_pix_x      = pix_x;
+    h->lcu.i_pix_y      = pix_y;
+    h->lcu.i_pix_width  = (int16_t)XAVS2_MIN(1 << h->i_lcu_level, h->i_width  - pix_x);
+    h->lcu.i_pix_height = (int16_t)XAVS2_MIN(1 << h->i_lcu_level, h->i_height - pix_y);
+}
+
+#if ENABLE_RATE_CONTROL_CU
+/* ---------------------------------------------------------------------------
+ * set QPs of the CUs in coding order: a CU with coded residual signals the
+ * QP of the LCU by delta QP, the others inherit the previous QP
+ */
+static void cu_set_qp_in_coding_order(xavs2_t *h, int i_lcu_qp, int i_level, int img_x, int img_y, int *p_qp)
+{
+    cu_info_t *p_cu_info = &h->cu_info[(img_y >> MIN_CU_SIZE_IN_BIT) * h->i_width_in_mincu + (img_x >> MIN_CU_SIZE_IN_BIT)];
+
+    if (p_cu_info->i_level < i_level) {
+        int i_level_next = i_level - 1;
+        int i;
+
+        for (i = 0; i < 4; i++) {
+            int sub_pix_x = img_x + ((i &  1) << i_level_next);
+            int sub_pix_y = img_y + ((i >> 1) << i_level_next);
+
+            if (sub_pix_x < h->i_width && sub_pix_y < h->i_height) {
+                cu_set_qp_in_coding_order(h, i_lcu_qp, i_level_next, sub_pix_x, sub_pix_y, p_qp);
+            }
+        }
+    } else {
+        int w_in_scu = (XAVS2_MIN(1 << i_level, h->i_width  - img_x) + MIN_CU_SIZE - 1) >> MIN_CU_SIZE_IN_BIT;
+        int h_in_scu = (XAVS2_MIN(1 << i_level, h->i_height - img_y) + MIN_CU_SIZE - 1) >> MIN_CU_SIZE_IN_BIT;
+        int i_delta_qp = 0;
+        int x, y;
+
+        if (p_cu_info->i_cbp != 0) {
+            i_delta_qp = i_lcu_qp - *p_qp;
+            *p_qp      = i_lcu_qp;
+        }
+
+        for (y = 0; y < h_in_scu; y++, p_cu_info += h->i_width_in_mincu) {
+            for (x = 0; x < w_in_scu; x++) {
+                p_cu_info[x].i_cu_qp    = (int8_t)(*p_qp);
+                p_cu_info[x].i_delta_qp = (int8_t)i_delta_qp;
+            }
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * decide QPs and delta QPs of all CUs in one lcu (AQ), before the lcu is
+ * deblocked. the LCU in the left has been decided by the same thread; the
+ * first LCU of a row needs the last QP of the row above only if its first CU
+ * has no residual. with rows coded in parallel this runs in the loop filter
+ * tasks (LoopFilterWavefront is forced on), so the RDO of rows never waits
+ */
+static void lcu_decide_cu_qp(xavs2_t *h, row_info_t *row, row_info_t *last_row, int i_lcu_x)
+{
+    lcu_info_t *lcu = &row->lcus[i_lcu_x];
+    int i_qp;
+
+    if (i_lcu_x > 0) {
+        i_qp = row->lcus[i_lcu_x - 1].i_qp_last;
+    } else if (last_row == NULL) {
+        i_qp = h->slices[lcu->slice_index]->i_qp;   /* slice start */
+    } else if (h->cu_info[lcu->scu_xy].i_cbp != 0) {
+        i_qp = lcu->i_qp;                           /* not inherited */
+    } else {
+        if (h->param->enable_lf_wavefront) {
+            wait_lcu_row_filtered(last_row, h->i_width_in_lcu - 1);
+        } else {
+            wait_lcu_row_coded(last_row, h->i_width_in_lcu - 1);
+        }
+        i_qp = last_row->lcus[h->i_width_in_lcu - 1].i_qp_last;
+    }
+
+    cu_set_qp_in_coding_order(h, lcu->i_qp, h->i_lcu_level, lcu->pix_x, lcu->pix_y, &i_qp);
+    lcu->i_qp_last = i_qp;
+}
+#endif
+
+/* ---------------------------------------------------------------------------
+ * loop filter of one lcu: deblock the LCU, then decide and apply SAO for the
+ * LCU on its left (and for itself at the end of the row)
+ */
+static void lcu_loop_filter(xavs2_t *h, aec_t *p_aec, int i_lcu_x, int i_lcu_y)
+{
+    /* SAO statistics on the samples not yet deblocked */
+    if (h->param->enable_sao && h->param->b_sao_before_deblock) {
+        sao_get_lcu_stat_before_deblock(h, i_lcu_x, i_lcu_y);
+    }
+
+    /* deblock on lcu */
+#if XAVS2_DUMP_REC
+    if (!h->param->loop_filter_disable) {
+        xavs2_lcu_deblock(h, h->fdec);
+    }
+#else
+    /* no need to do loop-filter without dumping, but at this time,
+     * the PSNR is computed not correctly if XAVS2_STAT is on. */
+    if (!h->param->loop_filter_disable && h->fdec->rps.referd_by_others) {
+        xavs2_lcu_deblock(h, h->fdec);
+    }
+#endif
+
+    /* copy reconstruction pixels when the last LCU is reconstructed */
+    if (h->param->enable_sao) {
+        if (i_lcu_x > 0) {
+            sao_get_lcu_param_after_deblock(h, p_aec, i_lcu_x - 1, i_lcu_y);
+            sao_filter_lcu(h, h->sao_blk_params[i_lcu_y * h->i_width_in_lcu + i_lcu_x - 1], i_lcu_x - 1, i_lcu_y);
+        }
+        if (i_lcu_x == h->i_width_in_lcu - 1) {
+            sao_get_lcu_param_after_deblock(h, p_aec, i_lcu_x, i_lcu_y);
+            sao_filter_lcu(h, h->sao_blk_params[i_lcu_y * h->i_width_in_lcu + i_lcu_x], i_lcu_x, i_lcu_y);
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * whether the LCUs of the reconstructed frame are handed to the frames
+ * referencing it column by column during the coding of each row (frame
+ * parallel coding), instead of when the whole row is finished
+ */
+static ALWAYS_INLINE
+int is_lcu_column_sync(xavs2_t *h)
+{
+    return h->h_top->i_frm_threads > 1 && h->param->slice_num == 1 &&
+           !h->param->enable_alf && h->fdec->rps.referd_by_others;
+}
+
+/* ---------------------------------------------------------------------------
+ * prepare the LCUs [i_lcu_x_start, i_lcu_x_end) of one row for reference:
+ * store cu info, expand border, interpolate and build the downscaled planes
+ */
+static void lcu_ref_process(xavs2_t *h, int i_lcu_y, int i_lcu_x_start, int i_lcu_x_end)
+{
+    /* store cu info */
+    store_cu_info_lcus(h, i_lcu_x_start, i_lcu_x_end);
+
+    /* expand border */
+    xavs2_frame_expand_border_lcurow(h, h->fdec, i_lcu_y, i_lcu_x_start, i_lcu_x_end);
+
+    /* interpolate (after finished expanding border) */
+#if ENABLE_FRAME_SUBPEL_INTPL
+    if (h->use_fractional_me != 0) {
+        interpolate_lcu_row(h, h->fdec, i_lcu_y, i_lcu_x_start, i_lcu_x_end);
+    }
+#endif
+
+    /* downscaled planes for hierarchical ME */
+    if (h->param->me_pyramid_range > 0) {
+        xavs2_frame_lowres_lcurow(h, h->fdec, i_lcu_y, i_lcu_x_start, i_lcu_x_end);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * hand the finished LCUs of one row to the frames referencing this one, after
+ * the loop filter of the LCU i_lcu_x. The LCU (i_lcu_x - 1) is still changed
+ * by the deblocking and SAO of the LCU i_lcu_x, so LCUs [0, i_lcu_x - 1) are
+ * final. They are handed over in units of 64 luma columns (which keeps the
+ * downscaled planes aligned) and never ahead of the row above, of which the
+ * padded and interpolated lines are used by this row
+ */
+static void lcu_ref_publish(xavs2_t *h, row_info_t *last_row, int i_lcu_x, int i_lcu_y)
+{
+    xavs2_frame_t *fdec = h->fdec;
+    int unit_mask = (1 << (MAX_CU_SIZE_IN_BIT - h->i_lcu_level)) - 1;
+    int num_ready = fdec->num_lcu_coded_in_row[i_lcu_y];
+    int num_final = (i_lcu_x - 1) & (~unit_mask);
+
+    if (last_row != NULL) {
+        num_final = XAVS2_MIN(num_final, xavs2_atomic_load_acquire(&fdec->num_lcu_coded_in_row[last_row->row]));
+    }
+
+    if (num_final > num_ready) {
+        lcu_ref_process(h, i_lcu_y, num_ready, num_final);
+
+        /* release: paired with the lock-free checks of the referencing frames,
+         * the mutex avoids a lost wakeup of the ones about to wait */
+        xavs2_thread_mutex_lock(&fdec->mutex);     /* lock */
+        xavs2_atomic_store_release(&fdec->num_lcu_coded_in_row[i_lcu_y], num_final);
+        xavs2_thread_mutex_unlock(&fdec->mutex);   /* unlock */
+        xavs2_thread_cond_broadcast(&fdec->cond);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * post-processing for one lcu row, after all LCUs of the row are filtered
+ */
+static void lcu_row_post_process(xavs2_t *h, row_info_t *row, row_info_t *last_row)
+{
+    const int i_lcu_y = row->row;
+    int i_lcu_x;
+
+    if (h->param->enable_sao && (h->slice_sao_on[0] || h->slice_sao_on[1] || h->slice_sao_on[2])) {
+        int sao_off_num_y = 0;
+        int sao_off_num_u = 0;
+        int sao_off_num_v = 0;
+        int idx_lcu = i_lcu_y * h->i_width_in_lcu;
+        for (i_lcu_x = 0; i_lcu_x < h->i_width_in_lcu; i_lcu_x++, idx_lcu++) {
+            if (h->sao_blk_params[idx_lcu][0].typeIdc == SAO_TYPE_OFF) {
+                sao_off_num_y++;
+            }
+            if (h->sao_blk_params[idx_lcu][1].typeIdc == SAO_TYPE_OFF) {
+                sao_off_num_u++;
+            }
+            if (h->sao_blk_params[idx_lcu][2].typeIdc == SAO_TYPE_OFF) {
+                sao_off_num_v++;
+            }
+        }
+        h->num_sao_lcu_off[i_lcu_y][0] = sao_off_num_y;
+        h->num_sao_lcu_off[i_lcu_y][1] = sao_off_num_u;
+        h->num_sao_lcu_off[i_lcu_y][2] = sao_off_num_v;
+    } else {
+        int num_lcu = h->i_width_in_lcu;
+        h->num_sao_lcu_off[i_lcu_y][0] = num_lcu;
+        h->num_sao_lcu_off[i_lcu_y][1] = num_lcu;
+        h->num_sao_lcu_off[i_lcu_y][2] = num_lcu;
+    }
+
+    if (h->param->enable_alf && (h->pic_alf_on[0] || h->pic_alf_on[1] || h->pic_alf_on[2])) {
+        if (h->i_type == SLICE_TYPE_B && IS_ALG_ENABLE(OPT_FAST_ALF)) {
+            i_lcu_x = ((i_lcu_y + h->fenc->i_frm_coi) & 1);
+            for (; i_lcu_x < h->i_width_in_lcu; i_lcu_x += 2) {
+                alf_get_statistics_lcu(h, i_lcu_x, i_lcu_y, h->fenc, h->fdec);
+            }
+        } else {
+            for (i_lcu_x = 0; i_lcu_x < h->i_width_in_lcu; i_lcu_x++) {
+                alf_get_statistics_lcu(h, i_lcu_x, i_lcu_y, h->fenc, h->fdec);
+            }
+        }
+    }
+
+    /* reference frame */
+    if (h->fdec->rps.referd_by_others) {
+        /* LCUs not handed to the referencing frames yet */
+        int num_ready = h->fdec->num_lcu_coded_in_row[i_lcu_y];
+
+        if (last_row && is_lcu_column_sync(h)) {
+            /* the right-most LCUs use the padded lines of the top row */
+            wait_ref_lcu_row_coded(h->fdec, last_row->row, h->i_width_in_lcu);
+        }
+
+        lcu_ref_process(h, i_lcu_y, num_ready, h->i_width_in_lcu);
+
+        if (last_row) {
+            /* make sure the top row have finished interpolation and padding */
+            wait_ref_lcu_row_coded(h->fdec, last_row->row, h->i_width_in_lcu);
+        }
+    }
+}
+
 /* ---------------------------------------------------------------------------
  * encode one lcu row
  */
@@ -379,8 +648,9 @@ void *xavs2_lcu_row_write(void *arg)
     row_info_t  *last_row = (i_lcu_y > slice->i_first_lcu_y) ? &h->frameinfo->rows[i_lcu_y - 1] : 0;
     lcu_analyse_t lcu_analyse = g_funcs.compress_ctu[h->i_type];
     const bool_t b_enable_wpp = h->param->i_lcurow_threads > 1;
+    const bool_t b_lf_wavefront = h->param->enable_lf_wavefront;
     int min_level = h->i_scu_level;
-    int max_level = h->i_lcu_level;
+    int max_level = XAVS2_MIN(h->i_lcu_level, h->i_speed_max_cu_level);
     int i_lcu_x;
 #if ENABLE_RATE_CONTROL_CU
     int temp_dquant;
@@ -402,6 +672,9 @@ void *xavs2_lcu_row_write(void *arg)
         lcu->scu_xy      = h->lcu.i_scu_xy;
         lcu->pix_x       = h->lcu.i_pix_x;
         lcu->pix_y       = h->lcu.i_pix_y;
+#if ENABLE_RATE_CONTROL_CU
+        lcu->i_qp        = h->lcu.i_qp;
+#endif
 
         h->lcu.lcu_coeff[0] = lcu->coeffs_y;
         h->lcu.lcu_coeff[1] = lcu->coeffs_uv[0];
@@ -412,6 +685,7 @@ void *xavs2_lcu_row_write(void *arg)
 
         /* 1, sync */
         wait_lcu_row_coded(last_row, XAVS2_MIN(h->i_width_in_lcu - 1, i_lcu_x + 1));
+        xavs2e_inter_sync(h, i_lcu_y, i_lcu_x);
 
         if (b_enable_wpp && last_row != NULL && i_lcu_x == 0) {
             aec_copy_aec_state(p_aec, &last_row->aec_set);
@@ -420,6 +694,13 @@ void *xavs2_lcu_row_write(void *arg)
         /* 3, start */
         lcu_start_init_pixels(h, i_lcu_x, i_lcu_y);
 
+#if ENABLE_RATE_CONTROL_CU
+        if (h->fenc->aq_qp_offset != NULL) {
+            /* lambda follows the QP of the lcu */
+            xavs2e_update_lcu_lambda(h, h->lcu.i_qp - h->i_qp);
+        }
+#endif
+
         if (h->td_rdo != NULL) {
             tdrdo_lcu_adjust_lambda(h, &h->f_lambda_mode);
         }
@@ -431,8 +712,15 @@ void *xavs2_lcu_row_write(void *arg)
         /* 4, analyze */
         if (IS_ALG_ENABLE(OPT_CU_DEPTH_CTRL)) {
             est_cu_depth_range(h, &min_level, &max_level);
+            max_level = XAVS2_MIN(max_level, h->i_speed_max_cu_level);
+            min_level = XAVS2_MIN(min_level, max_level);
         }
 
+        aec_set_ctx_base(p_aec, ++h->i_aec_base_ver);
+        h->lcu.pyramid_mask = 0;
+        if (h->param->me_mv_reuse) {
+            memset(h->lcu.mvcache_mask, 0, sizeof(h->lcu.mvcache_mask));
+        }
         lcu_analyse(h, p_aec, h->lcu.p_ctu, h->i_lcu_level, min_level, max_level, MAX_COST);
 
         if (h->td_rdo != NULL) {
@@ -451,28 +739,17 @@ void *xavs2_lcu_row_write(void *arg)
             aec_copy_aec_state(&row->aec_set, p_aec);
         }
 
-        /* 4, deblock on lcu */
-#if XAVS2_DUMP_REC
-        if (!h->param->loop_filter_disable) {
-            xavs2_lcu_deblock(h, h->fdec);
-        }
-#else
-        /* no need to do loop-filter without dumping, but at this time,
-         * the PSNR is computed not correctly if XAVS2_STAT is on. */
-        if (!h->param->loop_filter_disable && h->fdec->rps.referd_by_others) {
-            xavs2_lcu_deblock(h, h->fdec);
-        }
+        /* 6, loop filter, or leave it to the loop filter task of this row */
+        if (!b_lf_wavefront) {
+#if ENABLE_RATE_CONTROL_CU
+            if (!h->param->fixed_picture_qp) {
+                lcu_decide_cu_qp(h, row, last_row, i_lcu_x);
+            }
 #endif
+            lcu_loop_filter(h, p_aec, i_lcu_x, i_lcu_y);
 
-        /* copy reconstruction pixels when the last LCU is reconstructed */
-        if (h->param->enable_sao) {
-            if (i_lcu_x > 0) {
-                sao_get_lcu_param_after_deblock(h, p_aec, i_lcu_x - 1, i_lcu_y);
-                sao_filter_lcu(h, h->sao_blk_params[i_lcu_y * h->i_width_in_lcu + i_lcu_x - 1], i_lcu_x - 1, i_lcu_y);
-            }
-            if (i_lcu_x == h->i_width_in_lcu - 1) {
-                sao_get_lcu_param_after_deblock(h, p_aec, i_lcu_x, i_lcu_y);
-                sao_filter_lcu(h, h->sao_blk_params[i_lcu_y * h->i_width_in_lcu + i_lcu_x], i_lcu_x, i_lcu_y);
+            if (is_lcu_column_sync(h)) {
+                lcu_ref_publish(h, last_row, i_lcu_x, i_lcu_y);
             }
         }
 
@@ -481,86 +758,80 @@ void *xavs2_lcu_row_write(void *arg)
         // h->fdec->num_lcu_coded_in_row[row->row]++;
         xavs2_thread_mutex_unlock(&row->mutex);  /* unlock */
 
-        /* signal to the next row */
-        if (i_lcu_x >= 1) {
+        /* signal to the next row (and to the loop filter task of this row) */
+        if (b_lf_wavefront) {
+            xavs2_thread_cond_broadcast(&row->cond);
+        } else if (i_lcu_x >= 1) {
             xavs2_thread_cond_signal(&row->cond);
         }
     }
 
-    /* post-processing for current lcu row -------------------------
-     */
-    if (h->param->enable_sao && (h->slice_sao_on[0] || h->slice_sao_on[1] || h->slice_sao_on[2])) {
-        int sao_off_num_y = 0;
-        int sao_off_num_u = 0;
-        int sao_off_num_v = 0;
-        int idx_lcu = i_lcu_y * h->i_width_in_lcu;
-        for (i_lcu_x = 0; i_lcu_x < h->i_width_in_lcu; i_lcu_x++, idx_lcu++) {
-            if (h->sao_blk_params[idx_lcu][0].typeIdc == SAO_TYPE_OFF) {
-                sao_off_num_y++;
-            }
-            if (h->sao_blk_params[idx_lcu][1].typeIdc == SAO_TYPE_OFF) {
-                sao_off_num_u++;
-            }
-            if (h->sao_blk_params[idx_lcu][2].typeIdc == SAO_TYPE_OFF) {
-                sao_off_num_v++;
-            }
-        }
-        h->num_sao_lcu_off[i_lcu_y][0] = sao_off_num_y;
-        h->num_sao_lcu_off[i_lcu_y][1] = sao_off_num_u;
-        h->num_sao_lcu_off[i_lcu_y][2] = sao_off_num_v;
-    } else {
-        int num_lcu = h->i_width_in_lcu;
-        h->num_sao_lcu_off[i_lcu_y][0] = num_lcu;
-        h->num_sao_lcu_off[i_lcu_y][1] = num_lcu;
-        h->num_sao_lcu_off[i_lcu_y][2] = num_lcu;
+    if (b_lf_wavefront) {
+        /* the loop filter task finishes the row */
+        xavs2e_free_row_context(h);
+        return 0;
     }
 
-    if (h->param->enable_alf && (h->pic_alf_on[0] || h->pic_alf_on[1] || h->pic_alf_on[2])) {
-        if (h->i_type == SLICE_TYPE_B && IS_ALG_ENABLE(OPT_FAST_ALF)) {
-            i_lcu_x = ((i_lcu_y + h->fenc->i_frm_coi) & 1);
-            for (; i_lcu_x < h->i_width_in_lcu; i_lcu_x += 2) {
-                alf_get_statistics_lcu(h, i_lcu_x, i_lcu_y, h->fenc, h->fdec);
-            }
-        } else {
-            for (i_lcu_x = 0; i_lcu_x < h->i_width_in_lcu; i_lcu_x++) {
-                alf_get_statistics_lcu(h, i_lcu_x, i_lcu_y, h->fenc, h->fdec);
-            }
-        }
-    }
+    /* post-processing for current lcu row */
+    lcu_row_post_process(h, row, last_row);
 
-    /* reference frame */
-    if (h->fdec->rps.referd_by_others) {
-        /* store cu info */
-        store_cu_info_row(row);
+    /* release task */
+    xavs2e_release_row_task(h, row);
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * loop filter task of one lcu row, trailing the RDO of the row and the loop
+ * filter of the row above (by two LCUs, as the RDO of the rows does)
+ */
+void *xavs2_lcu_row_filter(void *arg)
+{
+    row_info_t  *row      = (row_info_t *)arg;
+    xavs2_t     *h        = row->h_lf;
+    slice_t     *slice    = h->slices[h->i_slice_index];
+    const int    i_lcu_y  = row->row;
+    row_info_t  *last_row = (i_lcu_y > slice->i_first_lcu_y) ? &h->frameinfo->rows[i_lcu_y - 1] : 0;
+    int i_lcu_x;
 
-        /* expand border */
-        xavs2_frame_expand_border_lcurow(h, h->fdec, i_lcu_y);
+    if (h->param->slice_num > 1) {
+        slice_init_bufer(h, slice);
+    }
 
-        /* interpolate (after finished expanding border) */
-#if ENABLE_FRAME_SUBPEL_INTPL
-        if (h->use_fractional_me != 0) {
-            interpolate_lcu_row(h, h->fdec, i_lcu_y);
+    for (i_lcu_x = 0; i_lcu_x < h->i_width_in_lcu; i_lcu_x++) {
+        /* wait for the RDO of the LCU and the loop filter of the top-right LCU */
+        wait_lcu_row_coded(row, i_lcu_x);
+        wait_lcu_row_filtered(last_row, XAVS2_MIN(h->i_width_in_lcu - 1, i_lcu_x + 1));
+
+        lcu_filter_init_pos(h, i_lcu_x, i_lcu_y);
+#if ENABLE_RATE_CONTROL_CU
+        if (!h->param->fixed_picture_qp) {
+            lcu_decide_cu_qp(h, row, last_row, i_lcu_x);
         }
 #endif
+        lcu_loop_filter(h, &h->aec, i_lcu_x, i_lcu_y);
 
-        if (last_row) {
-            /* make sure the top row have finished interpolation and padding */
-            xavs2_frame_t *fdec = h->fdec;
-
-            xavs2_thread_mutex_lock(&fdec->mutex);   /* lock */
-            while (fdec->num_lcu_coded_in_row[last_row->row] < h->i_width_in_lcu) {
-                xavs2_thread_cond_wait(&fdec->cond, &fdec->mutex);
-            }
-            xavs2_thread_mutex_unlock(&fdec->mutex); /* unlock */
+        if (is_lcu_column_sync(h)) {
+            lcu_ref_publish(h, last_row, i_lcu_x, i_lcu_y);
         }
+
+        xavs2_thread_mutex_lock(&row->mutex);    /* lock */
+        row->filtered = i_lcu_x;
+        xavs2_thread_mutex_unlock(&row->mutex);  /* unlock */
+
+        xavs2_thread_cond_broadcast(&row->cond);
     }
 
+    /* post-processing for current lcu row */
+    lcu_row_post_process(h, row, last_row);
+
     /* release task */
-    xavs2e_release_row_task(row);
+    xavs2e_release_row_task(h, row);
 
     return 0;
 }
 
+
 /* ---------------------------------------------------------------------------
  * start encodes one slice
  */
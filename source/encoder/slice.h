@@ -82,6 +82,21 @@ void wait_lcu_row_coded(row_info_t *last_row, int wait_lcu_coded)
     }
 }
 
+/* ---------------------------------------------------------------------------
+ * wait until the loop filter of one LCU row has finished the given LCU
+ */
+static ALWAYS_INLINE
+void wait_lcu_row_filtered(row_info_t *last_row, int wait_lcu_filtered)
+{
+    if (last_row != NULL && last_row->filtered < wait_lcu_filtered) {
+        xavs2_thread_mutex_lock(&last_row->mutex);   /* lock */
+        while (last_row->filtered < wait_lcu_filtered) {
+            xavs2_thread_cond_wait(&last_row->cond, &last_row->mutex);
+        }
+        xavs2_thread_mutex_unlock(&last_row->mutex); /* unlock */
+    }
+}
+
 
 /* ---------------------------------------------------------------------------
  * ѯһLCUǷѱ
@@ -98,20 +113,36 @@ int is_lcu_row_finished(xavs2_t *h, xavs2_frame_t *frm, int lcu_row)
 static ALWAYS_INLINE
 void set_lcu_row_finished(xavs2_t *h, xavs2_frame_t *frm, int lcu_row)
 {
-    frm->num_lcu_coded_in_row[lcu_row] = h->i_width_in_lcu + 1;
+    /* release: the reconstruction of the row is visible to lock-free readers */
+    xavs2_atomic_store_release(&frm->num_lcu_coded_in_row[lcu_row], h->i_width_in_lcu + 1);
 }
 
 
 /* ---------------------------------------------------------------------------
- * release a row task
+ * free a row context, the row itself may still be finished by another context
  */
 static INLINE
-void xavs2e_release_row_task(row_info_t *row)
+void xavs2e_free_row_context(xavs2_t *h)
+{
+    if (h->task_type == XAVS2_TASK_ROW) {
+        xavs2_handler_t *h_mgr = h->h_top;
+
+        xavs2_thread_mutex_lock(&h_mgr->mutex);   /* lock */
+        h->task_status = XAVS2_TASK_FREE;
+        xavs2_thread_mutex_unlock(&h_mgr->mutex); /* unlock */
+        /* signal a free row context available */
+        xavs2_thread_cond_signal(&h_mgr->cond[SIG_ROW_CONTEXT_RELEASED]);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * release a row task: the row is finished by the context h
+ */
+static INLINE
+void xavs2e_release_row_task(xavs2_t *h, row_info_t *row)
 {
     if (row) {
-        xavs2_t         *h     = row->h;
         xavs2_frame_t   *fdec  = h->fdec;
-        xavs2_handler_t *h_mgr = h->h_top;
         int b_slice_boundary_done = FALSE;
 
         /* ʱSlice߽Ѵֱ꣬ӽвֵҪ
@@ -158,46 +189,82 @@ void xavs2e_release_row_task(row_info_t *row)
         } else {
             /* TODO: SliceʱSlice߽Ĵ */
         }
+        /* integral lines depend on the lines above, build them in the order of
+         * LCU rows, as soon as all rows above are finished. with ALF they are
+         * built once after ALF, as published lines are never rebuilt */
+        if (fdec->integral != NULL && fdec->rps.referd_by_others && !h->param->enable_alf) {
+            int i_row = fdec->i_integral_rows;
+            while (i_row < h->i_height_in_lcu && (i_row == row->row || is_lcu_row_finished(h, fdec, i_row))) {
+                xavs2_frame_integral_lcurow(h, fdec, i_row);
+                xavs2_atomic_store_release(&fdec->i_integral_rows, ++i_row);
+            }
+        }
         set_lcu_row_finished(h, fdec, row->row);
         xavs2_thread_mutex_unlock(&fdec->mutex);         /* unlock */
 
         /* broadcast to the aec thread and all waiting contexts */
         xavs2_thread_cond_broadcast(&fdec->cond);
 
-        if (h->task_type == XAVS2_TASK_ROW) {
-            xavs2_thread_mutex_lock(&h_mgr->mutex);   /* lock */
-            h->task_status = XAVS2_TASK_FREE;
-            xavs2_thread_mutex_unlock(&h_mgr->mutex); /* unlock */
-            /* signal a free row context available */
-            xavs2_thread_cond_signal(&h_mgr->cond[SIG_ROW_CONTEXT_RELEASED]);
+        xavs2e_free_row_context(h);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * number of LCU rows (and columns) by which a frame may run ahead of its
+ * reference frames in frame parallel coding (the search range plus one LCU).
+ * the search range of the sequence is used, as the one of a frame task may be
+ * lowered by speed control after the mv range is decided
+ */
+static ALWAYS_INLINE
+int xavs2e_get_ref_row_lag(xavs2_t *h)
+{
+    return ((h->h_top->param->search_range + (1 << h->i_lcu_level) - 1) >> h->i_lcu_level) + 1;
+}
+
+/* ---------------------------------------------------------------------------
+ * wait until the given number of LCUs in one row of the reference frame are
+ * ready (reconstructed, padded and interpolated)
+ */
+static ALWAYS_INLINE
+void wait_ref_lcu_row_coded(xavs2_frame_t *p_ref, int lcu_row, int wait_lcu_coded)
+{
+    volatile int *p_coded = p_ref->num_lcu_coded_in_row + lcu_row;
+
+    /* lock-free check first (acquire, paired with set_lcu_row_finished() and
+     * the LCU columns handed over during the row), the mutex is only taken
+     * when we need to wait */
+    if (xavs2_atomic_load_acquire(p_coded) < wait_lcu_coded) {
+        xavs2_thread_mutex_lock(&p_ref->mutex);    /* lock */
+        while (*p_coded < wait_lcu_coded) {
+            xavs2_thread_cond_wait(&p_ref->cond, &p_ref->mutex);
         }
+        xavs2_thread_mutex_unlock(&p_ref->mutex);  /* unlock */
     }
 }
 
 /* ---------------------------------------------------------------------------
- * sync of frame parallel coding
+ * sync of frame parallel coding: wait until the LCUs of the reference frames
+ * within the search range of the LCU (lcu_x, lcu_y) are ready. Reference
+ * frames may hand over the LCUs of a row column by column, the count of a
+ * finished row is (i_width_in_lcu + 1)
  */
 static ALWAYS_INLINE
 void xavs2e_inter_sync(xavs2_t *h, int lcu_y, int lcu_x)
 {
     if (h->i_type != SLICE_TYPE_I && h->h_top->i_frm_threads > 1) {
-        int num_lcu_delay = ((h->param->search_range + (1 << h->i_lcu_level) - 1) >> h->i_lcu_level) + 1;
+        int num_lcu_delay = xavs2e_get_ref_row_lag(h);
         int low_bound  = XAVS2_MAX(lcu_y - num_lcu_delay, 0);
         int up_bound = XAVS2_MIN(lcu_y + num_lcu_delay, h->i_height_in_lcu - 1);
-        int col_coded = h->i_width_in_lcu;
+        int col_coded = XAVS2_MIN(lcu_x + num_lcu_delay + 1, h->i_width_in_lcu);
         int i, j;
 
-        UNUSED_PARAMETER(lcu_x);
-
         for (i = 0; i < h->i_ref; i++) {
             xavs2_frame_t *p_ref = h->fref[i];
 
-            for (j = low_bound; j <= up_bound; j++) {
-                xavs2_thread_mutex_lock(&p_ref->mutex);    /* lock */
-                while (p_ref->num_lcu_coded_in_row[j] < col_coded) {
-                    xavs2_thread_cond_wait(&p_ref->cond, &p_ref->mutex);
-                }
-                xavs2_thread_mutex_unlock(&p_ref->mutex);  /* unlock */
+            /* rows are mostly finished from top to bottom, check the lowest one first */
+            wait_ref_lcu_row_coded(p_ref, up_bound, col_coded);
+            for (j = low_bound; j < up_bound; j++) {
+                wait_ref_lcu_row_coded(p_ref, j, col_coded);
             }
         }
     }
@@ -221,12 +288,19 @@ xavs2_t *xavs2e_alloc_row_task(xavs2_t *h)
         for (i = 0; i < h_mgr->num_row_contexts; i++) {
             xavs2_t *h_row_coder = &h_mgr->row_contexts[i];
 
+            if (i == h_mgr->num_row_contexts_built) {
+                /* all built row contexts are busy, build a new one */
+                encoder_init_row_context(h_mgr, h_row_coder);
+                h_mgr->num_row_contexts_built++;
+            }
+
             if (h_row_coder->task_status == XAVS2_TASK_FREE) {
                 h_row_coder->task_status = XAVS2_TASK_BUSY;
                 h_row_coder->frameinfo = h->frameinfo;   /* duplicate frame info */
 
                 /* sync row contexts */
                 memcpy(&h_row_coder->row_vars_1, &h->row_vars_1, (uint8_t *)&h->row_vars_2 - (uint8_t *)&h->row_vars_1);
+                h_row_coder->param = h->param;           /* parameters of the frame task */
 
                 /* make the state of the aec engine same as the one when the slice starts */
                 /* h->aecλòͬܲһLCUбʱ֤ͬһ */
@@ -255,6 +329,9 @@ void  xavs2_slice_write_start(xavs2_t *h);
 #define xavs2_lcu_row_write FPFX(lcu_row_write)
 void *xavs2_lcu_row_write(void *arg);
 
+#define xavs2_lcu_row_filter FPFX(lcu_row_filter)
+void *xavs2_lcu_row_filter(void *arg);
+
 #define slice_lcu_row_order_init FPFX(slice_lcu_row_order_init)
 void  slice_lcu_row_order_init(xavs2_t *h);
 
@@ -52,6 +52,7 @@ void frame_buffer_init(xavs2_handler_t *h_mgr, uint8_t **mem_base, xavs2_frame_b
     frm_buf->COI     = 0;
     frm_buf->COI_IDR = 0;
     frm_buf->POC_IDR = 0;
+    frm_buf->COI_RPS = 0;
     frm_buf->num_frames = num_frm;
     frm_buf->i_frame_b  = 0;
     frm_buf->ip_pic_idx = 0;
@@ -86,14 +87,20 @@ void frame_buffer_destroy(xavs2_handler_t *h_mgr, xavs2_frame_buffer_t *frm_buf)
 /* ---------------------------------------------------------------------------
  * update frame buffer information
  */
-void frame_buffer_update(xavs2_t *h, xavs2_frame_buffer_t *frm_buf, xavs2_frame_t *frm)
+void frame_buffer_update(const xavs2_param_t *param, xavs2_frame_buffer_t *frm_buf, xavs2_frame_t *frm)
 {
     /* update the task manager */
-    if (h->param->intra_period_max != 0 && frm->i_frm_type == XAVS2_TYPE_I) {
+    if ((param->intra_period_max != 0 || frm->b_scenecut) && frm->i_frm_type == XAVS2_TYPE_I) {
         frm_buf->COI_IDR = frm->i_frm_coi;
         frm_buf->POC_IDR = frm->i_frame;
     }
 
+    /* the GOP structure restarts at every I frame of closed GOPs and at scene cuts */
+    if (frm->i_frm_type == XAVS2_TYPE_I &&
+        (frm->b_scenecut || (!param->b_open_gop && param->num_bframes > 0))) {
+        frm_buf->COI_RPS = frm->i_frm_coi;
+    }
+
     if (frm->i_frm_type == XAVS2_TYPE_B) {
         frm_buf->i_frame_b++;      /* encoded B-picture index */
     } else {
@@ -122,7 +129,7 @@ void destroy_all_lists(xavs2_handler_t *h_mgr)
     xl_destroy(&h_mgr->list_frames_ready);
     xl_destroy(&h_mgr->list_frames_free);
 
-    for (i = 0; i < XAVS2_INPUT_NUM; i++) {
+    for (i = 0; i < h_mgr->ipb.num_frames; i++) {
         xavs2_frame_destroy_objects(h_mgr, h_mgr->ipb.frames[i]);
     }
 }
@@ -142,6 +149,8 @@ void *proc_wrapper_thread(void *args)
     xlist_t         *list_in   = &h_mgr->list_frames_ready;
     xlist_t         *list_idle = &h_mgr->list_frames_free;
 
+    xavs2_thread_set_node(h_mgr->param->numa_node);
+
     for (;;) {
         /* fetch one node from input list */
         xavs2_frame_t *frame = (xavs2_frame_t *)xl_remove_head(list_in, 1);
@@ -40,6 +40,16 @@
 #include "xlist.h"
 #include "threadpool.h"
 
+/**
+ * ===========================================================================
+ * macros
+ * ===========================================================================
+ */
+#define SCENECUT_BLOCK_BITS     3     /* size of blocks in thumbnails for scene cut detection: 8x8 */
+#define SCENECUT_HIST_BINS      32    /* number of bins in histograms for scene cut detection */
+#define SCENECUT_MIN_SAD        6     /* minimum SAD per 8x8 block mean of a scene cut (8-bit scale) */
+#define AQ_MAX_QP_OFFSET        12    /* maximum absolute QP offset of an LCU decided by AQ */
+
 
 /**
  * ===========================================================================
@@ -50,16 +60,6 @@
 // function type
 typedef void(*vpp_ipred_t)(pel_t *p_pred, pel_t *p_top, pel_t *p_left);
 
-/* ---------------------------------------------------------------------------
- * lookahead_t
- */
-typedef struct lookahead_t {
-    int         start;
-    int         bpframes;
-    int         gopframes;
-} lookahead_t;
-
-
 /* ---------------------------------------------------------------------------
  * low resolution of frame (luma plane)
  */
@@ -70,6 +70,32 @@ typedef struct frm_lowres_t {
     pel_t      *filtered;             /* half-size copy of input frame (luma only) */
 } frm_lowres_t;
 
+/* ---------------------------------------------------------------------------
+ * lookahead_t
+ */
+typedef struct lookahead_t {
+    int         start;
+    int         bpframes;
+    int         gopframes;
+
+    /* scene cut detection, on 8x8 block means of luma (8-bit scale) */
+    uint8_t    *thumb[2];             /* thumbnails of the current and the previous input frame */
+    int         hist[2][SCENECUT_HIST_BINS]; /* histograms of the thumbnails */
+    int         i_thumb_width;        /* width  of thumbnails (in 8x8 blocks) */
+    int         i_thumb_height;       /* height of thumbnails (in 8x8 blocks) */
+    int         i_thumb_cur;          /* index of the thumbnail of the current frame */
+    int         b_thumb_valid;        /* is the thumbnail of the previous frame available? */
+    double      f_sad_avg;            /* average thumbnail SAD of the current scene (0: not available) */
+
+    /* adaptive quantization */
+    float      *aq_activity;          /* activity of LCUs: average log2 variance of 8x8 luma blocks */
+
+    /* frame costs for the stats of the first pass */
+    frm_lowres_t lowres[2];           /* half-size luma of the current and the previous input frame */
+    int         i_lowres_cur;         /* index of the half-size luma of the current frame */
+    int         b_lowres_valid;       /* is the half-size luma of the previous frame available? */
+} lookahead_t;
+
 /* ---------------------------------------------------------------------------
  * video pre-processing motion estimation
  */
@@ -93,6 +119,7 @@ struct xavs2_frame_buffer_t {
     int              COI;                    /* Coding Order Index */
     int              COI_IDR;                /* COI of current IDR frame */
     int              POC_IDR;                /* POC of current IDR frame */
+    int              COI_RPS;                /* COI of the I frame restarting the GOP structure, RPS indices count from it */
     int              ip_pic_idx;           /* encoded I/P/F-picture index (to be REMOVED) */
     int              i_frame_b;            /* number of encoded B-picture in a GOP */
 
@@ -108,8 +135,10 @@ struct xavs2_handler_t {
     ALIGN32(xavs2_log_t   module_log);              /* used for logging */
     /* encoder engines */
     xavs2_t    *p_coder;                            /* point to the xavs2 video encoder */
-    xavs2_t    *frm_contexts[MAX_PARALLEL_FRAMES];  /* frame task contexts */
-    xavs2_t    *row_contexts;                       /* row   task contexts */
+    xavs2_param_t *param;                           /* parameters, frame tasks copy them when they start */
+    xavs2_t    *frm_contexts[MAX_PARALLEL_FRAMES];  /* frame task contexts, created on first use */
+    xavs2_t    *row_contexts;                       /* row   task contexts, built on first use */
+    uint8_t    *ctx_communal_vars;                  /* communal variables of the main context for new contexts */
 
     /* frame buffers */
     xavs2_frame_buffer_t ipb;         /* input picture buffer */
@@ -139,8 +168,11 @@ struct xavs2_handler_t {
     int                   i_row_threads;      /* real number of thread in LCU-row level parallel */
     int                   num_pool_threads;   /* number of threads allocated in threadpool */
     int                   num_row_contexts;   /* number of row contexts */
+    int                   num_row_contexts_built;  /* number of row contexts built */
     xavs2_threadpool_t   *threadpool_rdo;     /* the thread pool (for parallel encoding) */
     xavs2_threadpool_t   *threadpool_aec;     /* the thread pool for aec encoding */
+    xavs2_threadpool_t   *threadpool_ctu;     /* the thread pool for parallel analysis inside CTU */
+    int                   num_ctu_threads;    /* number of threads in threadpool_ctu */
     xavs2_thread_t       thread_wrapper;     /* thread for wrapper proceeding */
 
     xavs2_thread_cond_t  cond[SIG_COUNT];
@@ -164,6 +196,19 @@ struct xavs2_handler_t {
     ratectrl_t     *rate_control;            /* rate control */
     td_rdo_t       *td_rdo;
 
+    /* preset tables, shared by all encoders */
+    const double  (*tab_qsfd_thres)[MAX_QP][2][CTU_DEPTH];  /* QSFD thresholds: [preset level][qp][inter/intra][cu level] */
+
+    /* adaptive speed control */
+    double          speed_ctrl_avg_time;     /* smoothed time cost of one frame (in us) */
+    int             speed_ctrl_level;        /* preset level of fast algorithms for the following frames */
+    int             speed_ctrl_num_frames;   /* number of frames encoded since the last level switch */
+
+    /* runtime reconfiguration */
+    xavs2_param_t   param_reconfig;          /* pending parameters, set by xavs2_encoder_reconfig() */
+    int             b_reconfig;              /* are there pending parameters to be applied? */
+    int             intra_period_next[2];    /* intra period (max, min) for the next I frame, 0: unchanged */
+
 #if XAVS2_STAT
     xavs2_stat_t      stat;           /* stat total */
     FILE             *fp_trace;       /* for trace output */
@@ -209,7 +254,7 @@ void frame_buffer_init(xavs2_handler_t *h_mgr, uint8_t **mem_base, xavs2_frame_b
 void frame_buffer_destroy(xavs2_handler_t *h_mgr, xavs2_frame_buffer_t *frm_buf);
 
 #define frame_buffer_update FPFX(frame_buffer_update)
-void frame_buffer_update(xavs2_t *h, xavs2_frame_buffer_t *frm_buf, xavs2_frame_t *frm);
+void frame_buffer_update(const xavs2_param_t *param, xavs2_frame_buffer_t *frm_buf, xavs2_frame_t *frm);
 
 /* ---------------------------------------------------------------------------
  * wrapper
@@ -351,6 +396,19 @@ int xavs2_encoder_encode(void *coder, xavs2_picture_t *pic, xavs2_outpacket_t *p
  */
 int xavs2_encoder_packet_unref(void *coder, xavs2_outpacket_t *packet);
 
+/**
+ * ---------------------------------------------------------------------------
+ * Function   : change one encoding parameter while encoding
+ * Parameters :
+ *      [in ] : coder - pointer to wrapper of the xavs2 encoder
+ *            : name  - name of parameter
+ *            : value_string - parameter value
+ *      [out] : none
+ * Return     : zero for success, otherwise failed
+ * ---------------------------------------------------------------------------
+ */
+int xavs2_encoder_reconfig(void *coder, const char *name, const char *value_string);
+
 
 /**
  * ---------------------------------------------------------------------------
@@ -67,6 +67,105 @@ int get_num_frame_threads(xavs2_param_t *param, int num_frame_threads, int num_r
     return i - 1;
 }
 
+/* ---------------------------------------------------------------------------
+ * number of input frames to buffer
+ */
+static
+int get_num_input_frames(const xavs2_param_t *param, int num_frame_threads)
+{
+    if (param->enable_lean_memory) {
+        /* frames blocked for slice type decision (one GOP), frames of the last
+         * released GOP waiting for output, frames in encoding, and the frames
+         * held by the caller (input picture, unreferenced packet, flushing) */
+        int num_frames = 2 * XAVS2_ABS(param->i_gop_size) + num_frame_threads + 4;
+        return XAVS2_MIN(num_frames, XAVS2_INPUT_NUM);
+    } else {
+        return XAVS2_INPUT_NUM;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * have the primitives in g_funcs been initialized?
+ */
+static int g_b_primitives_ready = 0;
+
+/* ---------------------------------------------------------------------------
+ * parameters which can be changed while encoding
+ */
+static const char *const tab_reconfig_names[] = {
+    "TargetBitRate", "CRF", "QP", "InitialQP", "QPIFrame", "MinQP", "MaxQP",
+    "PresetLevel", "Preset", "IntraPeriodMax", "IntraPeriodMin", NULL
+};
+
+/* ---------------------------------------------------------------------------
+ * apply the pending parameters, frame tasks started later will use them
+ */
+static
+void encoder_apply_reconfig(xavs2_handler_t *h_mgr)
+{
+    /* frame tasks take a copy of the parameters when they start */
+    xavs2_param_t       *param = h_mgr->param;
+    const xavs2_param_t *p_new = &h_mgr->param_reconfig;
+    int max_qp       = 63 + (param->sample_bit_depth - 8) * 8;
+    int period_max   = p_new->intra_period_max;
+    int period_min   = p_new->intra_period_min;
+
+    xavs2_thread_mutex_lock(&h_mgr->mutex);   /* lock */
+    h_mgr->b_reconfig = 0;
+
+    /* QP range and QP */
+    if (p_new->i_min_qp < 0 || p_new->i_max_qp > max_qp || p_new->i_min_qp > p_new->i_max_qp) {
+        xavs2_log(h_mgr, XAVS2_LOG_WARNING, "reconfig: invalid QP range [%d, %d], ignored\n",
+                  p_new->i_min_qp, p_new->i_max_qp);
+    } else {
+        param->i_min_qp = p_new->i_min_qp;
+        param->i_max_qp = p_new->i_max_qp;
+    }
+    param->i_initial_qp = XAVS2_CLIP3(param->i_min_qp, param->i_max_qp, p_new->i_initial_qp);
+
+    /* target bitrate, the one in the sequence header is not changed */
+    if (p_new->i_target_bitrate > 0) {
+        param->i_target_bitrate = p_new->i_target_bitrate;
+    }
+    param->f_rate_factor = XAVS2_CLIP3F((float)param->i_min_qp, (float)param->i_max_qp, p_new->f_rate_factor);
+
+    /* preset: level of the fast algorithms, also the upper level of speed control */
+    if (p_new->preset_level != param->preset_level) {
+        if (p_new->preset_level < 0 || p_new->preset_level > 9) {
+            xavs2_log(h_mgr, XAVS2_LOG_WARNING, "reconfig: invalid preset level %d, ignored\n",
+                      p_new->preset_level);
+        } else {
+            param->preset_level          = p_new->preset_level;
+            h_mgr->speed_ctrl_level      = p_new->preset_level;
+            h_mgr->speed_ctrl_num_frames = 0;
+        }
+    }
+
+    /* intra period, switched at the next I frame in slice_type_analyse() */
+    if (period_max != param->intra_period_max || period_min != param->intra_period_min) {
+        if (param->intra_period_max <= 1 || period_max <= 1 ||
+            (param->num_bframes && period_max <= param->i_gop_size) ||
+            param->InterlaceCodingOption == FIELD_CODING) {
+            xavs2_log(h_mgr, XAVS2_LOG_WARNING, "reconfig: IntraPeriod %d can not be changed to %d, ignored\n",
+                      param->intra_period_max, period_max);
+        } else {
+            if (param->b_open_gop && param->num_bframes && period_max % param->i_gop_size) {
+                period_max = (period_max / param->i_gop_size + 1) * param->i_gop_size;
+            }
+            h_mgr->intra_period_next[0] = period_max;
+            h_mgr->intra_period_next[1] = XAVS2_CLIP3(1, period_max, period_min);
+        }
+    }
+
+    xavs2_thread_mutex_unlock(&h_mgr->mutex); /* unlock */
+
+    xavs2_rc_reconfig(h_mgr->rate_control, param);
+
+    xavs2_log(h_mgr, XAVS2_LOG_DEBUG, "reconfig: frame %d, bitrate %d, CRF %.1f, QP %d [%d, %d], preset %d\n",
+              h_mgr->num_input, param->i_target_bitrate, param->f_rate_factor, param->i_initial_qp,
+              param->i_min_qp, param->i_max_qp, param->preset_level);
+}
+
 
 /**
  * ===========================================================================
@@ -112,6 +211,7 @@ xavs2_param_t *xavs2_encoder_opt_alloc(void)
     strcpy(param->psz_in_file,        "input.yuv");
     strcpy(param->psz_bs_file,        "test.avs");
     strcpy(param->psz_dump_yuv,       "");
+    strcpy(param->psz_stats_file,     "xavs2_stats.log");
 #if XAVS2_TRACE
     strcpy(param->psz_trace_file,     "trace_enc.txt");
 #endif
@@ -124,6 +224,7 @@ xavs2_param_t *xavs2_encoder_opt_alloc(void)
     param->num_bframes                = 7;
     param->intra_period_max           = -1;
     param->intra_period_min           = -1;
+    param->scenecut_threshold         = 0;
 
     /* --- picture ---------------------------------------------- */
     param->progressive_frame          = 1;
@@ -138,8 +239,11 @@ xavs2_param_t *xavs2_encoder_opt_alloc(void)
 
     /* --- analysis options ------------------------------------- */
     param->enable_hadamard            = TRUE;
+    param->enable_intra_satd_x4       = TRUE;
     param->me_method                  = XAVS2_ME_UMH;
     param->search_range               = 64;
+    param->me_pyramid_range           = 0;
+    param->me_mv_reuse                = 0;
     param->num_max_ref                = XAVS2_MAX_REFS;
     param->inter_2pu                  = TRUE;
     param->enable_amp                 = TRUE;
@@ -147,6 +251,7 @@ xavs2_param_t *xavs2_encoder_opt_alloc(void)
     param->i_rd_level                 = RDO_ALL;
     param->preset_level               = 5;
     param->is_preset_configured       = FALSE;
+    param->speed_ctrl_fps             = 0;
     param->rdo_bit_est_method         = 0;
 
     /* encoding tools ------------------------------------------- */
@@ -200,12 +305,21 @@ xavs2_param_t *xavs2_encoder_opt_alloc(void)
     param->i_min_qp                   = 20;
     param->i_max_qp                   = MAX_QP;
     param->i_target_bitrate           = 1000000;
+    param->f_rate_factor              = -1;
+    param->i_rc_pass                  = 0;
+    param->i_aq_mode                  = XAVS2_AQ_NONE;
+    param->f_aq_strength              = 1.0f;
 
     /* --- parallel --------------------------------------------- */
     param->num_parallel_gop           = 1;
     param->i_frame_threads            = 0;
     param->i_lcurow_threads           = 0;
     param->enable_aec_thread          = 1;
+    param->enable_lean_memory         = 0;
+    param->hugepage_mode              = 0;
+    param->numa_node                  = -1;
+    param->enable_parallel_ctu        = 0;
+    param->enable_lf_wavefront        = 0;
 
     /* --- log -------------------------------------------------- */
     param->i_log_level                = 3;
@@ -253,7 +367,13 @@ void *xavs2_encoder_create(xavs2_param_t *param)
     uint8_t         *mem_ptr = NULL;
     size_t size_ratecontrol;      /* size for rate control module */
     size_t size_tdrdo;
+    size_t size_thumb;            /* size for one thumbnail of scene cut detection */
+    size_t size_aq;               /* size for activities of LCUs (AQ) */
+    size_t size_lowres;           /* size for one half-size luma plane of the first pass */
     size_t mem_size;
+    int num_row_threads;
+    int num_frm_threads;
+    int num_input_frames;
     int i;
 
     if (param == NULL) {
@@ -270,12 +390,23 @@ void *xavs2_encoder_create(xavs2_param_t *param)
     }
     g_xavs2_default_log.i_log_level = param->i_log_level;
 
-    /* init all function handlers */
-    memset(&g_funcs, 0, sizeof(g_funcs));
+    if (param->sample_bit_depth != g_bit_depth) {
+        xavs2_log(NULL, XAVS2_LOG_ERROR, "init primitives error: only %d bit-depth is supported\n", g_bit_depth);
+    }
+
+    /* init all function handlers, only once since they are shared by all encoders */
+    if (!xavs2_atomic_load_acquire(&g_b_primitives_ready)) {
+        xavs2_init_lock();
+        if (!g_b_primitives_ready) {
+            memset(&g_funcs, 0, sizeof(g_funcs));
 #if HAVE_MMX
-    g_funcs.cpuid = xavs2_cpu_detect();
+            g_funcs.cpuid = xavs2_cpu_detect();
 #endif
-    xavs2_init_all_primitives(param, &g_funcs);
+            xavs2_init_all_primitives(param, &g_funcs);
+            xavs2_atomic_store_release(&g_b_primitives_ready, 1);
+        }
+        xavs2_init_unlock();
+    }
 
     /* check parameters */
     if (encoder_check_parameters(param) < 0) {
@@ -285,16 +416,39 @@ void *xavs2_encoder_create(xavs2_param_t *param)
 
     size_ratecontrol = xavs2_rc_get_buffer_size(param);      /* rate control */
     size_tdrdo       = tdrdo_get_buffer_size(param);
+    size_thumb       = 0;
+    if (param->scenecut_threshold > 0) {
+        size_thumb   = (size_t)(param->org_width  >> SCENECUT_BLOCK_BITS) *
+                       (size_t)(param->org_height >> SCENECUT_BLOCK_BITS) * sizeof(uint8_t);
+    }
+    size_aq          = 0;
+    if (param->i_aq_mode != XAVS2_AQ_NONE) {
+        int size_lcu = 1 << param->lcu_bit_level;
+        size_aq      = (size_t)((param->org_width  + size_lcu - 1) >> param->lcu_bit_level) *
+                       (size_t)((param->org_height + size_lcu - 1) >> param->lcu_bit_level) * sizeof(float);
+    }
+    size_lowres      = 0;
+    if (param->i_rc_pass == 1) {
+        size_lowres  = (size_t)XAVS2_ALIGN(param->org_width >> 1, 32) * (size_t)(param->org_height >> 1) * sizeof(pel_t);
+    }
+
+    /* decide all thread numbers */
+    num_row_threads  = param->i_lcurow_threads == 0 ? xavs2_cpu_num_processors() : param->i_lcurow_threads;
+    num_frm_threads  = get_num_frame_threads(param, param->i_frame_threads, num_row_threads);
+    num_input_frames = get_num_input_frames(param, num_frm_threads);
 
     /* compute the memory size */
     mem_size = sizeof(xavs2_handler_t)                           +   /* M0, size of the encoder wrapper */
-               xavs2_frame_buffer_size(param, FT_ENC) * XAVS2_INPUT_NUM     +   /* M4, size of buffered input frames */
+               xavs2_frame_buffer_size(param, FT_ENC) * num_input_frames    +   /* M4, size of buffered input frames */
                size_ratecontrol                                             +   /* M5, rate control information */
                size_tdrdo                                                   +   /* M6, TDRDO */
-               CACHE_LINE_SIZE * (XAVS2_INPUT_NUM + 4);
+               size_thumb * 2                                               +   /* M7, scene cut detection */
+               size_aq                                                      +   /* M8, adaptive quantization */
+               size_lowres * 2                                              +   /* M9, frame costs of the first pass */
+               CACHE_LINE_SIZE * (num_input_frames + 9);
 
     /* alloc memory for the encoder wrapper */
-    CHECKED_MALLOC(mem_ptr, uint8_t *, mem_size);
+    CHECKED_MALLOC_LARGE(mem_ptr, uint8_t *, mem_size, param);
 
     /* M0: assign the wrapper */
     h_mgr = (xavs2_handler_t *)mem_ptr;
@@ -342,32 +496,69 @@ void *xavs2_encoder_create(xavs2_param_t *param)
         }
     }
 
-    /* decide all thread numbers */
-    h_mgr->i_row_threads = param->i_lcurow_threads == 0 ? xavs2_cpu_num_processors() : param->i_lcurow_threads;
-    h_mgr->i_frm_threads = get_num_frame_threads(param, param->i_frame_threads, h_mgr->i_row_threads);
+    /* set all thread numbers */
+    h_mgr->i_row_threads = num_row_threads;
+    h_mgr->i_frm_threads = num_frm_threads;
     h_mgr->num_pool_threads = 0;
     h_mgr->num_row_contexts = 0;
     param->i_lcurow_threads = h_mgr->i_row_threads;
     param->i_frame_threads  = h_mgr->i_frm_threads;
 
+    /* AQ decides QPs of an LCU row only after the row above is finished,
+     * which is left to the loop filter tasks not to hold up the rows */
+    if (param->i_aq_mode != XAVS2_AQ_NONE && !param->enable_lf_wavefront && h_mgr->i_row_threads > 1) {
+        xavs2_log(h_mgr, XAVS2_LOG_WARNING, "AQMode with more than one row thread needs LoopFilterWavefront, enabled.\n");
+        param->enable_lf_wavefront = 1;
+    }
+
+    /* the loop filter wavefront trails the rows coded in parallel */
+    if (param->enable_lf_wavefront && h_mgr->i_row_threads < 2) {
+        xavs2_log(h_mgr, XAVS2_LOG_WARNING, "LoopFilterWavefront needs more than one row thread, disabled.\n");
+        param->enable_lf_wavefront = 0;
+    }
+
     /* create RDO thread pool */
     if (h_mgr->i_frm_threads > 1 || h_mgr->i_row_threads > 1) {
         int thread_num = h_mgr->i_frm_threads + h_mgr->i_row_threads;   /* total threads */
 
+        /* each row in flight has a loop filter task of its own */
+        if (param->enable_lf_wavefront) {
+            thread_num += h_mgr->i_row_threads;
+        }
+
         h_mgr->num_row_contexts = thread_num + h_mgr->i_frm_threads;
 
         /* create the thread pool */
-        if (xavs2_threadpool_init(&h_mgr->threadpool_rdo, thread_num, NULL, NULL)) {
+        if (xavs2_threadpool_init(&h_mgr->threadpool_rdo, thread_num, xavs2_thread_init_node, &param->numa_node)) {
             xavs2_log(h_mgr, XAVS2_LOG_ERROR, "Error init thread pool RDO. %d", thread_num);
             goto fail;
         }
         h_mgr->num_pool_threads = thread_num;
     }
 
+    /* create the thread pool for parallel analysis inside CTU: each context
+     * coding LCU rows has at most two pending jobs (a 64x64 CU and one of its
+     * 32x32 CUs), so submitting a job never waits for a busy pool */
+    h_mgr->threadpool_ctu  = NULL;
+    h_mgr->num_ctu_threads = 0;
+    if (param->enable_parallel_ctu) {
+        int thread_num = 2 * (h_mgr->num_pool_threads + 1);
+
+        if (thread_num > XAVS2_THREAD_MAX) {
+            xavs2_log(h_mgr, XAVS2_LOG_WARNING, "Too many threads for ParallelCTU, disabled. %d\n", thread_num);
+            param->enable_parallel_ctu = 0;
+        } else if (xavs2_threadpool_init(&h_mgr->threadpool_ctu, thread_num, xavs2_thread_init_node, &param->numa_node)) {
+            xavs2_log(h_mgr, XAVS2_LOG_ERROR, "Error init thread pool CTU. %d", thread_num);
+            goto fail;
+        } else {
+            h_mgr->num_ctu_threads = thread_num;
+        }
+    }
+
     /* create AEC thread pool */
     h_mgr->threadpool_aec = NULL;
     if (param->enable_aec_thread) {
-        xavs2_threadpool_init(&h_mgr->threadpool_aec, h_mgr->i_frm_threads, NULL, NULL);
+        xavs2_threadpool_init(&h_mgr->threadpool_aec, h_mgr->i_frm_threads, xavs2_thread_init_node, &param->numa_node);
     }
 
     /* init all lists */
@@ -401,12 +592,48 @@ void *xavs2_encoder_create(xavs2_param_t *param)
         }
     }
 
+    /* scene cut detection */
+    if (size_thumb > 0) {
+        for (i = 0; i < 2; i++) {
+            h_mgr->lookahead.thumb[i] = mem_ptr;
+            mem_ptr += size_thumb;
+            ALIGN_POINTER(mem_ptr);
+        }
+        h_mgr->lookahead.i_thumb_width  = param->org_width  >> SCENECUT_BLOCK_BITS;
+        h_mgr->lookahead.i_thumb_height = param->org_height >> SCENECUT_BLOCK_BITS;
+    }
+
+    /* adaptive quantization */
+    if (size_aq > 0) {
+        h_mgr->lookahead.aq_activity = (float *)mem_ptr;
+        mem_ptr += size_aq;
+        ALIGN_POINTER(mem_ptr);
+    }
+
+    /* frame costs of the first pass */
+    if (size_lowres > 0) {
+        for (i = 0; i < 2; i++) {
+            frm_lowres_t *lowres = &h_mgr->lookahead.lowres[i];
+
+            lowres->i_width  = param->org_width  >> 1;
+            lowres->i_lines  = param->org_height >> 1;
+            lowres->i_stride = XAVS2_ALIGN(lowres->i_width, 32);
+            lowres->filtered = (pel_t *)mem_ptr;
+            mem_ptr += size_lowres;
+            ALIGN_POINTER(mem_ptr);
+        }
+    }
+
     /* create an encoder handler */
+    h_mgr->param   = param;
     h_mgr->p_coder = encoder_open(param, h_mgr);
     if (h_mgr->p_coder == NULL) {
         goto fail;
     }
 
+    /* adaptive speed control starts from the configured preset level */
+    h_mgr->speed_ctrl_level = param->preset_level;
+
     /* create encoder handlers for multi-thread */
     if (h_mgr->i_frm_threads > 1 || h_mgr->i_row_threads > 1) {
         if (encoder_contexts_init(h_mgr->p_coder, h_mgr) < 0) {
@@ -416,8 +643,8 @@ void *xavs2_encoder_create(xavs2_param_t *param)
 
     /* M4: alloc memory for each node and append to image idle list */
     frame_buffer_init(h_mgr, &mem_ptr, &h_mgr->ipb,
-                      XAVS2_INPUT_NUM, FT_ENC);
-    for (i = 0; i < XAVS2_INPUT_NUM; i++) {
+                      num_input_frames, FT_ENC);
+    for (i = 0; i < num_input_frames; i++) {
         frm = h_mgr->ipb.frames[i];
         if (frm) {
             xl_append(&h_mgr->list_frames_free, frm);
@@ -445,6 +672,10 @@ void *xavs2_encoder_create(xavs2_param_t *param)
 
     h_mgr->fp_trace = NULL;
 
+#if XAVS2_STAT
+    encoder_show_memory_info(h_mgr);
+#endif
+
     /* create wrapper thread */
     if (xavs2_create_thread(&h_mgr->thread_wrapper, proc_wrapper_thread, h_mgr)) {
         xavs2_log(h_mgr, XAVS2_LOG_ERROR, "create encoding thread\n");
@@ -516,8 +747,7 @@ void xavs2_encoder_destroy(void *coder)
 int xavs2_encoder_get_buffer(void *coder, xavs2_picture_t *pic)
 {
     xavs2_handler_t *h_mgr   = (xavs2_handler_t *)coder;
-    xavs2_t         *p_coder = h_mgr->p_coder;
-    const xavs2_param_t *param = p_coder->param;
+    const xavs2_param_t *param = h_mgr->param;
     xavs2_frame_t   *frame;
 
     assert(h_mgr != NULL && pic != NULL);
@@ -593,6 +823,11 @@ int xavs2_encoder_encode(void *coder, xavs2_picture_t *pic, xavs2_outpacket_t *p
 
     assert(h_mgr != NULL);
 
+    /* parameters changed by xavs2_encoder_reconfig() since the last call */
+    if (h_mgr->b_reconfig) {
+        encoder_apply_reconfig(h_mgr);
+    }
+
     if (pic != NULL) {
         xavs2_t *h = NULL;
 
@@ -615,7 +850,7 @@ int xavs2_encoder_encode(void *coder, xavs2_picture_t *pic, xavs2_outpacket_t *p
             h = h_mgr->p_coder;
 
             /* expand border if need */
-            if (h->param->org_width != h->i_width || h->param->org_height != h->i_height) {
+            if (h_mgr->param->org_width != h->i_width || h_mgr->param->org_height != h->i_height) {
                 xavs2_frame_expand_border_mod8(h, frame);
             }
 
@@ -651,3 +886,48 @@ int xavs2_encoder_encode(void *coder, xavs2_picture_t *pic, xavs2_outpacket_t *p
 
     return 0;
 }
+
+/**
+ * ---------------------------------------------------------------------------
+ * Function   : change one encoding parameter while encoding
+ * Parameters :
+ *      [in ] : coder - pointer to wrapper of the xavs2 encoder
+ *            : name  - name of parameter
+ *            : value_string - parameter value
+ *      [out] : none
+ * Return     : zero for success, otherwise failed
+ * ---------------------------------------------------------------------------
+ */
+int xavs2_encoder_reconfig(void *coder, const char *name, const char *value_string)
+{
+    xavs2_handler_t *h_mgr = (xavs2_handler_t *)coder;
+    int ret;
+    int i;
+
+    if (h_mgr == NULL || name == NULL || value_string == NULL) {
+        return -1;
+    }
+
+    for (i = 0; tab_reconfig_names[i] != NULL; i++) {
+        if (!strcasecmp(tab_reconfig_names[i], name)) {
+            break;
+        }
+    }
+    if (tab_reconfig_names[i] == NULL) {
+        xavs2_log(h_mgr, XAVS2_LOG_ERROR, "reconfig: parameter %s can not be changed while encoding\n", name);
+        return -1;
+    }
+
+    /* collect all parameters set before the next call of xavs2_encoder_encode() */
+    xavs2_thread_mutex_lock(&h_mgr->mutex);   /* lock */
+    if (!h_mgr->b_reconfig) {
+        memcpy(&h_mgr->param_reconfig, h_mgr->param, sizeof(xavs2_param_t));
+    }
+    ret = xavs2_encoder_opt_set2(&h_mgr->param_reconfig, name, value_string);
+    if (ret == 0) {
+        h_mgr->b_reconfig = 1;
+    }
+    xavs2_thread_mutex_unlock(&h_mgr->mutex); /* unlock */
+
+    return ret;
+}
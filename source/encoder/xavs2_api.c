@@ -69,6 +69,7 @@ static xavs2_api_t api_default = {
     xavs2_encoder_destroy,
     xavs2_encoder_encode,
     xavs2_encoder_packet_unref,
+    xavs2_encoder_reconfig,
 };
 
 typedef const xavs2_api_t *(*xavs2_api_get_t)(int bit_depth);
@@ -55,6 +55,7 @@
 #else
 #include <unistd.h>
 #include <pthread.h>
+#include <sys/time.h>
 #endif
 
 #include "xavs2.h"
@@ -198,6 +199,67 @@ int test_encoder(const xavs2_api_t *api, xavs2_param_t *param)
     return 0;
 }
 
+/* ---------------------------------------------------------------------------
+ * wall clock time in microseconds
+ */
+static int64_t get_time_us(void)
+{
+#if defined(_MSC_VER)
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (int64_t)(count.QuadPart * 1000000.0 / freq.QuadPart);
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+/* ---------------------------------------------------------------------------
+ * measure the encoder startup time: parse parameters, create and destroy
+ * the encoder for 'num_loops' times (--StartupBench=N)
+ */
+int test_encoder_startup(const xavs2_api_t *api, int argc, char **argv, int num_loops)
+{
+    int64_t t_param = 0, t_create = 0, t_destroy = 0;
+    int i;
+
+    for (i = 0; i < num_loops; i++) {
+        int64_t t0 = get_time_us();
+        int64_t t1, t2, t3;
+        xavs2_param_t *param = api->opt_alloc();
+        void *encoder;
+
+        if (param == NULL || api->opt_set(param, argc, argv) < 0) {
+            fprintf(stdout, "parse contents error.\n");
+            return -1;
+        }
+        api->opt_set2(param, "log", "0");
+        t1 = get_time_us();
+
+        if ((encoder = api->encoder_create(param)) == NULL) {
+            fprintf(stdout, "create encoder error.\n");
+            api->opt_destroy(param);
+            return -1;
+        }
+        t2 = get_time_us();
+
+        api->encoder_destroy(encoder);
+        api->opt_destroy(param);
+        t3 = get_time_us();
+
+        t_param   += t1 - t0;
+        t_create  += t2 - t1;
+        t_destroy += t3 - t2;
+    }
+
+    fprintf(stdout, "startup bench: %d loops, param %.3f ms, create %.3f ms, destroy %.3f ms\n",
+            num_loops, t_param * 0.001 / num_loops, t_create * 0.001 / num_loops, t_destroy * 0.001 / num_loops);
+
+    return 0;
+}
+
 /* ---------------------------------------------------------------------------
  */
 const xavs2_api_t *load_xavs2_library(int argc, char **argv, xavs2_param_t **p_param)
@@ -258,7 +320,15 @@ int main(int argc, char **argv)
 {
     /* encoding parameters */
     xavs2_param_t *param = NULL;
+    int num_bench_loops = 0;
     int ret;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--StartupBench=", 15) == 0) {
+            num_bench_loops = atoi(argv[i] + 15);
+        }
+    }
 
     /* get API handler */
     g_api = load_xavs2_library(argc, argv, &param);
@@ -269,8 +339,13 @@ int main(int argc, char **argv)
     }
     fflush(NULL);    // flush all output streams
 
-    /* test encoding */
-    ret = test_encoder(g_api, param);
+    if (num_bench_loops > 0) {
+        /* test encoder startup */
+        ret = test_encoder_startup(g_api, argc, argv, num_bench_loops);
+    } else {
+        /* test encoding */
+        ret = test_encoder(g_api, param);
+    }
 
     /* free spaces */
     g_api->opt_destroy(param);
@@ -43,7 +43,7 @@
 extern "C" {    // only need to export C interface if used by C++ source code
 #endif
 
-#define XAVS2_BUILD         13        /* xavs2 build version */
+#define XAVS2_BUILD         14        /* xavs2 build version */
 
 /**
  * ===========================================================================
@@ -361,6 +361,25 @@ typedef struct xavs2_api_t {
      * ---------------------------------------------------------------------------
      */
     int (*encoder_packet_unref)(void *coder, xavs2_outpacket_t *packet);
+
+    /**
+     * ---------------------------------------------------------------------------
+     * Function   : change one encoding parameter while encoding, without re-creating the encoder
+     * Parameters :
+     *      [in ] : coder - pointer to handle of xavs2 encoder (return by `encoder_create()`)
+     *            : name  - name of parameter, the same as in `opt_set2()`
+     *            : value_string - parameter value
+     *      [out] : none
+     * Return     : zero for success, otherwise failed
+     * Note       : only TargetBitRate, QP, MinQP, MaxQP, Preset, IntraPeriodMax and IntraPeriodMin
+     *              are accepted. Parameters set before the next `encoder_encode()` call are applied
+     *              together to the frames which start encoding after it, the intra period from
+     *              the next I frame.
+     *              A new preset level switches the fast algorithms only; the tools which are
+     *              decided at creation (search range, RDO levels, references, ALF, ...) are kept.
+     * ---------------------------------------------------------------------------
+     */
+    int (*encoder_reconfig)(void *coder, const char *name, const char *value_string);
 } xavs2_api_t;
 
 